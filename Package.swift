@@ -22,24 +22,37 @@ let package = Package(
     ],
     dependencies: [
         .package(name: "libextobjc", url: "https://github.com/SRGSSR/libextobjc.git", .exact("0.6.0-srg4")),
-        .package(name: "MAKVONotificationCenter", url: "https://github.com/SRGSSR/MAKVONotificationCenter.git", .exact("1.0.0-srg6")),
         .package(name: "SRGLogger", url: "https://github.com/SRGSSR/srglogger-apple.git", .upToNextMinor(from: "3.1.0"))
     ],
     targets: [
         .target(
             name: "SRGNetwork",
-            dependencies: ["libextobjc", "MAKVONotificationCenter", "SRGLogger"],
+            dependencies: ["libextobjc", "SRGLogger"],
             resources: [
                 .process("Resources")
             ],
             cSettings: [
                 .define("MARKETING_VERSION", to: "\"\(ProjectSettings.marketingVersion)\""),
                 .define("NS_BLOCK_ASSERTIONS", to: "1", .when(configuration: .release))
+            ],
+            linkerSettings: [
+                .linkedLibrary("z")
+            ]
+        ),
+        .target(
+            name: "SRGNetworkTestSupport",
+            path: "Tests/SRGNetworkTestSupport",
+            linkerSettings: [
+                .linkedLibrary("z")
             ]
         ),
         .testTarget(
             name: "SRGNetworkTests",
-            dependencies: ["SRGNetwork"]
+            dependencies: ["SRGNetwork", "SRGNetworkTestSupport"]
+        ),
+        .testTarget(
+            name: "SRGNetworkBenchmarks",
+            dependencies: ["SRGNetwork", "SRGNetworkTestSupport"]
         )
     ]
 )
@@ -0,0 +1,32 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGLatencyHistogram.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Histogram into which durations can be recorded from any thread without locking.
+ */
+@interface SRGAtomicHistogram : NSObject
+
+/**
+ *  Record a duration. Negative durations are ignored.
+ */
+- (void)recordDuration:(NSTimeInterval)duration;
+
+/**
+ *  Return a snapshot of the durations recorded so far, `nil` if none has been recorded.
+ *
+ *  @discussion Durations recorded while the snapshot is taken might only be partially reflected by its statistics.
+ */
+- (nullable SRGLatencyHistogram *)snapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
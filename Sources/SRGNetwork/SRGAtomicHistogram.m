@@ -0,0 +1,84 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAtomicHistogram.h"
+
+#import "SRGLatencyHistogram+Private.h"
+
+#import <stdatomic.h>
+
+@interface SRGAtomicHistogram () {
+@private
+    _Atomic(uint64_t) *_bucketCounts;
+    _Atomic(uint64_t) _sum;
+    _Atomic(uint64_t) _minimum;
+    _Atomic(uint64_t) _maximum;
+}
+
+@end
+
+@implementation SRGAtomicHistogram
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _bucketCounts = calloc(SRGLatencyHistogramBucketCount, sizeof(_Atomic(uint64_t)));
+        atomic_init(&_sum, 0);
+        atomic_init(&_minimum, UINT64_MAX);
+        atomic_init(&_maximum, 0);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_bucketCounts);
+}
+
+#pragma mark Recording
+
+- (void)recordDuration:(NSTimeInterval)duration
+{
+    if (duration < 0.) {
+        return;
+    }
+    
+    // Relaxed ordering is sufficient since values are independent counters, only read for statistical purposes
+    uint64_t microseconds = (uint64_t)(duration * USEC_PER_SEC);
+    atomic_fetch_add_explicit(&_bucketCounts[SRGLatencyHistogramBucketIndex(microseconds)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_sum, microseconds, memory_order_relaxed);
+    
+    uint64_t minimum = atomic_load_explicit(&_minimum, memory_order_relaxed);
+    while (microseconds < minimum && ! atomic_compare_exchange_weak_explicit(&_minimum, &minimum, microseconds, memory_order_relaxed, memory_order_relaxed));
+    
+    uint64_t maximum = atomic_load_explicit(&_maximum, memory_order_relaxed);
+    while (microseconds > maximum && ! atomic_compare_exchange_weak_explicit(&_maximum, &maximum, microseconds, memory_order_relaxed, memory_order_relaxed));
+}
+
+#pragma mark Snapshot
+
+- (SRGLatencyHistogram *)snapshot
+{
+    uint64_t bucketCounts[SRGLatencyHistogramBucketCount];
+    uint64_t count = 0;
+    for (NSUInteger i = 0; i < SRGLatencyHistogramBucketCount; i++) {
+        bucketCounts[i] = atomic_load_explicit(&_bucketCounts[i], memory_order_relaxed);
+        count += bucketCounts[i];
+    }
+    
+    if (count == 0) {
+        return nil;
+    }
+    
+    return [[SRGLatencyHistogram alloc] initWithBucketCounts:bucketCounts
+                                                         sum:atomic_load_explicit(&_sum, memory_order_relaxed)
+                                                     minimum:atomic_load_explicit(&_minimum, memory_order_relaxed)
+                                                     maximum:atomic_load_explicit(&_maximum, memory_order_relaxed)];
+}
+
+@end
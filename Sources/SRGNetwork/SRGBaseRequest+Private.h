@@ -0,0 +1,38 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGBaseRequest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SRGRequestBatcher;
+@class SRGRequestQueue;
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGBaseRequest (Private)
+
+/**
+ *  The queues the request belongs to, in the order it was added to them. A request can belong to several queues, each
+ *  one being notified each time the running status of the request changes. Queues are not retained.
+ */
+@property (nonatomic, readonly) NSArray<SRGRequestQueue *> *requestQueues;
+
+/**
+ *  Add the request to the specified queue. Does nothing if the request already belongs to it.
+ */
+- (void)addRequestQueue:(SRGRequestQueue *)requestQueue;
+
+/**
+ *  The batcher the request is performed with, if any, and the key identifying its item within batches.
+ */
+@property (nonatomic, nullable) SRGRequestBatcher *batcher;
+@property (nonatomic, copy, nullable) NSString *batchKey;
+
+@end
+
+NS_ASSUME_NONNULL_END
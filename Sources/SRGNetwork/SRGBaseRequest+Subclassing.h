@@ -5,12 +5,15 @@
 //
 
 #import "SRGBaseRequest.h"
+#import "SRGJSONStreamParser.h"
 #import "SRGNetworkTypes.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 // Blocks signatures.
 typedef void (^SRGObjectExtractor)(id _Nullable object, NSURLResponse * _Nullable response);
+typedef SRGJSONStreamParser * _Nonnull (^SRGStreamParserProvider)(void);
+typedef void (^SRGResultHandler)(id _Nullable object, NSURLResponse * _Nullable response);
 
 /**
  *  Methods accessible to `SRGBaseRequest` subclasses.
@@ -37,11 +40,43 @@ typedef void (^SRGObjectExtractor)(id _Nullable object, NSURLResponse * _Nullabl
                          extractor:(nullable SRGObjectExtractor)extractor
                    completionBlock:(SRGObjectCompletionBlock)completionBlock;
 
+/**
+ *  Apply the settings of another request (all settings except options, which have to be applied separately) to the
+ *  receiver. Subclasses must call this method when creating derived requests so that settings are preserved.
+ */
+- (void)applySettingsFromRequest:(SRGBaseRequest *)request;
+
+/**
+ *  Start the request, completing it with the specified result (as if it had been received and parsed) without any
+ *  network access. The extractor and the completion block are called as usual.
+ */
+- (void)resumeWithObject:(nullable id)object response:(nullable NSURLResponse *)response;
+
+/**
+ *  Start the request, obtaining its result from the provider (called synchronously), which must call the result handler
+ *  exactly once, possibly later and from any thread. The request then completes as with `-resumeWithObject:response:`,
+ *  or is performed as usual if no object is provided. Results provided after the request has been cancelled are
+ *  ignored.
+ */
+- (void)resumeWithResultProvider:(void (^)(SRGResultHandler resultHandler))resultProvider;
+
 /**
  *  The parser to be used, if any.
  */
 @property (nonatomic, readonly, copy, nullable) SRGResponseParser parser;
 
+/**
+ *  If set, a fresh incremental parser is obtained from this block each time the request is started, and fed with data
+ *  as it is received. The parser is then used instead of `parser`, and the response cache is ignored.
+ */
+@property (nonatomic, copy, nullable) SRGStreamParserProvider streamParserProvider;
+
+/**
+ *  The length of the (decoded) data the object delivered by the request was parsed from, 0 if unknown (e.g. for streamed
+ *  responses or results provided with `-resumeWithObject:response:`). Available from the extractor.
+ */
+@property (atomic, readonly) NSUInteger parsedDataLength;
+
 @end
 
 NS_ASSUME_NONNULL_END
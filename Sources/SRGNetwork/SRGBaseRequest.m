@@ -8,27 +8,113 @@
 
 #import "NSBundle+SRGNetwork.h"
 #import "NSHTTPURLResponse+SRGNetwork.h"
+#import "SRGBaseRequest+Private.h"
 #import "SRGBaseRequest+Subclassing.h"
-#import "SRGNetworkActivityManagement.h"
+#import "SRGBatchTask.h"
+#import "SRGCancellationToken+Private.h"
+#import "SRGCoalescedTask.h"
+#import "SRGConnectionPrewarmer+Private.h"
+#import "SRGContentCoding+Private.h"
+#import "SRGHedgedTask.h"
+#import "SRGMainQueueDelivery.h"
+#import "SRGMetricsCollector+Private.h"
+#import "SRGNetworkActivityManagement+Private.h"
 #import "SRGNetworkError.h"
+#import "SRGNetworkLogger.h"
+#import "SRGParsingExecutor+Private.h"
+#import "SRGRequestMetrics+Private.h"
+#import "SRGRequestBatcher+Private.h"
+#import "SRGRequestQueue+Private.h"
+#import "SRGResponseCache+Private.h"
+#import "SRGStreamingSessionDelegate.h"
+#import "SRGTaskMetricsDelegate.h"
 
-@interface SRGBaseRequest ()
+#import <os/lock.h>
+
+@import libextobjc;
+
+static NSError *SRGBaseRequestInvalidDataError(NSError *parsingError);
+static NSError *SRGBaseRequestDeadlineExceededError(NSURLRequest *URLRequest);
+static NSError *SRGBaseRequestHTTPError(NSHTTPURLResponse *HTTPURLResponse);
+static NSData *SRGBaseRequestMappedData(NSURL *fileURL, NSError * __autoreleasing *pError);
+static dispatch_queue_t SRGBaseRequestCompletionQueue(void);
+
+@interface SRGBaseRequest () {
+@private
+    os_unfair_lock _runningLock;
+    
+    // Protected by the running lock, since they are accessed from the parsing executor, from retry timers and from
+    // `-cancel`
+    NSURLSessionTask *_sessionTask;
+    SRGCoalescedTask *_coalescedTask;
+    SRGBatchTask *_batchTask;
+    SRGHedgedTask *_hedgedTask;
+    dispatch_block_t _pendingFinishBlock;
+    dispatch_block_t _pendingRetryBlock;
+    
+    // Queues the request belongs to, in the order it was added to them (weak, protected by the running lock as well)
+    NSPointerArray *_requestQueues;
+}
 
 @property (nonatomic) NSURLRequest *URLRequest;
 @property (nonatomic) NSURLSession *session;
 @property (nonatomic) SRGRequestOptions options;
+@property (nonatomic) SRGResponseCache *responseCache;
+@property (nonatomic) NSTimeInterval maximumStaleness;
+@property (nonatomic) SRGParsingExecutor *parsingExecutor;
+@property (nonatomic) NSQualityOfService parsingQualityOfService;
+@property (nonatomic) float priority;
+@property (nonatomic) SRGRetryPolicy *retryPolicy;
+@property (nonatomic) SRGHedgingPolicy *hedgingPolicy;
+@property (nonatomic) SRGMetricsCollector *metricsCollector;
+@property (nonatomic, copy) NSArray<SRGContentCoding *> *contentCodings;
+@property (nonatomic) SRGContentCoding *bodyContentCoding;
+@property (nonatomic) NSUInteger minimumBodyLength;
+@property (nonatomic) NSDate *deadline;
 @property (nonatomic, copy) SRGResponseParser parser;
+@property (nonatomic, copy) SRGStreamParserProvider streamParserProvider;
 @property (nonatomic, copy) SRGObjectExtractor extractor;
 @property (nonatomic, copy) SRGObjectCompletionBlock completionBlock;
 
+@property (nonatomic) NSURLRequest *transportURLRequest;
 @property (nonatomic) NSURLSessionTask *sessionTask;
+@property (nonatomic) SRGCoalescedTask *coalescedTask;
+@property (nonatomic) SRGBatchTask *batchTask;
+@property (nonatomic) SRGHedgedTask *hedgedTask;
+
+@property (nonatomic) NSUInteger numberOfAttempts;
+@property (nonatomic) NSDate *firstAttemptDate;
+
+@property (atomic) SRGCancellationToken *cancellationToken;
+@property (nonatomic) NSDate *effectiveDeadline;
+@property (atomic) NSError *expirationError;
+
+@property (nonatomic) SRGRequestMetrics *runningMetrics;
+@property (atomic) SRGRequestMetrics *metrics;
+@property (atomic) SRGConnectionReuse connectionReuse;
+@property (atomic) SRGCachedResponse *staleCachedResponse;
+@property (atomic, getter=isRevalidating) BOOL revalidating;
+@property (atomic, getter=isStale) BOOL stale;
+@property (atomic) NSUInteger parsedDataLength;
+
+// Serial, so that a stale result is always delivered before the fresh one, but targeting a concurrent queue shared
+// by all requests
+@property (nonatomic) dispatch_queue_t completionQueue;
 
 @property (nonatomic, getter=isRunning) BOOL running;
+@property (nonatomic) SRGNetworkActivityHostCounter *hostCounter;
+@property (nonatomic) SRGRequestBatcher *batcher;
+@property (nonatomic, copy) NSString *batchKey;
 
 @end
 
 @implementation SRGBaseRequest
 
+@synthesize sessionTask = _sessionTask;
+@synthesize coalescedTask = _coalescedTask;
+@synthesize batchTask = _batchTask;
+@synthesize hedgedTask = _hedgedTask;
+
 #pragma mark Object lifecycle
 
 - (instancetype)initWithURLRequest:(NSURLRequest *)URLRequest
@@ -39,10 +125,16 @@
 {
     if (self = [super init]) {
         self.URLRequest = URLRequest;
+        self.hostCounter = [SRGNetworkActivityHostCounter counterForHost:URLRequest.URL.host];
         self.session = session;
         self.parser = parser;
         self.extractor = extractor;
         self.completionBlock = completionBlock;
+        self.parsingQualityOfService = NSQualityOfServiceUserInitiated;
+        self.priority = NSURLSessionTaskPriorityDefault;
+        self.completionQueue = dispatch_queue_create_with_target("ch.srgssr.network.request.completion", DISPATCH_QUEUE_SERIAL, SRGBaseRequestCompletionQueue());
+        _runningLock = OS_UNFAIR_LOCK_INIT;
+        _requestQueues = [NSPointerArray weakObjectsPointerArray];
     }
     return self;
 }
@@ -58,25 +150,120 @@
 - (void)dealloc
 {
     self.running = NO;
+    [self.coalescedTask removeSubscriber:self];
+    [self.batchTask removeSubscriber:self];
+    [self.hedgedTask cancel];
     [self.sessionTask cancel];
 }
 
 #pragma mark Getters and setters
 
+- (SRGParsingExecutor *)parsingExecutor
+{
+    return _parsingExecutor ?: SRGParsingExecutor.sharedExecutor;
+}
+
+- (NSURLSessionTask *)sessionTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    NSURLSessionTask *sessionTask = _sessionTask;
+    os_unfair_lock_unlock(&_runningLock);
+    return sessionTask;
+}
+
+- (void)setSessionTask:(NSURLSessionTask *)sessionTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    _sessionTask = sessionTask;
+    os_unfair_lock_unlock(&_runningLock);
+}
+
+- (SRGCoalescedTask *)coalescedTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    SRGCoalescedTask *coalescedTask = _coalescedTask;
+    os_unfair_lock_unlock(&_runningLock);
+    return coalescedTask;
+}
+
+- (void)setCoalescedTask:(SRGCoalescedTask *)coalescedTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    _coalescedTask = coalescedTask;
+    os_unfair_lock_unlock(&_runningLock);
+}
+
+- (SRGBatchTask *)batchTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    SRGBatchTask *batchTask = _batchTask;
+    os_unfair_lock_unlock(&_runningLock);
+    return batchTask;
+}
+
+- (void)setBatchTask:(SRGBatchTask *)batchTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    _batchTask = batchTask;
+    os_unfair_lock_unlock(&_runningLock);
+}
+
+- (SRGHedgedTask *)hedgedTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    SRGHedgedTask *hedgedTask = _hedgedTask;
+    os_unfair_lock_unlock(&_runningLock);
+    return hedgedTask;
+}
+
+- (void)setHedgedTask:(SRGHedgedTask *)hedgedTask
+{
+    os_unfair_lock_lock(&_runningLock);
+    _hedgedTask = hedgedTask;
+    os_unfair_lock_unlock(&_runningLock);
+}
+
 - (void)setRunning:(BOOL)running
 {
-    if (running != _running) {
-        _running = running;
-        
-        if (running) {
-            [SRGNetworkActivityManagement increaseNumberOfRunningRequests];
-        }
-        else {
-            [SRGNetworkActivityManagement decreaseNumberOfRunningRequests];
-        }
+    os_unfair_lock_lock(&_runningLock);
+    BOOL changed = (running != _running);
+    _running = running;
+    os_unfair_lock_unlock(&_runningLock);
+    
+    if (! changed) {
+        return;
+    }
+    
+    if (running) {
+        [SRGNetworkActivityManagement increaseNumberOfRunningRequestsWithHostCounter:self.hostCounter];
+    }
+    else {
+        [SRGNetworkActivityManagement decreaseNumberOfRunningRequestsWithHostCounter:self.hostCounter];
+    }
+    
+    for (SRGRequestQueue *requestQueue in self.requestQueues) {
+        [requestQueue requestRunningStatusDidChange:self];
     }
 }
 
+- (NSArray<SRGRequestQueue *> *)requestQueues
+{
+    os_unfair_lock_lock(&_runningLock);
+    NSArray<SRGRequestQueue *> *requestQueues = _requestQueues.allObjects;
+    os_unfair_lock_unlock(&_runningLock);
+    return requestQueues;
+}
+
+- (void)addRequestQueue:(SRGRequestQueue *)requestQueue
+{
+    os_unfair_lock_lock(&_runningLock);
+    [_requestQueues compact];
+    if (! [_requestQueues.allObjects containsObject:requestQueue]) {
+        [_requestQueues addPointer:(__bridge void *)requestQueue];
+    }
+    os_unfair_lock_unlock(&_runningLock);
+}
+
 #pragma mark Options
 
 - (SRGBaseRequest *)requestWithOptions:(SRGRequestOptions)options
@@ -86,6 +273,114 @@
     return request;
 }
 
+#pragma mark Settings
+
+- (SRGBaseRequest *)requestWithResponseCache:(SRGResponseCache *)responseCache
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.responseCache = responseCache;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithMaximumStaleness:(NSTimeInterval)maximumStaleness
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.maximumStaleness = fmax(maximumStaleness, 0.);
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithParsingExecutor:(SRGParsingExecutor *)parsingExecutor
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.parsingExecutor = parsingExecutor;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithParsingQualityOfService:(NSQualityOfService)parsingQualityOfService
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.parsingQualityOfService = parsingQualityOfService;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithPriority:(float)priority
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.priority = fminf(fmaxf(priority, NSURLSessionTaskPriorityLow), NSURLSessionTaskPriorityHigh);
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithHedgingPolicy:(SRGHedgingPolicy *)hedgingPolicy
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.hedgingPolicy = hedgingPolicy;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithMetricsCollector:(SRGMetricsCollector *)metricsCollector
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.metricsCollector = metricsCollector;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithRetryPolicy:(SRGRetryPolicy *)retryPolicy
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.retryPolicy = retryPolicy;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithContentCodings:(NSArray<SRGContentCoding *> *)contentCodings
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.contentCodings = contentCodings;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithBodyContentCoding:(SRGContentCoding *)bodyContentCoding minimumBodyLength:(NSUInteger)minimumBodyLength
+{
+    NSParameterAssert(! bodyContentCoding || bodyContentCoding.encoder);
+    
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.bodyContentCoding = bodyContentCoding;
+    request.minimumBodyLength = minimumBodyLength;
+    return request;
+}
+
+- (SRGBaseRequest *)requestWithDeadline:(NSDate *)deadline
+{
+    SRGBaseRequest *request = [self requestWithOptions:self.options];
+    request.deadline = deadline;
+    return request;
+}
+
+- (void)applySettingsFromRequest:(SRGBaseRequest *)request
+{
+    self.responseCache = request.responseCache;
+    self.maximumStaleness = request.maximumStaleness;
+    self.parsingExecutor = request->_parsingExecutor;
+    self.parsingQualityOfService = request.parsingQualityOfService;
+    self.priority = request.priority;
+    self.retryPolicy = request.retryPolicy;
+    self.hedgingPolicy = request.hedgingPolicy;
+    self.metricsCollector = request.metricsCollector;
+    self.streamParserProvider = request.streamParserProvider;
+    self.contentCodings = request.contentCodings;
+    self.bodyContentCoding = request.bodyContentCoding;
+    self.minimumBodyLength = request.minimumBodyLength;
+    self.deadline = request.deadline;
+    self.batcher = request.batcher;
+    self.batchKey = request.batchKey;
+}
+
+- (SRGResponseCache *)usableResponseCache
+{
+    // Streamed responses are never buffered and therefore cannot be cached. Batch responses are not associated with
+    // the request built for a single key, and cannot be cached either.
+    return (self.streamParserProvider || self.batcher) ? nil : self.responseCache;
+}
+
 #pragma mark Session task management
 
 - (void)resume
@@ -94,107 +389,802 @@
         return;
     }
     
+    [self beginRunning];
+    [self performAttempts];
+}
+
+- (void)beginRunning
+{
+    self.running = YES;
+    self.runningMetrics = [self.metricsCollector metricsForURLRequest:self.URLRequest];
+    self.connectionReuse = SRGConnectionReuseUnknown;
+    self.staleCachedResponse = nil;
+    self.stale = NO;
+    self.parsedDataLength = 0;
+    self.cancellationToken = [[SRGCancellationToken alloc] init];
+    self.expirationError = nil;
+}
+
+- (void)performAttempts
+{
+    self.numberOfAttempts = 0;
+    self.firstAttemptDate = NSDate.date;
+    
+    // Request bodies are encoded once for all attempts. Responses are cached for the original request.
+    self.transportURLRequest = SRGContentCodingURLRequest(self.URLRequest, self.contentCodings, self.bodyContentCoding, self.minimumBodyLength);
+    
+    // The earliest of the request deadline and of the deadlines of its queues applies
+    NSDate *deadline = self.deadline;
+    for (SRGRequestQueue *requestQueue in self.requestQueues) {
+        NSDate *queueDeadline = requestQueue.deadline;
+        if (queueDeadline && (! deadline || [queueDeadline compare:deadline] == NSOrderedAscending)) {
+            deadline = queueDeadline;
+        }
+    }
+    self.effectiveDeadline = deadline;
+    
+    if (deadline) {
+        // Requests started too late (e.g. waiting in a queue whose budget has been exhausted) are never attempted
+        NSTimeInterval remainingTime = deadline.timeIntervalSinceNow;
+        if (remainingTime <= 0.) {
+            NSError *expirationError = SRGBaseRequestDeadlineExceededError(self.URLRequest);
+            [self finishAsynchronouslyWithBlock:^{
+                [self finishWithObject:nil response:nil error:expirationError];
+            }];
+            return;
+        }
+        [self scheduleExpirationAfterInterval:remainingTime];
+    }
+    
+    if (self.streamParserProvider) {
+        [self resumeStreaming];
+        return;
+    }
+    
+    SRGResponseCache *responseCache = self.usableResponseCache;
+    if (! responseCache) {
+        [self attemptWithCachedResponse:nil];
+        return;
+    }
+    
+    // Cache lookups might read from disk, and are therefore performed by the parsing executor, like the parsing
+    // of cached responses which usually follows. Cancellation is detected as for finish blocks.
+    [self finishAsynchronouslyWithBlock:^{
+        [self resumeWithResponseCache:responseCache];
+    }];
+}
+
+- (void)resumeWithResponseCache:(SRGResponseCache *)responseCache
+{
+    // Fresh cached responses are used without any network access
+    SRGCachedResponse *cachedResponse = [responseCache cachedResponseForURLRequest:self.URLRequest];
+    if (cachedResponse.fresh) {
+        [responseCache recordHit];
+        [self finishWithCachedResponse:cachedResponse];
+        return;
+    }
+    
+    // Stale cached responses can be used while being revalidated
+    NSTimeInterval maximumStaleness = self.maximumStaleness;
+    if (cachedResponse && maximumStaleness > 0. && [cachedResponse isUsableStaleWithMaximumStaleness:maximumStaleness]) {
+        [responseCache recordStaleHit];
+        [self deliverStaleCachedResponse:cachedResponse];
+        return;
+    }
+    
+    [self attemptWithCachedResponse:cachedResponse];
+}
+
+- (void)attemptWithCachedResponse:(SRGCachedResponse *)cachedResponse
+{
+    self.numberOfAttempts++;
+    
+    // Stale cached responses are revalidated
+    NSURLRequest *URLRequest = cachedResponse ? [cachedResponse conditionalURLRequestForURLRequest:self.transportURLRequest] : self.transportURLRequest;
+    self.revalidating = cachedResponse.revalidatable;
+    
     // No weakify / strongify dance here, so that the request retains itself while it is running
-    void (^completionBlock)(NSData * _Nullable, NSURLResponse * _Nullable, NSError * _Nullable) = ^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-        if (data) {
-            self.extractor ? self.extractor(data, response) : nil;
+    if (self.batcher) {
+        NSString *batchKey = self.batchKey;
+        self.batchTask = [self.batcher taskForKey:batchKey subscriber:self priority:self.priority completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error, SRGBatchTask *batchTask) {
+            [self processDataAsynchronously:data response:response error:error withParser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+                return [batchTask objectForKey:batchKey fromData:data error:pError];
+            }];
+        }];
+    }
+    else if ((self.options & SRGRequestOptionDownloadToFileEnabled) != 0) {
+        self.sessionTask = [self.session downloadTaskWithRequest:URLRequest completionHandler:^(NSURL * _Nullable location, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            // The downloaded file is removed when the handler returns, and must therefore be mapped immediately
+            NSData *data = nil;
+            if (location && ! error) {
+                NSError *mappingError = nil;
+                data = SRGBaseRequestMappedData(location, &mappingError);
+                error = mappingError;
+            }
+            [self processDataAsynchronously:data response:response error:error withParser:self.parser];
+        }];
+        [self resumeSessionTask];
+    }
+    else if ((self.options & SRGRequestOptionCoalescingEnabled) != 0 && SRGCoalescedTaskIsSupportedForURLRequest(URLRequest)) {
+        self.coalescedTask = [SRGCoalescedTask taskWithURLRequest:URLRequest session:self.session subscriber:self completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error, SRGCoalescedTask *coalescedTask) {
+            [self processDataAsynchronously:data response:response error:error withParser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+                return [coalescedTask objectFromData:data withParser:self.parser error:pError];
+            }];
+        }];
+        [self.coalescedTask raisePriority:self.priority];
+    }
+    else if (self.hedgingPolicy && SRGHedgedTaskIsSupportedForURLRequest(URLRequest)) {
+        self.hedgedTask = [[SRGHedgedTask alloc] initWithURLRequest:URLRequest session:self.session hedgingPolicy:self.hedgingPolicy priority:self.priority completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [self processDataAsynchronously:data response:response error:error withParser:self.parser];
+        }];
+        [self.hedgedTask resume];
+    }
+    else {
+        self.sessionTask = [self.session dataTaskWithRequest:URLRequest completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [self processDataAsynchronously:data response:response error:error withParser:self.parser];
+        }];
+        [self resumeSessionTask];
+    }
+    
+    // Retries are attempted from a background queue. If the request was cancelled while the attempt was being made,
+    // the work just started might have been missed by `-cancel`, and must be cancelled as well.
+    if (self.cancellationToken.cancelled) {
+        [self cancelPendingWork];
+    }
+}
+
+- (void)scheduleExpirationAfterInterval:(NSTimeInterval)interval
+{
+    // Requests must not be kept alive until their deadline. The token identifies the execution the timer belongs to.
+    SRGCancellationToken *cancellationToken = self.cancellationToken;
+    
+    // Cancellation is performed on the main thread, as for requests cancelled by their client
+    @weakify(self)
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        @strongify(self)
+        if (! self || self.cancellationToken != cancellationToken || cancellationToken.cancelled || ! self.running) {
+            return;
         }
         
-        if ((self.options & SRGRequestOptionBackgroundCompletionEnabled) == 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                self.completionBlock(data, response, error);
-            });
+        SRGNetworkLogInfo(@"Request", @"The deadline of %@ has been exceeded. Cancelling.", self);
+        self.expirationError = SRGBaseRequestDeadlineExceededError(self.URLRequest);
+        [self cancel];
+    });
+}
+
+- (void)resumeSessionTask
+{
+    self.sessionTask.priority = self.priority;
+    
+    // Connection reuse is only determined when metrics are collected anyway, or when connections might have been
+    // prewarmed
+    SRGRequestMetrics *metrics = self.runningMetrics;
+    SRGConnectionPrewarmer *connectionPrewarmer = [SRGConnectionPrewarmer prewarmerForSession:self.session];
+    if (metrics || connectionPrewarmer) {
+        @weakify(self)
+        [SRGTaskMetricsDelegate observeMetricsForTask:self.sessionTask withHandler:^(NSURLSessionTaskMetrics * _Nonnull taskMetrics) {
+            @strongify(self)
+            [metrics applyTaskMetrics:taskMetrics];
+            self.connectionReuse = connectionPrewarmer ? [connectionPrewarmer connectionReuseForTaskMetrics:taskMetrics] : SRGConnectionReuseForTaskMetrics(taskMetrics);
+        }];
+    }
+    [self.sessionTask resume];
+}
+
+- (void)resumeWithObject:(id)object response:(NSURLResponse *)response
+{
+    if (self.running) {
+        return;
+    }
+    
+    [self beginRunning];
+    [self finishAsynchronouslyWithBlock:^{
+        [self finishWithObject:object response:response error:nil];
+    }];
+}
+
+- (void)resumeWithResultProvider:(void (^)(SRGResultHandler))resultProvider
+{
+    if (self.running) {
+        return;
+    }
+    
+    [self beginRunning];
+    
+    // Cancellation while waiting for the result is detected as for finish blocks. The block identity is used to
+    // detect cancellation, the request retaining itself until the result is available.
+    dispatch_block_t attemptBlock = [^{
+        [self performAttempts];
+    } copy];
+    os_unfair_lock_lock(&_runningLock);
+    _pendingFinishBlock = attemptBlock;
+    os_unfair_lock_unlock(&_runningLock);
+    
+    resultProvider(^(id _Nullable object, NSURLResponse * _Nullable response) {
+        if (! [self claimPendingFinishBlock:attemptBlock]) {
+            return;
+        }
+        
+        if (object) {
+            [self finishAsynchronouslyWithBlock:^{
+                [self finishWithObject:object response:response error:nil];
+            }];
         }
         else {
-            self.completionBlock(data, response, error);
+            attemptBlock();
+        }
+    });
+}
+
+- (void)finishAsynchronouslyWithBlock:(dispatch_block_t)block
+{
+    // The block identity is used to detect cancellation before it could be executed
+    dispatch_block_t finishBlock = [block copy];
+    os_unfair_lock_lock(&_runningLock);
+    _pendingFinishBlock = finishBlock;
+    os_unfair_lock_unlock(&_runningLock);
+    
+    [self.parsingExecutor executeBlock:^{
+        if (! [self claimPendingFinishBlock:finishBlock]) {
+            return;
         }
         
-        self.running = NO;
+        finishBlock();
+    } withQualityOfService:self.parsingQualityOfService];
+}
+
+// Atomically clear the pending finish block if it is the specified one, returning whether it was cleared. Only the
+// side which claims the block (its execution or `-cancel`) may proceed, so that a block is never both executed and
+// reported as cancelled.
+- (BOOL)claimPendingFinishBlock:(dispatch_block_t)finishBlock
+{
+    os_unfair_lock_lock(&_runningLock);
+    BOOL claimed = (_pendingFinishBlock == finishBlock);
+    if (claimed) {
+        _pendingFinishBlock = nil;
+    }
+    os_unfair_lock_unlock(&_runningLock);
+    return claimed;
+}
+
+- (void)resumeStreaming
+{
+    self.numberOfAttempts++;
+    
+    SRGJSONStreamParser *streamParser = self.streamParserProvider();
+    
+    // Received data is parsed by the parsing executor, so that the session delegate queue is never blocked. Blocks of
+    // the serial queue are executed one after the other, no synchronization is therefore required.
+    SRGParsingSerialQueue *parsingQueue = [self.parsingExecutor serialQueueWithQualityOfService:self.parsingQualityOfService];
+    __block BOOL parsingEnabled = NO;
+    __block NSError *parsingError = nil;
+    __block id<SRGContentDecoder> decoder = nil;
+    
+    // Decoded chunks are parsed as they are produced, so that neither the encoded nor the decoded body is buffered
+    SRGContentDecoderOutputBlock decodedDataBlock = ^(NSData *decodedData) {
+        NSError *error = nil;
+        if (! parsingError && ! [streamParser parseData:decodedData error:&error]) {
+            parsingError = error;
+        }
     };
     
-    self.sessionTask = [self.session dataTaskWithRequest:self.URLRequest completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-        if (error) {
-            if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) {
-                if ((self.options & SRGRequestOptionCancellationErrorsEnabled) == 0) {
-                    return;
+    // No weakify / strongify dance here, so that the request retains itself while it is running
+    self.sessionTask = [SRGStreamingSessionDelegate dataTaskWithURLRequest:self.transportURLRequest session:self.session responseHandler:^(NSURLResponse * _Nonnull response) {
+        [parsingQueue executeBlock:^{
+            // Bodies of unsuccessful responses are not parsed
+            parsingEnabled = ! [response isKindOfClass:NSHTTPURLResponse.class] || ((NSHTTPURLResponse *)response).statusCode < 300;
+            SRGContentCoding *contentCoding = SRGContentCodingForResponse(response, self.contentCodings);
+            decoder = contentCoding ? contentCoding.decoderProvider() : nil;
+        }];
+    } dataHandler:^(NSData * _Nonnull data) {
+        [parsingQueue executeBlock:^{
+            if (! parsingEnabled || parsingError) {
+                return;
+            }
+            
+            NSError *error = nil;
+            if (decoder) {
+                if (! [decoder decodeData:data withBlock:decodedDataBlock error:&error]) {
+                    parsingError = error;
                 }
             }
-            else if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorServerCertificateUntrusted) {
-                if ((self.options & SRGRequestOptionFriendlyWiFiMessagesDisabled) == 0) {
-                    NSMutableDictionary *userInfo = error.userInfo.mutableCopy;
-                    userInfo[NSLocalizedDescriptionKey] = SRGNetworkLocalizedString(@"You are likely connected to a public WiFi network with no Internet access", @"The error message when request a media or a media list on a public network with no Internet access (e.g. SBB)");
-                    
-                    NSError *publicWiFiError = [NSError errorWithDomain:error.domain
-                                                                   code:error.code
-                                                               userInfo:userInfo.copy];
-                    completionBlock(nil, response, publicWiFiError);
-                    return;
+            else if (! [streamParser parseData:data error:&error]) {
+                parsingError = error;
+            }
+        }];
+    } completionHandler:^(NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [parsingQueue executeBlock:^{
+            if (parsingEnabled && ! parsingError && ! error && decoder) {
+                NSError *decodingError = nil;
+                if (! [decoder finishWithBlock:decodedDataBlock error:&decodingError]) {
+                    parsingError = decodingError;
                 }
             }
             
-            completionBlock(nil, response, error);
-            return;
+            [self processData:NSData.data response:response error:error withParser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+                if (parsingError) {
+                    if (pError) {
+                        *pError = parsingError;
+                    }
+                    return nil;
+                }
+                return [streamParser finishWithError:pError];
+            }];
+        }];
+    }];
+    self.sessionTask.priority = self.priority;
+    [self.sessionTask resume];
+}
+
+- (void)cancel
+{
+    // Requests waiting to be started by their queue must not be started anymore
+    for (SRGRequestQueue *requestQueue in self.requestQueues) {
+        [requestQueue requestWasCancelled:self];
+    }
+    
+    self.running = NO;
+    
+    // Responses already received are not parsed anymore, and parsers in progress can stop early
+    [self.cancellationToken cancel];
+    
+    [self cancelPendingWork];
+}
+
+// Pending work is claimed atomically, so that it is either cancelled here or performed, never both
+- (void)cancelPendingWork
+{
+    os_unfair_lock_lock(&_runningLock);
+    NSURLSessionTask *sessionTask = _sessionTask;
+    SRGCoalescedTask *coalescedTask = _coalescedTask;
+    SRGBatchTask *batchTask = _batchTask;
+    SRGHedgedTask *hedgedTask = _hedgedTask;
+    BOOL hasPendingBlock = (_pendingFinishBlock || _pendingRetryBlock);
+    _coalescedTask = nil;
+    _batchTask = nil;
+    _hedgedTask = nil;
+    _pendingFinishBlock = nil;
+    _pendingRetryBlock = nil;
+    os_unfair_lock_unlock(&_runningLock);
+    
+    if (coalescedTask) {
+        // The shared task is only cancelled when its last subscriber leaves, cancellation errors must therefore be
+        // reported by the request itself
+        if ([coalescedTask removeSubscriber:self]) {
+            [self reportCancellation];
+        }
+    }
+    else if (batchTask) {
+        // Same as for coalesced tasks, the batch is only cancelled when all its logical requests have been cancelled
+        if ([batchTask removeSubscriber:self]) {
+            [self reportCancellation];
+        }
+    }
+    else if (hedgedTask) {
+        // Session tasks cancelled by a hedged task are not reported, cancellation must therefore be reported by the
+        // request itself
+        if ([hedgedTask cancel]) {
+            [self reportCancellation];
+        }
+    }
+    else if (hasPendingBlock) {
+        [self reportCancellation];
+    }
+    else {
+        [sessionTask cancel];
+    }
+}
+
+- (void)reportCancellation
+{
+    NSError *error = [self cancellationError];
+    if (! error) {
+        return;
+    }
+    
+    // Never report cancellation synchronously to avoid deadlocks when cancelling from the main thread
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [self processData:nil response:nil error:error withParser:nil];
+    });
+}
+
+// The error to report for the cancelled request, `nil` if cancellation must not be reported
+- (NSError *)cancellationError
+{
+    // Exceeded deadlines are always reported
+    NSError *expirationError = self.expirationError;
+    if (expirationError) {
+        return expirationError;
+    }
+    
+    if ((self.options & SRGRequestOptionCancellationErrorsEnabled) == 0) {
+        return nil;
+    }
+    
+    return [NSError errorWithDomain:NSURLErrorDomain
+                               code:NSURLErrorCancelled
+                           userInfo:@{ NSURLErrorFailingURLErrorKey : self.URLRequest.URL }];
+}
+
+#pragma mark Response processing
+
+- (void)processDataAsynchronously:(NSData *)data response:(NSURLResponse *)response error:(NSError *)error withParser:(SRGResponseParser)parser
+{
+    // Return control to the session delegate queue immediately, so that slow parsing never delays other responses
+    [self.parsingExecutor executeBlock:^{
+        [self processData:data response:response error:error withParser:parser];
+    } withQualityOfService:self.parsingQualityOfService];
+}
+
+- (void)processData:(NSData *)data response:(NSURLResponse *)response error:(NSError *)error withParser:(SRGResponseParser)parser
+{
+    if ([self retryAfterResponse:response error:error]) {
+        return;
+    }
+    
+    if (error) {
+        if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) {
+            NSError *expirationError = self.expirationError;
+            if (expirationError) {
+                error = expirationError;
+            }
+            else if ((self.options & SRGRequestOptionCancellationErrorsEnabled) == 0) {
+                return;
+            }
+        }
+        else if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorServerCertificateUntrusted) {
+            if ((self.options & SRGRequestOptionFriendlyWiFiMessagesDisabled) == 0) {
+                NSMutableDictionary *userInfo = error.userInfo.mutableCopy;
+                userInfo[NSLocalizedDescriptionKey] = SRGNetworkLocalizedString(@"You are likely connected to a public WiFi network with no Internet access", @"The error message when request a media or a media list on a public network with no Internet access (e.g. SBB)");
+                
+                NSError *publicWiFiError = [NSError errorWithDomain:error.domain
+                                                               code:error.code
+                                                           userInfo:userInfo.copy];
+                [self finishWithObject:nil response:response error:publicWiFiError];
+                return;
+            }
         }
         
-        if ([response isKindOfClass:NSHTTPURLResponse.class]) {
-            NSHTTPURLResponse *HTTPURLResponse = (NSHTTPURLResponse *)response;
-            NSInteger HTTPStatusCode = HTTPURLResponse.statusCode;
-            
-            // Properly handle HTTP error codes >= 400 as real errors
-            if (HTTPStatusCode >= 400) {
-                if ((self.options & SRGRequestOptionHTTPErrorsDisabled) == 0) {
-                    NSError *HTTPError = [NSError errorWithDomain:SRGNetworkErrorDomain
-                                                             code:SRGNetworkErrorHTTP
-                                                         userInfo:@{ NSLocalizedDescriptionKey : [NSHTTPURLResponse srg_localizedStringForStatusCode:HTTPStatusCode],
-                                                                     SRGNetworkFailingURLKey : response.URL,
-                                                                     SRGNetworkHTTPStatusCodeKey : @(HTTPStatusCode) }];
-                    completionBlock(nil, response, HTTPError);
+        [self finishWithObject:nil response:response error:error];
+        return;
+    }
+    
+    if ([response isKindOfClass:NSHTTPURLResponse.class]) {
+        NSHTTPURLResponse *HTTPURLResponse = (NSHTTPURLResponse *)response;
+        NSInteger HTTPStatusCode = HTTPURLResponse.statusCode;
+        
+        // Successful revalidations are served from the cache, without involving the parser again
+        SRGResponseCache *responseCache = self.usableResponseCache;
+        if (responseCache && [SRGResponseCache isCacheableURLRequest:self.URLRequest]) {
+            if (HTTPStatusCode == 304) {
+                SRGCachedResponse *cachedResponse = [responseCache revalidateCachedResponseForURLRequest:self.URLRequest withResponse:HTTPURLResponse];
+                if (cachedResponse) {
+                    [responseCache recordHit];
+                    if (self.staleCachedResponse) {
+                        [self finishRevalidation];
+                    }
+                    else {
+                        [self finishWithCachedResponse:cachedResponse];
+                    }
+                    return;
+                }
+                
+                [responseCache recordMiss];
+                
+                // The cached response has been evicted in the meantime. Since `304` responses have no body, the request
+                // is made again without conditional headers.
+                if (self.revalidating) {
+                    if (self.cancellationToken.cancelled) {
+                        [self finishCancelledWithResponse:response];
+                        return;
+                    }
+                    
+                    SRGNetworkLogInfo(@"Request", @"The response revalidated for %@ is not cached anymore. Retrieving it again.", self);
+                    [self attemptWithCachedResponse:nil];
                 }
                 else {
-                    completionBlock(nil, response, nil);
+                    [self finishWithObject:nil response:response error:SRGBaseRequestHTTPError(HTTPURLResponse)];
                 }
                 return;
             }
+            [responseCache recordMiss];
         }
         
-        if (data) {
-            NSError *parsingError = nil;
-            id object = self.parser ? self.parser(data, &parsingError) : data;
-            if (parsingError) {
-                NSError *error = [NSError errorWithDomain:SRGNetworkErrorDomain
-                                                     code:SRGNetworkErrorInvalidData
-                                                 userInfo:@{ NSLocalizedDescriptionKey : SRGNetworkLocalizedString(@"The data is invalid", @"Error message returned when a server response data is incorrect."),
-                                                             NSUnderlyingErrorKey : parsingError }];
-                completionBlock(nil, response, error);
-                return;
+        // Properly handle HTTP error codes >= 400 as real errors
+        if (HTTPStatusCode >= 400) {
+            if ((self.options & SRGRequestOptionHTTPErrorsDisabled) == 0) {
+                [self finishWithObject:nil response:response error:SRGBaseRequestHTTPError(HTTPURLResponse)];
             }
-            
-            completionBlock(object, response, nil);
+            else {
+                [self finishWithObject:nil response:response error:nil];
+            }
+            return;
         }
-        else {
-            completionBlock(nil, response, nil);
+    }
+    
+    if (data) {
+        // Responses of requests cancelled while waiting to be processed are discarded without being parsed
+        SRGCancellationToken *cancellationToken = self.cancellationToken;
+        if (cancellationToken.cancelled) {
+            [self finishCancelledWithResponse:response];
+            return;
+        }
+        
+        SRGRequestMetrics *metrics = self.runningMetrics;
+        [metrics beginPhase:SRGRequestPhaseParsing];
+        
+        // Streamed responses have already been decoded as they were received
+        NSError *parsingError = nil;
+        SRGContentCoding *contentCoding = self.streamParserProvider ? nil : SRGContentCodingForResponse(response, self.contentCodings);
+        NSData *decodedData = contentCoding ? [contentCoding decodedDataFromData:data error:&parsingError] : data;
+        
+        // Unchanged content is not parsed again, the stale result already delivered remaining valid
+        SRGCachedResponse *staleCachedResponse = self.staleCachedResponse;
+        if (decodedData && staleCachedResponse && [response isKindOfClass:NSHTTPURLResponse.class]
+                && [staleCachedResponse hasSameContentAsResponse:(NSHTTPURLResponse *)response data:decodedData]) {
+            [metrics endPhase:SRGRequestPhaseParsing];
+            [self storeData:decodedData object:[staleCachedResponse objectWithParser:self.parser error:NULL] response:response];
+            [self finishRevalidation];
+            return;
+        }
+        
+        id object = nil;
+        if (decodedData) {
+            __block id parsedObject = nil;
+            __block NSError *parserError = nil;
+            SRGCancellationTokenPerformBlock(cancellationToken, ^{
+                NSError *error = nil;
+                parsedObject = parser ? parser(decodedData, &error) : decodedData;
+                parserError = error;
+            });
+            object = parsedObject;
+            parsingError = parserError;
+            self.parsedDataLength = decodedData.length;
+        }
+        
+        [metrics endPhase:SRGRequestPhaseParsing];
+        
+        // Parsers might have stopped early, their result is meaningless
+        if (cancellationToken.cancelled) {
+            [self finishCancelledWithResponse:response];
+            return;
+        }
+        
+        if (parsingError) {
+            [self finishWithObject:nil response:response error:SRGBaseRequestInvalidDataError(parsingError)];
+            return;
+        }
+        
+        [self storeData:decodedData object:object response:response];
+        [self finishWithObject:object response:response error:nil];
+    }
+    else {
+        [self finishWithObject:nil response:response error:nil];
+    }
+}
+
+- (void)finishCancelledWithResponse:(NSURLResponse *)response
+{
+    NSError *error = [self cancellationError];
+    if (! error) {
+        return;
+    }
+    
+    [self finishWithObject:nil response:response error:error];
+}
+
+// The retry policy of the first queue the request belongs to which has one, if any
+- (SRGRetryPolicy *)queueRetryPolicy
+{
+    for (SRGRequestQueue *requestQueue in self.requestQueues) {
+        SRGRetryPolicy *retryPolicy = requestQueue.retryPolicy;
+        if (retryPolicy) {
+            return retryPolicy;
+        }
+    }
+    return nil;
+}
+
+- (BOOL)retryAfterResponse:(NSURLResponse *)response error:(NSError *)error
+{
+    // Streamed data might already have been delivered, and cannot be retrieved again
+    SRGRetryPolicy *retryPolicy = self.retryPolicy ?: [self queueRetryPolicy];
+    if (! retryPolicy || self.streamParserProvider || ! self.running) {
+        return NO;
+    }
+    
+    NSUInteger attempt = self.numberOfAttempts;
+    if (! [retryPolicy shouldRetryURLRequest:self.URLRequest afterAttempt:attempt withResponse:response error:error]) {
+        return NO;
+    }
+    
+    NSTimeInterval delay = [retryPolicy delayBeforeAttempt:attempt + 1 withResponse:response];
+    if ([NSDate.date timeIntervalSinceDate:self.firstAttemptDate] + delay > retryPolicy.timeBudget) {
+        return NO;
+    }
+    
+    NSDate *deadline = self.effectiveDeadline;
+    if (deadline && delay >= deadline.timeIntervalSinceNow) {
+        return NO;
+    }
+    
+    SRGNetworkLogInfo(@"Request", @"Attempt %@ of %@ failed. Retrying in %.2f seconds.", @(attempt), self, delay);
+    
+    // The request stays running while waiting, so that retries are invisible to request queues. The block identity
+    // is used to detect cancellation in the meantime.
+    dispatch_block_t retryBlock = ^{
+        SRGCachedResponse *cachedResponse = [self.usableResponseCache cachedResponseForURLRequest:self.URLRequest];
+        [self attemptWithCachedResponse:cachedResponse];
+    };
+    
+    os_unfair_lock_lock(&_runningLock);
+    _coalescedTask = nil;
+    _batchTask = nil;
+    _hedgedTask = nil;
+    _pendingRetryBlock = retryBlock;
+    os_unfair_lock_unlock(&_runningLock);
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        // Same as for finish blocks, only the side which claims the block may proceed
+        os_unfair_lock_lock(&self->_runningLock);
+        BOOL claimed = (self->_pendingRetryBlock == retryBlock);
+        if (claimed) {
+            self->_pendingRetryBlock = nil;
+        }
+        os_unfair_lock_unlock(&self->_runningLock);
+        
+        if (claimed) {
+            retryBlock();
         }
+    });
+    return YES;
+}
+
+- (void)storeData:(NSData *)data object:(id)object response:(NSURLResponse *)response
+{
+    SRGResponseCache *responseCache = self.usableResponseCache;
+    if (! responseCache || ! [response isKindOfClass:NSHTTPURLResponse.class]) {
+        return;
+    }
+    
+    SRGCachedResponse *cachedResponse = [responseCache storeResponse:(NSHTTPURLResponse *)response data:data forURLRequest:self.URLRequest];
+    if (cachedResponse && object && self.parser) {
+        [cachedResponse setObject:object forParser:self.parser];
+    }
+}
+
+- (void)finishWithCachedResponse:(SRGCachedResponse *)cachedResponse
+{
+    SRGRequestMetrics *metrics = self.runningMetrics;
+    [metrics beginPhase:SRGRequestPhaseParsing];
+    
+    NSError *parsingError = nil;
+    id object = [cachedResponse objectWithParser:self.parser error:&parsingError];
+    
+    [metrics endPhase:SRGRequestPhaseParsing];
+    
+    if (parsingError) {
+        [self finishWithObject:nil response:cachedResponse.response error:SRGBaseRequestInvalidDataError(parsingError)];
+        return;
+    }
+    
+    self.parsedDataLength = cachedResponse.data.length;
+    [self finishWithObject:object response:cachedResponse.response error:nil];
+}
+
+- (void)deliverStaleCachedResponse:(SRGCachedResponse *)cachedResponse
+{
+    // Stale responses which cannot be parsed anymore are simply revalidated
+    NSError *parsingError = nil;
+    id object = [cachedResponse objectWithParser:self.parser error:&parsingError];
+    if (! parsingError) {
+        self.staleCachedResponse = cachedResponse;
+        self.parsedDataLength = cachedResponse.data.length;
+        [self deliverObject:object response:cachedResponse.response error:nil stale:YES];
+    }
+    
+    // The request might have been cancelled in the meantime
+    if (self.cancellationToken.cancelled) {
+        return;
+    }
+    
+    [self attemptWithCachedResponse:cachedResponse];
+}
+
+- (void)finishWithObject:(id)object response:(NSURLResponse *)response error:(NSError *)error
+{
+    // The stale result already delivered remains the latest known one if revalidation fails
+    if (error && self.staleCachedResponse) {
+        SRGNetworkLogInfo(@"Request", @"The stale result of %@ could not be revalidated. Reason: %@", self, error);
+        [self finishRevalidation];
+        return;
+    }
+    
+    [self deliverObject:object response:response error:error stale:NO];
+}
+
+// Finish a request whose stale result has been delivered, without calling the completion block again
+- (void)finishRevalidation
+{
+    SRGRequestMetrics *metrics = self.runningMetrics;
+    [metrics beginPhase:SRGRequestPhaseDelivery];
+    
+    [self deliverBlock:^{
+        [self finishMetrics:metrics];
+        self.stale = NO;
+        [self didFinish];
     }];
+}
+
+// Stale results are delivered without finishing the request
+- (void)deliverObject:(id)object response:(NSURLResponse *)response error:(NSError *)error stale:(BOOL)stale
+{
+    SRGRequestMetrics *metrics = stale ? nil : self.runningMetrics;
     
-    self.running = YES;
-    [self.sessionTask resume];
+    if (object && self.extractor) {
+        [metrics beginPhase:SRGRequestPhaseExtraction];
+        SRGCancellationTokenPerformBlock(self.cancellationToken, ^{
+            self.extractor(object, response);
+        });
+        [metrics endPhase:SRGRequestPhaseExtraction];
+    }
+    
+    [metrics beginPhase:SRGRequestPhaseDelivery];
+    
+    [self deliverBlock:^{
+        [self finishMetrics:metrics];
+        self.stale = stale;
+        self.completionBlock(object, response, error);
+        if (! stale) {
+            [self didFinish];
+        }
+    }];
 }
 
-- (void)cancel
+- (void)deliverBlock:(dispatch_block_t)block
+{
+    if ((self.options & SRGRequestOptionBackgroundCompletionEnabled) == 0) {
+        // Never block the calling thread. The request stays running until the completion block has been called on the
+        // main thread, so that request queue state changes are still reported in order.
+        [SRGMainQueueDelivery deliverBlock:block];
+    }
+    else {
+        // Completion blocks are user code of unknown duration and must not occupy the bounded parsing executor slots
+        dispatch_async(self.completionQueue, block);
+    }
+}
+
+- (void)finishMetrics:(SRGRequestMetrics *)metrics
+{
+    if (! metrics) {
+        return;
+    }
+    
+    [metrics endPhase:SRGRequestPhaseDelivery];
+    [metrics finish];
+    self.metrics = metrics;
+}
+
+- (void)didFinish
 {
+    self.staleCachedResponse = nil;
+    self.coalescedTask = nil;
+    self.batchTask = nil;
+    self.hedgedTask = nil;
     self.running = NO;
-    [self.sessionTask cancel];
 }
 
 #pragma mark NSCopying protocol
 
 - (id)copyWithZone:(NSZone *)zone
 {
-    return [[self.class alloc] initWithURLRequest:self.URLRequest
-                                          session:self.session
-                                           parser:self.parser
-                                        extractor:self.extractor
-                                  completionBlock:self.completionBlock];
+    SRGBaseRequest *request = [[self.class alloc] initWithURLRequest:self.URLRequest
+                                                             session:self.session
+                                                              parser:self.parser
+                                                           extractor:self.extractor
+                                                     completionBlock:self.completionBlock];
+    [request applySettingsFromRequest:self];
+    return request;
 }
 
 #pragma mark Description
@@ -209,3 +1199,59 @@
 }
 
 @end
+
+#pragma mark Static functions
+
+static NSError *SRGBaseRequestDeadlineExceededError(NSURLRequest *URLRequest)
+{
+    return [NSError errorWithDomain:SRGNetworkErrorDomain
+                               code:SRGNetworkErrorDeadlineExceeded
+                           userInfo:@{ NSLocalizedDescriptionKey : SRGNetworkLocalizedString(@"The request could not be completed in time", @"Error message returned when a request deadline or request queue time budget has been exceeded."),
+                                       SRGNetworkFailingURLKey : URLRequest.URL }];
+}
+
+static NSError *SRGBaseRequestHTTPError(NSHTTPURLResponse *HTTPURLResponse)
+{
+    NSInteger HTTPStatusCode = HTTPURLResponse.statusCode;
+    return [NSError errorWithDomain:SRGNetworkErrorDomain
+                               code:SRGNetworkErrorHTTP
+                           userInfo:@{ NSLocalizedDescriptionKey : [NSHTTPURLResponse srg_localizedStringForStatusCode:HTTPStatusCode],
+                                       SRGNetworkFailingURLKey : HTTPURLResponse.URL,
+                                       SRGNetworkHTTPStatusCodeKey : @(HTTPStatusCode) }];
+}
+
+static NSError *SRGBaseRequestInvalidDataError(NSError *parsingError)
+{
+    return [NSError errorWithDomain:SRGNetworkErrorDomain
+                               code:SRGNetworkErrorInvalidData
+                           userInfo:@{ NSLocalizedDescriptionKey : SRGNetworkLocalizedString(@"The data is invalid", @"Error message returned when a server response data is incorrect."),
+                                       NSUnderlyingErrorKey : parsingError }];
+}
+
+static NSData *SRGBaseRequestMappedData(NSURL *fileURL, NSError * __autoreleasing *pError)
+{
+    // Move the file to a location the system does not manage anymore once the download completion handler returns
+    NSFileManager *fileManager = NSFileManager.defaultManager;
+    NSString *fileName = [NSString stringWithFormat:@"SRGNetwork-%@", NSUUID.UUID.UUIDString];
+    NSURL *mappedFileURL = [fileManager.temporaryDirectory URLByAppendingPathComponent:fileName];
+    if (! [fileManager moveItemAtURL:fileURL toURL:mappedFileURL error:pError]) {
+        return nil;
+    }
+    
+    NSData *data = [NSData dataWithContentsOfURL:mappedFileURL options:NSDataReadingMappedIfSafe error:pError];
+    
+    // Mapped pages remain valid after the file has been removed. Its storage is reclaimed when the data is released,
+    // which ties the file lifetime to the data lifetime, without any file left behind if the process is terminated.
+    [fileManager removeItemAtURL:mappedFileURL error:NULL];
+    return data;
+}
+
+static dispatch_queue_t SRGBaseRequestCompletionQueue(void)
+{
+    static dispatch_queue_t s_completionQueue;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_completionQueue = dispatch_queue_create("ch.srgssr.network.completion", DISPATCH_QUEUE_CONCURRENT);
+    });
+    return s_completionQueue;
+}
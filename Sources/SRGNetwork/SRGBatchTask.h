@@ -0,0 +1,61 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRequestBatcher.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SRGBatchTask;
+
+// Block signatures.
+typedef void (^SRGBatchTaskCompletionHandler)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error, SRGBatchTask *batchTask);
+
+/**
+ *  Network task shared between subscribers requesting items identified by keys, performed as a single batch request.
+ *  Tasks are reference-counted: the underlying session task is only cancelled when its last subscriber leaves.
+ */
+@interface SRGBatchTask : NSObject
+
+/**
+ *  Create a task which collects subscribers until started.
+ */
+- (instancetype)initWithSession:(NSURLSession *)session builder:(SRGBatchBuilder)builder splitter:(SRGBatchSplitter)splitter NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Attach a subscriber for the specified key. The completion handler is called on a background thread when the task
+ *  ends, except if the subscriber was removed in the meantime. Subscribers must be added before the task is started.
+ */
+- (void)addSubscriber:(id)subscriber forKey:(NSString *)key priority:(float)priority completionHandler:(SRGBatchTaskCompletionHandler)completionHandler;
+
+/**
+ *  Remove a subscriber. Its key is removed from the batch if the task has not been started yet and no other subscriber
+ *  requested it. If it was the last subscriber of a started task, the underlying session task is cancelled. Returns
+ *  `YES` iff the subscriber was still attached to the task.
+ */
+- (BOOL)removeSubscriber:(id)subscriber;
+
+/**
+ *  Build and start the batch request for the keys of the current subscribers. Returns `NO` if there is no subscriber.
+ */
+- (BOOL)start;
+
+/**
+ *  Return the object for the specified key, splitting the data only once per task.
+ */
+- (nullable id)objectForKey:(NSString *)key fromData:(NSData *)data error:(NSError * __autoreleasing *)pError;
+
+/**
+ *  The number of distinct keys currently requested.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfKeys;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,217 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGBatchTask.h"
+
+#import "SRGCancellationToken+Private.h"
+
+#import <os/lock.h>
+
+@interface SRGBatchTaskSubscription : NSObject
+
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) SRGBatchTaskCompletionHandler completionHandler;
+
+@end
+
+@interface SRGBatchTask () {
+@private
+    os_unfair_lock _lock;
+    os_unfair_lock _resultsLock;
+}
+
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic, copy) SRGBatchBuilder builder;
+@property (nonatomic, copy) SRGBatchSplitter splitter;
+
+@property (nonatomic) NSMapTable<id, SRGBatchTaskSubscription *> *subscriptions;
+@property (nonatomic) NSCountedSet<NSString *> *countedKeys;
+@property (nonatomic) NSMutableOrderedSet<NSString *> *keys;
+@property (nonatomic) float priority;
+
+@property (nonatomic) NSURLSessionTask *sessionTask;
+
+@property (nonatomic) NSDictionary<NSString *, id> *objects;
+@property (nonatomic) NSError *splittingError;
+@property (nonatomic, getter=isSplit) BOOL split;
+
+@end
+
+@implementation SRGBatchTask
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithSession:(NSURLSession *)session builder:(SRGBatchBuilder)builder splitter:(SRGBatchSplitter)splitter
+{
+    if (self = [super init]) {
+        self.session = session;
+        self.builder = builder;
+        self.splitter = splitter;
+        self.subscriptions = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                   valueOptions:NSPointerFunctionsStrongMemory];
+        self.countedKeys = [NSCountedSet set];
+        self.keys = [NSMutableOrderedSet orderedSet];
+        self.priority = NSURLSessionTaskPriorityLow;
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _resultsLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithSession:NSURLSession.sharedSession builder:^NSURLRequest * _Nonnull(NSArray<NSString *> * _Nonnull keys) {
+        return [NSURLRequest new];
+    } splitter:^NSDictionary<NSString *, id> * _Nullable(NSData * _Nonnull data, NSArray<NSString *> * _Nonnull keys, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        return nil;
+    }];
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfKeys
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfKeys = self.keys.count;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfKeys;
+}
+
+#pragma mark Subscribers
+
+- (void)addSubscriber:(id)subscriber forKey:(NSString *)key priority:(float)priority completionHandler:(SRGBatchTaskCompletionHandler)completionHandler
+{
+    SRGBatchTaskSubscription *subscription = [[SRGBatchTaskSubscription alloc] init];
+    subscription.key = key;
+    subscription.completionHandler = completionHandler;
+    
+    os_unfair_lock_lock(&_lock);
+    NSAssert(! self.sessionTask, @"Subscribers must be added before the task is started");
+    [self.subscriptions setObject:subscription forKey:subscriber];
+    [self.countedKeys addObject:key];
+    [self.keys addObject:key];
+    self.priority = fmaxf(self.priority, priority);
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (BOOL)removeSubscriber:(id)subscriber
+{
+    os_unfair_lock_lock(&_lock);
+    SRGBatchTaskSubscription *subscription = [self.subscriptions objectForKey:subscriber];
+    if (subscription) {
+        [self.subscriptions removeObjectForKey:subscriber];
+        [self.countedKeys removeObject:subscription.key];
+        
+        // Keys requested by cancelled subscribers only are not included in batches which have not been started yet
+        if (! self.sessionTask && [self.countedKeys countForObject:subscription.key] == 0) {
+            [self.keys removeObject:subscription.key];
+        }
+    }
+    
+    BOOL last = subscription && self.subscriptions.count == 0;
+    NSURLSessionTask *sessionTask = self.sessionTask;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (last) {
+        [sessionTask cancel];
+    }
+    return (subscription != nil);
+}
+
+#pragma mark Execution
+
+- (BOOL)start
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<NSString *> *keys = self.keys.array;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (keys.count == 0) {
+        return NO;
+    }
+    
+    // Build the request outside the lock, since the builder is provided by the client
+    NSURLRequest *URLRequest = self.builder(keys);
+    NSURLSessionTask *sessionTask = [self.session dataTaskWithRequest:URLRequest completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [self finishWithData:data response:response error:error];
+    }];
+    
+    // Subscribers leaving in the meantime find the session task, or the task is never resumed if none is left
+    os_unfair_lock_lock(&_lock);
+    self.keys = [NSMutableOrderedSet orderedSetWithArray:keys];
+    self.sessionTask = sessionTask;
+    sessionTask.priority = self.priority;
+    BOOL cancelled = (self.subscriptions.count == 0);
+    os_unfair_lock_unlock(&_lock);
+    
+    if (cancelled) {
+        return NO;
+    }
+    
+    [sessionTask resume];
+    return YES;
+}
+
+- (void)finishWithData:(NSData *)data response:(NSURLResponse *)response error:(NSError *)error
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<SRGBatchTaskSubscription *> *subscriptions = self.subscriptions.objectEnumerator.allObjects;
+    [self.subscriptions removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+    
+    for (SRGBatchTaskSubscription *subscription in subscriptions) {
+        subscription.completionHandler(data, response, error, self);
+    }
+}
+
+#pragma mark Splitting
+
+- (id)objectForKey:(NSString *)key fromData:(NSData *)data error:(NSError * __autoreleasing *)pError
+{
+    os_unfair_lock_lock(&_resultsLock);
+    if (! self.split) {
+        // The result is shared, and must not be affected by the cancellation of the request which computes it
+        __block NSError *splittingError = nil;
+        __block NSDictionary<NSString *, id> *objects = nil;
+        SRGCancellationTokenPerformBlock(nil, ^{
+            NSError *error = nil;
+            objects = self.splitter(data, self.keys.array, &error);
+            splittingError = error;
+        });
+        self.objects = objects;
+        self.splittingError = splittingError;
+        self.split = YES;
+    }
+    id object = self.objects[key];
+    NSError *splittingError = self.splittingError;
+    os_unfair_lock_unlock(&_resultsLock);
+    
+    if (splittingError) {
+        if (pError) {
+            *pError = splittingError;
+        }
+        return nil;
+    }
+    return (object != NSNull.null) ? object : nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; keys = %@; sessionTask = %@>",
+            self.class,
+            self,
+            self.keys.array,
+            self.sessionTask];
+}
+
+@end
+
+@implementation SRGBatchTaskSubscription
+
+@end
@@ -0,0 +1,115 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGNetworkTypes.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Return the value of the specified header (case-insensitive), if any.
+ */
+OBJC_EXPORT NSString * _Nullable SRGCachedResponseHeaderValue(NSHTTPURLResponse *response, NSString *headerName);
+
+/**
+ *  Parse an HTTP date (RFC 1123 format), returning `nil` if invalid.
+ */
+OBJC_EXPORT NSDate * _Nullable SRGCachedResponseDateFromHTTPDateString(NSString * _Nullable string);
+
+/**
+ *  Response stored in a response cache, with its raw body and the object last parsed from it.
+ */
+@interface SRGCachedResponse : NSObject
+
+/**
+ *  Return `YES` iff the specified response can be stored in a cache.
+ */
++ (BOOL)isCacheableResponse:(NSHTTPURLResponse *)response;
+
+/**
+ *  Create a cached response with the specified data, stored at the specified date.
+ */
+- (instancetype)initWithResponse:(NSHTTPURLResponse *)response data:(NSData *)data storageDate:(NSDate *)storageDate;
+
+/**
+ *  Create a cached response from archived metadata (see `-metadata`) and data. Returns `nil` if the metadata is invalid.
+ */
+- (nullable instancetype)initWithMetadata:(NSData *)metadata data:(NSData *)data;
+
+/**
+ *  Return a copy of the receiver, revalidated with a `304 Not Modified` response received from the server. The object
+ *  already parsed is preserved.
+ */
+- (SRGCachedResponse *)cachedResponseRevalidatedWithResponse:(NSHTTPURLResponse *)response;
+
+/**
+ *  Return `YES` iff the stale response can be used while being revalidated, provided it has not been stale for longer
+ *  than the specified interval. Responses with a `must-revalidate` directive are never used stale.
+ */
+- (BOOL)isUsableStaleWithMaximumStaleness:(NSTimeInterval)maximumStaleness;
+
+/**
+ *  Return `YES` iff the specified response received from the server has the same content as the receiver, either
+ *  because both have the same `ETag`, or because their bodies have the same digest.
+ */
+- (BOOL)hasSameContentAsResponse:(NSHTTPURLResponse *)response data:(NSData *)data;
+
+/**
+ *  Return a request equivalent to the specified one, with conditional headers added for revalidation.
+ */
+- (NSURLRequest *)conditionalURLRequestForURLRequest:(NSURLRequest *)URLRequest;
+
+/**
+ *  Return the object obtained by parsing the data with the specified parser. The object parsed last is stored, so
+ *  that a parser used repeatedly never needs to process the same cached data twice. Parsers are identified by pointer.
+ *  If no parser is provided, data is returned as is.
+ */
+- (nullable id)objectWithParser:(nullable SRGResponseParser)parser error:(NSError * __autoreleasing *)pError;
+
+/**
+ *  Store an object parsed with the specified parser, replacing any object previously stored.
+ */
+- (void)setObject:(id)object forParser:(SRGResponseParser)parser;
+
+@property (nonatomic, readonly) NSHTTPURLResponse *response;
+@property (nonatomic, readonly) NSData *data;
+@property (nonatomic, readonly) NSDate *storageDate;
+
+/**
+ *  Archived response metadata.
+ */
+@property (nonatomic, readonly, nullable) NSData *metadata;
+
+/**
+ *  Return `YES` iff the response can be used without revalidation.
+ */
+@property (nonatomic, readonly, getter=isFresh) BOOL fresh;
+
+/**
+ *  The time elapsed since the response became stale (0 if fresh).
+ */
+@property (nonatomic, readonly) NSTimeInterval staleness;
+
+/**
+ *  SHA-256 digest of the data, computed once when first needed.
+ */
+@property (nonatomic, readonly) NSData *digest;
+
+/**
+ *  Return `YES` iff the response can be revalidated with the server (`ETag` or `Last-Modified` available).
+ */
+@property (nonatomic, readonly, getter=isRevalidatable) BOOL revalidatable;
+
+/**
+ *  The approximate memory cost of the response, accounting for its data and parsed object. Constant over the lifetime
+ *  of the response.
+ */
+@property (nonatomic, readonly) NSUInteger cost;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,315 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGCachedResponse.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <os/lock.h>
+
+static NSString * const SRGCachedResponseResponseKey = @"response";
+static NSString * const SRGCachedResponseStorageDateKey = @"storageDate";
+
+static NSDictionary<NSString *, NSString *> *SRGCachedResponseCacheControlDirectives(NSHTTPURLResponse *response);
+static NSData *SRGCachedResponseDigest(NSData *data);
+
+@interface SRGCachedResponse () {
+@private
+    os_unfair_lock _objectsLock;
+}
+
+@property (nonatomic) NSHTTPURLResponse *response;
+@property (nonatomic) NSData *data;
+@property (nonatomic) NSDate *storageDate;
+
+// Protected by the objects lock. Only the object parsed last is kept, so that the memory used by a response is bounded.
+@property (nonatomic, copy) SRGResponseParser parser;
+@property (nonatomic) id object;
+@property (nonatomic) NSData *digest;
+
+@end
+
+@implementation SRGCachedResponse
+
+#pragma mark Class methods
+
++ (BOOL)isCacheableResponse:(NSHTTPURLResponse *)response
+{
+    if (response.statusCode != 200) {
+        return NO;
+    }
+    
+    NSDictionary<NSString *, NSString *> *directives = SRGCachedResponseCacheControlDirectives(response);
+    if (directives[@"no-store"]) {
+        return NO;
+    }
+    
+    SRGCachedResponse *cachedResponse = [[SRGCachedResponse alloc] initWithResponse:response data:NSData.data storageDate:NSDate.date];
+    return cachedResponse.fresh || cachedResponse.revalidatable;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithResponse:(NSHTTPURLResponse *)response data:(NSData *)data storageDate:(NSDate *)storageDate
+{
+    if (self = [super init]) {
+        self.response = response;
+        self.data = data;
+        self.storageDate = storageDate;
+        _objectsLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (instancetype)initWithMetadata:(NSData *)metadata data:(NSData *)data
+{
+    NSSet<Class> *classes = [NSSet setWithObjects:NSDictionary.class, NSString.class, NSHTTPURLResponse.class, NSDate.class, nil];
+    NSDictionary *dictionary = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:metadata error:NULL];
+    
+    NSHTTPURLResponse *response = dictionary[SRGCachedResponseResponseKey];
+    NSDate *storageDate = dictionary[SRGCachedResponseStorageDateKey];
+    if (! [response isKindOfClass:NSHTTPURLResponse.class] || ! [storageDate isKindOfClass:NSDate.class]) {
+        return nil;
+    }
+    
+    return [self initWithResponse:response data:data storageDate:storageDate];
+}
+
+#pragma mark Getters and setters
+
+- (NSData *)metadata
+{
+    NSDictionary *dictionary = @{ SRGCachedResponseResponseKey : self.response,
+                                  SRGCachedResponseStorageDateKey : self.storageDate };
+    return [NSKeyedArchiver archivedDataWithRootObject:dictionary requiringSecureCoding:YES error:NULL];
+}
+
+- (NSTimeInterval)freshnessLifetime
+{
+    NSDictionary<NSString *, NSString *> *directives = SRGCachedResponseCacheControlDirectives(self.response);
+    if (directives[@"no-cache"]) {
+        return 0.;
+    }
+    
+    NSString *maxAge = directives[@"max-age"];
+    if (maxAge) {
+        return maxAge.doubleValue;
+    }
+    
+    NSDate *expirationDate = SRGCachedResponseDateFromHTTPDateString(SRGCachedResponseHeaderValue(self.response, @"Expires"));
+    NSDate *date = SRGCachedResponseDateFromHTTPDateString(SRGCachedResponseHeaderValue(self.response, @"Date")) ?: self.storageDate;
+    return expirationDate ? [expirationDate timeIntervalSinceDate:date] : 0.;
+}
+
+- (BOOL)isFresh
+{
+    return [NSDate.date timeIntervalSinceDate:self.storageDate] < self.freshnessLifetime;
+}
+
+- (NSTimeInterval)staleness
+{
+    return fmax([NSDate.date timeIntervalSinceDate:self.storageDate] - self.freshnessLifetime, 0.);
+}
+
+- (NSData *)digest
+{
+    os_unfair_lock_lock(&_objectsLock);
+    NSData *digest = _digest;
+    os_unfair_lock_unlock(&_objectsLock);
+    
+    if (digest) {
+        return digest;
+    }
+    
+    // Computed outside the lock, a concurrent computation yielding the same result anyway
+    digest = SRGCachedResponseDigest(self.data);
+    
+    os_unfair_lock_lock(&_objectsLock);
+    _digest = digest;
+    os_unfair_lock_unlock(&_objectsLock);
+    
+    return digest;
+}
+
+- (BOOL)isRevalidatable
+{
+    return SRGCachedResponseHeaderValue(self.response, @"ETag") != nil || SRGCachedResponseHeaderValue(self.response, @"Last-Modified") != nil;
+}
+
+- (NSUInteger)cost
+{
+    // The data and at most one parsed object, which is roughly as large as the data it was parsed from
+    return 2 * self.data.length;
+}
+
+#pragma mark Revalidation
+
+- (SRGCachedResponse *)cachedResponseRevalidatedWithResponse:(NSHTTPURLResponse *)response
+{
+    NSMutableDictionary<NSString *, NSString *> *headerFields = self.response.allHeaderFields.mutableCopy;
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull name, NSString * _Nonnull value, BOOL * _Nonnull stop) {
+        // Entity headers describing the body must be kept
+        if ([name caseInsensitiveCompare:@"Content-Length"] == NSOrderedSame || [name caseInsensitiveCompare:@"Content-Encoding"] == NSOrderedSame) {
+            return;
+        }
+        headerFields[name] = value;
+    }];
+    
+    NSHTTPURLResponse *revalidatedResponse = [[NSHTTPURLResponse alloc] initWithURL:self.response.URL
+                                                                         statusCode:self.response.statusCode
+                                                                        HTTPVersion:@"HTTP/1.1"
+                                                                       headerFields:headerFields.copy];
+    SRGCachedResponse *cachedResponse = [[SRGCachedResponse alloc] initWithResponse:revalidatedResponse data:self.data storageDate:NSDate.date];
+    
+    os_unfair_lock_lock(&_objectsLock);
+    cachedResponse.parser = _parser;
+    cachedResponse.object = _object;
+    cachedResponse.digest = _digest;
+    os_unfair_lock_unlock(&_objectsLock);
+    
+    return cachedResponse;
+}
+
+- (BOOL)isUsableStaleWithMaximumStaleness:(NSTimeInterval)maximumStaleness
+{
+    NSDictionary<NSString *, NSString *> *directives = SRGCachedResponseCacheControlDirectives(self.response);
+    if (directives[@"must-revalidate"]) {
+        return NO;
+    }
+    
+    return self.staleness <= maximumStaleness;
+}
+
+- (BOOL)hasSameContentAsResponse:(NSHTTPURLResponse *)response data:(NSData *)data
+{
+    NSString *ETag = SRGCachedResponseHeaderValue(self.response, @"ETag");
+    if (ETag && [SRGCachedResponseHeaderValue(response, @"ETag") isEqualToString:ETag]) {
+        return YES;
+    }
+    
+    return data.length == self.data.length && [SRGCachedResponseDigest(data) isEqualToData:self.digest];
+}
+
+- (NSURLRequest *)conditionalURLRequestForURLRequest:(NSURLRequest *)URLRequest
+{
+    NSString *ETag = SRGCachedResponseHeaderValue(self.response, @"ETag");
+    NSString *lastModified = SRGCachedResponseHeaderValue(self.response, @"Last-Modified");
+    if (! ETag && ! lastModified) {
+        return URLRequest;
+    }
+    
+    NSMutableURLRequest *conditionalURLRequest = URLRequest.mutableCopy;
+    if (ETag) {
+        [conditionalURLRequest setValue:ETag forHTTPHeaderField:@"If-None-Match"];
+    }
+    if (lastModified) {
+        [conditionalURLRequest setValue:lastModified forHTTPHeaderField:@"If-Modified-Since"];
+    }
+    return conditionalURLRequest.copy;
+}
+
+#pragma mark Parsing
+
+- (id)objectWithParser:(SRGResponseParser)parser error:(NSError * __autoreleasing *)pError
+{
+    if (! parser) {
+        return self.data;
+    }
+    
+    os_unfair_lock_lock(&_objectsLock);
+    id object = (_parser == parser) ? _object : nil;
+    os_unfair_lock_unlock(&_objectsLock);
+    
+    if (object) {
+        return object;
+    }
+    
+    object = parser(self.data, pError);
+    if (object) {
+        [self setObject:object forParser:parser];
+    }
+    return object;
+}
+
+- (void)setObject:(id)object forParser:(SRGResponseParser)parser
+{
+    os_unfair_lock_lock(&_objectsLock);
+    _parser = parser;
+    _object = object;
+    os_unfair_lock_unlock(&_objectsLock);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; URL = %@; storageDate = %@; fresh = %@>",
+            self.class,
+            self,
+            self.response.URL,
+            self.storageDate,
+            self.fresh ? @"YES" : @"NO"];
+}
+
+@end
+
+#pragma mark Functions
+
+NSString *SRGCachedResponseHeaderValue(NSHTTPURLResponse *response, NSString *headerName)
+{
+    __block NSString *headerValue = nil;
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull name, NSString * _Nonnull value, BOOL * _Nonnull stop) {
+        if ([name caseInsensitiveCompare:headerName] == NSOrderedSame) {
+            headerValue = value;
+            *stop = YES;
+        }
+    }];
+    return headerValue;
+}
+
+static NSDictionary<NSString *, NSString *> *SRGCachedResponseCacheControlDirectives(NSHTTPURLResponse *response)
+{
+    NSString *cacheControl = SRGCachedResponseHeaderValue(response, @"Cache-Control");
+    if (! cacheControl) {
+        return @{};
+    }
+    
+    NSMutableDictionary<NSString *, NSString *> *directives = [NSMutableDictionary dictionary];
+    for (NSString *component in [cacheControl componentsSeparatedByString:@","]) {
+        NSArray<NSString *> *parts = [component componentsSeparatedByString:@"="];
+        NSString *name = [parts.firstObject stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet].lowercaseString;
+        if (name.length == 0) {
+            continue;
+        }
+        
+        NSString *value = (parts.count > 1) ? [parts[1] stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@" \""]] : @"";
+        directives[name] = value;
+    }
+    return directives.copy;
+}
+
+NSDate *SRGCachedResponseDateFromHTTPDateString(NSString *string)
+{
+    if (! string) {
+        return nil;
+    }
+    
+    static NSDateFormatter *s_dateFormatter;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_dateFormatter = [[NSDateFormatter alloc] init];
+        s_dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        s_dateFormatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        s_dateFormatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    return [s_dateFormatter dateFromString:string];
+}
+
+static NSData *SRGCachedResponseDigest(NSData *data)
+{
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+    return [NSData dataWithBytes:digest length:CC_SHA256_DIGEST_LENGTH];
+}
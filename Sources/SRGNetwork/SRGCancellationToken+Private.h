@@ -0,0 +1,28 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGCancellationToken.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Perform a block synchronously, with the specified token as current token (or without current token if `nil`).
+ */
+OBJC_EXPORT void SRGCancellationTokenPerformBlock(SRGCancellationToken * _Nullable cancellationToken, NS_NOESCAPE dispatch_block_t block);
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGCancellationToken (Private)
+
+/**
+ *  Cancel the token. Can be called from any thread.
+ */
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,74 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGCancellationToken+Private.h"
+
+#import <stdatomic.h>
+
+// Tokens are retained by their request while current, an unretained reference is therefore sufficient.
+static _Thread_local __unsafe_unretained SRGCancellationToken *s_currentToken = nil;
+
+@interface SRGCancellationToken () {
+@private
+    atomic_bool _cancelled;
+}
+
+@end
+
+@implementation SRGCancellationToken
+
+#pragma mark Class methods
+
++ (SRGCancellationToken *)currentToken
+{
+    return s_currentToken;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        atomic_init(&_cancelled, false);
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (BOOL)isCancelled
+{
+    return atomic_load_explicit(&_cancelled, memory_order_relaxed);
+}
+
+#pragma mark Cancellation
+
+- (void)cancel
+{
+    atomic_store_explicit(&_cancelled, true, memory_order_relaxed);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; cancelled = %@>",
+            self.class,
+            self,
+            self.cancelled ? @"YES" : @"NO"];
+}
+
+@end
+
+#pragma mark Functions
+
+void SRGCancellationTokenPerformBlock(SRGCancellationToken *cancellationToken, dispatch_block_t block)
+{
+    SRGCancellationToken *previousToken = s_currentToken;
+    s_currentToken = cancellationToken;
+    block();
+    s_currentToken = previousToken;
+}
@@ -0,0 +1,64 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGNetworkTypes.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SRGCoalescedTask;
+
+// Block signatures.
+typedef void (^SRGCoalescedTaskCompletionHandler)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error, SRGCoalescedTask *coalescedTask);
+
+/**
+ *  Return `YES` iff the specified request can be coalesced with equivalent requests.
+ */
+OBJC_EXPORT BOOL SRGCoalescedTaskIsSupportedForURLRequest(NSURLRequest *URLRequest);
+
+/**
+ *  Network task shared between several subscribers performing equivalent requests. Tasks are reference-counted:
+ *  the underlying session task is only cancelled when its last subscriber leaves.
+ */
+@interface SRGCoalescedTask : NSObject
+
+/**
+ *  Attach a subscriber to the running task performing an equivalent request with the same session, or create and
+ *  start a new task if none is available. The completion handler is called on a background thread when the task ends,
+ *  except if the subscriber was removed in the meantime.
+ */
++ (SRGCoalescedTask *)taskWithURLRequest:(NSURLRequest *)URLRequest
+                                 session:(NSURLSession *)session
+                              subscriber:(id)subscriber
+                       completionHandler:(SRGCoalescedTaskCompletionHandler)completionHandler;
+
+/**
+ *  Remove a subscriber. If it was the last one, the underlying session task is cancelled. Returns `YES` iff the
+ *  subscriber was still attached to the task.
+ */
+- (BOOL)removeSubscriber:(id)subscriber;
+
+/**
+ *  Parse the data using the specified parser (returning the data as is if none is provided). The result is shared
+ *  between all subscribers using the same parser. Parsing occurs outside any lock, and the first published result is
+ *  kept if subscribers using the same parser happen to parse concurrently.
+ */
+- (nullable id)objectFromData:(NSData *)data withParser:(nullable SRGResponseParser)parser error:(NSError * __autoreleasing *)pError;
+
+/**
+ *  Raise the priority of the underlying session task to the specified value, if higher than its current priority.
+ */
+- (void)raisePriority:(float)priority;
+
+/**
+ *  The number of attached subscribers.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfSubscribers;
+
+@end
+
+NS_ASSUME_NONNULL_END
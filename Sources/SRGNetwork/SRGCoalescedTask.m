@@ -0,0 +1,217 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGCoalescedTask.h"
+
+#import "SRGCancellationToken+Private.h"
+#import "SRGResponseCache+Private.h"
+
+#import <os/lock.h>
+
+static NSMutableDictionary<NSString *, SRGCoalescedTask *> *s_coalescedTasks = nil;
+static os_unfair_lock s_lock = OS_UNFAIR_LOCK_INIT;
+
+static NSString *SRGCoalescedTaskKey(NSURLRequest *URLRequest, NSURLSession *session);
+
+@interface SRGCoalescedTask () {
+@private
+    os_unfair_lock _resultsLock;
+}
+
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic) NSURLSessionTask *sessionTask;
+
+@property (nonatomic) NSMapTable<id, SRGCoalescedTaskCompletionHandler> *subscribers;
+@property (nonatomic) NSMapTable<id, NSArray *> *results;
+
+@end
+
+@implementation SRGCoalescedTask
+
+#pragma mark Class methods
+
++ (void)initialize
+{
+    if (self != SRGCoalescedTask.class) {
+        return;
+    }
+    
+    s_coalescedTasks = [NSMutableDictionary dictionary];
+}
+
++ (SRGCoalescedTask *)taskWithURLRequest:(NSURLRequest *)URLRequest
+                                 session:(NSURLSession *)session
+                              subscriber:(id)subscriber
+                       completionHandler:(SRGCoalescedTaskCompletionHandler)completionHandler
+{
+    NSString *key = SRGCoalescedTaskKey(URLRequest, session);
+    BOOL created = NO;
+    
+    os_unfair_lock_lock(&s_lock);
+    SRGCoalescedTask *coalescedTask = s_coalescedTasks[key];
+    if (! coalescedTask) {
+        coalescedTask = [[SRGCoalescedTask alloc] initWithKey:key];
+        
+        // Created within the lock so that the session task is always available to a subscriber cancelling it
+        coalescedTask.sessionTask = [session dataTaskWithRequest:URLRequest completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [coalescedTask finishWithData:data response:response error:error];
+        }];
+        s_coalescedTasks[key] = coalescedTask;
+        created = YES;
+    }
+    [coalescedTask.subscribers setObject:completionHandler forKey:subscriber];
+    os_unfair_lock_unlock(&s_lock);
+    
+    if (created) {
+        [coalescedTask.sessionTask resume];
+    }
+    return coalescedTask;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithKey:(NSString *)key
+{
+    if (self = [super init]) {
+        self.key = key;
+        self.subscribers = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                 valueOptions:NSPointerFunctionsStrongMemory];
+        self.results = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                             valueOptions:NSPointerFunctionsStrongMemory];
+        _resultsLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfSubscribers
+{
+    os_unfair_lock_lock(&s_lock);
+    NSUInteger numberOfSubscribers = self.subscribers.count;
+    os_unfair_lock_unlock(&s_lock);
+    return numberOfSubscribers;
+}
+
+#pragma mark Subscribers
+
+- (BOOL)removeSubscriber:(id)subscriber
+{
+    os_unfair_lock_lock(&s_lock);
+    BOOL attached = ([self.subscribers objectForKey:subscriber] != nil);
+    [self.subscribers removeObjectForKey:subscriber];
+    
+    BOOL last = attached && self.subscribers.count == 0;
+    if (last && s_coalescedTasks[self.key] == self) {
+        [s_coalescedTasks removeObjectForKey:self.key];
+    }
+    os_unfair_lock_unlock(&s_lock);
+    
+    if (last) {
+        [self.sessionTask cancel];
+    }
+    return attached;
+}
+
+- (void)finishWithData:(NSData *)data response:(NSURLResponse *)response error:(NSError *)error
+{
+    os_unfair_lock_lock(&s_lock);
+    if (s_coalescedTasks[self.key] == self) {
+        [s_coalescedTasks removeObjectForKey:self.key];
+    }
+    NSArray<SRGCoalescedTaskCompletionHandler> *completionHandlers = self.subscribers.objectEnumerator.allObjects;
+    [self.subscribers removeAllObjects];
+    os_unfair_lock_unlock(&s_lock);
+    
+    for (SRGCoalescedTaskCompletionHandler completionHandler in completionHandlers) {
+        completionHandler(data, response, error, self);
+    }
+}
+
+#pragma mark Priority
+
+- (void)raisePriority:(float)priority
+{
+    NSURLSessionTask *sessionTask = self.sessionTask;
+    if (priority > sessionTask.priority) {
+        sessionTask.priority = priority;
+    }
+}
+
+#pragma mark Parsing
+
+- (id)objectFromData:(NSData *)data withParser:(SRGResponseParser)parser error:(NSError * __autoreleasing *)pError
+{
+    if (! parser) {
+        return data;
+    }
+    
+    // Parsers are usually global blocks (no captured variables), and therefore shared between requests of the same kind
+    os_unfair_lock_lock(&_resultsLock);
+    NSArray *result = [self.results objectForKey:parser];
+    os_unfair_lock_unlock(&_resultsLock);
+    
+    if (! result) {
+        // Parse without holding the lock, so that subscribers using other parsers are not delayed. The result is shared,
+        // and must not be affected by the cancellation of the request which computes it
+        __block NSError *parsingError = nil;
+        __block id object = nil;
+        SRGCancellationTokenPerformBlock(nil, ^{
+            NSError *error = nil;
+            object = parser(data, &error);
+            parsingError = error;
+        });
+        NSArray *parsedResult = @[ object ?: NSNull.null, parsingError ?: NSNull.null ];
+        
+        // Publish the result unless a concurrent subscriber did first, so that all subscribers share the same object
+        os_unfair_lock_lock(&_resultsLock);
+        result = [self.results objectForKey:parser];
+        if (! result) {
+            result = parsedResult;
+            [self.results setObject:result forKey:parser];
+        }
+        os_unfair_lock_unlock(&_resultsLock);
+    }
+    
+    NSError *parsingError = (result.lastObject != NSNull.null) ? result.lastObject : nil;
+    if (parsingError) {
+        if (pError) {
+            *pError = parsingError;
+        }
+        return nil;
+    }
+    return (result.firstObject != NSNull.null) ? result.firstObject : nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; key = %@; sessionTask = %@>",
+            self.class,
+            self,
+            self.key,
+            self.sessionTask];
+}
+
+@end
+
+#pragma mark Functions
+
+BOOL SRGCoalescedTaskIsSupportedForURLRequest(NSURLRequest *URLRequest)
+{
+    if (URLRequest.HTTPBody || URLRequest.HTTPBodyStream) {
+        return NO;
+    }
+    
+    NSString *HTTPMethod = URLRequest.HTTPMethod.uppercaseString ?: @"GET";
+    return [HTTPMethod isEqualToString:@"GET"] || [HTTPMethod isEqualToString:@"HEAD"];
+}
+
+static NSString *SRGCoalescedTaskKey(NSURLRequest *URLRequest, NSURLSession *session)
+{
+    return [NSString stringWithFormat:@"%p %@", session, SRGResponseCacheKey(URLRequest)];
+}
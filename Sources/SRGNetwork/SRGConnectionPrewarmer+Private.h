@@ -0,0 +1,34 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGConnectionPrewarmer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGConnectionPrewarmer (Private)
+
+/**
+ *  Return the prewarmer associated with the specified session, if any. Can be called from any thread.
+ */
++ (nullable SRGConnectionPrewarmer *)prewarmerForSession:(NSURLSession *)session;
+
+/**
+ *  Return how the connection used by the task whose metrics are provided was obtained. Reuses of prewarmed
+ *  connections are counted.
+ */
+- (SRGConnectionReuse)connectionReuseForTaskMetrics:(NSURLSessionTaskMetrics *)taskMetrics;
+
+@end
+
+/**
+ *  Return how the connection used by the task whose metrics are provided was obtained, without prewarmer.
+ */
+OBJC_EXPORT SRGConnectionReuse SRGConnectionReuseForTaskMetrics(NSURLSessionTaskMetrics *taskMetrics);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,320 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGConnectionPrewarmer+Private.h"
+
+#import "SRGNetworkLogger.h"
+#import "SRGTaskMetricsDelegate.h"
+
+#import <os/lock.h>
+
+@import libextobjc;
+
+// Probes are expected to be answered quickly, otherwise prewarming is pointless.
+static const NSTimeInterval SRGConnectionPrewarmerProbeTimeoutInterval = 10.;
+
+static os_unfair_lock s_prewarmersLock = OS_UNFAIR_LOCK_INIT;
+static NSMapTable<NSURLSession *, SRGConnectionPrewarmer *> *s_prewarmers = nil;
+
+static NSString *SRGConnectionPrewarmerOrigin(NSURL *URL);
+static NSString *SRGConnectionPrewarmerConnectionIdentifier(NSURLSessionTaskTransactionMetrics *transactionMetrics);
+
+@interface SRGConnectionPrewarmer () {
+@private
+    os_unfair_lock _lock;
+    NSUInteger _numberOfProbes;
+    NSUInteger _numberOfPrewarmedConnectionReuses;
+}
+
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic) NSTimeInterval keepAliveInterval;
+
+@property (nonatomic) NSMutableDictionary<NSString *, NSURL *> *probeURLs;
+@property (nonatomic) NSMutableSet<NSString *> *warmOrigins;
+@property (nonatomic) NSMutableSet<NSString *> *connectionIdentifiers;
+
+@property (nonatomic) dispatch_source_t keepAliveTimer;
+
+@end
+
+@implementation SRGConnectionPrewarmer
+
+#pragma mark Class methods
+
++ (SRGConnectionPrewarmer *)prewarmerForSession:(NSURLSession *)session
+{
+    os_unfair_lock_lock(&s_prewarmersLock);
+    SRGConnectionPrewarmer *prewarmer = [s_prewarmers objectForKey:session];
+    os_unfair_lock_unlock(&s_prewarmersLock);
+    return prewarmer;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithSession:(NSURLSession *)session keepAliveInterval:(NSTimeInterval)keepAliveInterval
+{
+    if (self = [super init]) {
+        self.session = session;
+        self.keepAliveInterval = fmax(keepAliveInterval, 0.);
+        self.probeURLs = [NSMutableDictionary dictionary];
+        self.warmOrigins = [NSMutableSet set];
+        self.connectionIdentifiers = [NSMutableSet set];
+        _lock = OS_UNFAIR_LOCK_INIT;
+        
+        // Weak references only, so that the prewarmer lifetime is managed by its owner
+        os_unfair_lock_lock(&s_prewarmersLock);
+        if (! s_prewarmers) {
+            s_prewarmers = [NSMapTable weakToWeakObjectsMapTable];
+        }
+        [s_prewarmers setObject:self forKey:session];
+        os_unfair_lock_unlock(&s_prewarmersLock);
+        
+        if (self.keepAliveInterval > 0.) {
+            int64_t interval = (int64_t)(self.keepAliveInterval * NSEC_PER_SEC);
+            self.keepAliveTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+            dispatch_source_set_timer(self.keepAliveTimer, dispatch_time(DISPATCH_TIME_NOW, interval), (uint64_t)interval, (uint64_t)(interval / 10));
+            
+            @weakify(self)
+            dispatch_source_set_event_handler(self.keepAliveTimer, ^{
+                @strongify(self)
+                [self probeAllOrigins];
+            });
+            dispatch_resume(self.keepAliveTimer);
+        }
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithSession:NSURLSession.sharedSession keepAliveInterval:0.];
+}
+
+- (void)dealloc
+{
+    [self invalidate];
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfProbes
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfProbes = _numberOfProbes;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfProbes;
+}
+
+- (NSUInteger)numberOfPrewarmedConnectionReuses
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfPrewarmedConnectionReuses = _numberOfPrewarmedConnectionReuses;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfPrewarmedConnectionReuses;
+}
+
+#pragma mark Prewarming
+
+- (void)prewarmOriginsWithURLs:(NSArray<NSURL *> *)URLs completionBlock:(void (^)(void))completionBlock
+{
+    NSMutableDictionary<NSString *, NSURL *> *probeURLs = [NSMutableDictionary dictionary];
+    for (NSURL *URL in URLs) {
+        NSString *origin = SRGConnectionPrewarmerOrigin(URL);
+        if (origin) {
+            probeURLs[origin] = [NSURL URLWithString:[origin stringByAppendingString:@"/"]];
+        }
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    [self.probeURLs addEntriesFromDictionary:probeURLs];
+    os_unfair_lock_unlock(&_lock);
+    
+    [self probeURLs:probeURLs completionBlock:completionBlock];
+}
+
+- (void)probeAllOrigins
+{
+    os_unfair_lock_lock(&_lock);
+    NSDictionary<NSString *, NSURL *> *probeURLs = self.probeURLs.copy;
+    os_unfair_lock_unlock(&_lock);
+    
+    [self probeURLs:probeURLs completionBlock:nil];
+}
+
+- (void)probeURLs:(NSDictionary<NSString *, NSURL *> *)probeURLs completionBlock:(void (^)(void))completionBlock
+{
+    dispatch_group_t group = dispatch_group_create();
+    
+    [probeURLs enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull origin, NSURL * _Nonnull probeURL, BOOL * _Nonnull stop) {
+        NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:probeURL cachePolicy:NSURLRequestReloadIgnoringLocalCacheData timeoutInterval:SRGConnectionPrewarmerProbeTimeoutInterval];
+        URLRequest.HTTPMethod = @"HEAD";
+        
+        dispatch_group_enter(group);
+        
+        // Any response, whatever its status, means that a connection has been established
+        NSURLSessionDataTask *dataTask = [self.session dataTaskWithRequest:URLRequest completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            os_unfair_lock_lock(&self->_lock);
+            if (response) {
+                [self.warmOrigins addObject:origin];
+            }
+            else {
+                [self.warmOrigins removeObject:origin];
+            }
+            os_unfair_lock_unlock(&self->_lock);
+            
+            if (! response) {
+                SRGNetworkLogWarning(@"Connection Prewarmer", @"Could not prewarm a connection to %@. Reason: %@", origin, error);
+            }
+            dispatch_group_leave(group);
+        }];
+        
+        // Identify the probe connection, so that requests reusing it can be told apart
+        [SRGTaskMetricsDelegate observeMetricsForTask:dataTask withHandler:^(NSURLSessionTaskMetrics * _Nonnull taskMetrics) {
+            NSString *connectionIdentifier = SRGConnectionPrewarmerConnectionIdentifier(taskMetrics.transactionMetrics.lastObject);
+            if (! connectionIdentifier) {
+                return;
+            }
+            
+            os_unfair_lock_lock(&self->_lock);
+            [self.connectionIdentifiers addObject:connectionIdentifier];
+            os_unfair_lock_unlock(&self->_lock);
+        }];
+        
+        os_unfair_lock_lock(&self->_lock);
+        self->_numberOfProbes++;
+        os_unfair_lock_unlock(&self->_lock);
+        
+        [dataTask resume];
+    }];
+    
+    if (completionBlock) {
+        dispatch_group_notify(group, dispatch_get_main_queue(), completionBlock);
+    }
+}
+
+- (BOOL)isOriginWarmForURL:(NSURL *)URL
+{
+    NSString *origin = SRGConnectionPrewarmerOrigin(URL);
+    if (! origin) {
+        return NO;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    BOOL warm = [self.warmOrigins containsObject:origin];
+    os_unfair_lock_unlock(&_lock);
+    return warm;
+}
+
+- (void)invalidate
+{
+    os_unfair_lock_lock(&_lock);
+    dispatch_source_t keepAliveTimer = _keepAliveTimer;
+    _keepAliveTimer = nil;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (keepAliveTimer) {
+        dispatch_source_cancel(keepAliveTimer);
+    }
+}
+
+#pragma mark Connection reuse
+
+- (SRGConnectionReuse)connectionReuseForTaskMetrics:(NSURLSessionTaskMetrics *)taskMetrics
+{
+    SRGConnectionReuse connectionReuse = SRGConnectionReuseForTaskMetrics(taskMetrics);
+    if (connectionReuse != SRGConnectionReuseReused) {
+        return connectionReuse;
+    }
+    
+    NSString *connectionIdentifier = SRGConnectionPrewarmerConnectionIdentifier(taskMetrics.transactionMetrics.lastObject);
+    if (! connectionIdentifier) {
+        return connectionReuse;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    BOOL prewarmed = [self.connectionIdentifiers containsObject:connectionIdentifier];
+    if (prewarmed) {
+        _numberOfPrewarmedConnectionReuses++;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return prewarmed ? SRGConnectionReusePrewarmed : connectionReuse;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<NSString *> *origins = self.probeURLs.allKeys;
+    os_unfair_lock_unlock(&_lock);
+    
+    return [NSString stringWithFormat:@"<%@: %p; session = %@; keepAliveInterval = %@; origins = %@>",
+            self.class,
+            self,
+            self.session,
+            @(self.keepAliveInterval),
+            origins];
+}
+
+@end
+
+#pragma mark Functions
+
+SRGConnectionReuse SRGConnectionReuseForTaskMetrics(NSURLSessionTaskMetrics *taskMetrics)
+{
+    // Earlier transactions correspond to redirects. Responses loaded from a cache involve no connection at all.
+    NSURLSessionTaskTransactionMetrics *transactionMetrics = taskMetrics.transactionMetrics.lastObject;
+    if (! transactionMetrics || transactionMetrics.resourceFetchType != NSURLSessionTaskMetricsResourceFetchTypeNetworkLoad) {
+        return SRGConnectionReuseUnknown;
+    }
+    
+    return transactionMetrics.reusedConnection ? SRGConnectionReuseReused : SRGConnectionReuseNone;
+}
+
+#pragma mark Static functions
+
+static NSString *SRGConnectionPrewarmerOrigin(NSURL *URL)
+{
+    NSString *scheme = URL.scheme.lowercaseString;
+    NSString *host = URL.host.lowercaseString;
+    if (! scheme || host.length == 0) {
+        return nil;
+    }
+    
+    NSNumber *port = URL.port;
+    if (! port) {
+        if ([scheme isEqualToString:@"https"]) {
+            port = @443;
+        }
+        else if ([scheme isEqualToString:@"http"]) {
+            port = @80;
+        }
+        else {
+            return nil;
+        }
+    }
+    
+    // IPv6 address literals must be enclosed in brackets
+    if ([host containsString:@":"]) {
+        host = [NSString stringWithFormat:@"[%@]", host];
+    }
+    return [NSString stringWithFormat:@"%@://%@:%@", scheme, host, port];
+}
+
+// Connections are identified by their local and remote endpoints, which are unique among open connections.
+static NSString *SRGConnectionPrewarmerConnectionIdentifier(NSURLSessionTaskTransactionMetrics *transactionMetrics)
+{
+    if (@available(iOS 13, tvOS 13, watchOS 6, *)) {
+        if (! transactionMetrics.localAddress || ! transactionMetrics.localPort || ! transactionMetrics.remoteAddress || ! transactionMetrics.remotePort) {
+            return nil;
+        }
+        return [NSString stringWithFormat:@"%@:%@-%@:%@", transactionMetrics.localAddress, transactionMetrics.localPort, transactionMetrics.remoteAddress, transactionMetrics.remotePort];
+    }
+    else {
+        return nil;
+    }
+}
@@ -0,0 +1,38 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGContentCoding.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Return the request to perform for the specified request: the names of the specified codings are advertised in its
+ *  `Accept-Encoding` header (unless already set), and its body is encoded with the body coding if at least as large as
+ *  the specified minimum length (unless a `Content-Encoding` header is already set).
+ */
+OBJC_EXPORT NSURLRequest *SRGContentCodingURLRequest(NSURLRequest *URLRequest,
+                                                     NSArray<SRGContentCoding *> * _Nullable contentCodings,
+                                                     SRGContentCoding * _Nullable bodyContentCoding,
+                                                     NSUInteger minimumBodyLength);
+
+/**
+ *  Return the coding among the specified ones which must be used to decode the body of the specified response, if any.
+ */
+OBJC_EXPORT SRGContentCoding * _Nullable SRGContentCodingForResponse(NSURLResponse * _Nullable response, NSArray<SRGContentCoding *> * _Nullable contentCodings);
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGContentCoding (Private)
+
+/**
+ *  Decode a complete body at once. Fails with an `SRGNetworkErrorInvalidData` error if the decoded body exceeds 64 MB.
+ */
+- (nullable NSData *)decodedDataFromData:(NSData *)data error:(NSError * __autoreleasing *)pError;
+
+@end
+
+NS_ASSUME_NONNULL_END
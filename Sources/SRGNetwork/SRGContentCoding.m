@@ -0,0 +1,430 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGContentCoding+Private.h"
+
+#import "NSBundle+SRGNetwork.h"
+#import "SRGNetworkError.h"
+
+#import <zlib.h>
+
+// Maximum size of decoded chunks.
+static const NSUInteger SRGZlibContentDecoderChunkSize = 64 * 1024;
+
+// Maximum size of bodies decoded at once, protecting against excessive memory use (e.g. compression bombs).
+static const NSUInteger SRGContentCodingMaximumDecodedLength = 64 * 1024 * 1024;
+
+typedef NS_ENUM(NSInteger, SRGZlibFormat) {
+    SRGZlibFormatGzip,
+    SRGZlibFormatDeflate
+};
+
+static BOOL SRGZlibFormatMatchesHeader(SRGZlibFormat format, const uint8_t *bytes);
+static NSData *SRGZlibEncodedData(NSData *data, SRGZlibFormat format);
+static NSError *SRGZlibError(SRGZlibFormat format, NSString *description);
+
+/**
+ *  Streaming zlib decoder. Bodies which do not start with the format header are considered already decoded by the
+ *  transport, and are passed through unchanged.
+ */
+@interface SRGZlibContentDecoder : NSObject <SRGContentDecoder> {
+@private
+    z_stream _stream;
+    uint8_t _header[2];
+    NSUInteger _headerLength;
+    uint8_t *_buffer;
+}
+
+- (instancetype)initWithFormat:(SRGZlibFormat)format;
+
+@property (nonatomic) SRGZlibFormat format;
+@property (nonatomic, getter=isInflating) BOOL inflating;
+@property (nonatomic, getter=isPassingThrough) BOOL passingThrough;
+@property (nonatomic, getter=isFinished) BOOL finished;
+
+@end
+
+@interface SRGContentCoding ()
+
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) SRGContentDecoderProvider decoderProvider;
+@property (nonatomic, copy) SRGContentEncoder encoder;
+
+@end
+
+@implementation SRGContentCoding
+
+#pragma mark Class methods
+
++ (SRGContentCoding *)gzipContentCoding
+{
+    static SRGContentCoding *s_contentCoding;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_contentCoding = [[SRGContentCoding alloc] initWithName:@"gzip" decoderProvider:^id<SRGContentDecoder> _Nonnull{
+            return [[SRGZlibContentDecoder alloc] initWithFormat:SRGZlibFormatGzip];
+        } encoder:^NSData * _Nullable(NSData * _Nonnull data) {
+            return SRGZlibEncodedData(data, SRGZlibFormatGzip);
+        }];
+    });
+    return s_contentCoding;
+}
+
++ (SRGContentCoding *)deflateContentCoding
+{
+    static SRGContentCoding *s_contentCoding;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_contentCoding = [[SRGContentCoding alloc] initWithName:@"deflate" decoderProvider:^id<SRGContentDecoder> _Nonnull{
+            return [[SRGZlibContentDecoder alloc] initWithFormat:SRGZlibFormatDeflate];
+        } encoder:^NSData * _Nullable(NSData * _Nonnull data) {
+            return SRGZlibEncodedData(data, SRGZlibFormatDeflate);
+        }];
+    });
+    return s_contentCoding;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithName:(NSString *)name decoderProvider:(SRGContentDecoderProvider)decoderProvider encoder:(SRGContentEncoder)encoder
+{
+    NSParameterAssert(name.length != 0);
+    
+    if (self = [super init]) {
+        self.name = name.lowercaseString;
+        self.decoderProvider = decoderProvider;
+        self.encoder = encoder;
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithName:@"identity" decoderProvider:^id<SRGContentDecoder> _Nonnull{
+        return [[SRGZlibContentDecoder alloc] initWithFormat:SRGZlibFormatGzip];
+    } encoder:nil];
+}
+
+#pragma mark Decoding
+
+- (NSData *)decodedDataFromData:(NSData *)data error:(NSError * __autoreleasing *)pError
+{
+    NSMutableArray<NSData *> *chunks = [NSMutableArray array];
+    __block NSUInteger length = 0;
+    __block BOOL exceeded = NO;
+    SRGContentDecoderOutputBlock block = ^(NSData *decodedData) {
+        // Decoding cannot be interrupted, but chunks beyond the limit are discarded
+        if (exceeded || length + decodedData.length > SRGContentCodingMaximumDecodedLength) {
+            [chunks removeAllObjects];
+            exceeded = YES;
+            return;
+        }
+        
+        [chunks addObject:decodedData];
+        length += decodedData.length;
+    };
+    
+    id<SRGContentDecoder> decoder = self.decoderProvider();
+    if (! [decoder decodeData:data withBlock:block error:pError] || ! [decoder finishWithBlock:block error:pError]) {
+        return nil;
+    }
+    
+    if (exceeded) {
+        if (pError) {
+            NSString *description = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"The %@ decoded data exceeds the maximum size of %@ bytes."), self.name, @(SRGContentCodingMaximumDecodedLength)];
+            *pError = [NSError errorWithDomain:SRGNetworkErrorDomain
+                                          code:SRGNetworkErrorInvalidData
+                                      userInfo:@{ NSLocalizedDescriptionKey : description }];
+        }
+        return nil;
+    }
+    
+    // Avoid copies when the body was passed through unchanged
+    if (chunks.count == 1) {
+        return chunks.firstObject;
+    }
+    
+    NSMutableData *decodedData = [NSMutableData dataWithCapacity:length];
+    for (NSData *chunk in chunks) {
+        [decodedData appendData:chunk];
+    }
+    return decodedData.copy;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; name = %@; encoder = %@>",
+            self.class,
+            self,
+            self.name,
+            self.encoder ? @"YES" : @"NO"];
+}
+
+@end
+
+@implementation SRGZlibContentDecoder
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithFormat:(SRGZlibFormat)format
+{
+    if (self = [super init]) {
+        self.format = format;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (self.inflating) {
+        inflateEnd(&_stream);
+    }
+    free(_buffer);
+}
+
+#pragma mark SRGContentDecoder protocol
+
+- (BOOL)decodeData:(NSData *)data withBlock:(SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError
+{
+    if (self.passingThrough) {
+        if (data.length != 0) {
+            block(data);
+        }
+        return YES;
+    }
+    
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    
+    // The header must be available to decide whether the body has already been decoded
+    if (! self.inflating) {
+        NSUInteger bufferedHeaderLength = _headerLength;
+        while (_headerLength < sizeof(_header) && length != 0) {
+            _header[_headerLength++] = *bytes++;
+            length--;
+        }
+        if (_headerLength < sizeof(_header)) {
+            return YES;
+        }
+        
+        if (! SRGZlibFormatMatchesHeader(self.format, _header)) {
+            self.passingThrough = YES;
+            if (bufferedHeaderLength != 0) {
+                block([NSData dataWithBytes:_header length:bufferedHeaderLength]);
+            }
+            if (data.length != 0) {
+                block(data);
+            }
+            return YES;
+        }
+        
+        int windowBits = (self.format == SRGZlibFormatGzip) ? 16 + MAX_WBITS : MAX_WBITS;
+        if (inflateInit2(&_stream, windowBits) != Z_OK) {
+            if (pError) {
+                *pError = SRGZlibError(self.format, SRGNetworkNonLocalizedString(@"The decoder could not be created."));
+            }
+            return NO;
+        }
+        self.inflating = YES;
+        _buffer = malloc(SRGZlibContentDecoderChunkSize);
+        
+        if (! [self inflateBytes:_header length:_headerLength withBlock:block error:pError]) {
+            return NO;
+        }
+    }
+    
+    return [self inflateBytes:bytes length:length withBlock:block error:pError];
+}
+
+- (BOOL)finishWithBlock:(SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError
+{
+    if (self.passingThrough) {
+        return YES;
+    }
+    
+    // Bodies too short to contain a header cannot be encoded
+    if (! self.inflating) {
+        if (_headerLength != 0) {
+            block([NSData dataWithBytes:_header length:_headerLength]);
+        }
+        return YES;
+    }
+    
+    if (! self.finished) {
+        if (pError) {
+            *pError = SRGZlibError(self.format, SRGNetworkNonLocalizedString(@"The data is truncated."));
+        }
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark Inflation
+
+- (BOOL)inflateBytes:(const uint8_t *)bytes length:(NSUInteger)length withBlock:(SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError
+{
+    // Trailing bytes after the end of the stream are ignored
+    while (length != 0 && ! self.finished) {
+        uInt sliceLength = (uInt)MIN(length, (NSUInteger)UINT_MAX);
+        _stream.next_in = (Bytef *)bytes;
+        _stream.avail_in = sliceLength;
+        
+        do {
+            _stream.next_out = _buffer;
+            _stream.avail_out = (uInt)SRGZlibContentDecoderChunkSize;
+            
+            int status = inflate(&_stream, Z_NO_FLUSH);
+            if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+                if (pError) {
+                    NSString *description = _stream.msg ? @(_stream.msg) : SRGNetworkNonLocalizedString(@"The data is corrupted.");
+                    *pError = SRGZlibError(self.format, description);
+                }
+                return NO;
+            }
+            
+            NSUInteger decodedLength = SRGZlibContentDecoderChunkSize - _stream.avail_out;
+            if (decodedLength != 0) {
+                block([NSData dataWithBytes:_buffer length:decodedLength]);
+            }
+            
+            if (status == Z_STREAM_END) {
+                self.finished = YES;
+                break;
+            }
+        } while (_stream.avail_out == 0 || _stream.avail_in != 0);
+        
+        bytes += sliceLength;
+        length -= sliceLength;
+    }
+    return YES;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; format = %@; passingThrough = %@>",
+            self.class,
+            self,
+            (self.format == SRGZlibFormatGzip) ? @"gzip" : @"deflate",
+            self.passingThrough ? @"YES" : @"NO"];
+}
+
+@end
+
+#pragma mark Functions
+
+NSURLRequest *SRGContentCodingURLRequest(NSURLRequest *URLRequest, NSArray<SRGContentCoding *> *contentCodings, SRGContentCoding *bodyContentCoding, NSUInteger minimumBodyLength)
+{
+    BOOL advertisingCodings = (contentCodings.count != 0) && ! [URLRequest valueForHTTPHeaderField:@"Accept-Encoding"];
+    
+    NSData *body = URLRequest.HTTPBody;
+    BOOL encodingBody = bodyContentCoding.encoder && body.length != 0 && body.length >= minimumBodyLength
+        && ! [URLRequest valueForHTTPHeaderField:@"Content-Encoding"];
+    
+    if (! advertisingCodings && ! encodingBody) {
+        return URLRequest;
+    }
+    
+    NSMutableURLRequest *mutableURLRequest = URLRequest.mutableCopy;
+    
+    if (advertisingCodings) {
+        // Codings natively decoded by the system remain supported, with lower preference
+        NSMutableOrderedSet<NSString *> *names = [NSMutableOrderedSet orderedSet];
+        for (SRGContentCoding *contentCoding in contentCodings) {
+            [names addObject:contentCoding.name];
+        }
+        [names addObjectsFromArray:@[ @"gzip", @"deflate", @"br" ]];
+        [mutableURLRequest setValue:[names.array componentsJoinedByString:@", "] forHTTPHeaderField:@"Accept-Encoding"];
+    }
+    
+    if (encodingBody) {
+        // Only send encoded bodies which are actually smaller
+        NSData *encodedBody = bodyContentCoding.encoder(body);
+        if (encodedBody && encodedBody.length < body.length) {
+            mutableURLRequest.HTTPBody = encodedBody;
+            [mutableURLRequest setValue:bodyContentCoding.name forHTTPHeaderField:@"Content-Encoding"];
+        }
+    }
+    
+    return mutableURLRequest.copy;
+}
+
+SRGContentCoding *SRGContentCodingForResponse(NSURLResponse *response, NSArray<SRGContentCoding *> *contentCodings)
+{
+    if (contentCodings.count == 0 || ! [response isKindOfClass:NSHTTPURLResponse.class]) {
+        return nil;
+    }
+    
+    // Several codings applied in sequence are not supported
+    NSString *contentEncoding = [(NSHTTPURLResponse *)response valueForHTTPHeaderField:@"Content-Encoding"];
+    NSString *name = [contentEncoding stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet].lowercaseString;
+    if (name.length == 0 || [name containsString:@","]) {
+        return nil;
+    }
+    
+    for (SRGContentCoding *contentCoding in contentCodings) {
+        if ([contentCoding.name isEqualToString:name]) {
+            return contentCoding;
+        }
+    }
+    return nil;
+}
+
+#pragma mark Static functions
+
+static BOOL SRGZlibFormatMatchesHeader(SRGZlibFormat format, const uint8_t *bytes)
+{
+    if (format == SRGZlibFormatGzip) {
+        return bytes[0] == 0x1f && bytes[1] == 0x8b;
+    }
+    else {
+        // Deflate compression method and header checksum (see RFC 1950)
+        return (bytes[0] & 0x0f) == Z_DEFLATED && (bytes[0] >> 4) <= 7 && ((bytes[0] << 8) | bytes[1]) % 31 == 0;
+    }
+}
+
+static NSData *SRGZlibEncodedData(NSData *data, SRGZlibFormat format)
+{
+    if (data.length > UINT_MAX) {
+        return nil;
+    }
+    
+    z_stream stream = { 0 };
+    int windowBits = (format == SRGZlibFormatGzip) ? 16 + MAX_WBITS : MAX_WBITS;
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+    
+    uLong capacity = deflateBound(&stream, (uLong)data.length);
+    NSMutableData *encodedData = [NSMutableData dataWithLength:capacity];
+    
+    stream.next_in = (Bytef *)data.bytes;
+    stream.avail_in = (uInt)data.length;
+    stream.next_out = encodedData.mutableBytes;
+    stream.avail_out = (uInt)capacity;
+    
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+    
+    encodedData.length = stream.total_out;
+    return encodedData.copy;
+}
+
+static NSError *SRGZlibError(SRGZlibFormat format, NSString *description)
+{
+    NSString *name = (format == SRGZlibFormatGzip) ? @"gzip" : @"deflate";
+    NSString *fullDescription = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Invalid %@ encoded data. %@"), name, description];
+    return [NSError errorWithDomain:SRGNetworkErrorDomain
+                               code:SRGNetworkErrorInvalidData
+                           userInfo:@{ NSLocalizedDescriptionKey : fullDescription }];
+}
@@ -9,6 +9,7 @@
 #import "SRGNetworkError.h"
 #import "SRGNetworkParsers.h"
 #import "SRGPage+Private.h"
+#import "SRGPageFanOut.h"
 #import "SRGPageRequest+Subclassing.h"
 
 @implementation SRGFirstPageRequest
@@ -84,4 +85,19 @@
     return [self requestWithPage:page class:SRGPageRequest.class];
 }
 
+- (SRGRequestQueue *)requestQueueForAllPagesWithBuilder:(SRGPageBuilder)builder
+                                         itemsExtractor:(SRGPageItemsExtractor)itemsExtractor
+                      maximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+                                        completionBlock:(SRGAllPagesCompletionBlock)completionBlock
+{
+    SRGPageFanOut *pageFanOut = [[SRGPageFanOut alloc] initWithRequest:self
+                                                               builder:builder
+                                                        itemsExtractor:itemsExtractor
+                                     maximumNumberOfConcurrentRequests:maximumNumberOfConcurrentRequests
+                                                       completionBlock:completionBlock];
+    SRGRequestQueue *requestQueue = pageFanOut.requestQueue;
+    [pageFanOut resume];
+    return requestQueue;
+}
+
 @end
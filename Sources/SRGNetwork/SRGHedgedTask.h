@@ -0,0 +1,51 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGHedgingPolicy.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGHedgedTaskCompletionHandler)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error);
+
+/**
+ *  Return `YES` iff the specified request can safely be performed twice.
+ */
+OBJC_EXPORT BOOL SRGHedgedTaskIsSupportedForURLRequest(NSURLRequest *URLRequest);
+
+/**
+ *  Network task starting a duplicate session task if no response has been received after the delay defined by its
+ *  policy. The first task which finishes wins, and the other one is cancelled. The completion handler is called once,
+ *  on a background thread.
+ */
+@interface SRGHedgedTask : NSObject
+
+/**
+ *  Create a task. Call `-resume` to start it.
+ */
+- (instancetype)initWithURLRequest:(NSURLRequest *)URLRequest
+                           session:(NSURLSession *)session
+                     hedgingPolicy:(SRGHedgingPolicy *)hedgingPolicy
+                          priority:(float)priority
+                 completionHandler:(SRGHedgedTaskCompletionHandler)completionHandler NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Start the task.
+ */
+- (void)resume;
+
+/**
+ *  Cancel the task. The completion handler is not called. Returns `YES` iff the task had not finished yet.
+ */
+- (BOOL)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
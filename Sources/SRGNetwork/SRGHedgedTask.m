@@ -0,0 +1,167 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGHedgedTask.h"
+
+#import "SRGHedgingPolicy+Private.h"
+
+#import <os/lock.h>
+
+@interface SRGHedgedTask () {
+@private
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic) NSURLRequest *URLRequest;
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic) SRGHedgingPolicy *hedgingPolicy;
+@property (nonatomic) float priority;
+@property (nonatomic, copy) SRGHedgedTaskCompletionHandler completionHandler;
+
+// Task state (protected by the lock)
+@property (nonatomic) NSURLSessionTask *primarySessionTask;
+@property (nonatomic) NSURLSessionTask *hedgeSessionTask;
+@property (nonatomic) NSUInteger numberOfRunningSessionTasks;
+@property (nonatomic, getter=isFinished) BOOL finished;
+
+@property (nonatomic) NSDate *startDate;
+
+@end
+
+@implementation SRGHedgedTask
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithURLRequest:(NSURLRequest *)URLRequest
+                           session:(NSURLSession *)session
+                     hedgingPolicy:(SRGHedgingPolicy *)hedgingPolicy
+                          priority:(float)priority
+                 completionHandler:(SRGHedgedTaskCompletionHandler)completionHandler
+{
+    if (self = [super init]) {
+        self.URLRequest = URLRequest;
+        self.session = session;
+        self.hedgingPolicy = hedgingPolicy;
+        self.priority = priority;
+        self.completionHandler = completionHandler;
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Task management
+
+- (void)resume
+{
+    NSURLSessionTask *sessionTask = [self sessionTaskAsHedge:NO];
+    self.startDate = NSDate.date;
+    
+    os_unfair_lock_lock(&_lock);
+    self.primarySessionTask = sessionTask;
+    self.numberOfRunningSessionTasks = 1;
+    os_unfair_lock_unlock(&_lock);
+    
+    [sessionTask resume];
+    
+    // The task retains itself until the hedge has been considered
+    NSTimeInterval delay = self.hedgingPolicy.delay;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [self startHedgeIfNeeded];
+    });
+}
+
+- (void)startHedgeIfNeeded
+{
+    // The session task response is available as soon as headers have been received
+    os_unfair_lock_lock(&_lock);
+    BOOL needed = ! self.finished && ! self.hedgeSessionTask && self.primarySessionTask.response == nil;
+    NSURLSessionTask *hedgeSessionTask = nil;
+    if (needed) {
+        hedgeSessionTask = [self sessionTaskAsHedge:YES];
+        self.hedgeSessionTask = hedgeSessionTask;
+        self.numberOfRunningSessionTasks++;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (hedgeSessionTask) {
+        [self.hedgingPolicy recordHedgeFired];
+        [hedgeSessionTask resume];
+    }
+}
+
+- (BOOL)cancel
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL running = ! self.finished;
+    self.finished = YES;
+    NSURLSessionTask *primarySessionTask = self.primarySessionTask;
+    NSURLSessionTask *hedgeSessionTask = self.hedgeSessionTask;
+    os_unfair_lock_unlock(&_lock);
+    
+    [primarySessionTask cancel];
+    [hedgeSessionTask cancel];
+    return running;
+}
+
+- (NSURLSessionTask *)sessionTaskAsHedge:(BOOL)hedge
+{
+    NSURLSessionTask *sessionTask = [self.session dataTaskWithRequest:self.URLRequest completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [self sessionTaskAsHedge:hedge didFinishWithData:data response:response error:error];
+    }];
+    sessionTask.priority = self.priority;
+    return sessionTask;
+}
+
+- (void)sessionTaskAsHedge:(BOOL)hedge didFinishWithData:(NSData *)data response:(NSURLResponse *)response error:(NSError *)error
+{
+    os_unfair_lock_lock(&_lock);
+    self.numberOfRunningSessionTasks--;
+    
+    // A failed task only wins if no other task can succeed anymore
+    BOOL won = ! self.finished && (! error || self.numberOfRunningSessionTasks == 0);
+    NSURLSessionTask *loserSessionTask = nil;
+    if (won) {
+        self.finished = YES;
+        loserSessionTask = hedge ? self.primarySessionTask : self.hedgeSessionTask;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (! won) {
+        return;
+    }
+    
+    [loserSessionTask cancel];
+    
+    // Latencies of original tasks only. If the hedge won, the original task latency is at least the elapsed time.
+    [self.hedgingPolicy recordLatency:[NSDate.date timeIntervalSinceDate:self.startDate]];
+    
+    if (hedge) {
+        [self.hedgingPolicy recordHedgeWon];
+    }
+    
+    self.completionHandler(data, response, error);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; URL = %@; hedgingPolicy = %@>",
+            self.class,
+            self,
+            self.URLRequest.URL,
+            self.hedgingPolicy];
+}
+
+@end
+
+#pragma mark Functions
+
+BOOL SRGHedgedTaskIsSupportedForURLRequest(NSURLRequest *URLRequest)
+{
+    NSString *HTTPMethod = URLRequest.HTTPMethod.uppercaseString ?: @"GET";
+    return ([HTTPMethod isEqualToString:@"GET"] || [HTTPMethod isEqualToString:@"HEAD"]) && ! URLRequest.HTTPBody && ! URLRequest.HTTPBodyStream;
+}
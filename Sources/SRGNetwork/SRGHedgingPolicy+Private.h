@@ -0,0 +1,33 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGHedgingPolicy.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGHedgingPolicy (Private)
+
+/**
+ *  Record the latency of a network task, from its start until it finished.
+ */
+- (void)recordLatency:(NSTimeInterval)latency;
+
+/**
+ *  Record that a duplicate task has been started.
+ */
+- (void)recordHedgeFired;
+
+/**
+ *  Record that a duplicate task finished first.
+ */
+- (void)recordHedgeWon;
+
+@end
+
+NS_ASSUME_NONNULL_END
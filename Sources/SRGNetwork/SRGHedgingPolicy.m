@@ -0,0 +1,133 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGHedgingPolicy+Private.h"
+
+#import <os/lock.h>
+
+// Number of recent latencies from which percentiles are computed, and the minimum number required.
+static const NSUInteger SRGHedgingPolicyLatencyCapacity = 128;
+static const NSUInteger SRGHedgingPolicyMinimumLatencyCount = 16;
+
+@interface SRGHedgingPolicy () {
+@private
+    os_unfair_lock _lock;
+    NSTimeInterval _latencies[SRGHedgingPolicyLatencyCapacity];
+    NSUInteger _latencyCount;
+    NSUInteger _latencyIndex;
+    NSTimeInterval _delay;
+    NSUInteger _numberOfHedgesFired;
+    NSUInteger _numberOfHedgesWon;
+}
+
+@property (nonatomic) double latencyPercentile;
+@property (nonatomic) NSTimeInterval minimumDelay;
+
+@end
+
+@implementation SRGHedgingPolicy
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithDelay:(NSTimeInterval)delay
+{
+    // A percentile of 0 is never used, the minimum delay is always applied
+    return [self initWithLatencyPercentile:0. minimumDelay:delay];
+}
+
+- (instancetype)initWithLatencyPercentile:(double)latencyPercentile minimumDelay:(NSTimeInterval)minimumDelay
+{
+    if (self = [super init]) {
+        self.latencyPercentile = fmin(fmax(latencyPercentile, 0.), 1.);
+        self.minimumDelay = fmax(minimumDelay, 0.);
+        _delay = self.minimumDelay;
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSTimeInterval)delay
+{
+    os_unfair_lock_lock(&_lock);
+    NSTimeInterval delay = _delay;
+    os_unfair_lock_unlock(&_lock);
+    return delay;
+}
+
+- (NSUInteger)numberOfHedgesFired
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfHedgesFired = _numberOfHedgesFired;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfHedgesFired;
+}
+
+- (NSUInteger)numberOfHedgesWon
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfHedgesWon = _numberOfHedgesWon;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfHedgesWon;
+}
+
+#pragma mark Recording
+
+- (void)recordLatency:(NSTimeInterval)latency
+{
+    if (self.latencyPercentile == 0.) {
+        return;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    _latencies[_latencyIndex] = latency;
+    _latencyIndex = (_latencyIndex + 1) % SRGHedgingPolicyLatencyCapacity;
+    _latencyCount = MIN(_latencyCount + 1, SRGHedgingPolicyLatencyCapacity);
+    
+    // The delay is computed once per recorded latency, so that reading it stays cheap
+    if (_latencyCount >= SRGHedgingPolicyMinimumLatencyCount) {
+        NSTimeInterval sortedLatencies[SRGHedgingPolicyLatencyCapacity];
+        memcpy(sortedLatencies, _latencies, _latencyCount * sizeof(NSTimeInterval));
+        qsort_b(sortedLatencies, _latencyCount, sizeof(NSTimeInterval), ^int(const void *latency1, const void *latency2) {
+            NSTimeInterval value1 = *(const NSTimeInterval *)latency1;
+            NSTimeInterval value2 = *(const NSTimeInterval *)latency2;
+            return (value1 > value2) - (value1 < value2);
+        });
+        
+        NSUInteger index = MIN((NSUInteger)ceil(self.latencyPercentile * _latencyCount), _latencyCount) - 1;
+        _delay = fmax(sortedLatencies[index], self.minimumDelay);
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)recordHedgeFired
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfHedgesFired++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)recordHedgeWon
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfHedgesWon++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; delay = %@; numberOfHedgesFired = %@; numberOfHedgesWon = %@>",
+            self.class,
+            self,
+            @(self.delay),
+            @(self.numberOfHedgesFired),
+            @(self.numberOfHedgesWon)];
+}
+
+@end
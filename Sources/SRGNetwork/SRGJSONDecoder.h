@@ -0,0 +1,37 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONSchema.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  One-pass decoder populating model objects directly from UTF-8 JSON data, as described by a schema. Values which
+ *  are not needed are skipped without being materialized.
+ *
+ *  Decoders are not thread-safe and must be used for a single decoding.
+ */
+@interface SRGJSONDecoder : NSObject
+
+/**
+ *  Create a decoder for the specified data.
+ */
+- (instancetype)initWithData:(NSData *)data NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Decode the value found at the specified key path (the top-level value if `nil`), returning a model if it is an
+ *  object or an array of models if it is an array. Returns `nil` and an error if the data is invalid, if no object
+ *  or array is found at the key path, or if a value does not have the type declared by the schema.
+ */
+- (nullable id)decodeWithSchema:(SRGJSONSchema *)schema keyPath:(nullable NSString *)keyPath error:(NSError * __autoreleasing *)pError;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,596 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONDecoder.h"
+
+#import "NSBundle+SRGNetwork.h"
+#import "SRGCancellationToken.h"
+#import "SRGJSONScanner.h"
+#import "SRGJSONSchema+Private.h"
+#import "SRGNetworkError.h"
+
+// Maximum nesting depth, so that malicious data cannot exhaust the stack.
+static const NSUInteger SRGJSONDecoderMaximumDepth = 512;
+
+// Number of array elements decoded between two cancellation checks.
+static const NSUInteger SRGJSONDecoderCancellationCheckInterval = 256;
+
+@interface SRGJSONDecoder () {
+@private
+    const uint8_t *_bytes;
+    NSUInteger _length;
+    NSUInteger _offset;
+    NSUInteger _depth;
+    NSUInteger _numberOfElements;
+}
+
+@property (nonatomic) NSData *data;
+@property (nonatomic) SRGCancellationToken *cancellationToken;
+@property (nonatomic) NSError *error;
+
+@end
+
+@implementation SRGJSONDecoder
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithData:(NSData *)data
+{
+    if (self = [super init]) {
+        // Accessing the bytes flattens discontiguous data once, which is cheaper than dealing with regions
+        self.data = data;
+        self.cancellationToken = SRGCancellationToken.currentToken;
+        _bytes = data.bytes;
+        _length = data.length;
+    }
+    return self;
+}
+
+#pragma mark Decoding
+
+- (id)decodeWithSchema:(SRGJSONSchema *)schema keyPath:(NSString *)keyPath error:(NSError * __autoreleasing *)pError
+{
+    // Skip the UTF-8 byte order mark, if any
+    if (_length >= 3 && _bytes[0] == 0xEF && _bytes[1] == 0xBB && _bytes[2] == 0xBF) {
+        _offset = 3;
+    }
+    
+    NSArray<NSData *> *keyPathComponents = nil;
+    if (keyPath) {
+        NSMutableArray<NSData *> *components = [NSMutableArray array];
+        for (NSString *component in [keyPath componentsSeparatedByString:@"."]) {
+            [components addObject:[component dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+        keyPathComponents = components.copy;
+    }
+    else {
+        keyPathComponents = @[];
+    }
+    
+    id result = nil;
+    if ([self decodeValue:&result withSchema:schema keyPathComponents:keyPathComponents index:0]) {
+        [self skipWhitespace];
+        if (_offset != _length) {
+            [self failWithDescription:SRGNetworkNonLocalizedString(@"Unexpected data after the JSON value")];
+        }
+        else if (! result) {
+            NSString *description = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"No object or array found at key path '%@'"), keyPath ?: @""];
+            [self failWithDescription:description];
+        }
+    }
+    
+    if (self.error) {
+        if (pError) {
+            *pError = self.error;
+        }
+        return nil;
+    }
+    
+    return result;
+}
+
+- (BOOL)decodeValue:(id __autoreleasing *)pValue withSchema:(SRGJSONSchema *)schema keyPathComponents:(NSArray<NSData *> *)keyPathComponents index:(NSUInteger)index
+{
+    if (index == keyPathComponents.count) {
+        return [self decodeModelOrModels:pValue withSchema:schema];
+    }
+    
+    if ([self peekCharacter] != '{') {
+        return [self skipValue];
+    }
+    
+    // Traverse the object to find the key path component, skipping all other values
+    NSData *keyData = keyPathComponents[index];
+    __block id value = nil;
+    BOOL success = [self decodeObjectWithKeyBlock:^BOOL(const uint8_t *keyBytes, NSUInteger keyLength) {
+        if (keyLength == keyData.length && memcmp(keyBytes, keyData.bytes, keyLength) == 0) {
+            id nestedValue = nil;
+            if (! [self decodeValue:&nestedValue withSchema:schema keyPathComponents:keyPathComponents index:index + 1]) {
+                return NO;
+            }
+            value = nestedValue;
+            return YES;
+        }
+        else {
+            return [self skipValue];
+        }
+    }];
+    if (! success) {
+        return NO;
+    }
+    *pValue = value;
+    return YES;
+}
+
+- (BOOL)decodeModelOrModels:(id __autoreleasing *)pValue withSchema:(SRGJSONSchema *)schema
+{
+    uint8_t character = [self peekCharacter];
+    if (character == '{') {
+        id model = [[schema.modelClass alloc] init];
+        if (! [self decodeObjectWithNode:schema.node intoModel:model]) {
+            return NO;
+        }
+        *pValue = model;
+        return YES;
+    }
+    else if (character == '[') {
+        NSMutableArray *models = [NSMutableArray array];
+        BOOL success = [self decodeArrayWithElementBlock:^BOOL{
+            uint8_t character = [self peekCharacter];
+            if (character == '{') {
+                id model = [[schema.modelClass alloc] init];
+                if (! [self decodeObjectWithNode:schema.node intoModel:model]) {
+                    return NO;
+                }
+                [models addObject:model];
+                return YES;
+            }
+            else if (character == 'n') {
+                return [self skipValue];
+            }
+            else {
+                [self failWithDescription:[NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Expected an object to decode %@"), schema.modelClass]];
+                return NO;
+            }
+        }];
+        if (! success) {
+            return NO;
+        }
+        *pValue = models.copy;
+        return YES;
+    }
+    else {
+        return [self skipValue];
+    }
+}
+
+- (BOOL)decodeObjectWithNode:(SRGJSONSchemaNode *)node intoModel:(id)model
+{
+    return [self decodeObjectWithKeyBlock:^BOOL(const uint8_t *keyBytes, NSUInteger keyLength) {
+        SRGJSONSchemaEntry *entry = [node entryForKeyBytes:keyBytes length:keyLength];
+        if (! entry) {
+            return [self skipValue];
+        }
+        
+        // Several fields and nested key paths might be decoded from the same value, which is then simply read again
+        [self skipWhitespace];
+        NSUInteger valueOffset = self->_offset;
+        for (SRGJSONField *field in entry.fields) {
+            self->_offset = valueOffset;
+            if (! [self decodeField:field intoModel:model]) {
+                return NO;
+            }
+        }
+        if (entry.node) {
+            self->_offset = valueOffset;
+            if ([self peekCharacter] == '{') {
+                return [self decodeObjectWithNode:entry.node intoModel:model];
+            }
+            else {
+                return [self skipValue];
+            }
+        }
+        return YES;
+    }];
+}
+
+- (BOOL)decodeField:(SRGJSONField *)field intoModel:(id)model
+{
+    uint8_t character = [self peekCharacter];
+    if (character == 'n') {
+        return [self skipValue];
+    }
+    
+    id value = nil;
+    if (field.schema) {
+        if (character != '{' && character != '[') {
+            [self failWithTypeMismatchForField:field];
+            return NO;
+        }
+        if (! [self decodeModelOrModels:&value withSchema:field.schema]) {
+            return NO;
+        }
+    }
+    else {
+        switch (field.type) {
+            case SRGJSONFieldTypeString:
+            case SRGJSONFieldTypeURL: {
+                if (character != '"') {
+                    [self failWithTypeMismatchForField:field];
+                    return NO;
+                }
+                NSString *string = [self decodeString];
+                if (! string) {
+                    return NO;
+                }
+                if (field.type == SRGJSONFieldTypeURL) {
+                    value = [NSURL URLWithString:string];
+                    if (! value) {
+                        [self failWithDescription:[NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Invalid URL for key path '%@'"), field.keyPath]];
+                        return NO;
+                    }
+                }
+                else {
+                    value = string;
+                }
+                break;
+            }
+            
+            case SRGJSONFieldTypeNumber: {
+                if (character != '-' && ! (character >= '0' && character <= '9')) {
+                    [self failWithTypeMismatchForField:field];
+                    return NO;
+                }
+                value = [self decodeNumber];
+                break;
+            }
+            
+            case SRGJSONFieldTypeBoolean: {
+                SRGJSONLiteral literal = [self scanLiteral];
+                if (literal != SRGJSONLiteralTrue && literal != SRGJSONLiteralFalse) {
+                    [self failWithTypeMismatchForField:field];
+                    return NO;
+                }
+                value = SRGJSONLiteralObject(literal);
+                break;
+            }
+            
+            case SRGJSONFieldTypeJSON: {
+                value = [self decodeJSONValue];
+                break;
+            }
+        }
+        
+        if (! value) {
+            return NO;
+        }
+    }
+    
+    [model setValue:value forKey:field.property];
+    return YES;
+}
+
+#pragma mark Containers
+
+- (BOOL)decodeObjectWithKeyBlock:(BOOL (^)(const uint8_t *keyBytes, NSUInteger keyLength))keyBlock
+{
+    if (! [self enterContainer:'{']) {
+        return NO;
+    }
+    
+    if ([self peekCharacter] == '}') {
+        _offset++;
+        _depth--;
+        return YES;
+    }
+    
+    while (YES) {
+        if ([self peekCharacter] != '"') {
+            [self failWithDescription:SRGNetworkNonLocalizedString(@"Expected a key")];
+            return NO;
+        }
+        
+        // Keys are compared as raw bytes. Keys with escape sequences (very rare) are decoded first.
+        NSRange range = NSMakeRange(0, 0);
+        BOOL escaped = NO;
+        if (! [self scanStringWithRange:&range escaped:&escaped]) {
+            return NO;
+        }
+        
+        BOOL success = NO;
+        if (escaped) {
+            NSString *key = [self stringWithRange:range escaped:YES];
+            if (! key) {
+                return NO;
+            }
+            NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+            success = [self consumeCharacter:':'] && keyBlock(keyData.bytes, keyData.length);
+        }
+        else {
+            success = [self consumeCharacter:':'] && keyBlock(_bytes + range.location, range.length);
+        }
+        if (! success) {
+            return NO;
+        }
+        
+        uint8_t character = [self peekCharacter];
+        if (character == ',') {
+            _offset++;
+        }
+        else if (character == '}') {
+            _offset++;
+            _depth--;
+            return YES;
+        }
+        else {
+            [self failWithUnexpectedCharacter];
+            return NO;
+        }
+    }
+}
+
+- (BOOL)decodeArrayWithElementBlock:(BOOL (^)(void))elementBlock
+{
+    if (! [self enterContainer:'[']) {
+        return NO;
+    }
+    
+    if ([self peekCharacter] == ']') {
+        _offset++;
+        _depth--;
+        return YES;
+    }
+    
+    while (YES) {
+        // Large arrays of cancelled requests are not decoded any further
+        if (++_numberOfElements % SRGJSONDecoderCancellationCheckInterval == 0 && self.cancellationToken.cancelled) {
+            return [self failWithCancellation];
+        }
+        
+        if (! elementBlock()) {
+            return NO;
+        }
+        
+        uint8_t character = [self peekCharacter];
+        if (character == ',') {
+            _offset++;
+        }
+        else if (character == ']') {
+            _offset++;
+            _depth--;
+            return YES;
+        }
+        else {
+            [self failWithUnexpectedCharacter];
+            return NO;
+        }
+    }
+}
+
+- (BOOL)enterContainer:(uint8_t)character
+{
+    if (! [self consumeCharacter:character]) {
+        return NO;
+    }
+    
+    if (++_depth > SRGJSONDecoderMaximumDepth) {
+        [self failWithDescription:SRGNetworkNonLocalizedString(@"Maximum nesting depth exceeded")];
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark Values
+
+- (BOOL)skipValue
+{
+    switch ([self peekCharacter]) {
+        case '{': {
+            return [self decodeObjectWithKeyBlock:^BOOL(const uint8_t *keyBytes, NSUInteger keyLength) {
+                return [self skipValue];
+            }];
+        }
+        
+        case '[': {
+            return [self decodeArrayWithElementBlock:^BOOL{
+                return [self skipValue];
+            }];
+        }
+        
+        case '"': {
+            NSRange range = NSMakeRange(0, 0);
+            BOOL escaped = NO;
+            return [self scanStringWithRange:&range escaped:&escaped];
+        }
+        
+        case 't':
+        case 'f':
+        case 'n': {
+            return [self scanLiteral] != SRGJSONLiteralNone || [self failWithUnexpectedCharacter];
+        }
+        
+        default: {
+            NSRange range = NSMakeRange(0, 0);
+            return [self scanNumberWithRange:&range];
+        }
+    }
+}
+
+- (id)decodeJSONValue
+{
+    [self skipWhitespace];
+    NSUInteger startOffset = _offset;
+    if (! [self skipValue]) {
+        return nil;
+    }
+    
+    // Rarely used, let Foundation materialize the value
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)(_bytes + startOffset) length:_offset - startOffset freeWhenDone:NO];
+    id value = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingFragmentsAllowed error:NULL];
+    if (! value) {
+        _offset = startOffset;
+        [self failWithDescription:SRGNetworkNonLocalizedString(@"Invalid value")];
+    }
+    return value;
+}
+
+- (NSString *)decodeString
+{
+    NSRange range = NSMakeRange(0, 0);
+    BOOL escaped = NO;
+    if (! [self scanStringWithRange:&range escaped:&escaped]) {
+        return nil;
+    }
+    return [self stringWithRange:range escaped:escaped];
+}
+
+- (NSNumber *)decodeNumber
+{
+    // Numbers have been validated when scanned
+    NSRange range = NSMakeRange(0, 0);
+    if (! [self scanNumberWithRange:&range]) {
+        return nil;
+    }
+    return SRGJSONNumberFromBytes(_bytes + range.location, range.length);
+}
+
+#pragma mark Lexer
+
+- (void)skipWhitespace
+{
+    while (_offset < _length) {
+        uint8_t character = _bytes[_offset];
+        if (character != ' ' && character != '\t' && character != '\n' && character != '\r') {
+            break;
+        }
+        _offset++;
+    }
+}
+
+- (uint8_t)peekCharacter
+{
+    [self skipWhitespace];
+    return (_offset < _length) ? _bytes[_offset] : 0;
+}
+
+- (BOOL)consumeCharacter:(uint8_t)character
+{
+    if ([self peekCharacter] != character) {
+        return [self failWithUnexpectedCharacter];
+    }
+    _offset++;
+    return YES;
+}
+
+- (SRGJSONLiteral)scanLiteral
+{
+    [self skipWhitespace];
+    SRGJSONLiteral literal = SRGJSONLiteralNone;
+    _offset += SRGJSONScanLiteral(_bytes, _length, _offset, &literal);
+    return literal;
+}
+
+- (BOOL)scanStringWithRange:(NSRange *)pRange escaped:(BOOL *)pEscaped
+{
+    if (! [self consumeCharacter:'"']) {
+        return NO;
+    }
+    
+    NSUInteger startOffset = _offset;
+    BOOL escaped = NO;
+    _offset = SRGJSONScanString(_bytes, _length, startOffset, &escaped);
+    if (_offset == _length) {
+        return [self failWithDescription:SRGNetworkNonLocalizedString(@"Unexpected end of data")];
+    }
+    else if (_bytes[_offset] != '"') {
+        return [self failWithDescription:SRGNetworkNonLocalizedString(@"Invalid string")];
+    }
+    
+    *pRange = NSMakeRange(startOffset, _offset - startOffset);
+    *pEscaped = escaped;
+    _offset++;
+    return YES;
+}
+
+- (NSString *)stringWithRange:(NSRange)range escaped:(BOOL)escaped
+{
+    NSString *string = SRGJSONStringFromBytes(_bytes + range.location, range.length, escaped);
+    if (! string) {
+        _offset = range.location;
+        [self failWithDescription:SRGNetworkNonLocalizedString(@"Invalid string")];
+        return nil;
+    }
+    return string;
+}
+
+- (BOOL)scanNumberWithRange:(NSRange *)pRange
+{
+    [self skipWhitespace];
+    
+    NSUInteger startOffset = _offset;
+    _offset = SRGJSONScanNumber(_bytes, _length, startOffset);
+    if (_offset == startOffset) {
+        return [self failWithUnexpectedCharacter];
+    }
+    else if (! SRGJSONIsValidNumber(_bytes + startOffset, _offset - startOffset)) {
+        _offset = startOffset;
+        return [self failWithDescription:SRGNetworkNonLocalizedString(@"Invalid number")];
+    }
+    
+    *pRange = NSMakeRange(startOffset, _offset - startOffset);
+    return YES;
+}
+
+#pragma mark Errors
+
+- (BOOL)failWithTypeMismatchForField:(SRGJSONField *)field
+{
+    return [self failWithDescription:[NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected type for key path '%@' (property '%@')"), field.keyPath, field.property]];
+}
+
+- (BOOL)failWithUnexpectedCharacter
+{
+    if (_offset < _length) {
+        return [self failWithDescription:[NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected character '%c'"), _bytes[_offset]]];
+    }
+    else {
+        return [self failWithDescription:SRGNetworkNonLocalizedString(@"Unexpected end of data")];
+    }
+}
+
+// Always return `NO`, so that failures can be returned directly
+- (BOOL)failWithCancellation
+{
+    self.error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+    return NO;
+}
+
+// Always return `NO`, so that failures can be returned directly
+- (BOOL)failWithDescription:(NSString *)description
+{
+    // Keep the first (innermost) error
+    if (! self.error) {
+        NSString *fullDescription = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Invalid JSON data at offset %@. %@"), @(_offset), description];
+        self.error = [NSError errorWithDomain:SRGNetworkErrorDomain
+                                         code:SRGNetworkErrorInvalidData
+                                     userInfo:@{ NSLocalizedDescriptionKey : fullDescription }];
+    }
+    return NO;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; offset = %@; length = %@; error = %@>",
+            self.class,
+            self,
+            @(_offset),
+            @(_length),
+            self.error];
+}
+
+@end
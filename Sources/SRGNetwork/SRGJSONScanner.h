@@ -0,0 +1,83 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Scanning primitives shared by all JSON parsers (views, decoders and stream parsers), so that they all accept the
+ *  exact same grammar (RFC 8259) for scalar values. Parsers remain responsible for the structure (containers, keys
+ *  and separators) and for error reporting.
+ */
+
+// JSON literals.
+typedef NS_ENUM(uint8_t, SRGJSONLiteral) {
+    SRGJSONLiteralNone = 0,
+    SRGJSONLiteralNull,
+    SRGJSONLiteralTrue,
+    SRGJSONLiteralFalse
+};
+
+/**
+ *  Return `YES` iff the character can appear in a number token. Whether the token is a valid number must be checked
+ *  separately.
+ */
+OBJC_EXPORT BOOL SRGJSONIsNumberCharacter(uint8_t character);
+
+/**
+ *  Return `YES` iff the character can appear in a literal token.
+ */
+OBJC_EXPORT BOOL SRGJSONIsLiteralCharacter(uint8_t character);
+
+/**
+ *  Return `YES` iff the character can appear as is within a string, i.e. is neither a quote, a backslash nor a control
+ *  character.
+ */
+OBJC_EXPORT BOOL SRGJSONIsUnescapedStringCharacter(uint8_t character);
+
+/**
+ *  Scan the contents of the string starting at the specified offset (just after its opening quote). Return the offset
+ *  at which scanning stopped, which is the offset of the closing quote for valid strings, the offset of an invalid
+ *  character, or the length of the data if the string is not terminated. `pEscaped` is set to `YES` iff the string
+ *  contains escape sequences.
+ */
+OBJC_EXPORT NSUInteger SRGJSONScanString(const uint8_t *bytes, NSUInteger length, NSUInteger offset, BOOL *pEscaped);
+
+/**
+ *  Scan the number token starting at the specified offset, returning the offset of the first character following it.
+ *  The token is valid iff it is not empty and `SRGJSONIsValidNumber()` returns `YES` for it.
+ */
+OBJC_EXPORT NSUInteger SRGJSONScanNumber(const uint8_t *bytes, NSUInteger length, NSUInteger offset);
+
+/**
+ *  Scan the literal starting at the specified offset, returning its length (0 if no literal is found). The literal is
+ *  returned in `pLiteral`.
+ */
+OBJC_EXPORT NSUInteger SRGJSONScanLiteral(const uint8_t *bytes, NSUInteger length, NSUInteger offset, SRGJSONLiteral *pLiteral);
+
+/**
+ *  Return `YES` iff the token matches the number grammar, i.e. `-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?`.
+ */
+OBJC_EXPORT BOOL SRGJSONIsValidNumber(const uint8_t *bytes, NSUInteger length);
+
+/**
+ *  Return the number corresponding to the specified token, or `nil` if the token is not a valid number. Integers are
+ *  returned as `long long` values when they fit, other numbers as `double` values, as with `NSJSONSerialization`.
+ */
+OBJC_EXPORT NSNumber * _Nullable SRGJSONNumberFromBytes(const uint8_t *bytes, NSUInteger length);
+
+/**
+ *  Return the string corresponding to the specified string contents (without quotes), or `nil` if invalid.
+ */
+OBJC_EXPORT NSString * _Nullable SRGJSONStringFromBytes(const uint8_t *bytes, NSUInteger length, BOOL escaped);
+
+/**
+ *  Return the object corresponding to a literal (`NSNull` or a boolean `NSNumber`), `nil` for `SRGJSONLiteralNone`.
+ */
+OBJC_EXPORT id _Nullable SRGJSONLiteralObject(SRGJSONLiteral literal);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,191 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONScanner.h"
+
+BOOL SRGJSONIsNumberCharacter(uint8_t character)
+{
+    return (character >= '0' && character <= '9') || character == '-' || character == '+' || character == '.' || character == 'e' || character == 'E';
+}
+
+BOOL SRGJSONIsLiteralCharacter(uint8_t character)
+{
+    return character >= 'a' && character <= 'z';
+}
+
+BOOL SRGJSONIsUnescapedStringCharacter(uint8_t character)
+{
+    return character >= 0x20 && character != '"' && character != '\\';
+}
+
+NSUInteger SRGJSONScanString(const uint8_t *bytes, NSUInteger length, NSUInteger offset, BOOL *pEscaped)
+{
+    BOOL escaped = NO;
+    NSUInteger i = offset;
+    while (i < length) {
+        uint8_t character = bytes[i];
+        if (SRGJSONIsUnescapedStringCharacter(character)) {
+            i++;
+        }
+        else if (character == '\\') {
+            // Escape sequences are validated when the string is materialized (for `\u` sequences, the hexadecimal
+            // digits are scanned as usual string characters)
+            escaped = YES;
+            i += 2;
+        }
+        else {
+            break;
+        }
+    }
+    
+    *pEscaped = escaped;
+    return MIN(i, length);
+}
+
+NSUInteger SRGJSONScanNumber(const uint8_t *bytes, NSUInteger length, NSUInteger offset)
+{
+    NSUInteger i = offset;
+    while (i < length && SRGJSONIsNumberCharacter(bytes[i])) {
+        i++;
+    }
+    return i;
+}
+
+NSUInteger SRGJSONScanLiteral(const uint8_t *bytes, NSUInteger length, NSUInteger offset, SRGJSONLiteral *pLiteral)
+{
+    NSUInteger remainingLength = length - offset;
+    if (remainingLength >= 4 && memcmp(bytes + offset, "null", 4) == 0) {
+        *pLiteral = SRGJSONLiteralNull;
+        return 4;
+    }
+    else if (remainingLength >= 4 && memcmp(bytes + offset, "true", 4) == 0) {
+        *pLiteral = SRGJSONLiteralTrue;
+        return 4;
+    }
+    else if (remainingLength >= 5 && memcmp(bytes + offset, "false", 5) == 0) {
+        *pLiteral = SRGJSONLiteralFalse;
+        return 5;
+    }
+    else {
+        *pLiteral = SRGJSONLiteralNone;
+        return 0;
+    }
+}
+
+BOOL SRGJSONIsValidNumber(const uint8_t *bytes, NSUInteger length)
+{
+    NSUInteger i = 0;
+    if (i < length && bytes[i] == '-') {
+        i++;
+    }
+    
+    if (i < length && bytes[i] == '0') {
+        i++;
+    }
+    else if (i < length && bytes[i] >= '1' && bytes[i] <= '9') {
+        while (i < length && bytes[i] >= '0' && bytes[i] <= '9') {
+            i++;
+        }
+    }
+    else {
+        return NO;
+    }
+    
+    if (i < length && bytes[i] == '.') {
+        i++;
+        NSUInteger start = i;
+        while (i < length && bytes[i] >= '0' && bytes[i] <= '9') {
+            i++;
+        }
+        if (i == start) {
+            return NO;
+        }
+    }
+    
+    if (i < length && (bytes[i] == 'e' || bytes[i] == 'E')) {
+        i++;
+        if (i < length && (bytes[i] == '+' || bytes[i] == '-')) {
+            i++;
+        }
+        NSUInteger start = i;
+        while (i < length && bytes[i] >= '0' && bytes[i] <= '9') {
+            i++;
+        }
+        if (i == start) {
+            return NO;
+        }
+    }
+    
+    return i == length;
+}
+
+NSNumber *SRGJSONNumberFromBytes(const uint8_t *bytes, NSUInteger length)
+{
+    if (! SRGJSONIsValidNumber(bytes, length)) {
+        return nil;
+    }
+    
+    // Null-terminate the token so that C string functions can be used (long tokens are rare and use the heap)
+    char stackBuffer[64];
+    char *buffer = (length < sizeof(stackBuffer)) ? stackBuffer : malloc(length + 1);
+    memcpy(buffer, bytes, length);
+    buffer[length] = '\0';
+    
+    NSNumber *number = nil;
+    if (strpbrk(buffer, ".eE") == NULL) {
+        errno = 0;
+        long long integer = strtoll(buffer, NULL, 10);
+        if (errno != ERANGE) {
+            number = @(integer);
+        }
+    }
+    if (! number) {
+        number = @(strtod(buffer, NULL));
+    }
+    
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return number;
+}
+
+NSString *SRGJSONStringFromBytes(const uint8_t *bytes, NSUInteger length, BOOL escaped)
+{
+    id string = nil;
+    if (escaped) {
+        // Let Foundation deal with escape sequences (including surrogate pairs), which are rare in practice
+        NSMutableData *quotedData = [NSMutableData dataWithCapacity:length + 2];
+        [quotedData appendBytes:"\"" length:1];
+        [quotedData appendBytes:bytes length:length];
+        [quotedData appendBytes:"\"" length:1];
+        string = [NSJSONSerialization JSONObjectWithData:quotedData options:NSJSONReadingFragmentsAllowed error:NULL];
+    }
+    else {
+        string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    }
+    return [string isKindOfClass:NSString.class] ? string : nil;
+}
+
+id SRGJSONLiteralObject(SRGJSONLiteral literal)
+{
+    switch (literal) {
+        case SRGJSONLiteralNull: {
+            return NSNull.null;
+        }
+        
+        case SRGJSONLiteralTrue: {
+            return @YES;
+        }
+        
+        case SRGJSONLiteralFalse: {
+            return @NO;
+        }
+        
+        default: {
+            return nil;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONSchema.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SRGJSONSchemaNode;
+
+/**
+ *  A key found in a JSON object, with the fields decoded from its value and, for key paths traversing the value,
+ *  the node describing the nested object.
+ */
+@interface SRGJSONSchemaEntry : NSObject
+
+@property (nonatomic, readonly) NSData *keyData;                    // UTF-8 key
+@property (nonatomic, readonly) NSArray<SRGJSONField *> *fields;
+@property (nonatomic, readonly, nullable) SRGJSONSchemaNode *node;
+
+@end
+
+/**
+ *  The keys of interest in a JSON object, compiled from schema key paths.
+ */
+@interface SRGJSONSchemaNode : NSObject
+
+/**
+ *  Return the entry matching the specified UTF-8 key, if any.
+ */
+- (nullable SRGJSONSchemaEntry *)entryForKeyBytes:(const uint8_t *)bytes length:(NSUInteger)length;
+
+@end
+
+@interface SRGJSONSchema (Private)
+
+/**
+ *  The node for the JSON object from which models are decoded.
+ */
+@property (nonatomic, readonly) SRGJSONSchemaNode *node;
+
+@end
+
+NS_ASSUME_NONNULL_END
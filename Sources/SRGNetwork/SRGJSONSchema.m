@@ -0,0 +1,213 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONSchema+Private.h"
+
+static SEL SRGJSONSchemaSetterForProperty(NSString *property);
+
+@interface SRGJSONField ()
+
+@property (nonatomic, copy) NSString *keyPath;
+@property (nonatomic, copy) NSString *property;
+@property (nonatomic) SRGJSONFieldType type;
+@property (nonatomic) SRGJSONSchema *schema;
+
+@end
+
+@interface SRGJSONSchemaEntry ()
+
+@property (nonatomic) NSData *keyData;
+@property (nonatomic) NSArray<SRGJSONField *> *fields;
+@property (nonatomic) SRGJSONSchemaNode *node;
+
+@end
+
+@interface SRGJSONSchemaNode ()
+
+@property (nonatomic) NSArray<SRGJSONSchemaEntry *> *entries;
+
+@end
+
+@interface SRGJSONSchema ()
+
+@property (nonatomic) Class modelClass;
+@property (nonatomic) NSArray<SRGJSONField *> *fields;
+@property (nonatomic) SRGJSONSchemaNode *node;
+
+@end
+
+@implementation SRGJSONField
+
+#pragma mark Class methods
+
++ (SRGJSONField *)fieldWithKeyPath:(NSString *)keyPath property:(NSString *)property type:(SRGJSONFieldType)type
+{
+    return [[self alloc] initWithKeyPath:keyPath property:property type:type schema:nil];
+}
+
++ (SRGJSONField *)fieldWithKeyPath:(NSString *)keyPath property:(NSString *)property schema:(SRGJSONSchema *)schema
+{
+    return [[self alloc] initWithKeyPath:keyPath property:property type:SRGJSONFieldTypeJSON schema:schema];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithKeyPath:(NSString *)keyPath property:(NSString *)property type:(SRGJSONFieldType)type schema:(SRGJSONSchema *)schema
+{
+    NSParameterAssert(keyPath.length != 0);
+    NSParameterAssert(property.length != 0);
+    
+    if (self = [super init]) {
+        self.keyPath = keyPath;
+        self.property = property;
+        self.type = type;
+        self.schema = schema;
+    }
+    return self;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; keyPath = %@; property = %@; type = %@; schema = %@>",
+            self.class,
+            self,
+            self.keyPath,
+            self.property,
+            @(self.type),
+            self.schema];
+}
+
+@end
+
+@implementation SRGJSONSchemaEntry
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; key = %@; fields = %@; node = %@>",
+            self.class,
+            self,
+            [[NSString alloc] initWithData:self.keyData encoding:NSUTF8StringEncoding],
+            self.fields,
+            self.node];
+}
+
+@end
+
+@implementation SRGJSONSchemaNode
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.entries = @[];
+    }
+    return self;
+}
+
+#pragma mark Compilation
+
+- (void)addField:(SRGJSONField *)field withKeyPathComponents:(NSArray<NSString *> *)keyPathComponents
+{
+    NSData *keyData = [keyPathComponents.firstObject dataUsingEncoding:NSUTF8StringEncoding];
+    SRGJSONSchemaEntry *entry = [self entryForKeyBytes:keyData.bytes length:keyData.length];
+    if (! entry) {
+        entry = [[SRGJSONSchemaEntry alloc] init];
+        entry.keyData = keyData;
+        entry.fields = @[];
+        self.entries = [self.entries arrayByAddingObject:entry];
+    }
+    
+    if (keyPathComponents.count == 1) {
+        entry.fields = [entry.fields arrayByAddingObject:field];
+    }
+    else {
+        if (! entry.node) {
+            entry.node = [[SRGJSONSchemaNode alloc] init];
+        }
+        [entry.node addField:field withKeyPathComponents:[keyPathComponents subarrayWithRange:NSMakeRange(1, keyPathComponents.count - 1)]];
+    }
+}
+
+#pragma mark Lookup
+
+- (SRGJSONSchemaEntry *)entryForKeyBytes:(const uint8_t *)bytes length:(NSUInteger)length
+{
+    // Objects usually have a few keys of interest, a linear search without any allocation is the fastest option
+    for (SRGJSONSchemaEntry *entry in self.entries) {
+        NSData *keyData = entry.keyData;
+        if (keyData.length == length && memcmp(keyData.bytes, bytes, length) == 0) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; entries = %@>",
+            self.class,
+            self,
+            self.entries];
+}
+
+@end
+
+@implementation SRGJSONSchema
+
+#pragma mark Class methods
+
++ (SRGJSONSchema *)schemaWithModelClass:(Class)modelClass fields:(NSArray<SRGJSONField *> *)fields
+{
+    return [[self alloc] initWithModelClass:modelClass fields:fields];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithModelClass:(Class)modelClass fields:(NSArray<SRGJSONField *> *)fields
+{
+    NSParameterAssert(modelClass);
+    
+    if (self = [super init]) {
+        self.modelClass = modelClass;
+        self.fields = fields.copy;
+        
+        // Compile key paths once, so that decoding does not need to split them
+        self.node = [[SRGJSONSchemaNode alloc] init];
+        for (SRGJSONField *field in fields) {
+            NSAssert([modelClass instancesRespondToSelector:SRGJSONSchemaSetterForProperty(field.property)], @"%@ has no writable %@ property", modelClass, field.property);
+            [self.node addField:field withKeyPathComponents:[field.keyPath componentsSeparatedByString:@"."]];
+        }
+    }
+    return self;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; modelClass = %@; fields = %@>",
+            self.class,
+            self,
+            self.modelClass,
+            self.fields];
+}
+
+@end
+
+#pragma mark Static functions
+
+static SEL SRGJSONSchemaSetterForProperty(NSString *property)
+{
+    NSString *capitalizedProperty = [[property substringToIndex:1].uppercaseString stringByAppendingString:[property substringFromIndex:1]];
+    return NSSelectorFromString([NSString stringWithFormat:@"set%@:", capitalizedProperty]);
+}
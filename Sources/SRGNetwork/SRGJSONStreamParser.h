@@ -0,0 +1,49 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGNetworkTypes.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Incremental JSON parser, building Foundation objects (with the same types as `NSJSONSerialization`) from data
+ *  received in arbitrary chunks.
+ *
+ *  Parsers are not thread-safe and must be fed from a single thread at a time.
+ */
+@interface SRGJSONStreamParser : NSObject
+
+/**
+ *  Create a parser. If an element block is provided and the top-level value is an array, its elements are provided
+ *  to the block as soon as they have been parsed, and are not accumulated in the array eventually returned by
+ *  `-finishWithError:` (which is therefore empty).
+ */
+- (instancetype)initWithElementBlock:(nullable SRGJSONElementBlock)elementBlock NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Feed the parser with the next available data chunk. Returns `NO` and an error if the data is invalid. Once an
+ *  error has been returned, the parser ignores any further data.
+ */
+- (BOOL)parseData:(NSData *)data error:(NSError * __autoreleasing *)pError;
+
+/**
+ *  Same as `-parseData:error:`, for raw bytes.
+ */
+- (BOOL)parseBytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError * __autoreleasing *)pError;
+
+/**
+ *  Signal that no more data is available, returning the parsed top-level value, or `nil` and an error if the data
+ *  received so far does not form a complete JSON document.
+ */
+- (nullable id)finishWithError:(NSError * __autoreleasing *)pError;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,428 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONStreamParser.h"
+
+#import "NSBundle+SRGNetwork.h"
+#import "SRGJSONScanner.h"
+#import "SRGNetworkError.h"
+
+typedef NS_ENUM(NSInteger, SRGJSONStreamFrameState) {
+    SRGJSONStreamFrameStateArrayStart,              // After '['
+    SRGJSONStreamFrameStateArrayValue,              // After ','
+    SRGJSONStreamFrameStateArrayNext,               // After a value
+    SRGJSONStreamFrameStateObjectStart,             // After '{'
+    SRGJSONStreamFrameStateObjectKey,               // After ','
+    SRGJSONStreamFrameStateObjectColon,             // After a key
+    SRGJSONStreamFrameStateObjectValue,             // After ':'
+    SRGJSONStreamFrameStateObjectNext               // After a value
+};
+
+typedef NS_ENUM(NSInteger, SRGJSONStreamLexerState) {
+    SRGJSONStreamLexerStateNone,
+    SRGJSONStreamLexerStateString,
+    SRGJSONStreamLexerStateStringEscape,
+    SRGJSONStreamLexerStateNumber,
+    SRGJSONStreamLexerStateLiteral
+};
+
+// A container being parsed.
+@interface SRGJSONStreamFrame : NSObject
+
+@property (nonatomic) id container;                 // NSMutableArray or NSMutableDictionary
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic) SRGJSONStreamFrameState state;
+
+@end
+
+@interface SRGJSONStreamParser ()
+
+@property (nonatomic, copy) SRGJSONElementBlock elementBlock;
+
+@property (nonatomic) NSMutableArray<SRGJSONStreamFrame *> *frames;
+@property (nonatomic) id rootObject;
+
+@property (nonatomic) SRGJSONStreamLexerState lexerState;
+@property (nonatomic) NSMutableData *token;
+@property (nonatomic) BOOL tokenContainsEscapes;
+
+@property (nonatomic) NSUInteger offset;
+@property (nonatomic) NSError *error;
+
+@end
+
+@implementation SRGJSONStreamParser
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithElementBlock:(SRGJSONElementBlock)elementBlock
+{
+    if (self = [super init]) {
+        self.elementBlock = elementBlock;
+        self.frames = [NSMutableArray array];
+        self.token = [NSMutableData data];
+    }
+    return self;
+}
+
+#pragma mark Parsing
+
+- (BOOL)parseData:(NSData *)data error:(NSError * __autoreleasing *)pError
+{
+    // Data received from `NSURLSession` might be discontiguous. Enumerate its regions to avoid flattening it.
+    __block BOOL success = YES;
+    [data enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
+        if (! [self parseBytes:bytes length:byteRange.length error:pError]) {
+            success = NO;
+            *stop = YES;
+        }
+    }];
+    return success;
+}
+
+- (BOOL)parseBytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError * __autoreleasing *)pError
+{
+    if (self.error) {
+        if (pError) {
+            *pError = self.error;
+        }
+        return NO;
+    }
+    
+    NSUInteger i = 0;
+    while (i < length && ! self.error) {
+        switch (self.lexerState) {
+            case SRGJSONStreamLexerStateString: {
+                NSUInteger start = i;
+                while (i < length && SRGJSONIsUnescapedStringCharacter(bytes[i])) {
+                    i++;
+                }
+                [self.token appendBytes:bytes + start length:i - start];
+                if (i == length) {
+                    break;
+                }
+                
+                if (bytes[i] == '\\') {
+                    [self.token appendBytes:bytes + i length:1];
+                    self.tokenContainsEscapes = YES;
+                    self.lexerState = SRGJSONStreamLexerStateStringEscape;
+                }
+                else if (bytes[i] == '"') {
+                    self.lexerState = SRGJSONStreamLexerStateNone;
+                    [self finishStringAtOffset:self.offset + i];
+                }
+                else {
+                    [self failWithDescription:SRGNetworkNonLocalizedString(@"Invalid string") atOffset:self.offset + i];
+                }
+                i++;
+                break;
+            }
+            
+            case SRGJSONStreamLexerStateStringEscape: {
+                // Escaped character (for `\u` sequences, the hexadecimal digits are read as usual string characters)
+                [self.token appendBytes:bytes + i length:1];
+                self.lexerState = SRGJSONStreamLexerStateString;
+                i++;
+                break;
+            }
+            
+            case SRGJSONStreamLexerStateNumber:
+            case SRGJSONStreamLexerStateLiteral: {
+                BOOL (*isTokenCharacter)(uint8_t) = (self.lexerState == SRGJSONStreamLexerStateNumber) ? SRGJSONIsNumberCharacter : SRGJSONIsLiteralCharacter;
+                
+                NSUInteger start = i;
+                while (i < length && isTokenCharacter(bytes[i])) {
+                    i++;
+                }
+                [self.token appendBytes:bytes + start length:i - start];
+                if (i == length) {
+                    break;
+                }
+                
+                // The terminating character is processed on the next iteration
+                [self finishTokenAtOffset:self.offset + i];
+                break;
+            }
+            
+            case SRGJSONStreamLexerStateNone: {
+                [self processCharacter:bytes[i] atOffset:self.offset + i];
+                i++;
+                break;
+            }
+        }
+    }
+    
+    self.offset += i;
+    
+    if (self.error) {
+        if (pError) {
+            *pError = self.error;
+        }
+        return NO;
+    }
+    else {
+        return YES;
+    }
+}
+
+- (id)finishWithError:(NSError * __autoreleasing *)pError
+{
+    if (! self.error) {
+        if (self.lexerState == SRGJSONStreamLexerStateNumber || self.lexerState == SRGJSONStreamLexerStateLiteral) {
+            [self finishTokenAtOffset:self.offset];
+        }
+        
+        if (! self.error && (self.lexerState != SRGJSONStreamLexerStateNone || self.frames.count != 0 || ! self.rootObject)) {
+            [self failWithDescription:SRGNetworkNonLocalizedString(@"Unexpected end of data") atOffset:self.offset];
+        }
+    }
+    
+    if (self.error) {
+        if (pError) {
+            *pError = self.error;
+        }
+        return nil;
+    }
+    
+    return self.rootObject;
+}
+
+#pragma mark Lexer
+
+- (void)processCharacter:(uint8_t)character atOffset:(NSUInteger)offset
+{
+    switch (character) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r': {
+            break;
+        }
+        
+        case '"': {
+            self.token.length = 0;
+            self.tokenContainsEscapes = NO;
+            self.lexerState = SRGJSONStreamLexerStateString;
+            break;
+        }
+        
+        case '[': {
+            [self openContainer:[NSMutableArray array] state:SRGJSONStreamFrameStateArrayStart atOffset:offset];
+            break;
+        }
+        
+        case '{': {
+            [self openContainer:[NSMutableDictionary dictionary] state:SRGJSONStreamFrameStateObjectStart atOffset:offset];
+            break;
+        }
+        
+        case ']': {
+            SRGJSONStreamFrameState state = self.frames.lastObject.state;
+            if (self.frames.count != 0 && (state == SRGJSONStreamFrameStateArrayStart || state == SRGJSONStreamFrameStateArrayNext)) {
+                [self closeContainerAtOffset:offset];
+            }
+            else {
+                [self failWithUnexpectedCharacter:character atOffset:offset];
+            }
+            break;
+        }
+        
+        case '}': {
+            SRGJSONStreamFrameState state = self.frames.lastObject.state;
+            if (self.frames.count != 0 && (state == SRGJSONStreamFrameStateObjectStart || state == SRGJSONStreamFrameStateObjectNext)) {
+                [self closeContainerAtOffset:offset];
+            }
+            else {
+                [self failWithUnexpectedCharacter:character atOffset:offset];
+            }
+            break;
+        }
+        
+        case ':': {
+            SRGJSONStreamFrame *frame = self.frames.lastObject;
+            if (frame && frame.state == SRGJSONStreamFrameStateObjectColon) {
+                frame.state = SRGJSONStreamFrameStateObjectValue;
+            }
+            else {
+                [self failWithUnexpectedCharacter:character atOffset:offset];
+            }
+            break;
+        }
+        
+        case ',': {
+            SRGJSONStreamFrame *frame = self.frames.lastObject;
+            if (frame && frame.state == SRGJSONStreamFrameStateArrayNext) {
+                frame.state = SRGJSONStreamFrameStateArrayValue;
+            }
+            else if (frame && frame.state == SRGJSONStreamFrameStateObjectNext) {
+                frame.state = SRGJSONStreamFrameStateObjectKey;
+            }
+            else {
+                [self failWithUnexpectedCharacter:character atOffset:offset];
+            }
+            break;
+        }
+        
+        default: {
+            if (character == '-' || (character >= '0' && character <= '9')) {
+                self.token.length = 0;
+                [self.token appendBytes:&character length:1];
+                self.lexerState = SRGJSONStreamLexerStateNumber;
+            }
+            else if (SRGJSONIsLiteralCharacter(character)) {
+                self.token.length = 0;
+                [self.token appendBytes:&character length:1];
+                self.lexerState = SRGJSONStreamLexerStateLiteral;
+            }
+            else {
+                [self failWithUnexpectedCharacter:character atOffset:offset];
+            }
+            break;
+        }
+    }
+}
+
+- (void)finishStringAtOffset:(NSUInteger)offset
+{
+    NSString *string = SRGJSONStringFromBytes(self.token.bytes, self.token.length, self.tokenContainsEscapes);
+    if (! string) {
+        [self failWithDescription:SRGNetworkNonLocalizedString(@"Invalid string") atOffset:offset];
+        return;
+    }
+    
+    SRGJSONStreamFrame *frame = self.frames.lastObject;
+    if (frame && (frame.state == SRGJSONStreamFrameStateObjectStart || frame.state == SRGJSONStreamFrameStateObjectKey)) {
+        frame.key = string;
+        frame.state = SRGJSONStreamFrameStateObjectColon;
+    }
+    else {
+        [self addValue:string atOffset:offset];
+    }
+}
+
+- (void)finishTokenAtOffset:(NSUInteger)offset
+{
+    SRGJSONStreamLexerState lexerState = self.lexerState;
+    self.lexerState = SRGJSONStreamLexerStateNone;
+    
+    const uint8_t *bytes = self.token.bytes;
+    NSUInteger length = self.token.length;
+    
+    id value = nil;
+    if (lexerState == SRGJSONStreamLexerStateNumber) {
+        value = SRGJSONNumberFromBytes(bytes, length);
+    }
+    else {
+        // The whole token must be a literal
+        SRGJSONLiteral literal = SRGJSONLiteralNone;
+        if (SRGJSONScanLiteral(bytes, length, 0, &literal) == length) {
+            value = SRGJSONLiteralObject(literal);
+        }
+    }
+    
+    if (! value) {
+        NSString *token = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        [self failWithDescription:[NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Invalid value '%@'"), token] atOffset:offset];
+        return;
+    }
+    
+    [self addValue:value atOffset:offset];
+}
+
+#pragma mark Structure
+
+- (BOOL)isExpectingValue
+{
+    SRGJSONStreamFrame *frame = self.frames.lastObject;
+    if (! frame) {
+        return self.rootObject == nil;
+    }
+    else {
+        SRGJSONStreamFrameState state = frame.state;
+        return state == SRGJSONStreamFrameStateArrayStart || state == SRGJSONStreamFrameStateArrayValue || state == SRGJSONStreamFrameStateObjectValue;
+    }
+}
+
+- (void)openContainer:(id)container state:(SRGJSONStreamFrameState)state atOffset:(NSUInteger)offset
+{
+    if (! [self isExpectingValue]) {
+        [self failWithDescription:SRGNetworkNonLocalizedString(@"Unexpected container") atOffset:offset];
+        return;
+    }
+    
+    SRGJSONStreamFrame *frame = [[SRGJSONStreamFrame alloc] init];
+    frame.container = container;
+    frame.state = state;
+    [self.frames addObject:frame];
+}
+
+- (void)closeContainerAtOffset:(NSUInteger)offset
+{
+    SRGJSONStreamFrame *frame = self.frames.lastObject;
+    [self.frames removeLastObject];
+    [self addValue:frame.container atOffset:offset];
+}
+
+- (void)addValue:(id)value atOffset:(NSUInteger)offset
+{
+    if (! [self isExpectingValue]) {
+        [self failWithDescription:SRGNetworkNonLocalizedString(@"Unexpected value") atOffset:offset];
+        return;
+    }
+    
+    SRGJSONStreamFrame *frame = self.frames.lastObject;
+    if (! frame) {
+        self.rootObject = value;
+    }
+    else if (frame.state == SRGJSONStreamFrameStateObjectValue) {
+        [frame.container setObject:value forKey:frame.key];
+        frame.key = nil;
+        frame.state = SRGJSONStreamFrameStateObjectNext;
+    }
+    else {
+        // Elements of a top-level array are delivered as they arrive, without being accumulated
+        if (self.frames.count == 1 && self.elementBlock) {
+            self.elementBlock(value);
+        }
+        else {
+            [frame.container addObject:value];
+        }
+        frame.state = SRGJSONStreamFrameStateArrayNext;
+    }
+}
+
+#pragma mark Errors
+
+- (void)failWithUnexpectedCharacter:(uint8_t)character atOffset:(NSUInteger)offset
+{
+    [self failWithDescription:[NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected character '%c'"), character] atOffset:offset];
+}
+
+- (void)failWithDescription:(NSString *)description atOffset:(NSUInteger)offset
+{
+    NSString *fullDescription = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Invalid JSON data at offset %@. %@"), @(offset), description];
+    self.error = [NSError errorWithDomain:SRGNetworkErrorDomain
+                                     code:SRGNetworkErrorInvalidData
+                                 userInfo:@{ NSLocalizedDescriptionKey : fullDescription }];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; offset = %@; depth = %@; error = %@>",
+            self.class,
+            self,
+            @(self.offset),
+            @(self.frames.count),
+            self.error];
+}
+
+@end
+
+@implementation SRGJSONStreamFrame
+
+@end
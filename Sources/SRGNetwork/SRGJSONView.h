@@ -0,0 +1,29 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Read-only JSON document over UTF-8 data. A compact structural index is built once, and values are only
+ *  materialized when accessed. Containers are returned as `NSDictionary` and `NSArray` views sharing the same
+ *  document, scalars as Foundation objects (with the same types as `NSJSONSerialization`).
+ *
+ *  Documents and views are immutable and can be shared between threads.
+ */
+@interface SRGJSONViewDocument : NSObject
+
+/**
+ *  Index the specified data, returning its top-level value, or `nil` and an error if the data is not valid JSON.
+ */
++ (nullable id)rootObjectWithData:(NSData *)data error:(NSError * __autoreleasing *)pError;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
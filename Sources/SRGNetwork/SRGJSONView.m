@@ -0,0 +1,549 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGJSONView.h"
+
+#import "NSBundle+SRGNetwork.h"
+#import "SRGJSONScanner.h"
+#import "SRGNetworkError.h"
+
+#import <os/lock.h>
+
+// Maximum nesting depth, so that indexing memory remains bounded for malicious data.
+static const NSUInteger SRGJSONViewMaximumDepth = 512;
+
+typedef NS_ENUM(uint8_t, SRGJSONViewType) {
+    SRGJSONViewTypeNull,
+    SRGJSONViewTypeFalse,
+    SRGJSONViewTypeTrue,
+    SRGJSONViewTypeNumber,
+    SRGJSONViewTypeString,
+    SRGJSONViewTypeArray,
+    SRGJSONViewTypeObject
+};
+
+typedef NS_ENUM(uint8_t, SRGJSONViewFrameState) {
+    SRGJSONViewFrameStateArrayStart,                // After '['
+    SRGJSONViewFrameStateArrayValue,                // After ','
+    SRGJSONViewFrameStateArrayNext,                 // After a value
+    SRGJSONViewFrameStateObjectStart,               // After '{'
+    SRGJSONViewFrameStateObjectKey,                 // After ','
+    SRGJSONViewFrameStateObjectColon,               // After a key
+    SRGJSONViewFrameStateObjectValue,               // After ':'
+    SRGJSONViewFrameStateObjectNext                 // After a value
+};
+
+// Structural index entry, one per value (and per object key). Object entries are followed by their key and value
+// entries, alternating, and array entries by their element entries.
+typedef struct {
+    uint32_t offset;                                // Value start (for strings, the first byte after the opening quote)
+    uint32_t length;                                // Byte length for scalars, number of elements (or pairs) for containers
+    uint32_t next;                                  // Index of the entry following the value and its descendants
+    SRGJSONViewType type;
+    BOOL escaped;                                   // Strings containing escape sequences
+} SRGJSONViewEntry;
+
+typedef struct {
+    uint32_t index;
+    SRGJSONViewFrameState state;
+} SRGJSONViewFrame;
+
+
+@interface SRGJSONViewDocument () {
+@private
+    const uint8_t *_bytes;
+    SRGJSONViewEntry *_entries;
+    NSUInteger _numberOfEntries;
+}
+
+@property (nonatomic) NSData *data;
+
+- (NSUInteger)countAtIndex:(NSUInteger)index;
+- (id)objectAtEntryIndex:(NSUInteger)index;
+- (nullable id)objectForKey:(NSString *)key inObjectAtIndex:(NSUInteger)index;
+- (NSArray<NSString *> *)keysInObjectAtIndex:(NSUInteger)index;
+- (NSUInteger)nextIndexForIndex:(NSUInteger)index;
+
+@end
+
+// View of a JSON object.
+@interface SRGJSONViewDictionary : NSDictionary
+
+- (instancetype)initWithDocument:(SRGJSONViewDocument *)document index:(NSUInteger)index;
+
+@property (nonatomic) SRGJSONViewDocument *document;
+@property (nonatomic) NSUInteger index;
+
+@end
+
+// View of a JSON array. Element entry indices are computed on first indexed access.
+@interface SRGJSONViewArray : NSArray {
+@private
+    os_unfair_lock _lock;
+    NSUInteger *_elementIndices;
+}
+
+- (instancetype)initWithDocument:(SRGJSONViewDocument *)document index:(NSUInteger)index;
+
+@property (nonatomic) SRGJSONViewDocument *document;
+@property (nonatomic) NSUInteger index;
+
+@end
+
+@implementation SRGJSONViewDocument
+
+#pragma mark Class methods
+
++ (id)rootObjectWithData:(NSData *)data error:(NSError * __autoreleasing *)pError
+{
+    SRGJSONViewDocument *document = [[self alloc] initWithData:data error:pError];
+    return [document objectAtEntryIndex:0];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithData:(NSData *)data error:(NSError * __autoreleasing *)pError
+{
+    if (self = [super init]) {
+        // Views reference the bytes, which must not change
+        self.data = data.copy;
+        _bytes = self.data.bytes;
+        
+        NSError *error = [self buildIndex];
+        if (error) {
+            if (pError) {
+                *pError = error;
+            }
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_entries);
+}
+
+#pragma mark Indexing
+
+- (NSError *)buildIndex
+{
+    NSUInteger length = self.data.length;
+    if (length > UINT32_MAX) {
+        return [self errorWithDescription:SRGNetworkNonLocalizedString(@"Data too large") atOffset:0];
+    }
+    
+    const uint8_t *bytes = _bytes;
+    
+    // Roughly one value every few dozen bytes for usual responses
+    NSUInteger capacity = MAX(length / 32, 16);
+    SRGJSONViewEntry *entries = malloc(capacity * sizeof(SRGJSONViewEntry));
+    NSUInteger numberOfEntries = 0;
+    
+    SRGJSONViewFrame frames[SRGJSONViewMaximumDepth];
+    NSUInteger depth = 0;
+    BOOL rootParsed = NO;
+    
+    NSUInteger i = 0;
+    
+    // Skip the UTF-8 byte order mark, if any
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        i = 3;
+    }
+
+#define SRGJSONViewFail(description) do { free(entries); return [self errorWithDescription:(description) atOffset:i]; } while (0)
+
+    while (i < length) {
+        uint8_t character = bytes[i];
+        if (character == ' ' || character == '\t' || character == '\n' || character == '\r') {
+            i++;
+            continue;
+        }
+        
+        SRGJSONViewFrame *frame = (depth != 0) ? &frames[depth - 1] : NULL;
+        BOOL expectingValue = frame ? (frame->state == SRGJSONViewFrameStateArrayStart || frame->state == SRGJSONViewFrameStateArrayValue || frame->state == SRGJSONViewFrameStateObjectValue) : ! rootParsed;
+        BOOL expectingKey = frame && (frame->state == SRGJSONViewFrameStateObjectStart || frame->state == SRGJSONViewFrameStateObjectKey);
+        
+        // Structural characters not introducing a value
+        if (character == ':') {
+            if (! frame || frame->state != SRGJSONViewFrameStateObjectColon) {
+                SRGJSONViewFail([NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected character '%c'"), character]);
+            }
+            frame->state = SRGJSONViewFrameStateObjectValue;
+            i++;
+            continue;
+        }
+        else if (character == ',') {
+            if (frame && frame->state == SRGJSONViewFrameStateArrayNext) {
+                frame->state = SRGJSONViewFrameStateArrayValue;
+            }
+            else if (frame && frame->state == SRGJSONViewFrameStateObjectNext) {
+                frame->state = SRGJSONViewFrameStateObjectKey;
+            }
+            else {
+                SRGJSONViewFail([NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected character '%c'"), character]);
+            }
+            i++;
+            continue;
+        }
+        else if (character == ']' || character == '}') {
+            BOOL closesArray = (character == ']') && frame && (frame->state == SRGJSONViewFrameStateArrayStart || frame->state == SRGJSONViewFrameStateArrayNext);
+            BOOL closesObject = (character == '}') && frame && (frame->state == SRGJSONViewFrameStateObjectStart || frame->state == SRGJSONViewFrameStateObjectNext);
+            if (! closesArray && ! closesObject) {
+                SRGJSONViewFail([NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected character '%c'"), character]);
+            }
+            entries[frame->index].next = (uint32_t)numberOfEntries;
+            depth--;
+            i++;
+        }
+        else {
+            if (! expectingValue && ! (expectingKey && character == '"')) {
+                SRGJSONViewFail(expectingKey ? SRGNetworkNonLocalizedString(@"Expected a key") : SRGNetworkNonLocalizedString(@"Unexpected value"));
+            }
+            
+            if (numberOfEntries == capacity) {
+                capacity *= 2;
+                entries = reallocf(entries, capacity * sizeof(SRGJSONViewEntry));
+            }
+            
+            SRGJSONViewEntry *entry = &entries[numberOfEntries];
+            NSUInteger entryIndex = numberOfEntries;
+            numberOfEntries++;
+            
+            entry->offset = (uint32_t)i;
+            entry->length = 0;
+            entry->next = (uint32_t)numberOfEntries;
+            entry->escaped = NO;
+            
+            if (character == '"') {
+                NSUInteger start = ++i;
+                BOOL escaped = NO;
+                i = SRGJSONScanString(bytes, length, start, &escaped);
+                if (i == length) {
+                    SRGJSONViewFail(SRGNetworkNonLocalizedString(@"Unexpected end of data"));
+                }
+                else if (bytes[i] != '"') {
+                    SRGJSONViewFail(SRGNetworkNonLocalizedString(@"Invalid string"));
+                }
+                
+                entry->type = SRGJSONViewTypeString;
+                entry->offset = (uint32_t)start;
+                entry->length = (uint32_t)(i - start);
+                entry->escaped = escaped;
+                i++;
+                
+                if (expectingKey) {
+                    frame->state = SRGJSONViewFrameStateObjectColon;
+                    continue;
+                }
+            }
+            else if (character == '[' || character == '{') {
+                if (depth == SRGJSONViewMaximumDepth) {
+                    SRGJSONViewFail(SRGNetworkNonLocalizedString(@"Maximum nesting depth exceeded"));
+                }
+                
+                entry->type = (character == '[') ? SRGJSONViewTypeArray : SRGJSONViewTypeObject;
+                frames[depth].index = (uint32_t)entryIndex;
+                frames[depth].state = (character == '[') ? SRGJSONViewFrameStateArrayStart : SRGJSONViewFrameStateObjectStart;
+                depth++;
+                i++;
+                
+                // The value is complete only once the container is closed
+                continue;
+            }
+            else if (character == '-' || (character >= '0' && character <= '9')) {
+                NSUInteger start = i;
+                i = SRGJSONScanNumber(bytes, length, start);
+                if (! SRGJSONIsValidNumber(bytes + start, i - start)) {
+                    i = start;
+                    SRGJSONViewFail(SRGNetworkNonLocalizedString(@"Invalid number"));
+                }
+                entry->type = SRGJSONViewTypeNumber;
+                entry->length = (uint32_t)(i - start);
+            }
+            else {
+                SRGJSONLiteral literal = SRGJSONLiteralNone;
+                NSUInteger literalLength = SRGJSONScanLiteral(bytes, length, i, &literal);
+                if (literal == SRGJSONLiteralNull) {
+                    entry->type = SRGJSONViewTypeNull;
+                }
+                else if (literal == SRGJSONLiteralTrue) {
+                    entry->type = SRGJSONViewTypeTrue;
+                }
+                else if (literal == SRGJSONLiteralFalse) {
+                    entry->type = SRGJSONViewTypeFalse;
+                }
+                else {
+                    SRGJSONViewFail([NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Unexpected character '%c'"), character]);
+                }
+                i += literalLength;
+            }
+        }
+        
+        // A value has been completed
+        if (depth == 0) {
+            rootParsed = YES;
+        }
+        else {
+            SRGJSONViewFrame *parentFrame = &frames[depth - 1];
+            entries[parentFrame->index].length++;
+            parentFrame->state = (parentFrame->state == SRGJSONViewFrameStateObjectValue) ? SRGJSONViewFrameStateObjectNext : SRGJSONViewFrameStateArrayNext;
+        }
+    }
+    
+    if (depth != 0 || ! rootParsed) {
+        SRGJSONViewFail(SRGNetworkNonLocalizedString(@"Unexpected end of data"));
+    }
+
+#undef SRGJSONViewFail
+
+    _entries = entries;
+    _numberOfEntries = numberOfEntries;
+    return nil;
+}
+
+- (NSError *)errorWithDescription:(NSString *)description atOffset:(NSUInteger)offset
+{
+    NSString *fullDescription = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Invalid JSON data at offset %@. %@"), @(offset), description];
+    return [NSError errorWithDomain:SRGNetworkErrorDomain
+                               code:SRGNetworkErrorInvalidData
+                           userInfo:@{ NSLocalizedDescriptionKey : fullDescription }];
+}
+
+#pragma mark Access
+
+- (NSUInteger)countAtIndex:(NSUInteger)index
+{
+    return _entries[index].length;
+}
+
+- (NSUInteger)nextIndexForIndex:(NSUInteger)index
+{
+    return _entries[index].next;
+}
+
+- (id)objectAtEntryIndex:(NSUInteger)index
+{
+    SRGJSONViewEntry *entry = &_entries[index];
+    switch (entry->type) {
+        case SRGJSONViewTypeNull: {
+            return NSNull.null;
+        }
+        
+        case SRGJSONViewTypeFalse: {
+            return @NO;
+        }
+        
+        case SRGJSONViewTypeTrue: {
+            return @YES;
+        }
+        
+        case SRGJSONViewTypeNumber: {
+            return [self numberAtIndex:index];
+        }
+        
+        case SRGJSONViewTypeString: {
+            return [self stringAtIndex:index] ?: NSNull.null;
+        }
+        
+        case SRGJSONViewTypeArray: {
+            return [[SRGJSONViewArray alloc] initWithDocument:self index:index];
+        }
+        
+        case SRGJSONViewTypeObject: {
+            return [[SRGJSONViewDictionary alloc] initWithDocument:self index:index];
+        }
+    }
+}
+
+- (NSString *)stringAtIndex:(NSUInteger)index
+{
+    SRGJSONViewEntry *entry = &_entries[index];
+    return SRGJSONStringFromBytes(_bytes + entry->offset, entry->length, entry->escaped);
+}
+
+- (NSNumber *)numberAtIndex:(NSUInteger)index
+{
+    // Numbers have been validated when indexing
+    SRGJSONViewEntry *entry = &_entries[index];
+    return SRGJSONNumberFromBytes(_bytes + entry->offset, entry->length);
+}
+
+- (id)objectForKey:(NSString *)key inObjectAtIndex:(NSUInteger)index
+{
+    const char *keyBytes = key.UTF8String;
+    if (! keyBytes) {
+        return nil;
+    }
+    size_t keyLength = strlen(keyBytes);
+    
+    NSUInteger keyIndex = index + 1;
+    NSUInteger end = _entries[index].next;
+    while (keyIndex < end) {
+        SRGJSONViewEntry *keyEntry = &_entries[keyIndex];
+        NSUInteger valueIndex = keyIndex + 1;
+        
+        // Keys are compared as raw bytes. Keys with escape sequences (very rare) are decoded first.
+        BOOL matches = NO;
+        if (! keyEntry->escaped) {
+            matches = (keyEntry->length == keyLength && memcmp(_bytes + keyEntry->offset, keyBytes, keyLength) == 0);
+        }
+        else {
+            matches = [[self stringAtIndex:keyIndex] isEqualToString:key];
+        }
+        
+        if (matches) {
+            return [self objectAtEntryIndex:valueIndex];
+        }
+        keyIndex = _entries[valueIndex].next;
+    }
+    return nil;
+}
+
+- (NSArray<NSString *> *)keysInObjectAtIndex:(NSUInteger)index
+{
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:_entries[index].length];
+    
+    NSUInteger keyIndex = index + 1;
+    NSUInteger end = _entries[index].next;
+    while (keyIndex < end) {
+        NSString *key = [self stringAtIndex:keyIndex];
+        if (key) {
+            [keys addObject:key];
+        }
+        keyIndex = _entries[keyIndex + 1].next;
+    }
+    return keys.copy;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; length = %@; numberOfEntries = %@>",
+            self.class,
+            self,
+            @(self.data.length),
+            @(_numberOfEntries)];
+}
+
+@end
+
+@implementation SRGJSONViewDictionary
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithDocument:(SRGJSONViewDocument *)document index:(NSUInteger)index
+{
+    if (self = [super init]) {
+        self.document = document;
+        self.index = index;
+    }
+    return self;
+}
+
+#pragma mark NSDictionary primitives
+
+- (NSUInteger)count
+{
+    return [self.document countAtIndex:self.index];
+}
+
+- (id)objectForKey:(id)key
+{
+    if (! [key isKindOfClass:NSString.class]) {
+        return nil;
+    }
+    return [self.document objectForKey:key inObjectAtIndex:self.index];
+}
+
+- (NSEnumerator *)keyEnumerator
+{
+    return [self.document keysInObjectAtIndex:self.index].objectEnumerator;
+}
+
+#pragma mark NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+#pragma mark NSCoding protocol
+
+- (Class)classForCoder
+{
+    return NSDictionary.class;
+}
+
+@end
+
+@implementation SRGJSONViewArray
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithDocument:(SRGJSONViewDocument *)document index:(NSUInteger)index
+{
+    if (self = [super init]) {
+        self.document = document;
+        self.index = index;
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_elementIndices);
+}
+
+#pragma mark NSArray primitives
+
+- (NSUInteger)count
+{
+    return [self.document countAtIndex:self.index];
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+    NSUInteger count = self.count;
+    if (index >= count) {
+        [NSException raise:NSRangeException format:@"Index %@ beyond bounds [0 .. %@]", @(index), @((NSInteger)count - 1)];
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    if (! _elementIndices) {
+        _elementIndices = malloc(count * sizeof(NSUInteger));
+        NSUInteger elementIndex = self.index + 1;
+        for (NSUInteger i = 0; i < count; i++) {
+            _elementIndices[i] = elementIndex;
+            elementIndex = [self.document nextIndexForIndex:elementIndex];
+        }
+    }
+    NSUInteger elementIndex = _elementIndices[index];
+    os_unfair_lock_unlock(&_lock);
+    
+    return [self.document objectAtEntryIndex:elementIndex];
+}
+
+#pragma mark NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+#pragma mark NSCoding protocol
+
+- (Class)classForCoder
+{
+    return NSArray.class;
+}
+
+@end
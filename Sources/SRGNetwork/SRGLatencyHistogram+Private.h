@@ -0,0 +1,34 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGLatencyHistogram.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  The number of histogram buckets. Bucket 0 contains durations below 1 microsecond, the following ones split each
+ *  power of two (in microseconds) into 4 buckets, up to about 6 days.
+ */
+static const NSUInteger SRGLatencyHistogramBucketCount = 1 + 39 * 4;
+
+/**
+ *  Return the index of the bucket containing the specified duration (in microseconds).
+ */
+OBJC_EXPORT NSUInteger SRGLatencyHistogramBucketIndex(uint64_t microseconds);
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGLatencyHistogram (Private)
+
+/**
+ *  Create a histogram from bucket counts (`SRGLatencyHistogramBucketCount` values) and statistics (in microseconds).
+ */
+- (instancetype)initWithBucketCounts:(const uint64_t *)bucketCounts sum:(uint64_t)sum minimum:(uint64_t)minimum maximum:(uint64_t)maximum;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,109 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGLatencyHistogram+Private.h"
+
+static NSTimeInterval SRGLatencyHistogramBucketMidpoint(NSUInteger index);
+
+@interface SRGLatencyHistogram ()
+
+@property (nonatomic) NSData *bucketCounts;
+@property (nonatomic) NSUInteger count;
+@property (nonatomic) NSTimeInterval mean;
+@property (nonatomic) NSTimeInterval minimum;
+@property (nonatomic) NSTimeInterval maximum;
+
+@end
+
+@implementation SRGLatencyHistogram
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithBucketCounts:(const uint64_t *)bucketCounts sum:(uint64_t)sum minimum:(uint64_t)minimum maximum:(uint64_t)maximum
+{
+    if (self = [super init]) {
+        self.bucketCounts = [NSData dataWithBytes:bucketCounts length:SRGLatencyHistogramBucketCount * sizeof(uint64_t)];
+        
+        uint64_t count = 0;
+        for (NSUInteger i = 0; i < SRGLatencyHistogramBucketCount; i++) {
+            count += bucketCounts[i];
+        }
+        self.count = (NSUInteger)count;
+        
+        if (count != 0) {
+            self.mean = (NSTimeInterval)sum / count / USEC_PER_SEC;
+            self.minimum = (NSTimeInterval)minimum / USEC_PER_SEC;
+            self.maximum = (NSTimeInterval)maximum / USEC_PER_SEC;
+        }
+    }
+    return self;
+}
+
+#pragma mark Percentiles
+
+- (NSTimeInterval)durationAtPercentile:(double)percentile
+{
+    if (self.count == 0) {
+        return 0.;
+    }
+    
+    uint64_t rank = MAX((uint64_t)ceil(fmin(fmax(percentile, 0.), 1.) * self.count), 1);
+    const uint64_t *bucketCounts = self.bucketCounts.bytes;
+    
+    uint64_t cumulatedCount = 0;
+    for (NSUInteger i = 0; i < SRGLatencyHistogramBucketCount; i++) {
+        cumulatedCount += bucketCounts[i];
+        if (cumulatedCount >= rank) {
+            return fmin(fmax(SRGLatencyHistogramBucketMidpoint(i), self.minimum), self.maximum);
+        }
+    }
+    return self.maximum;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; count = %@; mean = %@; p50 = %@; p99 = %@; maximum = %@>",
+            self.class,
+            self,
+            @(self.count),
+            @(self.mean),
+            @([self durationAtPercentile:0.5]),
+            @([self durationAtPercentile:0.99]),
+            @(self.maximum)];
+}
+
+@end
+
+#pragma mark Functions
+
+NSUInteger SRGLatencyHistogramBucketIndex(uint64_t microseconds)
+{
+    if (microseconds == 0) {
+        return 0;
+    }
+    
+    // The two bits following the most significant one select the bucket within the power of two
+    NSUInteger exponent = 63 - __builtin_clzll(microseconds);
+    NSUInteger fraction = (exponent >= 2) ? (microseconds >> (exponent - 2)) & 3 : (microseconds << (2 - exponent)) & 3;
+    return MIN(1 + exponent * 4 + fraction, SRGLatencyHistogramBucketCount - 1);
+}
+
+#pragma mark Static functions
+
+static NSTimeInterval SRGLatencyHistogramBucketMidpoint(NSUInteger index)
+{
+    if (index == 0) {
+        return 0.;
+    }
+    
+    NSUInteger exponent = (index - 1) / 4;
+    NSUInteger fraction = (index - 1) % 4;
+    double lowerBound = ldexp(4 + fraction, (int)exponent - 2);
+    double upperBound = ldexp(5 + fraction, (int)exponent - 2);
+    return (lowerBound + upperBound) / 2. / USEC_PER_SEC;
+}
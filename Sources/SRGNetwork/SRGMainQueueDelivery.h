@@ -0,0 +1,24 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Deliver blocks to the main thread without ever blocking the caller. Blocks submitted while a delivery is pending
+ *  are batched and executed within the same main queue hop, in submission order.
+ */
+@interface SRGMainQueueDelivery : NSObject
+
+/**
+ *  Submit a block for execution on the main thread. Can be called from any thread.
+ */
++ (void)deliverBlock:(dispatch_block_t)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGMainQueueDelivery.h"
+
+#import <os/lock.h>
+
+// Maximum number of blocks executed per main queue hop, so that the main thread remains responsive during bursts.
+static const NSUInteger SRGMainQueueDeliveryMaximumBatchSize = 64;
+
+static NSMutableArray<dispatch_block_t> *s_pendingBlocks = nil;
+static BOOL s_drainScheduled = NO;
+static os_unfair_lock s_lock = OS_UNFAIR_LOCK_INIT;
+
+static void SRGMainQueueDeliveryScheduleDrain(void);
+static void SRGMainQueueDeliveryDrain(void);
+
+@implementation SRGMainQueueDelivery
+
+#pragma mark Class methods
+
++ (void)initialize
+{
+    if (self != SRGMainQueueDelivery.class) {
+        return;
+    }
+    
+    s_pendingBlocks = [NSMutableArray array];
+}
+
++ (void)deliverBlock:(dispatch_block_t)block
+{
+    os_unfair_lock_lock(&s_lock);
+    [s_pendingBlocks addObject:block];
+    BOOL scheduleDrain = ! s_drainScheduled;
+    s_drainScheduled = YES;
+    os_unfair_lock_unlock(&s_lock);
+    
+    if (scheduleDrain) {
+        SRGMainQueueDeliveryScheduleDrain();
+    }
+}
+
+@end
+
+#pragma mark Static functions
+
+static void SRGMainQueueDeliveryScheduleDrain(void)
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        SRGMainQueueDeliveryDrain();
+    });
+}
+
+static void SRGMainQueueDeliveryDrain(void)
+{
+    NSUInteger numberOfExecutedBlocks = 0;
+    while (numberOfExecutedBlocks < SRGMainQueueDeliveryMaximumBatchSize) {
+        // Blocks submitted while draining are executed within the same hop, preserving submission order
+        os_unfair_lock_lock(&s_lock);
+        dispatch_block_t block = s_pendingBlocks.firstObject;
+        if (block) {
+            [s_pendingBlocks removeObjectAtIndex:0];
+        }
+        else {
+            s_drainScheduled = NO;
+        }
+        os_unfair_lock_unlock(&s_lock);
+        
+        if (! block) {
+            return;
+        }
+        
+        @autoreleasepool {
+            block();
+        }
+        numberOfExecutedBlocks++;
+    }
+    
+    // Remaining blocks are delivered in a later hop (the drain is still scheduled, preserving order)
+    SRGMainQueueDeliveryScheduleDrain();
+}
@@ -0,0 +1,23 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGMetricsCollector.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGMetricsCollector (Private)
+
+/**
+ *  Return new metrics for the specified request, started now, and recorded by the receiver once finished.
+ */
+- (SRGRequestMetrics *)metricsForURLRequest:(NSURLRequest *)URLRequest;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,132 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGMetricsCollector+Private.h"
+
+#import "SRGAtomicHistogram.h"
+#import "SRGRequestMetrics+Private.h"
+
+#import <os/lock.h>
+
+@interface SRGMetricsCollector () {
+@private
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic, copy) SRGMetricsEndpointProvider endpointProvider;
+@property (nonatomic) NSMutableDictionary<NSString *, NSArray<SRGAtomicHistogram *> *> *histograms;
+
+@end
+
+@implementation SRGMetricsCollector
+
+#pragma mark Class methods
+
++ (SRGMetricsCollector *)sharedCollector
+{
+    static SRGMetricsCollector *s_sharedCollector;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_sharedCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:nil];
+    });
+    return s_sharedCollector;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithEndpointProvider:(SRGMetricsEndpointProvider)endpointProvider
+{
+    if (self = [super init]) {
+        self.endpointProvider = endpointProvider ?: ^NSString *(NSURLRequest *URLRequest) {
+            return URLRequest.URL.host ?: @"";
+        };
+        self.histograms = [NSMutableDictionary dictionary];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSArray<NSString *> *)endpoints
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<NSString *> *endpoints = self.histograms.allKeys;
+    os_unfair_lock_unlock(&_lock);
+    return endpoints;
+}
+
+#pragma mark Metrics
+
+- (SRGRequestMetrics *)metricsForURLRequest:(NSURLRequest *)URLRequest
+{
+    NSString *endpoint = self.endpointProvider(URLRequest);
+    
+    // Histograms are looked up once per request, so that durations can then be recorded without locking
+    os_unfair_lock_lock(&_lock);
+    NSArray<SRGAtomicHistogram *> *histograms = self.histograms[endpoint];
+    if (! histograms) {
+        NSMutableArray<SRGAtomicHistogram *> *newHistograms = [NSMutableArray arrayWithCapacity:SRGRequestPhaseCount];
+        for (NSInteger i = 0; i < SRGRequestPhaseCount; i++) {
+            [newHistograms addObject:[[SRGAtomicHistogram alloc] init]];
+        }
+        histograms = newHistograms.copy;
+        self.histograms[endpoint] = histograms;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    return [[SRGRequestMetrics alloc] initWithURLRequest:URLRequest endpoint:endpoint histograms:histograms];
+}
+
+- (SRGLatencyHistogram *)histogramForEndpoint:(NSString *)endpoint phase:(SRGRequestPhase)phase
+{
+    if (phase < 0 || phase >= SRGRequestPhaseCount) {
+        return nil;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    NSArray<SRGAtomicHistogram *> *histograms = self.histograms[endpoint];
+    os_unfair_lock_unlock(&_lock);
+    
+    return histograms[phase].snapshot;
+}
+
+- (NSDictionary<NSString *, SRGLatencyHistogram *> *)histogramsForPhase:(SRGRequestPhase)phase
+{
+    if (phase < 0 || phase >= SRGRequestPhaseCount) {
+        return @{};
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    NSDictionary<NSString *, NSArray<SRGAtomicHistogram *> *> *histograms = self.histograms.copy;
+    os_unfair_lock_unlock(&_lock);
+    
+    NSMutableDictionary<NSString *, SRGLatencyHistogram *> *snapshots = [NSMutableDictionary dictionary];
+    [histograms enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull endpoint, NSArray<SRGAtomicHistogram *> * _Nonnull endpointHistograms, BOOL * _Nonnull stop) {
+        snapshots[endpoint] = endpointHistograms[phase].snapshot;
+    }];
+    return snapshots.copy;
+}
+
+- (void)reset
+{
+    // Requests running during a reset record their metrics into discarded histograms
+    os_unfair_lock_lock(&_lock);
+    [self.histograms removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; endpoints = %@>",
+            self.class,
+            self,
+            self.endpoints];
+}
+
+@end
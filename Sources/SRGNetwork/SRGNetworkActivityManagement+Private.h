@@ -0,0 +1,43 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGNetworkActivityManagement.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Counter of running requests to a host. Counters are never released and can therefore be retrieved once and
+ *  updated without any further lookup.
+ */
+@interface SRGNetworkActivityHostCounter : NSObject
+
+/**
+ *  Return the counter for the specified host, `nil` if none.
+ */
++ (nullable SRGNetworkActivityHostCounter *)counterForHost:(nullable NSString *)host;
+
+/**
+ *  The current number of running requests to the host.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfRunningRequests;
+
+@end
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGNetworkActivityManagement (Private)
+
+/**
+ *  Increase or decrease the number of running requests, also updating the specified host counter if any. Can be called
+ *  from any thread.
+ */
++ (void)increaseNumberOfRunningRequestsWithHostCounter:(nullable SRGNetworkActivityHostCounter *)hostCounter;
++ (void)decreaseNumberOfRunningRequestsWithHostCounter:(nullable SRGNetworkActivityHostCounter *)hostCounter;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -4,13 +4,39 @@
 //  License information is available from the LICENSE file.
 //
 
-#import "SRGNetworkActivityManagement.h"
+#import "SRGNetworkActivityManagement+Private.h"
+
+#import <os/lock.h>
+#import <stdatomic.h>
 
 @import UIKit;
 
-static NSInteger s_numberOfRunningRequests = 0;
+// Running requests are counted atomically from any thread. Only changes between idle and active states are notified,
+// after a main queue hop. Each change increments the generation, so that notifications for changes superseded in the
+// meantime can be discarded.
+static atomic_long s_numberOfRunningRequests = 0;
+static atomic_ulong s_generation = 0;
+static _Atomic(double) s_debounceInterval = 0.;
+
+// Accessed on the main thread only, except when enabling or disabling management.
+static BOOL s_active = NO;
 static void (^s_networkActivityManagementHandler)(BOOL) = nil;
 
+static os_unfair_lock s_hostCountersLock = OS_UNFAIR_LOCK_INIT;
+static NSMutableDictionary<NSString *, SRGNetworkActivityHostCounter *> *s_hostCounters = nil;
+
+static void SRGNetworkActivityManagementAddRunningRequests(long delta);
+static void SRGNetworkActivityManagementNotify(void);
+
+@interface SRGNetworkActivityHostCounter () {
+@private
+    atomic_long _numberOfRunningRequests;
+}
+
+- (void)addRunningRequests:(long)delta;
+
+@end
+
 @implementation SRGNetworkActivityManagement
 
 #pragma mark Class methods
@@ -29,7 +55,8 @@ static void (^s_networkActivityManagementHandler)(BOOL) = nil;
 + (void)enableWithHandler:(void (^)(BOOL))handler
 {
     s_networkActivityManagementHandler = handler;
-    handler(s_numberOfRunningRequests != 0);
+    s_active = (atomic_load_explicit(&s_numberOfRunningRequests, memory_order_relaxed) != 0);
+    handler(s_active);
 }
 
 + (void)disable
@@ -38,38 +65,134 @@ static void (^s_networkActivityManagementHandler)(BOOL) = nil;
     s_networkActivityManagementHandler = nil;
 }
 
++ (NSTimeInterval)debounceInterval
+{
+    return atomic_load_explicit(&s_debounceInterval, memory_order_relaxed);
+}
+
++ (void)setDebounceInterval:(NSTimeInterval)debounceInterval
+{
+    atomic_store_explicit(&s_debounceInterval, fmax(debounceInterval, 0.), memory_order_relaxed);
+}
+
 + (void)increaseNumberOfRunningRequests
 {
-    void (^increase)(void) = ^{
-        if (s_numberOfRunningRequests == 0) {
-            s_networkActivityManagementHandler ? s_networkActivityManagementHandler(YES) : nil;
-        }
-        ++s_numberOfRunningRequests;
-    };
-    
-    if (NSThread.isMainThread) {
-        increase();
-    }
-    else {
-        dispatch_async(dispatch_get_main_queue(), increase);
-    }
+    [self increaseNumberOfRunningRequestsWithHostCounter:nil];
 }
 
 + (void)decreaseNumberOfRunningRequests
 {
-    void (^decrease)(void) = ^{
-        --s_numberOfRunningRequests;
-        if (s_numberOfRunningRequests == 0) {
-            s_networkActivityManagementHandler ? s_networkActivityManagementHandler(NO) : nil;
-        }
-    };
+    [self decreaseNumberOfRunningRequestsWithHostCounter:nil];
+}
+
++ (void)increaseNumberOfRunningRequestsWithHostCounter:(SRGNetworkActivityHostCounter *)hostCounter
+{
+    [hostCounter addRunningRequests:1];
+    SRGNetworkActivityManagementAddRunningRequests(1);
+}
+
++ (void)decreaseNumberOfRunningRequestsWithHostCounter:(SRGNetworkActivityHostCounter *)hostCounter
+{
+    [hostCounter addRunningRequests:-1];
+    SRGNetworkActivityManagementAddRunningRequests(-1);
+}
+
++ (NSUInteger)numberOfRunningRequests
+{
+    return MAX(atomic_load_explicit(&s_numberOfRunningRequests, memory_order_relaxed), 0);
+}
+
++ (NSUInteger)numberOfRunningRequestsForHost:(NSString *)host
+{
+    os_unfair_lock_lock(&s_hostCountersLock);
+    SRGNetworkActivityHostCounter *hostCounter = s_hostCounters[host.lowercaseString];
+    os_unfair_lock_unlock(&s_hostCountersLock);
+    return hostCounter.numberOfRunningRequests;
+}
+
+@end
+
+@implementation SRGNetworkActivityHostCounter
+
+#pragma mark Class methods
+
++ (SRGNetworkActivityHostCounter *)counterForHost:(NSString *)host
+{
+    if (host.length == 0) {
+        return nil;
+    }
     
-    if (NSThread.isMainThread) {
-        decrease();
+    NSString *key = host.lowercaseString;
+    
+    os_unfair_lock_lock(&s_hostCountersLock);
+    if (! s_hostCounters) {
+        s_hostCounters = [NSMutableDictionary dictionary];
     }
-    else {
-        dispatch_async(dispatch_get_main_queue(), decrease);
+    SRGNetworkActivityHostCounter *hostCounter = s_hostCounters[key];
+    if (! hostCounter) {
+        hostCounter = [[SRGNetworkActivityHostCounter alloc] init];
+        s_hostCounters[key] = hostCounter;
     }
+    os_unfair_lock_unlock(&s_hostCountersLock);
+    return hostCounter;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        atomic_init(&_numberOfRunningRequests, 0);
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfRunningRequests
+{
+    return MAX(atomic_load_explicit(&_numberOfRunningRequests, memory_order_relaxed), 0);
+}
+
+#pragma mark Updates
+
+- (void)addRunningRequests:(long)delta
+{
+    atomic_fetch_add_explicit(&_numberOfRunningRequests, delta, memory_order_relaxed);
 }
 
 @end
+
+#pragma mark Static functions
+
+static void SRGNetworkActivityManagementAddRunningRequests(long delta)
+{
+    long numberOfRunningRequests = atomic_fetch_add_explicit(&s_numberOfRunningRequests, delta, memory_order_relaxed) + delta;
+    
+    // Only transitions between idle and active states require a main queue hop
+    BOOL changed = (delta > 0) ? (numberOfRunningRequests == delta) : (numberOfRunningRequests == 0);
+    if (! changed) {
+        return;
+    }
+    
+    unsigned long generation = atomic_fetch_add_explicit(&s_generation, 1, memory_order_relaxed) + 1;
+    NSTimeInterval debounceInterval = atomic_load_explicit(&s_debounceInterval, memory_order_relaxed);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(debounceInterval * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        // Changes superseded by a more recent one have not persisted long enough
+        if (atomic_load_explicit(&s_generation, memory_order_relaxed) != generation) {
+            return;
+        }
+        SRGNetworkActivityManagementNotify();
+    });
+}
+
+static void SRGNetworkActivityManagementNotify(void)
+{
+    BOOL active = (atomic_load_explicit(&s_numberOfRunningRequests, memory_order_relaxed) != 0);
+    if (active == s_active) {
+        return;
+    }
+    
+    s_active = active;
+    s_networkActivityManagementHandler ? s_networkActivityManagementHandler(active) : nil;
+}
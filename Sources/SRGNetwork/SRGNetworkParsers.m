@@ -7,8 +7,19 @@
 #import "SRGNetworkParsers.h"
 
 #import "NSBundle+SRGNetwork.h"
+#import "SRGJSONDecoder.h"
+#import "SRGJSONView.h"
 #import "SRGNetworkError.h"
 
+#import <os/lock.h>
+
+// Decoding parsers in use, per schema and key path (weak, protected by the lock)
+static NSMapTable<SRGJSONSchema *, NSMapTable<id, SRGResponseParser> *> *s_decodingParsers = nil;
+static os_unfair_lock s_decodingParsersLock = OS_UNFAIR_LOCK_INIT;
+
+static id SRGNetworkJSONObjectOfClass(id JSONObject, Class expectedClass, NSError **pError);
+static SRGResponseParser SRGNetworkJSONDecodingParserWithKeyPath(SRGJSONSchema *schema, NSString *keyPath);
+
 static id SRGNetworkJSONParser(NSData *data, Class expectedClass, NSError **pError)
 {   
     NSError *parsingError = nil;
@@ -20,6 +31,25 @@ static id SRGNetworkJSONParser(NSData *data, Class expectedClass, NSError **pErr
         return nil;
     }
     
+    return SRGNetworkJSONObjectOfClass(JSONObject, expectedClass, pError);
+}
+
+static id SRGNetworkJSONViewParser(NSData *data, Class expectedClass, NSError **pError)
+{
+    NSError *parsingError = nil;
+    id JSONObject = [SRGJSONViewDocument rootObjectWithData:data error:&parsingError];
+    if (parsingError) {
+        if (pError) {
+            *pError = parsingError;
+        }
+        return nil;
+    }
+    
+    return SRGNetworkJSONObjectOfClass(JSONObject, expectedClass, pError);
+}
+
+static id SRGNetworkJSONObjectOfClass(id JSONObject, Class expectedClass, NSError **pError)
+{
     if (! [JSONObject isKindOfClass:expectedClass]) {
         if (pError) {
             NSString *description = [NSString stringWithFormat:SRGNetworkNonLocalizedString(@"Incorrect JSON type. Expected %@ but found %@"), NSStringFromClass(expectedClass), NSStringFromClass([JSONObject class])];
@@ -42,3 +72,52 @@ NSDictionary *SRGNetworkJSONDictionaryParser(NSData *data, NSError **pError)
 {
     return SRGNetworkJSONParser(data, NSDictionary.class, pError);
 }
+
+NSArray *SRGNetworkJSONArrayViewParser(NSData *data, NSError **pError)
+{
+    return SRGNetworkJSONViewParser(data, NSArray.class, pError);
+}
+
+NSDictionary *SRGNetworkJSONDictionaryViewParser(NSData *data, NSError **pError)
+{
+    return SRGNetworkJSONViewParser(data, NSDictionary.class, pError);
+}
+
+SRGResponseParser SRGNetworkJSONDecodingParser(SRGJSONSchema *schema)
+{
+    return SRGNetworkJSONDecodingParserWithKeyPath(schema, nil);
+}
+
+SRGResponseParser SRGNetworkJSONDecodingParserAtKeyPath(SRGJSONSchema *schema, NSString *keyPath)
+{
+    return SRGNetworkJSONDecodingParserWithKeyPath(schema, keyPath);
+}
+
+// Parsers are identified by pointer (e.g. to store parsed objects in response caches). The same parser is therefore
+// returned for the same schema and key path as long as it is in use.
+static SRGResponseParser SRGNetworkJSONDecodingParserWithKeyPath(SRGJSONSchema *schema, NSString *keyPath)
+{
+    id key = keyPath ?: NSNull.null;
+    
+    os_unfair_lock_lock(&s_decodingParsersLock);
+    if (! s_decodingParsers) {
+        s_decodingParsers = [NSMapTable weakToStrongObjectsMapTable];
+    }
+    
+    NSMapTable<id, SRGResponseParser> *parsers = [s_decodingParsers objectForKey:schema];
+    if (! parsers) {
+        parsers = [NSMapTable strongToWeakObjectsMapTable];
+        [s_decodingParsers setObject:parsers forKey:schema];
+    }
+    
+    SRGResponseParser parser = [parsers objectForKey:key];
+    if (! parser) {
+        parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+            return [[[SRGJSONDecoder alloc] initWithData:data] decodeWithSchema:schema keyPath:keyPath error:pError];
+        };
+        [parsers setObject:parser forKey:key];
+    }
+    os_unfair_lock_unlock(&s_decodingParsersLock);
+    
+    return parser;
+}
@@ -6,7 +6,12 @@
 
 #import "SRGPage.h"
 
-@interface SRGPage ()
+static NSUInteger SRGPageHash(NSUInteger size, NSUInteger number, NSURL *URL);
+
+@interface SRGPage () {
+@private
+    NSUInteger _hash;
+}
 
 @property (nonatomic) NSUInteger size;
 @property (nonatomic) NSUInteger number;
@@ -24,6 +29,9 @@
         self.number = MAX(number, 0);
         self.size = size;
         self.URLRequest = URLRequest;
+        
+        // Pages are immutable and often used as dictionary keys, their hash is therefore computed once
+        _hash = SRGPageHash(self.size, self.number, URLRequest.URL);
     }
     return self;
 }
@@ -32,17 +40,21 @@
 
 - (BOOL)isEqual:(id)object
 {
+    if (object == self) {
+        return YES;
+    }
+    
     if (! [object isKindOfClass:self.class]) {
         return NO;
     }
     
     SRGPage *otherPage = object;
-    return self.size == otherPage.size && self.number == otherPage.number && [self.URLRequest.URL isEqual:otherPage.URLRequest.URL];
+    return _hash == otherPage->_hash && self.size == otherPage.size && self.number == otherPage.number && [self.URLRequest.URL isEqual:otherPage.URLRequest.URL];
 }
 
 - (NSUInteger)hash
 {
-    return [NSString stringWithFormat:@"%@_%@_%@", @(self.size), @(self.number), self.URLRequest.URL.absoluteString].hash;
+    return _hash;
 }
 
 #pragma mark NSCopying protocol
@@ -65,3 +77,14 @@
 }
 
 @end
+
+#pragma mark Static functions
+
+static NSUInteger SRGPageHash(NSUInteger size, NSUInteger number, NSURL *URL)
+{
+    // Combine values without any allocation (see boost::hash_combine)
+    NSUInteger hash = URL.hash;
+    hash ^= size + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= number + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
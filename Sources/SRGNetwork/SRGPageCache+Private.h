@@ -0,0 +1,28 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPageCache.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGPageCache (Private)
+
+/**
+ *  Store the result of the page retrieved by the specified request, with the specified cost. Pages with a zero cost
+ *  are not stored.
+ */
+- (void)storeObject:(id)object
+           response:(nullable NSURLResponse *)response
+           nextPage:(nullable SRGPage *)nextPage
+         forRequest:(SRGPageRequest *)request
+               cost:(NSUInteger)cost;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,358 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPageCache.h"
+
+#import "SRGBaseRequest+Subclassing.h"
+#import "SRGPageCache+Private.h"
+#import "SRGPageRequest+Private.h"
+
+#import <os/lock.h>
+
+@import libextobjc;
+
+// Identifies a page or a list (by the URL of its first page request) among those of requests using the same parser.
+// Requests with different parsers, and therefore different result types, never share cached pages.
+@interface SRGPageCacheKey : NSObject <NSCopying>
+
+- (instancetype)initWithObject:(id)object parser:(SRGResponseParser)parser;
+
+@property (nonatomic, readonly) id object;
+@property (nonatomic, readonly, copy) SRGResponseParser parser;
+
+@end
+
+@interface SRGCachedPage ()
+
+@property (nonatomic) id object;
+@property (nonatomic) SRGPage *page;
+@property (nonatomic) SRGPage *nextPage;
+@property (nonatomic) NSURLResponse *response;
+@property (nonatomic) NSUInteger cost;
+@property (nonatomic) SRGPageCacheKey *listKey;
+
+@end
+
+@interface SRGPageCache () {
+@private
+    os_unfair_lock _lock;
+}
+
+// Cached pages and their keys, ordered from the least to the most recently used one (protected by the lock)
+@property (nonatomic) NSMutableDictionary<SRGPageCacheKey *, SRGCachedPage *> *cachedPages;
+@property (nonatomic) NSMutableOrderedSet<SRGPageCacheKey *> *pageKeys;
+
+// Keys of the pages belonging to each list (protected by the lock)
+@property (nonatomic) NSMutableDictionary<SRGPageCacheKey *, NSMutableSet<SRGPageCacheKey *> *> *listPageKeys;
+
+@property (nonatomic) dispatch_source_t memoryPressureSource;
+
+@end
+
+@implementation SRGCachedPage
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithObject:(id)object response:(NSURLResponse *)response page:(SRGPage *)page nextPage:(SRGPage *)nextPage listKey:(SRGPageCacheKey *)listKey cost:(NSUInteger)cost
+{
+    if (self = [super init]) {
+        self.object = object;
+        self.response = response;
+        self.page = page;
+        self.nextPage = nextPage;
+        self.listKey = listKey;
+        self.cost = cost;
+    }
+    return self;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; page = %@; nextPage = %@; cost = %@>",
+            self.class,
+            self,
+            self.page,
+            self.nextPage,
+            @(self.cost)];
+}
+
+@end
+
+@implementation SRGPageCache
+
+@synthesize costLimit = _costLimit;
+@synthesize totalCost = _totalCost;
+@synthesize numberOfHits = _numberOfHits;
+@synthesize numberOfMisses = _numberOfMisses;
+@synthesize numberOfEvictions = _numberOfEvictions;
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithCostLimit:(NSUInteger)costLimit
+{
+    if (self = [super init]) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _costLimit = costLimit;
+        
+        self.cachedPages = [NSMutableDictionary dictionary];
+        self.pageKeys = [NSMutableOrderedSet orderedSet];
+        self.listPageKeys = [NSMutableDictionary dictionary];
+        
+        // Cached pages can always be retrieved again, release them as soon as memory gets scarce
+        self.memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        
+        @weakify(self)
+        dispatch_source_set_event_handler(self.memoryPressureSource, ^{
+            @strongify(self)
+            [self removeAllCachedPages];
+        });
+        dispatch_resume(self.memoryPressureSource);
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithCostLimit:0];
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_memoryPressureSource);
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)costLimit
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger costLimit = _costLimit;
+    os_unfair_lock_unlock(&_lock);
+    return costLimit;
+}
+
+- (void)setCostLimit:(NSUInteger)costLimit
+{
+    os_unfair_lock_lock(&_lock);
+    _costLimit = costLimit;
+    [self trim];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSUInteger)totalCost
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger totalCost = _totalCost;
+    os_unfair_lock_unlock(&_lock);
+    return totalCost;
+}
+
+- (NSUInteger)numberOfCachedPages
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfCachedPages = self.cachedPages.count;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfCachedPages;
+}
+
+- (NSUInteger)numberOfHits
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfHits = _numberOfHits;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfHits;
+}
+
+- (NSUInteger)numberOfMisses
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfMisses = _numberOfMisses;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfMisses;
+}
+
+- (NSUInteger)numberOfEvictions
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfEvictions = _numberOfEvictions;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfEvictions;
+}
+
+#pragma mark Cache management
+
+- (SRGCachedPage *)cachedPageForRequest:(SRGPageRequest *)request
+{
+    SRGPageCacheKey *key = [[SRGPageCacheKey alloc] initWithObject:request.page parser:request.parser];
+    
+    os_unfair_lock_lock(&_lock);
+    SRGCachedPage *cachedPage = self.cachedPages[key];
+    if (cachedPage) {
+        // Move the page to the most recently used position
+        [self.pageKeys removeObject:key];
+        [self.pageKeys addObject:key];
+        _numberOfHits++;
+    }
+    else {
+        _numberOfMisses++;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return cachedPage;
+}
+
+- (void)storeObject:(id)object response:(NSURLResponse *)response nextPage:(SRGPage *)nextPage forRequest:(SRGPageRequest *)request cost:(NSUInteger)cost
+{
+    if (! object || cost == 0) {
+        return;
+    }
+    
+    // Created outside the lock
+    SRGPageCacheKey *key = [[SRGPageCacheKey alloc] initWithObject:request.page parser:request.parser];
+    SRGPageCacheKey *listKey = [[SRGPageCacheKey alloc] initWithObject:request.firstPageURLRequest.URL parser:request.parser];
+    SRGCachedPage *cachedPage = [[SRGCachedPage alloc] initWithObject:object response:response page:request.page nextPage:nextPage listKey:listKey cost:cost];
+    
+    os_unfair_lock_lock(&_lock);
+    if (cost <= _costLimit) {
+        [self removeCachedPageForKey:key];
+        
+        self.cachedPages[key] = cachedPage;
+        [self.pageKeys addObject:key];
+        
+        NSMutableSet<SRGPageCacheKey *> *pageKeys = self.listPageKeys[listKey];
+        if (! pageKeys) {
+            pageKeys = [NSMutableSet set];
+            self.listPageKeys[listKey] = pageKeys;
+        }
+        [pageKeys addObject:key];
+        
+        _totalCost += cost;
+        [self trim];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)removeCachedPagesForRequest:(SRGPageRequest *)request
+{
+    SRGPageCacheKey *listKey = [[SRGPageCacheKey alloc] initWithObject:request.firstPageURLRequest.URL parser:request.parser];
+    
+    os_unfair_lock_lock(&_lock);
+    NSSet<SRGPageCacheKey *> *pageKeys = [self.listPageKeys[listKey] copy];
+    for (SRGPageCacheKey *key in pageKeys) {
+        [self removeCachedPageForKey:key];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)removeAllCachedPages
+{
+    os_unfair_lock_lock(&_lock);
+    [self.cachedPages removeAllObjects];
+    [self.pageKeys removeAllObjects];
+    [self.listPageKeys removeAllObjects];
+    _totalCost = 0;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)resetStatistics
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfHits = 0;
+    _numberOfMisses = 0;
+    _numberOfEvictions = 0;
+    os_unfair_lock_unlock(&_lock);
+}
+
+// Must be called with the lock held
+- (void)removeCachedPageForKey:(SRGPageCacheKey *)key
+{
+    SRGCachedPage *cachedPage = self.cachedPages[key];
+    if (! cachedPage) {
+        return;
+    }
+    
+    [self.cachedPages removeObjectForKey:key];
+    [self.pageKeys removeObject:key];
+    
+    NSMutableSet<SRGPageCacheKey *> *pageKeys = self.listPageKeys[cachedPage.listKey];
+    [pageKeys removeObject:key];
+    if (pageKeys.count == 0) {
+        [self.listPageKeys removeObjectForKey:cachedPage.listKey];
+    }
+    
+    _totalCost -= cachedPage.cost;
+}
+
+// Must be called with the lock held. Evicts the least recently used pages first.
+- (void)trim
+{
+    while (_totalCost > _costLimit && self.pageKeys.count != 0) {
+        [self removeCachedPageForKey:self.pageKeys.firstObject];
+        _numberOfEvictions++;
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; costLimit = %@; totalCost = %@; numberOfCachedPages = %@>",
+            self.class,
+            self,
+            @(self.costLimit),
+            @(self.totalCost),
+            @(self.numberOfCachedPages)];
+}
+
+@end
+
+@implementation SRGPageCacheKey
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithObject:(id)object parser:(SRGResponseParser)parser
+{
+    if (self = [super init]) {
+        _object = object;
+        _parser = [parser copy];
+    }
+    return self;
+}
+
+#pragma mark Equality
+
+- (BOOL)isEqual:(id)object
+{
+    if (object == self) {
+        return YES;
+    }
+    
+    if (! [object isKindOfClass:self.class]) {
+        return NO;
+    }
+    
+    // Parsers are compared by identity. Parsers of requests derived from each other are the same block, and parsers
+    // of built-in request kinds are global blocks
+    SRGPageCacheKey *otherKey = object;
+    return self.parser == otherKey.parser && [self.object isEqual:otherKey.object];
+}
+
+- (NSUInteger)hash
+{
+    return [self.object hash] ^ (NSUInteger)(__bridge void *)self.parser;
+}
+
+#pragma mark NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+@end
@@ -0,0 +1,42 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPageRequest.h"
+#import "SRGRequestQueue.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Retrieve all pages of a list concurrently, for services with random access to pages. Pages are requested in
+ *  increasing order through a request queue, until a short or empty page is received.
+ */
+@interface SRGPageFanOut : NSObject
+
+/**
+ *  Create a fan-out for the pages of the specified request (which must be a first page request), retrieving at most
+ *  `maximumNumberOfConcurrentRequests` pages at the same time.
+ */
+- (instancetype)initWithRequest:(SRGPageRequest *)request
+                        builder:(SRGPageBuilder)builder
+                 itemsExtractor:(SRGPageItemsExtractor)itemsExtractor
+maximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+                completionBlock:(SRGAllPagesCompletionBlock)completionBlock NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Start retrieving pages.
+ */
+- (void)resume;
+
+/**
+ *  The queue to which page requests are added.
+ */
+@property (nonatomic, readonly, nullable) SRGRequestQueue *requestQueue;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
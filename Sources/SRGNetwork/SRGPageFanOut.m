@@ -0,0 +1,221 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPageFanOut.h"
+
+#import "SRGPage+Private.h"
+#import "SRGPageRequest+Subclassing.h"
+
+#import <os/lock.h>
+
+@interface SRGPageFanOut () {
+@private
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic) SRGPageRequest *request;
+@property (nonatomic, copy) SRGPageBuilder builder;
+@property (nonatomic, copy) SRGPageItemsExtractor itemsExtractor;
+@property (nonatomic, copy) SRGAllPagesCompletionBlock completionBlock;
+
+// Strong reference until all pages have been retrieved
+@property (nonatomic) SRGRequestQueue *requestQueue;
+
+// Page state (protected by the lock). Pages without object are stored as `NSNull`.
+@property (nonatomic) NSMutableDictionary<NSNumber *, SRGPageRequest *> *pageRequests;
+@property (nonatomic) NSMutableDictionary<NSNumber *, id> *pageObjects;
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSArray *> *pageItems;
+@property (nonatomic) NSUInteger nextNumber;
+@property (nonatomic) NSUInteger lastNumber;
+
+@end
+
+@implementation SRGPageFanOut
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithRequest:(SRGPageRequest *)request
+                        builder:(SRGPageBuilder)builder
+                 itemsExtractor:(SRGPageItemsExtractor)itemsExtractor
+maximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+                completionBlock:(SRGAllPagesCompletionBlock)completionBlock
+{
+    if (self = [super init]) {
+        self.request = request;
+        self.builder = builder;
+        self.itemsExtractor = itemsExtractor;
+        self.completionBlock = completionBlock;
+        self.pageRequests = [NSMutableDictionary dictionary];
+        self.pageObjects = [NSMutableDictionary dictionary];
+        self.pageItems = [NSMutableDictionary dictionary];
+        self.lastNumber = NSNotFound;
+        _lock = OS_UNFAIR_LOCK_INIT;
+        
+        maximumNumberOfConcurrentRequests = MAX(maximumNumberOfConcurrentRequests, 1);
+        
+        // The queue retains the receiver until it finishes. A single failure cancels all other page requests.
+        self.requestQueue = [[[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+            if (finished) {
+                [self finishWithError:error];
+            }
+        }] requestQueueWithOptions:SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled] requestQueueWithMaximumNumberOfConcurrentRequests:maximumNumberOfConcurrentRequests];
+        
+        // Keep the pipeline full: as many pages as can be retrieved at the same time are requested upfront
+        self.nextNumber = maximumNumberOfConcurrentRequests;
+    }
+    return self;
+}
+
+#pragma mark Page management
+
+- (void)resume
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfPages = self.nextNumber;
+    os_unfair_lock_unlock(&_lock);
+    
+    for (NSUInteger number = 0; number < numberOfPages; number++) {
+        [self resumePageRequestWithNumber:number];
+    }
+}
+
+// Must be called without the lock held, since the page builder is called
+- (void)resumePageRequestWithNumber:(NSUInteger)number
+{
+    SRGPageRequest *request = [self pageRequestWithNumber:number];
+    
+    // The page is not needed anymore if a page with a smaller number was found to be the last one in the meantime
+    os_unfair_lock_lock(&_lock);
+    BOOL needed = (number <= self.lastNumber);
+    if (needed) {
+        self.pageRequests[@(number)] = request;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (needed) {
+        [self.requestQueue addRequest:request resume:YES];
+    }
+}
+
+- (SRGPageRequest *)pageRequestWithNumber:(NSUInteger)number
+{
+    SRGPage *firstPage = self.request.page;
+    NSURLRequest *URLRequest = (number == 0) ? firstPage.URLRequest : self.builder(firstPage.URLRequest, firstPage.size, number);
+    SRGPage *page = [[SRGPage alloc] initWithSize:firstPage.size number:number URLRequest:URLRequest];
+    
+    // Page requests capture the queue, so that it stays alive while pages are being retrieved
+    SRGRequestQueue *requestQueue = self.requestQueue;
+    SRGPageRequest *request = [self.request requestWithPage:page completionBlock:^(id _Nullable object, SRGPage * _Nonnull retrievedPage, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        if (error) {
+            [requestQueue reportError:error];
+            return;
+        }
+        
+        [self didRetrieveObject:object forPage:retrievedPage];
+    }];
+    
+    // Page requests which are not needed anymore are cancelled silently. Cancellation is reported once for all pages.
+    SRGRequestOptions options = (request.options & ~SRGRequestOptionCancellationErrorsEnabled) | SRGRequestOptionBackgroundCompletionEnabled;
+    return [request requestWithOptions:options];
+}
+
+- (void)didRetrieveObject:(id)object forPage:(SRGPage *)page
+{
+    NSArray *items = self.itemsExtractor(object) ?: @[];
+    
+    // A short or empty page is the last one. Pages with a larger number are not needed anymore.
+    BOOL lastPage = (items.count == 0 || (page.size != SRGPageUnspecifiedSize && items.count < page.size));
+    
+    NSUInteger nextNumber = NSNotFound;
+    NSMutableArray<SRGPageRequest *> *unneededRequests = [NSMutableArray array];
+    
+    os_unfair_lock_lock(&_lock);
+    self.pageRequests[@(page.number)] = nil;
+    self.pageObjects[@(page.number)] = object ?: NSNull.null;
+    self.pageItems[@(page.number)] = items;
+    
+    if (lastPage && page.number < self.lastNumber) {
+        self.lastNumber = page.number;
+        [self.pageRequests enumerateKeysAndObjectsUsingBlock:^(NSNumber * _Nonnull number, SRGPageRequest * _Nonnull request, BOOL * _Nonnull stop) {
+            if (number.unsignedIntegerValue > page.number) {
+                [unneededRequests addObject:request];
+            }
+        }];
+    }
+    
+    // Only reserve the next page number while the lock is held
+    if (self.lastNumber == NSNotFound) {
+        nextNumber = self.nextNumber;
+        self.nextNumber++;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    for (SRGPageRequest *request in unneededRequests) {
+        [request cancel];
+    }
+    
+    // Request the next page before the current request ends, so that the queue does not finish in between
+    if (nextNumber != NSNotFound) {
+        [self resumePageRequestWithNumber:nextNumber];
+    }
+}
+
+- (void)finishWithError:(NSError *)error
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger lastNumber = self.lastNumber;
+    NSDictionary<NSNumber *, id> *pageObjects = self.pageObjects.copy;
+    NSDictionary<NSNumber *, NSArray *> *pageItems = self.pageItems.copy;
+    [self.pageObjects removeAllObjects];
+    [self.pageItems removeAllObjects];
+    [self.pageRequests removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+    
+    // Break the cycle between the receiver and its queue
+    self.requestQueue = nil;
+    
+    if (error) {
+        self.completionBlock(nil, nil, error);
+        return;
+    }
+    
+    // All pages up to the last one must have been retrieved, otherwise retrieval was cancelled
+    BOOL complete = (lastNumber != NSNotFound);
+    for (NSUInteger number = 0; complete && number <= lastNumber; number++) {
+        complete = (pageItems[@(number)] != nil);
+    }
+    
+    if (! complete) {
+        if ((self.request.options & SRGRequestOptionCancellationErrorsEnabled) != 0) {
+            NSError *cancellationError = [NSError errorWithDomain:NSURLErrorDomain
+                                                             code:NSURLErrorCancelled
+                                                         userInfo:@{ NSURLErrorFailingURLErrorKey : self.request.page.URLRequest.URL }];
+            self.completionBlock(nil, nil, cancellationError);
+        }
+        return;
+    }
+    
+    NSMutableArray *orderedPageObjects = [NSMutableArray array];
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSUInteger number = 0; number <= lastNumber; number++) {
+        [orderedPageObjects addObject:pageObjects[@(number)]];
+        [items addObjectsFromArray:pageItems[@(number)]];
+    }
+    self.completionBlock(orderedPageObjects.copy, items.copy, nil);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; request = %@; requestQueue = %@>",
+            self.class,
+            self,
+            self.request,
+            self.requestQueue];
+}
+
+@end
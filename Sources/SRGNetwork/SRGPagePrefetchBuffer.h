@@ -0,0 +1,87 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPage.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Result of a page prefetched in advance.
+ */
+@interface SRGPrefetchedPage : NSObject
+
+@property (nonatomic, readonly, nullable) id object;
+@property (nonatomic, readonly, nullable) NSURLResponse *response;
+@property (nonatomic, readonly, nullable) SRGPage *nextPage;
+
+@end
+
+// Block signatures.
+typedef void (^SRGPrefetchedPageHandler)(SRGPrefetchedPage * _Nullable prefetchedPage);
+
+/**
+ *  Bounded buffer of prefetched pages, shared between related page requests. Pages are discarded once they have been
+ *  consumed, when they get too old, or when the system is under memory pressure.
+ *
+ *  Buffers are thread-safe.
+ */
+@interface SRGPagePrefetchBuffer : NSObject
+
+/**
+ *  Create a buffer for prefetching up to `depth` pages ahead. At most twice as many pages are kept, each for at most
+ *  `maximumAge` seconds.
+ */
+- (instancetype)initWithDepth:(NSUInteger)depth maximumAge:(NSTimeInterval)maximumAge NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Return and remove the prefetched result for the specified page, if available and not too old.
+ */
+- (nullable SRGPrefetchedPage *)takePrefetchedPageForPage:(SRGPage *)page;
+
+/**
+ *  Same as `-takePrefetchedPageForPage:`, but waiting for pages being prefetched. The handler is called synchronously
+ *  if the page is available, otherwise when its prefetching ends (from any thread, with `nil` if it failed). Returns
+ *  `NO` iff the page is neither available nor being prefetched, in which case the handler is not called.
+ */
+- (BOOL)takePrefetchedPageForPage:(SRGPage *)page withHandler:(SRGPrefetchedPageHandler)handler;
+
+/**
+ *  Request the specified page to be prefetched so that `depth` pages are available ahead of it (itself included).
+ *  Returns `YES` iff the caller must start prefetching the page. If the page has already been prefetched, returns `NO`
+ *  and its result by reference, so that the caller can continue with the pages following it. If the page is being
+ *  prefetched, its depth is raised if needed.
+ */
+- (BOOL)beginPrefetchingPage:(SRGPage *)page depth:(NSUInteger)depth prefetchedPage:(SRGPrefetchedPage * _Nullable __autoreleasing * _Nullable)pPrefetchedPage;
+
+/**
+ *  Store the result of a page whose prefetching started with `-beginPrefetchingPage:depth:prefetchedPage:`, returning
+ *  the remaining depth for following pages. Failures (`nil` object) are not stored and return 0. Results awaited with
+ *  `-takePrefetchedPageForPage:withHandler:` are delivered to their handlers instead of being stored.
+ */
+- (NSUInteger)finishPrefetchingPage:(SRGPage *)page withObject:(nullable id)object response:(nullable NSURLResponse *)response nextPage:(nullable SRGPage *)nextPage;
+
+/**
+ *  Discard all prefetched pages.
+ */
+- (void)removeAllPrefetchedPages;
+
+/**
+ *  The prefetch depth.
+ */
+@property (nonatomic, readonly) NSUInteger depth;
+
+/**
+ *  The number of prefetched pages currently available.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfPrefetchedPages;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,241 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPagePrefetchBuffer.h"
+
+#import <os/lock.h>
+
+@import libextobjc;
+
+@interface SRGPrefetchedPage ()
+
+@property (nonatomic) id object;
+@property (nonatomic) NSURLResponse *response;
+@property (nonatomic) SRGPage *nextPage;
+@property (nonatomic) NSDate *date;
+
+@end
+
+@interface SRGPagePrefetchBuffer () {
+@private
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic) NSUInteger depth;
+@property (nonatomic) NSTimeInterval maximumAge;
+
+// Prefetched pages and their insertion order, from the oldest to the most recent one (protected by the lock)
+@property (nonatomic) NSMutableDictionary<SRGPage *, SRGPrefetchedPage *> *prefetchedPages;
+@property (nonatomic) NSMutableArray<SRGPage *> *prefetchedPageOrder;
+
+// Depths of pages currently being prefetched (protected by the lock)
+@property (nonatomic) NSMutableDictionary<SRGPage *, NSNumber *> *prefetchingDepths;
+
+// Handlers waiting for pages currently being prefetched (protected by the lock)
+@property (nonatomic) NSMutableDictionary<SRGPage *, NSMutableArray<SRGPrefetchedPageHandler> *> *prefetchedPageHandlers;
+
+@property (nonatomic) dispatch_source_t memoryPressureSource;
+
+@end
+
+@implementation SRGPrefetchedPage
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; nextPage = %@; date = %@>",
+            self.class,
+            self,
+            self.nextPage,
+            self.date];
+}
+
+@end
+
+@implementation SRGPagePrefetchBuffer
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithDepth:(NSUInteger)depth maximumAge:(NSTimeInterval)maximumAge
+{
+    if (self = [super init]) {
+        self.depth = depth;
+        self.maximumAge = maximumAge;
+        self.prefetchedPages = [NSMutableDictionary dictionary];
+        self.prefetchedPageOrder = [NSMutableArray array];
+        self.prefetchingDepths = [NSMutableDictionary dictionary];
+        self.prefetchedPageHandlers = [NSMutableDictionary dictionary];
+        _lock = OS_UNFAIR_LOCK_INIT;
+        
+        // Prefetched pages can always be fetched again, release them as soon as memory gets scarce
+        self.memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        
+        @weakify(self)
+        dispatch_source_set_event_handler(self.memoryPressureSource, ^{
+            @strongify(self)
+            [self removeAllPrefetchedPages];
+        });
+        dispatch_resume(self.memoryPressureSource);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_memoryPressureSource);
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfPrefetchedPages
+{
+    os_unfair_lock_lock(&_lock);
+    [self removeExpiredPrefetchedPages];
+    NSUInteger numberOfPrefetchedPages = self.prefetchedPages.count;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfPrefetchedPages;
+}
+
+#pragma mark Buffer management
+
+- (SRGPrefetchedPage *)takePrefetchedPageForPage:(SRGPage *)page
+{
+    os_unfair_lock_lock(&_lock);
+    [self removeExpiredPrefetchedPages];
+    SRGPrefetchedPage *prefetchedPage = self.prefetchedPages[page];
+    if (prefetchedPage) {
+        [self.prefetchedPages removeObjectForKey:page];
+        [self.prefetchedPageOrder removeObject:page];
+    }
+    os_unfair_lock_unlock(&_lock);
+    return prefetchedPage;
+}
+
+- (BOOL)takePrefetchedPageForPage:(SRGPage *)page withHandler:(SRGPrefetchedPageHandler)handler
+{
+    os_unfair_lock_lock(&_lock);
+    [self removeExpiredPrefetchedPages];
+    SRGPrefetchedPage *prefetchedPage = self.prefetchedPages[page];
+    BOOL prefetching = (self.prefetchingDepths[page] != nil);
+    if (prefetchedPage) {
+        [self.prefetchedPages removeObjectForKey:page];
+        [self.prefetchedPageOrder removeObject:page];
+    }
+    else if (prefetching) {
+        NSMutableArray<SRGPrefetchedPageHandler> *handlers = self.prefetchedPageHandlers[page];
+        if (! handlers) {
+            handlers = [NSMutableArray array];
+            self.prefetchedPageHandlers[page] = handlers;
+        }
+        [handlers addObject:[handler copy]];
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (prefetchedPage) {
+        handler(prefetchedPage);
+    }
+    return prefetchedPage || prefetching;
+}
+
+- (BOOL)beginPrefetchingPage:(SRGPage *)page depth:(NSUInteger)depth prefetchedPage:(SRGPrefetchedPage * __autoreleasing *)pPrefetchedPage
+{
+    os_unfair_lock_lock(&_lock);
+    [self removeExpiredPrefetchedPages];
+    
+    SRGPrefetchedPage *prefetchedPage = self.prefetchedPages[page];
+    NSNumber *prefetchingDepth = self.prefetchingDepths[page];
+    if (! prefetchedPage) {
+        self.prefetchingDepths[page] = @(MAX(prefetchingDepth.unsignedIntegerValue, depth));
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (pPrefetchedPage) {
+        *pPrefetchedPage = prefetchedPage;
+    }
+    return ! prefetchedPage && ! prefetchingDepth;
+}
+
+- (NSUInteger)finishPrefetchingPage:(SRGPage *)page withObject:(id)object response:(NSURLResponse *)response nextPage:(SRGPage *)nextPage
+{
+    SRGPrefetchedPage *prefetchedPage = nil;
+    if (object) {
+        prefetchedPage = [[SRGPrefetchedPage alloc] init];
+        prefetchedPage.object = object;
+        prefetchedPage.response = response;
+        prefetchedPage.nextPage = nextPage;
+        prefetchedPage.date = NSDate.date;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    NSUInteger depth = [self.prefetchingDepths[page] unsignedIntegerValue];
+    [self.prefetchingDepths removeObjectForKey:page];
+    
+    // Awaited pages are consumed by their handlers
+    NSArray<SRGPrefetchedPageHandler> *handlers = self.prefetchedPageHandlers[page];
+    [self.prefetchedPageHandlers removeObjectForKey:page];
+    
+    if (prefetchedPage && ! handlers) {
+        if (self.prefetchedPages[page]) {
+            [self.prefetchedPageOrder removeObject:page];
+        }
+        [self.prefetchedPageOrder addObject:page];
+        self.prefetchedPages[page] = prefetchedPage;
+        
+        // Evict the oldest pages first
+        NSUInteger capacity = MAX(2 * self.depth, 1);
+        while (self.prefetchedPageOrder.count > capacity) {
+            [self.prefetchedPages removeObjectForKey:self.prefetchedPageOrder.firstObject];
+            [self.prefetchedPageOrder removeObjectAtIndex:0];
+        }
+    }
+    else if (! prefetchedPage) {
+        depth = 0;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    for (SRGPrefetchedPageHandler handler in handlers) {
+        handler(prefetchedPage);
+    }
+    
+    return (depth != 0) ? depth - 1 : 0;
+}
+
+- (void)removeAllPrefetchedPages
+{
+    os_unfair_lock_lock(&_lock);
+    [self.prefetchedPages removeAllObjects];
+    [self.prefetchedPageOrder removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+}
+
+// Must be called with the lock held
+- (void)removeExpiredPrefetchedPages
+{
+    NSDate *expirationDate = [NSDate dateWithTimeIntervalSinceNow:-self.maximumAge];
+    while (self.prefetchedPageOrder.count != 0) {
+        SRGPage *page = self.prefetchedPageOrder.firstObject;
+        if ([self.prefetchedPages[page].date compare:expirationDate] == NSOrderedDescending) {
+            break;
+        }
+        
+        [self.prefetchedPages removeObjectForKey:page];
+        [self.prefetchedPageOrder removeObjectAtIndex:0];
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; depth = %@; numberOfPrefetchedPages = %@>",
+            self.class,
+            self,
+            @(self.depth),
+            @(self.numberOfPrefetchedPages)];
+}
+
+@end
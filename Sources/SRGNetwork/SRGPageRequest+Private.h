@@ -0,0 +1,23 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPageRequest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGPageRequest (Private)
+
+/**
+ *  The request for the first page of the list the request belongs to, with its original size.
+ */
+@property (nonatomic, readonly) NSURLRequest *firstPageURLRequest;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -50,6 +50,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (__kindof SRGPageRequest *)requestWithPage:(nullable SRGPage *)page class:(Class)cls;
 
+/**
+ *  Return a request for the specified page, with the same settings and options as the receiver, but calling another
+ *  completion block. The returned request never prefetches pages, and never calls its completion block with stale results
+ *  (its completion block is therefore called at most once).
+ */
+- (SRGPageRequest *)requestWithPage:(SRGPage *)page completionBlock:(SRGObjectPageCompletionBlock)completionBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -8,8 +8,13 @@
 
 #import "SRGBaseRequest+Subclassing.h"
 #import "SRGPage+Private.h"
+#import "SRGPageCache+Private.h"
+#import "SRGPagePrefetchBuffer.h"
 #import "SRGPageRequest+Subclassing.h"
 
+// Prefetched pages older than this are discarded
+static const NSTimeInterval SRGPageRequestPrefetchedPageMaximumAge = 60.;
+
 @interface SRGPageRequest ()
 
 @property (nonatomic) NSURLRequest *firstPageURLRequest;
@@ -19,6 +24,13 @@
 @property (nonatomic, copy) SRGObjectPaginator paginator;
 @property (nonatomic, copy) SRGObjectPageCompletionBlock pageCompletionBlock;
 
+@property (nonatomic) SRGPagePrefetchBuffer *prefetchBuffer;
+@property (nonatomic) SRGPageCache *pageCache;
+
+// Next page known for results provided by the page cache or the prefetch buffer
+@property (atomic, getter=isNextPageKnown) BOOL nextPageKnown;
+@property (atomic) SRGPage *knownNextPage;
+
 @end
 
 @implementation SRGPageRequest
@@ -39,13 +51,30 @@
     
     __block SRGPage *nextPage = nil;
     
+    // The extractor is stored by the request, which must therefore only be weakly referenced
+    __block __weak SRGPageRequest *weakRequest = nil;
+    
     if (self = [super initWithURLRequest:page.URLRequest session:session parser:parser extractor:^(id  _Nullable object, NSURLResponse * _Nullable response) {
         NSAssert(! NSThread.isMainThread, @"Must always be executed in the background");
-        NSURLRequest *nextURLRequest = paginator(URLRequest, object, response, page.size, page.number + 1);
-        nextPage = nextURLRequest ? [[SRGPage alloc] initWithSize:page.size number:page.number + 1 URLRequest:nextURLRequest] : nil;
+        
+        SRGPageRequest *request = weakRequest;
+        if (request.nextPageKnown) {
+            // Provided results have already been cached and paginated
+            nextPage = request.knownNextPage;
+        }
+        else {
+            NSURLRequest *nextURLRequest = paginator(URLRequest, object, response, page.size, page.number + 1);
+            nextPage = nextURLRequest ? [[SRGPage alloc] initWithSize:page.size number:page.number + 1 URLRequest:nextURLRequest] : nil;
+            [request.pageCache storeObject:object response:response nextPage:nextPage forRequest:request cost:request.parsedDataLength];
+        }
+        
+        if (request.prefetchBuffer) {
+            [request prefetchPage:nextPage depth:request.prefetchBuffer.depth];
+        }
     } completionBlock:^(id  _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
         completionBlock(object, page, nextPage, response, error);
     }]) {
+        weakRequest = self;
         self.firstPageURLRequest = URLRequest;
         self.page = page;
         self.sizer = sizer;
@@ -55,6 +84,132 @@
     return self;
 }
 
+#pragma mark Getters and setters
+
+- (NSUInteger)prefetchDepth
+{
+    return self.prefetchBuffer.depth;
+}
+
+#pragma mark Settings
+
+- (SRGPageRequest *)requestWithPrefetchDepth:(NSUInteger)prefetchDepth
+{
+    SRGPageRequest *request = [self requestWithOptions:self.options];
+    request.prefetchBuffer = (prefetchDepth != 0) ? [[SRGPagePrefetchBuffer alloc] initWithDepth:prefetchDepth maximumAge:SRGPageRequestPrefetchedPageMaximumAge] : nil;
+    return request;
+}
+
+- (SRGPageRequest *)requestWithPageCache:(SRGPageCache *)pageCache
+{
+    SRGPageRequest *request = [self requestWithOptions:self.options];
+    request.pageCache = pageCache;
+    return request;
+}
+
+- (void)applySettingsFromRequest:(SRGBaseRequest *)request
+{
+    [super applySettingsFromRequest:request];
+    
+    // Related page requests share the same prefetch buffer and page cache
+    if ([request isKindOfClass:SRGPageRequest.class]) {
+        SRGPageRequest *pageRequest = (SRGPageRequest *)request;
+        self.prefetchBuffer = pageRequest.prefetchBuffer;
+        self.pageCache = pageRequest.pageCache;
+    }
+}
+
+#pragma mark Session task management
+
+- (void)resume
+{
+    if (self.running) {
+        return;
+    }
+    
+    self.nextPageKnown = NO;
+    self.knownNextPage = nil;
+    
+    SRGPagePrefetchBuffer *prefetchBuffer = self.prefetchBuffer;
+    SRGPrefetchedPage *prefetchedPage = [prefetchBuffer takePrefetchedPageForPage:self.page];
+    if (prefetchedPage) {
+        [self resumeWithObject:prefetchedPage.object response:prefetchedPage.response nextPage:prefetchedPage.nextPage];
+        return;
+    }
+    
+    SRGCachedPage *cachedPage = [self.pageCache cachedPageForRequest:self];
+    if (cachedPage) {
+        [self resumeWithObject:cachedPage.object response:cachedPage.response nextPage:cachedPage.nextPage];
+        return;
+    }
+    
+    if (! prefetchBuffer) {
+        [super resume];
+        return;
+    }
+    
+    // Pages being prefetched are not retrieved again, the result of their prefetching is awaited instead. If it
+    // fails, or if the page is not being prefetched, the page is retrieved as usual.
+    SRGPage *page = self.page;
+    [self resumeWithResultProvider:^(SRGResultHandler resultHandler) {
+        BOOL awaited = [prefetchBuffer takePrefetchedPageForPage:page withHandler:^(SRGPrefetchedPage * _Nullable prefetchedPage) {
+            if (prefetchedPage.object) {
+                self.knownNextPage = prefetchedPage.nextPage;
+                self.nextPageKnown = YES;
+            }
+            resultHandler(prefetchedPage.object, prefetchedPage.response);
+        }];
+        if (! awaited) {
+            resultHandler(nil, nil);
+        }
+    }];
+}
+
+// Complete with a result whose next page is already known, so that it is neither paginated nor cached again
+- (void)resumeWithObject:(id)object response:(NSURLResponse *)response nextPage:(SRGPage *)nextPage
+{
+    self.knownNextPage = nextPage;
+    self.nextPageKnown = YES;
+    [self resumeWithObject:object response:response];
+}
+
+#pragma mark Prefetching
+
+- (void)prefetchPage:(SRGPage *)page depth:(NSUInteger)depth
+{
+    SRGPagePrefetchBuffer *prefetchBuffer = self.prefetchBuffer;
+    
+    // Skip pages already available
+    while (YES) {
+        if (! page || depth == 0) {
+            return;
+        }
+        
+        SRGPrefetchedPage *prefetchedPage = nil;
+        if ([prefetchBuffer beginPrefetchingPage:page depth:depth prefetchedPage:&prefetchedPage]) {
+            break;
+        }
+        else if (! prefetchedPage) {
+            // Already being prefetched
+            return;
+        }
+        
+        page = prefetchedPage.nextPage;
+        depth--;
+    }
+    
+    // Pages are prefetched one after the other, since the location of a page is only known once the previous one has
+    // been parsed. The receiver is kept alive until prefetching ends.
+    SRGPageRequest *request = [self requestWithPage:page completionBlock:^(id _Nullable object, SRGPage * _Nonnull prefetchedPage, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        NSUInteger nextDepth = [prefetchBuffer finishPrefetchingPage:prefetchedPage withObject:error ? nil : object response:response nextPage:nextPage];
+        [self prefetchPage:nextPage depth:nextDepth];
+    }];
+    
+    // Prefetch requests never need to reach the main thread. Their completion block must always be called, even if
+    // they are cancelled (e.g. when their deadline is exceeded), so that requests awaiting them are not stuck.
+    [[request requestWithOptions:self.options | SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled] resume];
+}
+
 #pragma mark Request generation
 
 - (NSURLRequest *)URLRequestForFirstPageWithSize:(NSUInteger)size
@@ -77,20 +232,37 @@
                                                     paginator:self.paginator
                                               completionBlock:self.pageCompletionBlock];
     NSAssert([request isKindOfClass:SRGPageRequest.class], @"A page request subclass must be returned");
+    [request applySettingsFromRequest:self];
     return [request requestWithOptions:self.options];
 }
 
+- (SRGPageRequest *)requestWithPage:(SRGPage *)page completionBlock:(SRGObjectPageCompletionBlock)completionBlock
+{
+    SRGPageRequest *request = [[SRGPageRequest alloc] initWithURLRequest:self.firstPageURLRequest
+                                                                 session:self.session
+                                                                  parser:self.parser
+                                                                    page:page
+                                                                   sizer:self.sizer
+                                                               paginator:self.paginator
+                                                         completionBlock:completionBlock];
+    [request applySettingsFromRequest:self];
+    request.prefetchBuffer = nil;
+    return [[request requestWithOptions:self.options] requestWithMaximumStaleness:0.];
+}
+
 #pragma mark NSCopying protocol
 
 - (id)copyWithZone:(NSZone *)zone
 {
-    return [[self.class alloc] initWithURLRequest:self.firstPageURLRequest
-                                          session:self.session
-                                           parser:self.parser
-                                             page:self.page
-                                            sizer:self.sizer
-                                        paginator:self.paginator
-                                  completionBlock:self.pageCompletionBlock];
+    SRGPageRequest *request = [[self.class alloc] initWithURLRequest:self.firstPageURLRequest
+                                                             session:self.session
+                                                              parser:self.parser
+                                                                page:self.page
+                                                               sizer:self.sizer
+                                                           paginator:self.paginator
+                                                     completionBlock:self.pageCompletionBlock];
+    [request applySettingsFromRequest:self];
+    return request;
 }
 
 @end
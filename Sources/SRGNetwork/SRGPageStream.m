@@ -0,0 +1,256 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPageStream.h"
+
+#import "SRGNetworkLogger.h"
+#import "SRGPageRequest+Subclassing.h"
+
+#import <os/lock.h>
+
+@interface SRGStreamedPage ()
+
+@property (nonatomic) id object;
+@property (nonatomic) SRGPage *page;
+@property (nonatomic) NSURLResponse *response;
+
+@end
+
+@interface SRGPageStream () {
+@private
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic) SRGFirstPageRequest *request;
+@property (nonatomic) NSUInteger readAhead;
+@property (nonatomic) dispatch_queue_t deliveryQueue;
+
+// Stream state (protected by the lock). The next page is `nil` once the last page has been retrieved.
+@property (nonatomic) SRGPage *nextPage;
+@property (nonatomic) SRGPageRequest *pageRequest;
+@property (nonatomic) NSMutableArray<SRGStreamedPage *> *bufferedPages;
+@property (nonatomic) NSMutableArray<SRGPageStreamCompletionBlock> *completionBlocks;
+@property (nonatomic) NSError *error;
+@property (nonatomic) NSUInteger numberOfDeliveredPages;
+
+@end
+
+@implementation SRGStreamedPage
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithObject:(id)object page:(SRGPage *)page response:(NSURLResponse *)response
+{
+    if (self = [super init]) {
+        self.object = object;
+        self.page = page;
+        self.response = response;
+    }
+    return self;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; page = %@; object = %@>",
+            self.class,
+            self,
+            self.page,
+            self.object];
+}
+
+@end
+
+@implementation SRGPageStream
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithRequest:(SRGFirstPageRequest *)request readAhead:(NSUInteger)readAhead
+{
+    if (self = [super init]) {
+        self.request = request;
+        self.readAhead = readAhead;
+        
+        // Pages must be delivered in order
+        BOOL backgroundCompletionEnabled = ((request.options & SRGRequestOptionBackgroundCompletionEnabled) != 0);
+        self.deliveryQueue = backgroundCompletionEnabled ? dispatch_queue_create("ch.srgssr.network.page_stream", DISPATCH_QUEUE_SERIAL) : dispatch_get_main_queue();
+        self.nextPage = request.page;
+        self.bufferedPages = [NSMutableArray array];
+        self.completionBlocks = [NSMutableArray array];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithRequest:[SRGFirstPageRequest new] readAhead:0];
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfDeliveredPages
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfDeliveredPages = _numberOfDeliveredPages;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfDeliveredPages;
+}
+
+- (NSUInteger)numberOfBufferedPages
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfBufferedPages = self.bufferedPages.count;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfBufferedPages;
+}
+
+- (BOOL)isFinished
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL finished = (! self.nextPage || self.error) && self.bufferedPages.count == 0;
+    os_unfair_lock_unlock(&_lock);
+    return finished;
+}
+
+#pragma mark Pages
+
+- (void)nextPageWithCompletionBlock:(SRGPageStreamCompletionBlock)completionBlock
+{
+    os_unfair_lock_lock(&_lock);
+    [self.completionBlocks addObject:completionBlock];
+    os_unfair_lock_unlock(&_lock);
+    
+    [self update];
+}
+
+- (void)cancel
+{
+    os_unfair_lock_lock(&_lock);
+    SRGPageRequest *pageRequest = self.pageRequest;
+    self.pageRequest = nil;
+    if (! self.error) {
+        self.error = [NSError errorWithDomain:NSURLErrorDomain
+                                         code:NSURLErrorCancelled
+                                     userInfo:@{ NSURLErrorFailingURLErrorKey : self.request.page.URLRequest.URL }];
+    }
+    [self.bufferedPages removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+    
+    [pageRequest cancel];
+    [self update];
+}
+
+// Serve awaited pages from the buffer, and retrieve the next page if more pages are needed
+- (void)update
+{
+    NSMutableArray<dispatch_block_t> *deliveryBlocks = [NSMutableArray array];
+    SRGPageRequest *pageRequest = nil;
+    
+    os_unfair_lock_lock(&_lock);
+    while (self.completionBlocks.count != 0) {
+        SRGPageStreamCompletionBlock completionBlock = self.completionBlocks.firstObject;
+        if (self.bufferedPages.count != 0) {
+            SRGStreamedPage *streamedPage = self.bufferedPages.firstObject;
+            [self.bufferedPages removeObjectAtIndex:0];
+            _numberOfDeliveredPages++;
+            [deliveryBlocks addObject:^{
+                completionBlock(streamedPage, nil);
+            }];
+        }
+        else if (self.error || ! self.nextPage) {
+            NSError *error = self.error;
+            [deliveryBlocks addObject:^{
+                completionBlock(nil, error);
+            }];
+        }
+        else {
+            break;
+        }
+        [self.completionBlocks removeObjectAtIndex:0];
+    }
+    
+    // Pages are retrieved one after the other, as long as fewer pages than needed are available
+    BOOL needed = (self.bufferedPages.count < self.completionBlocks.count + self.readAhead);
+    if (needed && ! self.pageRequest && self.nextPage && ! self.error) {
+        pageRequest = [self pageRequestForPage:self.nextPage];
+        self.pageRequest = pageRequest;
+    }
+    
+    // Enqueued with the lock held, so that concurrent updates cannot deliver pages out of order
+    if (deliveryBlocks.count != 0) {
+        [self deliverBlocks:deliveryBlocks.copy];
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    [pageRequest resume];
+}
+
+// Must be called with the lock held
+- (SRGPageRequest *)pageRequestForPage:(SRGPage *)page
+{
+    // No weakify / strongify dance here, so that the stream stays alive while a page is being retrieved
+    SRGPageRequest *pageRequest = [self.request requestWithPage:page completionBlock:^(id _Nullable object, SRGPage * _Nonnull retrievedPage, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [self didRetrieveObject:object forPage:retrievedPage nextPage:nextPage response:response error:error];
+    }];
+    
+    // Results are delivered by the stream, and cancellation is reported once by the stream itself
+    SRGRequestOptions options = (pageRequest.options & ~SRGRequestOptionCancellationErrorsEnabled) | SRGRequestOptionBackgroundCompletionEnabled;
+    return [pageRequest requestWithOptions:options];
+}
+
+- (void)didRetrieveObject:(id)object forPage:(SRGPage *)page nextPage:(SRGPage *)nextPage response:(NSURLResponse *)response error:(NSError *)error
+{
+    os_unfair_lock_lock(&_lock);
+    
+    // Results received after cancellation are discarded
+    if (self.error) {
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+    
+    self.pageRequest = nil;
+    if (error) {
+        self.error = error;
+    }
+    else {
+        SRGStreamedPage *streamedPage = [[SRGStreamedPage alloc] initWithObject:object page:page response:response];
+        [self.bufferedPages addObject:streamedPage];
+        self.nextPage = nextPage;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (error) {
+        SRGNetworkLogDebug(@"Page Stream", @"Page %@ of %@ could not be retrieved. Reason: %@", @(page.number), self, error);
+    }
+    
+    [self update];
+}
+
+- (void)deliverBlocks:(NSArray<dispatch_block_t> *)blocks
+{
+    dispatch_async(self.deliveryQueue, ^{
+        for (dispatch_block_t block in blocks) {
+            block();
+        }
+    });
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; request = %@; readAhead = %@; numberOfDeliveredPages = %@>",
+            self.class,
+            self,
+            self.request,
+            @(self.readAhead),
+            @(self.numberOfDeliveredPages)];
+}
+
+@end
@@ -0,0 +1,41 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGParsingExecutor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Serial queue whose blocks are executed by a parsing executor, one after the other and in submission order. Each
+ *  block occupies one executor slot while it runs, like any other executor block.
+ */
+@interface SRGParsingSerialQueue : NSObject
+
+/**
+ *  Execute a block asynchronously, after all blocks previously submitted to the queue.
+ */
+- (void)executeBlock:(dispatch_block_t)block;
+
+@end
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGParsingExecutor (Private)
+
+/**
+ *  Execute a block asynchronously with the specified quality of service, as soon as the concurrency limit allows.
+ */
+- (void)executeBlock:(dispatch_block_t)block withQualityOfService:(NSQualityOfService)qualityOfService;
+
+/**
+ *  Create a serial queue whose blocks are executed by the receiver with the specified quality of service.
+ */
+- (SRGParsingSerialQueue *)serialQueueWithQualityOfService:(NSQualityOfService)qualityOfService;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,281 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGParsingExecutor+Private.h"
+
+#import <os/lock.h>
+
+// Supported quality of service classes, from the highest to the lowest.
+static const NSQualityOfService SRGParsingExecutorQualitiesOfService[] = {
+    NSQualityOfServiceUserInteractive,
+    NSQualityOfServiceUserInitiated,
+    NSQualityOfServiceDefault,
+    NSQualityOfServiceUtility,
+    NSQualityOfServiceBackground
+};
+static const NSUInteger SRGParsingExecutorQualitiesOfServiceCount = sizeof(SRGParsingExecutorQualitiesOfService) / sizeof(NSQualityOfService);
+
+static NSUInteger SRGParsingExecutorQualityOfServiceIndex(NSQualityOfService qualityOfService);
+static qos_class_t SRGParsingExecutorQOSClass(NSQualityOfService qualityOfService);
+
+@interface SRGParsingExecutor () {
+@private
+    os_unfair_lock _lock;
+    NSUInteger _numberOfRunningOperations;
+}
+
+@property (nonatomic) NSUInteger maximumConcurrentOperationCount;
+
+// One FIFO of pending blocks per quality of service (indexed like `SRGParsingExecutorQualitiesOfService`)
+@property (nonatomic) NSArray<NSMutableArray<dispatch_block_t> *> *pendingBlocks;
+
+@end
+
+@interface SRGParsingSerialQueue () {
+@private
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic) SRGParsingExecutor *executor;
+@property (nonatomic) NSQualityOfService qualityOfService;
+
+// Blocks waiting to be executed, and whether one of them is scheduled on the executor (protected by the lock)
+@property (nonatomic) NSMutableArray<dispatch_block_t> *pendingBlocks;
+@property (nonatomic, getter=isScheduled) BOOL scheduled;
+
+@end
+
+@implementation SRGParsingExecutor
+
+#pragma mark Class methods
+
++ (SRGParsingExecutor *)sharedExecutor
+{
+    static SRGParsingExecutor *s_sharedExecutor;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_sharedExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:NSProcessInfo.processInfo.activeProcessorCount];
+    });
+    return s_sharedExecutor;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithMaximumConcurrentOperationCount:(NSUInteger)maximumConcurrentOperationCount
+{
+    if (self = [super init]) {
+        self.maximumConcurrentOperationCount = MAX(maximumConcurrentOperationCount, 1);
+        
+        NSMutableArray<NSMutableArray<dispatch_block_t> *> *pendingBlocks = [NSMutableArray array];
+        for (NSUInteger i = 0; i < SRGParsingExecutorQualitiesOfServiceCount; i++) {
+            [pendingBlocks addObject:[NSMutableArray array]];
+        }
+        self.pendingBlocks = pendingBlocks.copy;
+        
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfRunningOperations
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfRunningOperations = _numberOfRunningOperations;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfRunningOperations;
+}
+
+- (NSUInteger)numberOfPendingOperations
+{
+    NSUInteger numberOfPendingOperations = 0;
+    os_unfair_lock_lock(&_lock);
+    for (NSMutableArray<dispatch_block_t> *blocks in self.pendingBlocks) {
+        numberOfPendingOperations += blocks.count;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return numberOfPendingOperations;
+}
+
+#pragma mark Execution
+
+- (void)executeBlock:(dispatch_block_t)block withQualityOfService:(NSQualityOfService)qualityOfService
+{
+    NSUInteger index = SRGParsingExecutorQualityOfServiceIndex(qualityOfService);
+    
+    os_unfair_lock_lock(&_lock);
+    BOOL canRun = (_numberOfRunningOperations < self.maximumConcurrentOperationCount);
+    if (canRun) {
+        _numberOfRunningOperations++;
+    }
+    else {
+        [self.pendingBlocks[index] addObject:block];
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (canRun) {
+        [self runBlock:block withQualityOfServiceIndex:index];
+    }
+}
+
+- (void)runBlock:(dispatch_block_t)block withQualityOfServiceIndex:(NSUInteger)index
+{
+    qos_class_t qosClass = SRGParsingExecutorQOSClass(SRGParsingExecutorQualitiesOfService[index]);
+    dispatch_async(dispatch_get_global_queue(qosClass, 0), ^{
+        block();
+        
+        dispatch_block_t nextBlock = nil;
+        NSUInteger nextIndex = 0;
+        
+        os_unfair_lock_lock(&self->_lock);
+        for (NSUInteger i = 0; i < SRGParsingExecutorQualitiesOfServiceCount; i++) {
+            NSMutableArray<dispatch_block_t> *blocks = self.pendingBlocks[i];
+            if (blocks.count != 0) {
+                nextBlock = blocks.firstObject;
+                nextIndex = i;
+                [blocks removeObjectAtIndex:0];
+                break;
+            }
+        }
+        if (! nextBlock) {
+            self->_numberOfRunningOperations--;
+        }
+        os_unfair_lock_unlock(&self->_lock);
+        
+        // The running slot is directly handed over to the next block
+        if (nextBlock) {
+            [self runBlock:nextBlock withQualityOfServiceIndex:nextIndex];
+        }
+    });
+}
+
+- (SRGParsingSerialQueue *)serialQueueWithQualityOfService:(NSQualityOfService)qualityOfService
+{
+    return [[SRGParsingSerialQueue alloc] initWithExecutor:self qualityOfService:qualityOfService];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; maximumConcurrentOperationCount = %@; numberOfRunningOperations = %@; numberOfPendingOperations = %@>",
+            self.class,
+            self,
+            @(self.maximumConcurrentOperationCount),
+            @(self.numberOfRunningOperations),
+            @(self.numberOfPendingOperations)];
+}
+
+@end
+
+@implementation SRGParsingSerialQueue
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithExecutor:(SRGParsingExecutor *)executor qualityOfService:(NSQualityOfService)qualityOfService
+{
+    if (self = [super init]) {
+        self.executor = executor;
+        self.qualityOfService = qualityOfService;
+        self.pendingBlocks = [NSMutableArray array];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Execution
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    os_unfair_lock_lock(&_lock);
+    [self.pendingBlocks addObject:[block copy]];
+    BOOL scheduled = self.scheduled;
+    self.scheduled = YES;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (! scheduled) {
+        [self scheduleNextBlock];
+    }
+}
+
+// Blocks are scheduled one at a time, so that a busy queue does not keep an executor slot for itself
+- (void)scheduleNextBlock
+{
+    [self.executor executeBlock:^{
+        os_unfair_lock_lock(&self->_lock);
+        dispatch_block_t block = self.pendingBlocks.firstObject;
+        [self.pendingBlocks removeObjectAtIndex:0];
+        os_unfair_lock_unlock(&self->_lock);
+        
+        block();
+        
+        os_unfair_lock_lock(&self->_lock);
+        BOOL scheduled = (self.pendingBlocks.count != 0);
+        self.scheduled = scheduled;
+        os_unfair_lock_unlock(&self->_lock);
+        
+        if (scheduled) {
+            [self scheduleNextBlock];
+        }
+    } withQualityOfService:self.qualityOfService];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfPendingBlocks = self.pendingBlocks.count;
+    os_unfair_lock_unlock(&_lock);
+    
+    return [NSString stringWithFormat:@"<%@: %p; executor = %@; numberOfPendingBlocks = %@>",
+            self.class,
+            self,
+            self.executor,
+            @(numberOfPendingBlocks)];
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSUInteger SRGParsingExecutorQualityOfServiceIndex(NSQualityOfService qualityOfService)
+{
+    for (NSUInteger i = 0; i < SRGParsingExecutorQualitiesOfServiceCount; i++) {
+        if (SRGParsingExecutorQualitiesOfService[i] == qualityOfService) {
+            return i;
+        }
+    }
+    
+    // Same index as `NSQualityOfServiceDefault`
+    return 2;
+}
+
+static qos_class_t SRGParsingExecutorQOSClass(NSQualityOfService qualityOfService)
+{
+    switch (qualityOfService) {
+        case NSQualityOfServiceUserInteractive: {
+            return QOS_CLASS_USER_INTERACTIVE;
+        }
+        
+        case NSQualityOfServiceUserInitiated: {
+            return QOS_CLASS_USER_INITIATED;
+        }
+        
+        case NSQualityOfServiceUtility: {
+            return QOS_CLASS_UTILITY;
+        }
+        
+        case NSQualityOfServiceBackground: {
+            return QOS_CLASS_BACKGROUND;
+        }
+        
+        default: {
+            return QOS_CLASS_DEFAULT;
+        }
+    }
+}
@@ -54,4 +54,20 @@
     } extractor:nil completionBlock:completionBlock];
 }
 
++ (SRGRequest *)JSONStreamRequestWithURLRequest:(NSURLRequest *)URLRequest
+                                        session:(NSURLSession *)session
+                                   elementBlock:(SRGJSONElementBlock)elementBlock
+                                completionBlock:(SRGObjectCompletionBlock)completionBlock
+{
+    SRGRequest *request = [[self.class alloc] initWithURLRequest:URLRequest
+                                                         session:session
+                                                          parser:nil
+                                                       extractor:nil
+                                                 completionBlock:completionBlock];
+    request.streamParserProvider = ^{
+        return [[SRGJSONStreamParser alloc] initWithElementBlock:elementBlock];
+    };
+    return request;
+}
+
 @end
@@ -0,0 +1,28 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGBatchTask.h"
+#import "SRGRequestBatcher.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGRequestBatcher (Private)
+
+/**
+ *  Attach a subscriber for the specified key to the batch currently collecting keys, or to a new batch if none is
+ *  available. Can be called from any thread.
+ */
+- (SRGBatchTask *)taskForKey:(NSString *)key
+                  subscriber:(id)subscriber
+                    priority:(float)priority
+           completionHandler:(SRGBatchTaskCompletionHandler)completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,157 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRequestBatcher.h"
+
+#import "SRGBaseRequest+Private.h"
+#import "SRGRequestBatcher+Private.h"
+
+#import <os/lock.h>
+
+@interface SRGRequestBatcher () {
+@private
+    os_unfair_lock _lock;
+    NSUInteger _numberOfBatches;
+}
+
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic) NSTimeInterval window;
+@property (nonatomic) NSUInteger maximumBatchSize;
+@property (nonatomic, copy) SRGBatchBuilder builder;
+@property (nonatomic, copy) SRGBatchSplitter splitter;
+
+@property (nonatomic) SRGBatchTask *pendingTask;
+
+@end
+
+@implementation SRGRequestBatcher
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithSession:(NSURLSession *)session
+                         window:(NSTimeInterval)window
+               maximumBatchSize:(NSUInteger)maximumBatchSize
+                        builder:(SRGBatchBuilder)builder
+                       splitter:(SRGBatchSplitter)splitter
+{
+    if (self = [super init]) {
+        self.session = session;
+        self.window = fmax(window, 0.);
+        self.maximumBatchSize = MAX(maximumBatchSize, 1);
+        self.builder = builder;
+        self.splitter = splitter;
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithSession:NSURLSession.sharedSession window:0. maximumBatchSize:1 builder:^NSURLRequest * _Nonnull(NSArray<NSString *> * _Nonnull keys) {
+        return [NSURLRequest new];
+    } splitter:^NSDictionary<NSString *, id> * _Nullable(NSData * _Nonnull data, NSArray<NSString *> * _Nonnull keys, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        return nil;
+    }];
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfBatches
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfBatches = _numberOfBatches;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfBatches;
+}
+
+#pragma mark Requests
+
+- (SRGRequest *)requestForKey:(NSString *)key completionBlock:(SRGObjectCompletionBlock)completionBlock
+{
+    // The request built for the key alone describes the logical request (e.g. for logs or request queue errors), but
+    // is never performed as is
+    NSURLRequest *URLRequest = self.builder(@[ key ]);
+    SRGRequest *request = [SRGRequest objectRequestWithURLRequest:URLRequest session:self.session parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        // Objects are obtained by splitting the batch response, see `SRGBatchTask`
+        return data;
+    } completionBlock:completionBlock];
+    request.batcher = self;
+    request.batchKey = key;
+    return request;
+}
+
+#pragma mark Batches
+
+- (SRGBatchTask *)taskForKey:(NSString *)key subscriber:(id)subscriber priority:(float)priority completionHandler:(SRGBatchTaskCompletionHandler)completionHandler
+{
+    os_unfair_lock_lock(&_lock);
+    SRGBatchTask *batchTask = self.pendingTask;
+    BOOL created = NO;
+    if (! batchTask) {
+        batchTask = [[SRGBatchTask alloc] initWithSession:self.session builder:self.builder splitter:self.splitter];
+        self.pendingTask = batchTask;
+        created = YES;
+    }
+    [batchTask addSubscriber:subscriber forKey:key priority:priority completionHandler:completionHandler];
+    
+    // Full batches are started immediately, others when their window ends
+    BOOL full = (batchTask.numberOfKeys >= self.maximumBatchSize);
+    if (full) {
+        self.pendingTask = nil;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (full) {
+        [self startTask:batchTask];
+    }
+    else if (created) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.window * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            [self startPendingTask:batchTask];
+        });
+    }
+    return batchTask;
+}
+
+- (void)startPendingTask:(SRGBatchTask *)batchTask
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL pending = (self.pendingTask == batchTask);
+    if (pending) {
+        self.pendingTask = nil;
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    // Tasks which were full have already been started
+    if (pending) {
+        [self startTask:batchTask];
+    }
+}
+
+- (void)startTask:(SRGBatchTask *)batchTask
+{
+    if (! [batchTask start]) {
+        return;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    _numberOfBatches++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; window = %@; maximumBatchSize = %@; numberOfBatches = %@>",
+            self.class,
+            self,
+            @(self.window),
+            @(self.maximumBatchSize),
+            @(self.numberOfBatches)];
+}
+
+@end
@@ -0,0 +1,42 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAtomicHistogram.h"
+#import "SRGRequestMetrics.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGRequestMetrics (Private)
+
+/**
+ *  Create metrics for the specified request, started now, and recorded into the specified histograms (one per phase)
+ *  when finished.
+ */
+- (instancetype)initWithURLRequest:(NSURLRequest *)URLRequest endpoint:(NSString *)endpoint histograms:(NSArray<SRGAtomicHistogram *> *)histograms;
+
+/**
+ *  Mark the beginning and the end of the specified phase. Phases can be measured several times, in which case only
+ *  the last measurement is kept.
+ */
+- (void)beginPhase:(SRGRequestPhase)phase;
+- (void)endPhase:(SRGRequestPhase)phase;
+
+/**
+ *  Extract transport phase durations from metrics collected by the URL loading system.
+ */
+- (void)applyTaskMetrics:(NSURLSessionTaskMetrics *)taskMetrics;
+
+/**
+ *  End the total phase and record all measured durations into the histograms. Metrics are recorded at most once.
+ */
+- (void)finish;
+
+@end
+
+NS_ASSUME_NONNULL_END
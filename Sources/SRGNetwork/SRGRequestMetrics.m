@@ -0,0 +1,171 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRequestMetrics+Private.h"
+
+#import <os/lock.h>
+#import <time.h>
+
+static NSTimeInterval SRGRequestMetricsDurationBetweenDates(NSDate *startDate, NSDate *endDate);
+
+@interface SRGRequestMetrics () {
+@private
+    os_unfair_lock _lock;
+    uint64_t _phaseStartTimes[SRGRequestPhaseCount];
+    NSTimeInterval _durations[SRGRequestPhaseCount];
+    BOOL _finished;
+}
+
+@property (nonatomic) NSURLRequest *URLRequest;
+@property (nonatomic, copy) NSString *endpoint;
+@property (nonatomic) NSDate *startDate;
+@property (nonatomic) NSArray<SRGAtomicHistogram *> *histograms;
+
+@end
+
+@implementation SRGRequestMetrics
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithURLRequest:(NSURLRequest *)URLRequest endpoint:(NSString *)endpoint histograms:(NSArray<SRGAtomicHistogram *> *)histograms
+{
+    if (self = [super init]) {
+        self.URLRequest = URLRequest;
+        self.endpoint = endpoint;
+        self.startDate = NSDate.date;
+        self.histograms = histograms;
+        _lock = OS_UNFAIR_LOCK_INIT;
+        for (NSInteger i = 0; i < SRGRequestPhaseCount; i++) {
+            _durations[i] = -1.;
+        }
+        _phaseStartTimes[SRGRequestPhaseTotal] = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    }
+    return self;
+}
+
+#pragma mark Durations
+
+- (NSTimeInterval)durationForPhase:(SRGRequestPhase)phase
+{
+    if (phase < 0 || phase >= SRGRequestPhaseCount) {
+        return -1.;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    NSTimeInterval duration = _durations[phase];
+    os_unfair_lock_unlock(&_lock);
+    return duration;
+}
+
+- (void)beginPhase:(SRGRequestPhase)phase
+{
+    uint64_t time = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    
+    os_unfair_lock_lock(&_lock);
+    _phaseStartTimes[phase] = time;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)endPhase:(SRGRequestPhase)phase
+{
+    uint64_t time = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    
+    os_unfair_lock_lock(&_lock);
+    if (_phaseStartTimes[phase] != 0) {
+        _durations[phase] = (NSTimeInterval)(time - _phaseStartTimes[phase]) / NSEC_PER_SEC;
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)applyTaskMetrics:(NSURLSessionTaskMetrics *)taskMetrics
+{
+    // Earlier transactions correspond to redirects
+    NSURLSessionTaskTransactionMetrics *transactionMetrics = taskMetrics.transactionMetrics.lastObject;
+    if (! transactionMetrics) {
+        return;
+    }
+    
+    // Reused connections involve no lookup or connection establishment at all
+    BOOL reusedConnection = transactionMetrics.reusedConnection;
+    
+    os_unfair_lock_lock(&_lock);
+    _durations[SRGRequestPhaseDomainLookup] = reusedConnection ? 0. : SRGRequestMetricsDurationBetweenDates(transactionMetrics.domainLookupStartDate, transactionMetrics.domainLookupEndDate);
+    _durations[SRGRequestPhaseConnect] = reusedConnection ? 0. : SRGRequestMetricsDurationBetweenDates(transactionMetrics.connectStartDate, transactionMetrics.connectEndDate);
+    _durations[SRGRequestPhaseSecureConnection] = reusedConnection ? 0. : SRGRequestMetricsDurationBetweenDates(transactionMetrics.secureConnectionStartDate, transactionMetrics.secureConnectionEndDate);
+    _durations[SRGRequestPhaseTimeToFirstByte] = SRGRequestMetricsDurationBetweenDates(transactionMetrics.requestStartDate, transactionMetrics.responseStartDate);
+    _durations[SRGRequestPhaseDownload] = SRGRequestMetricsDurationBetweenDates(transactionMetrics.responseStartDate, transactionMetrics.responseEndDate);
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)finish
+{
+    [self endPhase:SRGRequestPhaseTotal];
+    
+    NSTimeInterval durations[SRGRequestPhaseCount];
+    
+    os_unfair_lock_lock(&_lock);
+    BOOL finished = _finished;
+    _finished = YES;
+    memcpy(durations, _durations, sizeof(durations));
+    os_unfair_lock_unlock(&_lock);
+    
+    if (finished) {
+        return;
+    }
+    
+    [self.histograms enumerateObjectsUsingBlock:^(SRGAtomicHistogram * _Nonnull histogram, NSUInteger idx, BOOL * _Nonnull stop) {
+        [histogram recordDuration:durations[idx]];
+    }];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    NSMutableArray<NSString *> *durationDescriptions = [NSMutableArray array];
+    for (NSInteger i = 0; i < SRGRequestPhaseCount; i++) {
+        NSTimeInterval duration = [self durationForPhase:i];
+        if (duration >= 0.) {
+            [durationDescriptions addObject:[NSString stringWithFormat:@"%@ = %.3f", SRGRequestPhaseName(i), duration]];
+        }
+    }
+    
+    return [NSString stringWithFormat:@"<%@: %p; URL = %@; endpoint = %@; durations = {%@}>",
+            self.class,
+            self,
+            self.URLRequest.URL,
+            self.endpoint,
+            [durationDescriptions componentsJoinedByString:@"; "]];
+}
+
+@end
+
+#pragma mark Functions
+
+NSString *SRGRequestPhaseName(SRGRequestPhase phase)
+{
+    static NSDictionary<NSNumber *, NSString *> *s_names;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_names = @{ @(SRGRequestPhaseDomainLookup) : @"domainLookup",
+                     @(SRGRequestPhaseConnect) : @"connect",
+                     @(SRGRequestPhaseSecureConnection) : @"secureConnection",
+                     @(SRGRequestPhaseTimeToFirstByte) : @"timeToFirstByte",
+                     @(SRGRequestPhaseDownload) : @"download",
+                     @(SRGRequestPhaseParsing) : @"parsing",
+                     @(SRGRequestPhaseExtraction) : @"extraction",
+                     @(SRGRequestPhaseDelivery) : @"delivery",
+                     @(SRGRequestPhaseTotal) : @"total" };
+    });
+    return s_names[@(phase)] ?: @"unknown";
+}
+
+#pragma mark Static functions
+
+static NSTimeInterval SRGRequestMetricsDurationBetweenDates(NSDate *startDate, NSDate *endDate)
+{
+    return (startDate && endDate) ? [endDate timeIntervalSinceDate:startDate] : -1.;
+}
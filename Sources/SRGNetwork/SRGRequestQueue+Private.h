@@ -0,0 +1,34 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRequestQueue.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGRequestQueue (Private)
+
+/**
+ *  Must be called by requests belonging to the queue when their running status changes. Can be called from any thread.
+ */
+- (void)requestRunningStatusDidChange:(SRGBaseRequest *)request;
+
+/**
+ *  Must be called by requests belonging to the queue when they are cancelled. Can be called from any thread.
+ */
+- (void)requestWasCancelled:(SRGBaseRequest *)request;
+
+/**
+ *  The date at which the time budget of the current run is exhausted, `nil` if the queue is not running or has no
+ *  time budget.
+ */
+@property (nonatomic, readonly, nullable) NSDate *deadline;
+
+@end
+
+NS_ASSUME_NONNULL_END
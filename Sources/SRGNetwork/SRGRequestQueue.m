@@ -7,22 +7,55 @@
 #import "SRGRequestQueue.h"
 
 #import "NSBundle+SRGNetwork.h"
+#import "SRGBaseRequest+Private.h"
+#import "SRGMainQueueDelivery.h"
 #import "SRGNetworkError.h"
 #import "SRGNetworkLogger.h"
+#import "SRGRequestQueue+Private.h"
+
+#import <os/lock.h>
 
 @import libextobjc;
-@import MAKVONotificationCenter;
 
-static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relationshipTable = nil;
+// Entry for a request waiting to be started. Entries are removed lazily from their priority bucket, their request
+// being cleared when it is not pending anymore.
+@interface SRGPendingRequest : NSObject
+
+@property (nonatomic) SRGBaseRequest *request;
 
-@interface SRGRequestQueue ()
+@end
+
+@interface SRGRequestQueue () {
+@private
+    os_unfair_lock _lock;
+    NSDate *_deadline;
+}
 
 @property (nonatomic) SRGRequestQueueOptions options;
 
-@property (nonatomic, readonly) NSSet<SRGBaseRequest *> *requests;
+// All requests added to the queue (weak)
+@property (nonatomic) NSHashTable<SRGBaseRequest *> *requests;
+
+// Running requests, including admitted requests about to be started (strong, but running requests retain themselves
+// anyway)
+@property (nonatomic) NSHashTable<SRGBaseRequest *> *runningRequests;
+
+// Requests waiting to be started, with their entries
+@property (nonatomic) NSMapTable<SRGBaseRequest *, SRGPendingRequest *> *pendingRequests;
+
+// Pending request entries in FIFO order for each priority, and the priorities having entries, in decreasing order
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSMutableArray<SRGPendingRequest *> *> *pendingRequestBuckets;
+@property (nonatomic) NSMutableArray<NSNumber *> *pendingPriorities;
+
+@property (nonatomic) NSUInteger maximumNumberOfConcurrentRequests;
+@property (nonatomic) SRGRetryPolicy *retryPolicy;
+@property (nonatomic) NSTimeInterval timeBudget;
+
 @property (nonatomic, copy) void (^stateChangeBlock)(BOOL running, NSError *error);
 @property (nonatomic) NSMutableArray<NSError *> *errors;
-@property (nonatomic, getter=isRunning) BOOL running;
+
+// State change block calls not yet performed, in transition order
+@property (nonatomic) NSMutableArray<dispatch_block_t> *pendingStateChanges;
 
 @end
 
@@ -32,14 +65,10 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
 
 #pragma mark Class methods
 
-+ (void)initialize
++ (BOOL)automaticallyNotifiesObserversOfRunning
 {
-    if (self != SRGRequestQueue.class) {
-        return;
-    }
-    
-    s_relationshipTable = [NSMapTable mapTableWithKeyOptions:NSHashTableWeakMemory
-                                                valueOptions:NSHashTableStrongMemory];
+    // Notifications are sent manually, outside the lock
+    return NO;
 }
 
 #pragma mark Object lifecycle
@@ -47,9 +76,16 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
 - (instancetype)initWithStateChangeBlock:(void (^)(BOOL, NSError *))stateChangeBlock
 {
     if (self = [super init]) {
+        self.requests = [NSHashTable hashTableWithOptions:NSHashTableWeakMemory | NSHashTableObjectPointerPersonality];
+        self.runningRequests = [NSHashTable hashTableWithOptions:NSHashTableStrongMemory | NSHashTableObjectPointerPersonality];
+        self.pendingRequests = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                     valueOptions:NSPointerFunctionsStrongMemory];
+        self.pendingRequestBuckets = [NSMutableDictionary dictionary];
+        self.pendingPriorities = [NSMutableArray array];
         self.errors = [NSMutableArray array];
+        self.pendingStateChanges = [NSMutableArray array];
         self.stateChangeBlock = stateChangeBlock;
-        [s_relationshipTable setObject:[NSHashTable hashTableWithOptions:NSHashTableWeakMemory] forKey:self];
+        _lock = OS_UNFAIR_LOCK_INIT;
     }
     return self;
 }
@@ -61,18 +97,35 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
 
 - (void)dealloc
 {
-    for (SRGBaseRequest *request in self.requests) {
+    for (SRGBaseRequest *request in self.requests.allObjects) {
         [request cancel];
     }
-    
-    [s_relationshipTable removeObjectForKey:self];
 }
 
 #pragma mark Getters and setters
 
-- (NSArray<SRGBaseRequest *> *)requests
+- (NSArray<SRGBaseRequest *> *)allRequests
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<SRGBaseRequest *> *requests = self.requests.allObjects;
+    os_unfair_lock_unlock(&_lock);
+    return requests;
+}
+
+- (BOOL)isRunning
 {
-    return [s_relationshipTable objectForKey:self].copy;
+    os_unfair_lock_lock(&_lock);
+    BOOL running = _running;
+    os_unfair_lock_unlock(&_lock);
+    return running;
+}
+
+- (NSDate *)deadline
+{
+    os_unfair_lock_lock(&_lock);
+    NSDate *deadline = _deadline;
+    os_unfair_lock_unlock(&_lock);
+    return deadline;
 }
 
 #pragma mark Options
@@ -81,6 +134,30 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
 {
     SRGRequestQueue *requestQueue = [[self.class alloc] initWithStateChangeBlock:self.stateChangeBlock];
     requestQueue.options = options;
+    requestQueue.maximumNumberOfConcurrentRequests = self.maximumNumberOfConcurrentRequests;
+    requestQueue.retryPolicy = self.retryPolicy;
+    requestQueue.timeBudget = self.timeBudget;
+    return requestQueue;
+}
+
+- (SRGRequestQueue *)requestQueueWithMaximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+{
+    SRGRequestQueue *requestQueue = [self requestQueueWithOptions:self.options];
+    requestQueue.maximumNumberOfConcurrentRequests = maximumNumberOfConcurrentRequests;
+    return requestQueue;
+}
+
+- (SRGRequestQueue *)requestQueueWithRetryPolicy:(SRGRetryPolicy *)retryPolicy
+{
+    SRGRequestQueue *requestQueue = [self requestQueueWithOptions:self.options];
+    requestQueue.retryPolicy = retryPolicy;
+    return requestQueue;
+}
+
+- (SRGRequestQueue *)requestQueueWithTimeBudget:(NSTimeInterval)timeBudget
+{
+    SRGRequestQueue *requestQueue = [self requestQueueWithOptions:self.options];
+    requestQueue.timeBudget = fmax(timeBudget, 0.);
     return requestQueue;
 }
 
@@ -88,36 +165,49 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
 
 - (void)addRequest:(SRGBaseRequest *)request resume:(BOOL)resume
 {
-    NSHashTable<SRGBaseRequest *> *requests = [s_relationshipTable objectForKey:self];
-    if ([requests containsObject:request]) {
+    os_unfair_lock_lock(&_lock);
+    BOOL added = ! [self.requests containsObject:request];
+    if (added) {
+        [self.requests addObject:request];
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (! added) {
         return;
     }
-    [requests addObject:request];
     
-    @weakify(self)
-    [request addObserver:self keyPath:@keypath(request, running) options:NSKeyValueObservingOptionNew block:^(MAKVONotification *notification) {
-        @strongify(self)
-        
-        [self checkStateChange];
-    }];
+    // From now on, status changes are reported by the request itself (to all queues it belongs to). Synchronize with its
+    // current status in case it changed before the queue was attached.
+    [request addRequestQueue:self];
     
     if (resume) {
-        [request resume];
+        [self scheduleRequests:@[ request ]];
+    }
+    else {
+        [self requestRunningStatusDidChange:request];
     }
-    
-    [self checkStateChange];
 }
 
 - (void)resume
 {
-    for (SRGBaseRequest *request in self.requests) {
-        [request resume];
-    }
+    [self scheduleRequests:[self allRequests]];
 }
 
 - (void)cancel
 {
-    for (SRGBaseRequest *request in self.requests) {
+    // Discard pending requests first, so that they are not started when running ones are cancelled
+    os_unfair_lock_lock(&_lock);
+    [self removeAllPendingRequests];
+    NSError *error = nil;
+    BOOL changed = [self updateRunningStatusWithError:&error];
+    BOOL running = _running;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (changed) {
+        [self reportRunningStatus:running error:error];
+    }
+    
+    for (SRGBaseRequest *request in [self allRequests]) {
         [request cancel];
     }
 }
@@ -128,60 +218,290 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
         return;
     }
     
-    if (! self.running) {
+    os_unfair_lock_lock(&_lock);
+    BOOL running = _running;
+    if (running) {
+        [self.errors addObject:error];
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (! running) {
         SRGNetworkLogInfo(@"Request Queue", @"The error %@ was reported to a non-running queue and will therefore be lost.", error);
         return;
     }
     
-    [self.errors addObject:error];
-    
     if ((self.options & SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled) != 0) {
         [self cancel];
     }
 }
 
-#pragma mark State management
+#pragma mark Scheduling
+
+- (void)scheduleRequests:(NSArray<SRGBaseRequest *> *)requests
+{
+    os_unfair_lock_lock(&_lock);
+    for (SRGBaseRequest *request in requests) {
+        if (request.running) {
+            [self.runningRequests addObject:request];
+            continue;
+        }
+        else if ([self.runningRequests containsObject:request] || [self.pendingRequests objectForKey:request]) {
+            continue;
+        }
+        
+        [self addPendingRequest:request];
+    }
+    NSArray<SRGBaseRequest *> *admittedRequests = [self admitPendingRequests];
+    NSError *error = nil;
+    BOOL changed = [self updateRunningStatusWithError:&error];
+    BOOL running = _running;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (changed) {
+        [self reportRunningStatus:running error:error];
+    }
+    
+    for (SRGBaseRequest *request in admittedRequests) {
+        [request resume];
+    }
+}
+
+// Must be called with the lock held. Admitted requests are considered running and must be resumed afterwards.
+- (NSArray<SRGBaseRequest *> *)admitPendingRequests
+{
+    NSUInteger maximumNumberOfConcurrentRequests = self.maximumNumberOfConcurrentRequests;
+    NSMutableArray<SRGBaseRequest *> *admittedRequests = [NSMutableArray array];
+    while (self.pendingRequests.count != 0 && (maximumNumberOfConcurrentRequests == 0 || self.runningRequests.count < maximumNumberOfConcurrentRequests)) {
+        SRGBaseRequest *request = [self dequeuePendingRequest];
+        [self.runningRequests addObject:request];
+        [admittedRequests addObject:request];
+    }
+    return admittedRequests.copy;
+}
+
+#pragma mark Pending requests
 
-- (void)checkStateChange
+// Must be called with the lock held. The request is started after pending requests with higher or equal priority.
+- (void)addPendingRequest:(SRGBaseRequest *)request
 {
-    // Running iff at least one request is running
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == YES", @keypath(SRGBaseRequest.new, running)];
-    BOOL running = ([self.requests.allObjects filteredArrayUsingPredicate:predicate].count != 0);
-    if (running != self.running) {
-        self.running = running;
+    SRGPendingRequest *pendingRequest = [[SRGPendingRequest alloc] init];
+    pendingRequest.request = request;
+    [self.pendingRequests setObject:pendingRequest forKey:request];
+    
+    NSNumber *priority = @(request.priority);
+    NSMutableArray<SRGPendingRequest *> *bucket = self.pendingRequestBuckets[priority];
+    if (! bucket) {
+        bucket = [NSMutableArray array];
+        self.pendingRequestBuckets[priority] = bucket;
         
-        if (running) {
-            [self.errors removeAllObjects];
-            
-            SRGNetworkLogDebug(@"Request Queue", @"Started %@", self);
-            
-            if (NSThread.isMainThread) {
-                self.stateChangeBlock ? self.stateChangeBlock(NO, nil) : nil;
-            }
-            else {
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    self.stateChangeBlock ? self.stateChangeBlock(NO, nil) : nil;
-                });
-            }
+        NSUInteger index = [self.pendingPriorities indexOfObject:priority inSortedRange:NSMakeRange(0, self.pendingPriorities.count) options:NSBinarySearchingInsertionIndex usingComparator:^NSComparisonResult(NSNumber * _Nonnull priority1, NSNumber * _Nonnull priority2) {
+            return [priority2 compare:priority1];
+        }];
+        [self.pendingPriorities insertObject:priority atIndex:index];
+    }
+    [bucket addObject:pendingRequest];
+}
+
+// Must be called with the lock held
+- (void)removePendingRequest:(SRGBaseRequest *)request
+{
+    SRGPendingRequest *pendingRequest = [self.pendingRequests objectForKey:request];
+    if (! pendingRequest) {
+        return;
+    }
+    
+    pendingRequest.request = nil;
+    [self.pendingRequests removeObjectForKey:request];
+    
+    if (self.pendingRequests.count == 0) {
+        [self removeAllPendingRequests];
+    }
+}
+
+// Must be called with the lock held. Return the pending request with highest priority (first added for the same
+// priority), `nil` if none.
+- (SRGBaseRequest *)dequeuePendingRequest
+{
+    while (self.pendingPriorities.count != 0) {
+        NSNumber *priority = self.pendingPriorities.firstObject;
+        NSMutableArray<SRGPendingRequest *> *bucket = self.pendingRequestBuckets[priority];
+        SRGPendingRequest *pendingRequest = bucket.firstObject;
+        [bucket removeObjectAtIndex:0];
+        if (bucket.count == 0) {
+            [self.pendingRequestBuckets removeObjectForKey:priority];
+            [self.pendingPriorities removeObjectAtIndex:0];
         }
-        else {
-            NSError *error = (self.errors.count <= 1) ? self.errors.firstObject : [NSError errorWithDomain:SRGNetworkErrorDomain
-                                                                                                      code:SRGNetworkErrorMultiple
-                                                                                                  userInfo:@{ NSLocalizedDescriptionKey : SRGNetworkLocalizedString(@"Several errors have been encountered", @"The main error message if multiple errors have been encountered. Finally, the developer could should which one to display, and not show this message."),
-                                                                                                              SRGNetworkErrorsKey : self.errors }];
-            
-            SRGNetworkLogDebug(@"Request Queue", @"Ended %@ with error: %@", self, error);
-            
-            if (NSThread.isMainThread) {
-                self.stateChangeBlock ? self.stateChangeBlock(YES, error) : nil;
-            }
-            else {
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    self.stateChangeBlock ? self.stateChangeBlock(YES, error) : nil;
-                });
-            }
+        
+        SRGBaseRequest *request = pendingRequest.request;
+        if (request) {
+            pendingRequest.request = nil;
+            [self.pendingRequests removeObjectForKey:request];
+            return request;
         }
     }
+    return nil;
+}
+
+// Must be called with the lock held
+- (void)removeAllPendingRequests
+{
+    for (SRGPendingRequest *pendingRequest in self.pendingRequests.objectEnumerator) {
+        pendingRequest.request = nil;
+    }
+    [self.pendingRequests removeAllObjects];
+    [self.pendingRequestBuckets removeAllObjects];
+    [self.pendingPriorities removeAllObjects];
+}
+
+#pragma mark State management
+
+- (void)requestRunningStatusDidChange:(SRGBaseRequest *)request
+{
+    // Always reconcile with the current request status, so that notifications received out of order are harmless
+    BOOL requestRunning = request.running;
+    
+    os_unfair_lock_lock(&_lock);
+    if (requestRunning) {
+        // Pending requests might be resumed directly
+        [self removePendingRequest:request];
+        [self.runningRequests addObject:request];
+    }
+    else {
+        [self.runningRequests removeObject:request];
+    }
+    NSArray<SRGBaseRequest *> *admittedRequests = [self admitPendingRequests];
+    NSError *error = nil;
+    BOOL changed = [self updateRunningStatusWithError:&error];
+    BOOL running = _running;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (changed) {
+        [self reportRunningStatus:running error:error];
+    }
+    
+    for (SRGBaseRequest *admittedRequest in admittedRequests) {
+        [admittedRequest resume];
+    }
+}
+
+- (void)requestWasCancelled:(SRGBaseRequest *)request
+{
+    os_unfair_lock_lock(&_lock);
+    [self removePendingRequest:request];
+    
+    // Requests admitted but not started yet will not report any status change
+    if (! request.running) {
+        [self.runningRequests removeObject:request];
+    }
+    NSArray<SRGBaseRequest *> *admittedRequests = [self admitPendingRequests];
+    NSError *error = nil;
+    BOOL changed = [self updateRunningStatusWithError:&error];
+    BOOL running = _running;
+    os_unfair_lock_unlock(&_lock);
+    
+    if (changed) {
+        [self reportRunningStatus:running error:error];
+    }
+    
+    for (SRGBaseRequest *admittedRequest in admittedRequests) {
+        [admittedRequest resume];
+    }
+}
+
+// Must be called with the lock held. Return `YES` iff the running status changed.
+- (BOOL)updateRunningStatusWithError:(NSError * __autoreleasing *)pError
+{
+    // Running iff at least one request is running or waiting to be started
+    BOOL running = (self.runningRequests.count != 0 || self.pendingRequests.count != 0);
+    if (running == _running) {
+        return NO;
+    }
+    
+    _running = running;
+    
+    // Each run has its own time budget
+    NSTimeInterval timeBudget = self.timeBudget;
+    _deadline = (running && timeBudget > 0.) ? [NSDate dateWithTimeIntervalSinceNow:timeBudget] : nil;
+    
+    NSError *error = nil;
+    if (running) {
+        [self.errors removeAllObjects];
+    }
+    else {
+        error = [self consolidatedError];
+    }
+    
+    // Recorded within the lock so that state changes are always reported in transition order
+    void (^stateChangeBlock)(BOOL, NSError *) = self.stateChangeBlock;
+    if (stateChangeBlock) {
+        [self.pendingStateChanges addObject:^{
+            stateChangeBlock(! running, error);
+        }];
+    }
+    
+    if (pError) {
+        *pError = error;
+    }
+    return YES;
+}
+
+- (void)reportRunningStatus:(BOOL)running error:(NSError *)error
+{
+    [self willChangeValueForKey:@keypath(self, running)];
+    [self didChangeValueForKey:@keypath(self, running)];
+    
+    if (running) {
+        SRGNetworkLogDebug(@"Request Queue", @"Started %@", self);
+    }
+    else {
+        SRGNetworkLogDebug(@"Request Queue", @"Ended %@ with error: %@", self, error);
+    }
+    
+    // Delivered through the same main queue path as request completion blocks, so that the relative order of
+    // completion and state change blocks is preserved
+    if (NSThread.isMainThread) {
+        [self performPendingStateChanges];
+    }
+    else {
+        [SRGMainQueueDelivery deliverBlock:^{
+            [self performPendingStateChanges];
+        }];
+    }
+}
+
+- (void)performPendingStateChanges
+{
+    // State change blocks might release the last reference to the queue
+    SRGRequestQueue *requestQueue = self;
+    
+    while (YES) {
+        os_unfair_lock_lock(&requestQueue->_lock);
+        dispatch_block_t stateChange = requestQueue.pendingStateChanges.firstObject;
+        if (stateChange) {
+            [requestQueue.pendingStateChanges removeObjectAtIndex:0];
+        }
+        os_unfair_lock_unlock(&requestQueue->_lock);
+        
+        if (! stateChange) {
+            break;
+        }
+        
+        stateChange();
+    }
+}
+
+// Must be called with the lock held
+- (NSError *)consolidatedError
+{
+    if (self.errors.count <= 1) {
+        return self.errors.firstObject;
+    }
+    else {
+        return [NSError errorWithDomain:SRGNetworkErrorDomain
+                                   code:SRGNetworkErrorMultiple
+                               userInfo:@{ NSLocalizedDescriptionKey : SRGNetworkLocalizedString(@"Several errors have been encountered", @"The main error message if multiple errors have been encountered. Finally, the developer could should which one to display, and not show this message."),
+                                           SRGNetworkErrorsKey : self.errors.copy }];
+    }
 }
 
 #pragma mark Description
@@ -191,8 +511,12 @@ static NSMapTable<SRGRequestQueue *, NSHashTable<SRGBaseRequest *> *> *s_relatio
     return [NSString stringWithFormat:@"<%@: %p; requests = %@; running = %@>",
             self.class,
             self,
-            self.requests,
+            [self allRequests],
             self.running ? @"YES" : @"NO"];
 }
 
 @end
+
+@implementation SRGPendingRequest
+
+@end
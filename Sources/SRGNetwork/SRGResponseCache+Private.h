@@ -0,0 +1,53 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGCachedResponse.h"
+#import "SRGResponseCache.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Return a key identifying the specified request by its method, URL and headers (in a canonical order). Requests with
+ *  equal keys are equivalent.
+ */
+OBJC_EXPORT NSString *SRGResponseCacheKey(NSURLRequest *URLRequest);
+
+/**
+ *  Private category for implementation purposes.
+ */
+@interface SRGResponseCache (Private)
+
+/**
+ *  Return `YES` iff responses to the specified request can be cached.
+ */
++ (BOOL)isCacheableURLRequest:(NSURLRequest *)URLRequest;
+
+/**
+ *  Return the cached response for the specified request, if any.
+ */
+- (nullable SRGCachedResponse *)cachedResponseForURLRequest:(NSURLRequest *)URLRequest;
+
+/**
+ *  Store a response received for the specified request, if cacheable. Return the stored cached response, if any.
+ */
+- (nullable SRGCachedResponse *)storeResponse:(NSHTTPURLResponse *)response data:(NSData *)data forURLRequest:(NSURLRequest *)URLRequest;
+
+/**
+ *  Revalidate the cached response for the specified request with a `304 Not Modified` response. Return the updated cached
+ *  response, or `nil` if no cached response is available anymore.
+ */
+- (nullable SRGCachedResponse *)revalidateCachedResponseForURLRequest:(NSURLRequest *)URLRequest withResponse:(NSHTTPURLResponse *)response;
+
+/**
+ *  Statistics recording.
+ */
+- (void)recordHit;
+- (void)recordStaleHit;
+- (void)recordMiss;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,524 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGResponseCache.h"
+
+#import "SRGNetworkLogger.h"
+#import "SRGResponseCache+Private.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <os/lock.h>
+
+static NSString * const SRGResponseCacheDataExtension = @"data";
+static NSString * const SRGResponseCacheMetadataExtension = @"metadata";
+
+static NSString *SRGResponseCacheFileName(NSString *key);
+
+@interface SRGResponseCache () {
+@private
+    os_unfair_lock _lock;
+}
+
+// Memory tier (protected by the lock). Keys are ordered from the least to the most recently used one.
+@property (nonatomic) NSMutableDictionary<NSString *, SRGCachedResponse *> *memoryCachedResponses;
+@property (nonatomic) NSMutableOrderedSet<NSString *> *memoryKeys;
+
+// Disk tier (only accessed from the disk queue). File names are ordered from the least to the most recently used one.
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) dispatch_queue_t diskQueue;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *> *diskSizes;
+@property (nonatomic) NSMutableOrderedSet<NSString *> *diskFileNames;
+
+@end
+
+@implementation SRGResponseCache
+
+@synthesize memoryCapacity = _memoryCapacity;
+@synthesize diskCapacity = _diskCapacity;
+@synthesize currentMemoryUsage = _currentMemoryUsage;
+@synthesize currentDiskUsage = _currentDiskUsage;
+@synthesize numberOfHits = _numberOfHits;
+@synthesize numberOfRevalidations = _numberOfRevalidations;
+@synthesize numberOfStaleHits = _numberOfStaleHits;
+@synthesize numberOfMisses = _numberOfMisses;
+@synthesize numberOfEvictions = _numberOfEvictions;
+
+#pragma mark Class methods
+
++ (SRGResponseCache *)sharedCache
+{
+    static SRGResponseCache *s_sharedCache;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_sharedCache = [[SRGResponseCache alloc] initWithMemoryCapacity:4 * 1024 * 1024 diskCapacity:20 * 1024 * 1024 directoryURL:nil];
+    });
+    return s_sharedCache;
+}
+
++ (BOOL)isCacheableURLRequest:(NSURLRequest *)URLRequest
+{
+    if (URLRequest.HTTPBody || URLRequest.HTTPBodyStream) {
+        return NO;
+    }
+    
+    NSString *HTTPMethod = URLRequest.HTTPMethod.uppercaseString ?: @"GET";
+    return [HTTPMethod isEqualToString:@"GET"];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithMemoryCapacity:(NSUInteger)memoryCapacity diskCapacity:(NSUInteger)diskCapacity directoryURL:(NSURL *)directoryURL
+{
+    if (self = [super init]) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _memoryCapacity = memoryCapacity;
+        _diskCapacity = diskCapacity;
+        
+        self.memoryCachedResponses = [NSMutableDictionary dictionary];
+        self.memoryKeys = [NSMutableOrderedSet orderedSet];
+        
+        if (! directoryURL) {
+            NSURL *cachesDirectoryURL = [NSFileManager.defaultManager URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask].firstObject;
+            directoryURL = [cachesDirectoryURL URLByAppendingPathComponent:@"ch.srgssr.network.responses"];
+        }
+        self.directoryURL = directoryURL;
+        self.diskQueue = dispatch_queue_create("ch.srgssr.network.responsecache", DISPATCH_QUEUE_SERIAL);
+        self.diskSizes = [NSMutableDictionary dictionary];
+        self.diskFileNames = [NSMutableOrderedSet orderedSet];
+        
+        dispatch_async(self.diskQueue, ^{
+            [self loadDiskIndex];
+        });
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)memoryCapacity
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger memoryCapacity = _memoryCapacity;
+    os_unfair_lock_unlock(&_lock);
+    return memoryCapacity;
+}
+
+- (void)setMemoryCapacity:(NSUInteger)memoryCapacity
+{
+    os_unfair_lock_lock(&_lock);
+    _memoryCapacity = memoryCapacity;
+    [self trimMemory];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSUInteger)diskCapacity
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger diskCapacity = _diskCapacity;
+    os_unfair_lock_unlock(&_lock);
+    return diskCapacity;
+}
+
+- (void)setDiskCapacity:(NSUInteger)diskCapacity
+{
+    os_unfair_lock_lock(&_lock);
+    _diskCapacity = diskCapacity;
+    os_unfair_lock_unlock(&_lock);
+    
+    dispatch_async(self.diskQueue, ^{
+        [self trimDisk];
+    });
+}
+
+- (NSUInteger)currentMemoryUsage
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger currentMemoryUsage = _currentMemoryUsage;
+    os_unfair_lock_unlock(&_lock);
+    return currentMemoryUsage;
+}
+
+- (NSUInteger)currentDiskUsage
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger currentDiskUsage = _currentDiskUsage;
+    os_unfair_lock_unlock(&_lock);
+    return currentDiskUsage;
+}
+
+- (NSUInteger)numberOfHits
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfHits = _numberOfHits;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfHits;
+}
+
+- (NSUInteger)numberOfRevalidations
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfRevalidations = _numberOfRevalidations;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfRevalidations;
+}
+
+- (NSUInteger)numberOfStaleHits
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfStaleHits = _numberOfStaleHits;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfStaleHits;
+}
+
+- (NSUInteger)numberOfMisses
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfMisses = _numberOfMisses;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfMisses;
+}
+
+- (NSUInteger)numberOfEvictions
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger numberOfEvictions = _numberOfEvictions;
+    os_unfair_lock_unlock(&_lock);
+    return numberOfEvictions;
+}
+
+#pragma mark Cache management
+
+- (SRGCachedResponse *)cachedResponseForURLRequest:(NSURLRequest *)URLRequest
+{
+    if (! [SRGResponseCache isCacheableURLRequest:URLRequest]) {
+        return nil;
+    }
+    
+    NSString *key = SRGResponseCacheKey(URLRequest);
+    
+    os_unfair_lock_lock(&_lock);
+    SRGCachedResponse *cachedResponse = self.memoryCachedResponses[key];
+    if (cachedResponse) {
+        [self.memoryKeys removeObject:key];
+        [self.memoryKeys addObject:key];
+    }
+    os_unfair_lock_unlock(&_lock);
+    
+    if (cachedResponse) {
+        return cachedResponse;
+    }
+    
+    // Promote responses found on disk to the memory tier
+    cachedResponse = [self diskCachedResponseForKey:key];
+    if (cachedResponse) {
+        [self setMemoryCachedResponse:cachedResponse forKey:key];
+    }
+    return cachedResponse;
+}
+
+- (SRGCachedResponse *)storeResponse:(NSHTTPURLResponse *)response data:(NSData *)data forURLRequest:(NSURLRequest *)URLRequest
+{
+    if (! [SRGResponseCache isCacheableURLRequest:URLRequest] || ! [SRGCachedResponse isCacheableResponse:response]) {
+        return nil;
+    }
+    
+    NSString *key = SRGResponseCacheKey(URLRequest);
+    SRGCachedResponse *cachedResponse = [[SRGCachedResponse alloc] initWithResponse:response data:data storageDate:NSDate.date];
+    [self setMemoryCachedResponse:cachedResponse forKey:key];
+    [self setDiskCachedResponse:cachedResponse forKey:key];
+    return cachedResponse;
+}
+
+- (SRGCachedResponse *)revalidateCachedResponseForURLRequest:(NSURLRequest *)URLRequest withResponse:(NSHTTPURLResponse *)response
+{
+    SRGCachedResponse *cachedResponse = [self cachedResponseForURLRequest:URLRequest];
+    if (! cachedResponse) {
+        return nil;
+    }
+    
+    NSString *key = SRGResponseCacheKey(URLRequest);
+    SRGCachedResponse *revalidatedCachedResponse = [cachedResponse cachedResponseRevalidatedWithResponse:response];
+    [self setMemoryCachedResponse:revalidatedCachedResponse forKey:key];
+    [self setDiskCachedResponse:revalidatedCachedResponse forKey:key];
+    
+    os_unfair_lock_lock(&_lock);
+    _numberOfRevalidations++;
+    os_unfair_lock_unlock(&_lock);
+    
+    return revalidatedCachedResponse;
+}
+
+- (void)removeAllCachedResponses
+{
+    os_unfair_lock_lock(&_lock);
+    [self.memoryCachedResponses removeAllObjects];
+    [self.memoryKeys removeAllObjects];
+    _currentMemoryUsage = 0;
+    os_unfair_lock_unlock(&_lock);
+    
+    dispatch_async(self.diskQueue, ^{
+        [NSFileManager.defaultManager removeItemAtURL:self.directoryURL error:NULL];
+        [NSFileManager.defaultManager createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+        [self.diskSizes removeAllObjects];
+        [self.diskFileNames removeAllObjects];
+        
+        os_unfair_lock_lock(&self->_lock);
+        self->_currentDiskUsage = 0;
+        os_unfair_lock_unlock(&self->_lock);
+    });
+}
+
+#pragma mark Memory tier
+
+// Must be called with the lock held
+- (void)trimMemory
+{
+    while (_currentMemoryUsage > _memoryCapacity && self.memoryKeys.count != 0) {
+        NSString *key = self.memoryKeys.firstObject;
+        _currentMemoryUsage -= self.memoryCachedResponses[key].cost;
+        [self.memoryCachedResponses removeObjectForKey:key];
+        [self.memoryKeys removeObjectAtIndex:0];
+        _numberOfEvictions++;
+    }
+}
+
+- (void)setMemoryCachedResponse:(SRGCachedResponse *)cachedResponse forKey:(NSString *)key
+{
+    os_unfair_lock_lock(&_lock);
+    SRGCachedResponse *previousCachedResponse = self.memoryCachedResponses[key];
+    if (previousCachedResponse) {
+        _currentMemoryUsage -= previousCachedResponse.cost;
+        [self.memoryKeys removeObject:key];
+    }
+    
+    if (cachedResponse.cost <= _memoryCapacity) {
+        self.memoryCachedResponses[key] = cachedResponse;
+        [self.memoryKeys addObject:key];
+        _currentMemoryUsage += cachedResponse.cost;
+        [self trimMemory];
+    }
+    else {
+        [self.memoryCachedResponses removeObjectForKey:key];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+#pragma mark Disk tier
+
+// Must be called on the disk queue
+- (void)loadDiskIndex
+{
+    [NSFileManager.defaultManager createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+    
+    NSArray<NSURLResourceKey> *resourceKeys = @[ NSURLContentModificationDateKey, NSURLFileSizeKey ];
+    NSArray<NSURL *> *fileURLs = [NSFileManager.defaultManager contentsOfDirectoryAtURL:self.directoryURL includingPropertiesForKeys:resourceKeys options:0 error:NULL];
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"pathExtension == %@", SRGResponseCacheDataExtension];
+    NSArray<NSURL *> *dataFileURLs = [fileURLs filteredArrayUsingPredicate:predicate];
+    
+    NSMutableDictionary<NSURL *, NSDate *> *modificationDates = [NSMutableDictionary dictionary];
+    for (NSURL *fileURL in dataFileURLs) {
+        NSDate *modificationDate = nil;
+        [fileURL getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:NULL];
+        modificationDates[fileURL] = modificationDate ?: NSDate.distantPast;
+    }
+    
+    NSUInteger currentDiskUsage = 0;
+    for (NSURL *fileURL in [modificationDates keysSortedByValueUsingSelector:@selector(compare:)]) {
+        NSNumber *fileSize = nil;
+        [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:NULL];
+        
+        NSString *fileName = fileURL.URLByDeletingPathExtension.lastPathComponent;
+        self.diskSizes[fileName] = fileSize ?: @0;
+        [self.diskFileNames addObject:fileName];
+        currentDiskUsage += fileSize.unsignedIntegerValue;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    _currentDiskUsage = currentDiskUsage;
+    os_unfair_lock_unlock(&_lock);
+    
+    [self trimDisk];
+}
+
+// Must be called on the disk queue
+- (void)trimDisk
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger diskCapacity = _diskCapacity;
+    NSUInteger currentDiskUsage = _currentDiskUsage;
+    os_unfair_lock_unlock(&_lock);
+    
+    NSUInteger numberOfEvictions = 0;
+    while (currentDiskUsage > diskCapacity && self.diskFileNames.count != 0) {
+        NSString *fileName = self.diskFileNames.firstObject;
+        currentDiskUsage -= self.diskSizes[fileName].unsignedIntegerValue;
+        [self removeDiskFilesWithFileName:fileName];
+        numberOfEvictions++;
+    }
+    
+    os_unfair_lock_lock(&_lock);
+    _currentDiskUsage = currentDiskUsage;
+    _numberOfEvictions += numberOfEvictions;
+    os_unfair_lock_unlock(&_lock);
+}
+
+// Must be called on the disk queue
+- (void)removeDiskFilesWithFileName:(NSString *)fileName
+{
+    NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:fileName];
+    [NSFileManager.defaultManager removeItemAtURL:[fileURL URLByAppendingPathExtension:SRGResponseCacheDataExtension] error:NULL];
+    [NSFileManager.defaultManager removeItemAtURL:[fileURL URLByAppendingPathExtension:SRGResponseCacheMetadataExtension] error:NULL];
+    [self.diskSizes removeObjectForKey:fileName];
+    [self.diskFileNames removeObject:fileName];
+}
+
+- (SRGCachedResponse *)diskCachedResponseForKey:(NSString *)key
+{
+    NSString *fileName = SRGResponseCacheFileName(key);
+    
+    __block SRGCachedResponse *cachedResponse = nil;
+    dispatch_sync(self.diskQueue, ^{
+        if (! self.diskSizes[fileName]) {
+            return;
+        }
+        
+        NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:fileName];
+        NSData *data = [NSData dataWithContentsOfURL:[fileURL URLByAppendingPathExtension:SRGResponseCacheDataExtension]];
+        NSData *metadata = [NSData dataWithContentsOfURL:[fileURL URLByAppendingPathExtension:SRGResponseCacheMetadataExtension]];
+        cachedResponse = (data && metadata) ? [[SRGCachedResponse alloc] initWithMetadata:metadata data:data] : nil;
+        if (cachedResponse) {
+            [self.diskFileNames removeObject:fileName];
+            [self.diskFileNames addObject:fileName];
+        }
+        else {
+            SRGNetworkLogWarning(@"Response Cache", @"Could not read cached response %@. Removing it.", fileName);
+            
+            NSUInteger size = self.diskSizes[fileName].unsignedIntegerValue;
+            [self removeDiskFilesWithFileName:fileName];
+            
+            os_unfair_lock_lock(&self->_lock);
+            self->_currentDiskUsage -= MIN(size, self->_currentDiskUsage);
+            os_unfair_lock_unlock(&self->_lock);
+        }
+    });
+    return cachedResponse;
+}
+
+- (void)setDiskCachedResponse:(SRGCachedResponse *)cachedResponse forKey:(NSString *)key
+{
+    NSString *fileName = SRGResponseCacheFileName(key);
+    NSData *metadata = cachedResponse.metadata;
+    if (! metadata) {
+        return;
+    }
+    
+    dispatch_async(self.diskQueue, ^{
+        NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:fileName];
+        BOOL written = [cachedResponse.data writeToURL:[fileURL URLByAppendingPathExtension:SRGResponseCacheDataExtension] atomically:YES]
+            && [metadata writeToURL:[fileURL URLByAppendingPathExtension:SRGResponseCacheMetadataExtension] atomically:YES];
+        
+        NSUInteger previousSize = self.diskSizes[fileName].unsignedIntegerValue;
+        NSUInteger size = written ? cachedResponse.data.length + metadata.length : 0;
+        
+        if (written) {
+            self.diskSizes[fileName] = @(size);
+            [self.diskFileNames removeObject:fileName];
+            [self.diskFileNames addObject:fileName];
+        }
+        else {
+            SRGNetworkLogWarning(@"Response Cache", @"Could not write cached response %@.", fileName);
+            [self removeDiskFilesWithFileName:fileName];
+        }
+        
+        os_unfair_lock_lock(&self->_lock);
+        self->_currentDiskUsage = self->_currentDiskUsage - MIN(previousSize, self->_currentDiskUsage) + size;
+        os_unfair_lock_unlock(&self->_lock);
+        
+        [self trimDisk];
+    });
+}
+
+#pragma mark Statistics
+
+- (void)recordHit
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfHits++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)recordStaleHit
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfStaleHits++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)recordMiss
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfMisses++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)resetStatistics
+{
+    os_unfair_lock_lock(&_lock);
+    _numberOfHits = 0;
+    _numberOfRevalidations = 0;
+    _numberOfStaleHits = 0;
+    _numberOfMisses = 0;
+    _numberOfEvictions = 0;
+    os_unfair_lock_unlock(&_lock);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; memoryUsage = %@/%@; diskUsage = %@/%@; hits = %@; misses = %@; evictions = %@>",
+            self.class,
+            self,
+            @(self.currentMemoryUsage),
+            @(self.memoryCapacity),
+            @(self.currentDiskUsage),
+            @(self.diskCapacity),
+            @(self.numberOfHits),
+            @(self.numberOfMisses),
+            @(self.numberOfEvictions)];
+}
+
+@end
+
+#pragma mark Functions
+
+NSString *SRGResponseCacheKey(NSURLRequest *URLRequest)
+{
+    NSMutableString *key = [NSMutableString stringWithFormat:@"%@ %@", URLRequest.HTTPMethod.uppercaseString ?: @"GET", URLRequest.URL.absoluteString];
+    
+    NSDictionary<NSString *, NSString *> *headerFields = URLRequest.allHTTPHeaderFields;
+    NSArray<NSString *> *sortedHeaderNames = [headerFields.allKeys sortedArrayUsingSelector:@selector(caseInsensitiveCompare:)];
+    for (NSString *headerName in sortedHeaderNames) {
+        [key appendFormat:@"\n%@: %@", headerName.lowercaseString, headerFields[headerName]];
+    }
+    return key.copy;
+}
+
+#pragma mark Static functions
+
+static NSString *SRGResponseCacheFileName(NSString *key)
+{
+    NSData *data = [key dataUsingEncoding:NSUTF8StringEncoding];
+    
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+    
+    NSMutableString *fileName = [NSMutableString stringWithCapacity:2 * CC_SHA256_DIGEST_LENGTH];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [fileName appendFormat:@"%02x", digest[i]];
+    }
+    return fileName.copy;
+}
@@ -0,0 +1,137 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRetryPolicy.h"
+
+#import "SRGCachedResponse.h"
+
+@interface SRGRetryPolicy ()
+
+@property (nonatomic) NSUInteger maximumNumberOfAttempts;
+@property (nonatomic) NSTimeInterval timeBudget;
+
+@end
+
+@implementation SRGRetryPolicy
+
+#pragma mark Class methods
+
++ (SRGRetryPolicy *)defaultPolicy
+{
+    static SRGRetryPolicy *s_defaultPolicy;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_defaultPolicy = [[SRGRetryPolicy alloc] initWithMaximumNumberOfAttempts:3 timeBudget:30.];
+    });
+    return s_defaultPolicy;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithMaximumNumberOfAttempts:(NSUInteger)maximumNumberOfAttempts timeBudget:(NSTimeInterval)timeBudget
+{
+    if (self = [super init]) {
+        self.maximumNumberOfAttempts = MAX(maximumNumberOfAttempts, 1);
+        self.timeBudget = MAX(timeBudget, 0.);
+        self.baseDelay = 0.5;
+        self.maximumDelay = 10.;
+        
+        NSMutableIndexSet *retryableHTTPStatusCodes = [NSMutableIndexSet indexSet];
+        [retryableHTTPStatusCodes addIndex:408];
+        [retryableHTTPStatusCodes addIndex:429];
+        [retryableHTTPStatusCodes addIndexesInRange:NSMakeRange(502, 3)];
+        self.retryableHTTPStatusCodes = retryableHTTPStatusCodes.copy;
+    }
+    return self;
+}
+
+#pragma mark Retry
+
+- (BOOL)shouldRetryURLRequest:(NSURLRequest *)URLRequest afterAttempt:(NSUInteger)attempt withResponse:(NSURLResponse *)response error:(NSError *)error
+{
+    if (attempt >= self.maximumNumberOfAttempts) {
+        return NO;
+    }
+    
+    if (! self.nonIdempotentRequestRetryEnabled) {
+        static NSSet<NSString *> *s_idempotentMethods;
+        static dispatch_once_t s_onceToken;
+        dispatch_once(&s_onceToken, ^{
+            s_idempotentMethods = [NSSet setWithObjects:@"GET", @"HEAD", @"OPTIONS", @"TRACE", @"PUT", @"DELETE", nil];
+        });
+        
+        NSString *HTTPMethod = URLRequest.HTTPMethod.uppercaseString ?: @"GET";
+        if (! [s_idempotentMethods containsObject:HTTPMethod]) {
+            return NO;
+        }
+    }
+    
+    if (error) {
+        if (! [error.domain isEqualToString:NSURLErrorDomain]) {
+            return NO;
+        }
+        
+        static NSIndexSet *s_transientErrorCodes;
+        static dispatch_once_t s_onceToken;
+        dispatch_once(&s_onceToken, ^{
+            NSMutableIndexSet *transientErrorCodes = [NSMutableIndexSet indexSet];
+            [transientErrorCodes addIndex:-NSURLErrorTimedOut];
+            [transientErrorCodes addIndex:-NSURLErrorCannotFindHost];
+            [transientErrorCodes addIndex:-NSURLErrorCannotConnectToHost];
+            [transientErrorCodes addIndex:-NSURLErrorNetworkConnectionLost];
+            [transientErrorCodes addIndex:-NSURLErrorDNSLookupFailed];
+            [transientErrorCodes addIndex:-NSURLErrorNotConnectedToInternet];
+            s_transientErrorCodes = transientErrorCodes.copy;
+        });
+        return [s_transientErrorCodes containsIndex:-error.code];
+    }
+    else if ([response isKindOfClass:NSHTTPURLResponse.class]) {
+        return [self.retryableHTTPStatusCodes containsIndex:((NSHTTPURLResponse *)response).statusCode];
+    }
+    else {
+        return NO;
+    }
+}
+
+- (NSTimeInterval)delayBeforeAttempt:(NSUInteger)attempt withResponse:(NSURLResponse *)response
+{
+    // Servers know best when they are able to handle requests again
+    if ([response isKindOfClass:NSHTTPURLResponse.class]) {
+        NSString *retryAfter = SRGCachedResponseHeaderValue((NSHTTPURLResponse *)response, @"Retry-After");
+        if (retryAfter) {
+            NSScanner *scanner = [NSScanner scannerWithString:retryAfter];
+            NSInteger seconds = 0;
+            if ([scanner scanInteger:&seconds] && scanner.atEnd) {
+                return MAX(seconds, 0);
+            }
+            
+            NSDate *date = SRGCachedResponseDateFromHTTPDateString(retryAfter);
+            if (date) {
+                return MAX(date.timeIntervalSinceNow, 0.);
+            }
+        }
+    }
+    
+    // Full jitter: uniformly random delay up to an exponentially growing bound
+    NSUInteger retry = MAX(attempt, 2) - 2;
+    NSTimeInterval bound = fmin(self.baseDelay * pow(2., MIN(retry, 32)), self.maximumDelay);
+    return bound * arc4random_uniform(UINT32_MAX) / UINT32_MAX;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; maximumNumberOfAttempts = %@; timeBudget = %@; baseDelay = %@; maximumDelay = %@>",
+            self.class,
+            self,
+            @(self.maximumNumberOfAttempts),
+            @(self.timeBudget),
+            @(self.baseDelay),
+            @(self.maximumDelay)];
+}
+
+@end
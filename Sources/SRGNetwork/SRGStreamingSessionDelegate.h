@@ -0,0 +1,40 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGStreamingResponseHandler)(NSURLResponse *response);
+typedef void (^SRGStreamingDataHandler)(NSData *data);
+typedef void (^SRGStreamingCompletionHandler)(NSURLResponse * _Nullable response, NSError * _Nullable error);
+
+/**
+ *  Delegate forwarding data to per-task handlers as it is received, rather than buffering it until the task completes.
+ *
+ *  @discussion Streaming tasks are performed with the session they are requested for, using a per-task delegate, so
+ *              that the session delegate still handles authentication challenges, and so that connections are shared
+ *              with other tasks of the session. Per-task delegates are not available on all supported OS versions,
+ *              though. On older versions, streaming tasks are performed with an internal session sharing the
+ *              configuration of the session they are requested for, to whose delegate authentication challenges are
+ *              forwarded. This internal session is invalidated when the session it mirrors is deallocated.
+ */
+@interface SRGStreamingSessionDelegate : NSObject <NSURLSessionDataDelegate>
+
+/**
+ *  Create a (non-started) data task for the specified request and session. All handlers are called in sequence on the
+ *  session delegate queue (or on an internal serial queue on older OS versions), and must therefore return quickly.
+ */
++ (NSURLSessionDataTask *)dataTaskWithURLRequest:(NSURLRequest *)URLRequest
+                                         session:(NSURLSession *)session
+                                 responseHandler:(SRGStreamingResponseHandler)responseHandler
+                                     dataHandler:(SRGStreamingDataHandler)dataHandler
+                               completionHandler:(SRGStreamingCompletionHandler)completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
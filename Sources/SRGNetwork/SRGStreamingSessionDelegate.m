@@ -0,0 +1,239 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGStreamingSessionDelegate.h"
+
+#import <objc/runtime.h>
+#import <os/lock.h>
+
+static void *s_mirrorKey = &s_mirrorKey;
+
+static SRGStreamingSessionDelegate *s_delegate = nil;
+static NSMapTable<NSURLSession *, id> *s_mirrors = nil;
+static os_unfair_lock s_mirrorsLock = OS_UNFAIR_LOCK_INIT;
+
+// Handlers associated with a task.
+@interface SRGStreamingTaskHandlers : NSObject
+
+@property (nonatomic, copy) SRGStreamingResponseHandler responseHandler;
+@property (nonatomic, copy) SRGStreamingDataHandler dataHandler;
+@property (nonatomic, copy) SRGStreamingCompletionHandler completionHandler;
+
+@end
+
+// Internal session mirroring a client session, attached to it so that it is invalidated when the client session is
+// deallocated.
+@interface SRGStreamingSessionMirror : NSObject
+
+@property (nonatomic, weak) NSURLSession *session;
+@property (nonatomic) NSURLSession *streamingSession;
+
+@end
+
+@interface SRGStreamingSessionDelegate () {
+@private
+    os_unfair_lock _handlersLock;
+}
+
+@property (nonatomic) NSMapTable<NSURLSessionTask *, SRGStreamingTaskHandlers *> *handlers;
+
+@end
+
+@implementation SRGStreamingSessionDelegate
+
+#pragma mark Class methods
+
++ (void)initialize
+{
+    if (self != SRGStreamingSessionDelegate.class) {
+        return;
+    }
+    
+    s_delegate = [[SRGStreamingSessionDelegate alloc] init];
+    s_mirrors = [NSMapTable weakToWeakObjectsMapTable];
+}
+
++ (NSURLSession *)streamingSessionForSession:(NSURLSession *)session
+{
+    os_unfair_lock_lock(&s_mirrorsLock);
+    SRGStreamingSessionMirror *mirror = objc_getAssociatedObject(session, s_mirrorKey);
+    if (! mirror) {
+        NSOperationQueue *delegateQueue = [[NSOperationQueue alloc] init];
+        delegateQueue.maxConcurrentOperationCount = 1;
+        delegateQueue.qualityOfService = NSQualityOfServiceUserInitiated;
+        delegateQueue.name = @"ch.srgssr.network.streaming";
+        
+        mirror = [[SRGStreamingSessionMirror alloc] init];
+        mirror.session = session;
+        mirror.streamingSession = [NSURLSession sessionWithConfiguration:session.configuration delegate:s_delegate delegateQueue:delegateQueue];
+        objc_setAssociatedObject(session, s_mirrorKey, mirror, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        [s_mirrors setObject:mirror forKey:mirror.streamingSession];
+    }
+    os_unfair_lock_unlock(&s_mirrorsLock);
+    return mirror.streamingSession;
+}
+
++ (NSURLSession *)mirroredSessionForStreamingSession:(NSURLSession *)streamingSession
+{
+    os_unfair_lock_lock(&s_mirrorsLock);
+    SRGStreamingSessionMirror *mirror = [s_mirrors objectForKey:streamingSession];
+    os_unfair_lock_unlock(&s_mirrorsLock);
+    return mirror.session;
+}
+
++ (NSURLSessionDataTask *)dataTaskWithURLRequest:(NSURLRequest *)URLRequest
+                                         session:(NSURLSession *)session
+                                 responseHandler:(SRGStreamingResponseHandler)responseHandler
+                                     dataHandler:(SRGStreamingDataHandler)dataHandler
+                               completionHandler:(SRGStreamingCompletionHandler)completionHandler
+{
+    SRGStreamingTaskHandlers *handlers = [[SRGStreamingTaskHandlers alloc] init];
+    handlers.responseHandler = responseHandler;
+    handlers.dataHandler = dataHandler;
+    handlers.completionHandler = completionHandler;
+    
+    if (@available(iOS 15, tvOS 15, watchOS 8, *)) {
+        // Tasks retain their delegate until they are complete. Methods not implemented by the task delegate (e.g.
+        // authentication challenges) are still sent to the session delegate.
+        SRGStreamingSessionDelegate *delegate = [[SRGStreamingSessionDelegate alloc] init];
+        NSURLSessionDataTask *dataTask = [session dataTaskWithRequest:URLRequest];
+        [delegate setHandlers:handlers forTask:dataTask];
+        dataTask.delegate = delegate;
+        return dataTask;
+    }
+    else {
+        NSURLSessionDataTask *dataTask = [[self streamingSessionForSession:session] dataTaskWithRequest:URLRequest];
+        [s_delegate setHandlers:handlers forTask:dataTask];
+        return dataTask;
+    }
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.handlers = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                              valueOptions:NSPointerFunctionsStrongMemory];
+        _handlersLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark Handlers
+
+- (void)setHandlers:(SRGStreamingTaskHandlers *)handlers forTask:(NSURLSessionTask *)task
+{
+    os_unfair_lock_lock(&_handlersLock);
+    [self.handlers setObject:handlers forKey:task];
+    os_unfair_lock_unlock(&_handlersLock);
+}
+
+- (SRGStreamingTaskHandlers *)handlersForTask:(NSURLSessionTask *)task
+{
+    os_unfair_lock_lock(&_handlersLock);
+    SRGStreamingTaskHandlers *handlers = [self.handlers objectForKey:task];
+    os_unfair_lock_unlock(&_handlersLock);
+    return handlers;
+}
+
+- (SRGStreamingTaskHandlers *)removeHandlersForTask:(NSURLSessionTask *)task
+{
+    os_unfair_lock_lock(&_handlersLock);
+    SRGStreamingTaskHandlers *handlers = [self.handlers objectForKey:task];
+    [self.handlers removeObjectForKey:task];
+    os_unfair_lock_unlock(&_handlersLock);
+    return handlers;
+}
+
+#pragma mark Method forwarding
+
+- (BOOL)respondsToSelector:(SEL)selector
+{
+    // Per-task delegates let the session delegate handle authentication challenges
+    if (self != s_delegate && (selector == @selector(URLSession:didReceiveChallenge:completionHandler:)
+                               || selector == @selector(URLSession:task:didReceiveChallenge:completionHandler:))) {
+        return NO;
+    }
+    return [super respondsToSelector:selector];
+}
+
+#pragma mark NSURLSessionDelegate protocol
+
+- (void)URLSession:(NSURLSession *)session didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential * _Nullable))completionHandler
+{
+    NSURLSession *mirroredSession = [SRGStreamingSessionDelegate mirroredSessionForStreamingSession:session];
+    id<NSURLSessionDelegate> sessionDelegate = mirroredSession.delegate;
+    if ([sessionDelegate respondsToSelector:@selector(URLSession:didReceiveChallenge:completionHandler:)]) {
+        [mirroredSession.delegateQueue addOperationWithBlock:^{
+            [sessionDelegate URLSession:mirroredSession didReceiveChallenge:challenge completionHandler:completionHandler];
+        }];
+    }
+    else {
+        completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+    }
+}
+
+#pragma mark NSURLSessionDataDelegate protocol
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler
+{
+    SRGStreamingTaskHandlers *handlers = [self handlersForTask:dataTask];
+    if (handlers) {
+        handlers.responseHandler(response);
+    }
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
+{
+    SRGStreamingTaskHandlers *handlers = [self handlersForTask:dataTask];
+    if (handlers) {
+        handlers.dataHandler(data);
+    }
+}
+
+#pragma mark NSURLSessionTaskDelegate protocol
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential * _Nullable))completionHandler
+{
+    NSURLSession *mirroredSession = [SRGStreamingSessionDelegate mirroredSessionForStreamingSession:session];
+    id<NSURLSessionDelegate> sessionDelegate = mirroredSession.delegate;
+    if ([sessionDelegate respondsToSelector:@selector(URLSession:task:didReceiveChallenge:completionHandler:)]) {
+        [mirroredSession.delegateQueue addOperationWithBlock:^{
+            [(id<NSURLSessionTaskDelegate>)sessionDelegate URLSession:mirroredSession task:task didReceiveChallenge:challenge completionHandler:completionHandler];
+        }];
+    }
+    else {
+        completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
+{
+    SRGStreamingTaskHandlers *handlers = [self removeHandlersForTask:task];
+    if (handlers) {
+        handlers.completionHandler(task.response, error);
+    }
+}
+
+@end
+
+@implementation SRGStreamingTaskHandlers
+
+@end
+
+@implementation SRGStreamingSessionMirror
+
+#pragma mark Object lifecycle
+
+- (void)dealloc
+{
+    // Sessions retain their delegate and queue until invalidated
+    [_streamingSession finishTasksAndInvalidate];
+}
+
+@end
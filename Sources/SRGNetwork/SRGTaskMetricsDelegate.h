@@ -0,0 +1,30 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGTaskMetricsHandler)(NSURLSessionTaskMetrics *taskMetrics);
+
+/**
+ *  Per-task delegate retrieving the metrics collected by the URL loading system for a task.
+ *
+ *  @discussion Metrics are forwarded to the session delegate as well, if it implements the corresponding method, so
+ *              that clients collecting metrics with their own session delegate are not affected.
+ */
+@interface SRGTaskMetricsDelegate : NSObject <NSURLSessionTaskDelegate>
+
+/**
+ *  Call the specified handler with the metrics of the task once collected. Does nothing on OS versions which do not
+ *  support per-task delegates.
+ */
++ (void)observeMetricsForTask:(NSURLSessionTask *)task withHandler:(SRGTaskMetricsHandler)handler;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,41 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGTaskMetricsDelegate.h"
+
+@interface SRGTaskMetricsDelegate ()
+
+@property (nonatomic, copy) SRGTaskMetricsHandler handler;
+
+@end
+
+@implementation SRGTaskMetricsDelegate
+
+#pragma mark Class methods
+
++ (void)observeMetricsForTask:(NSURLSessionTask *)task withHandler:(SRGTaskMetricsHandler)handler
+{
+    if (@available(iOS 15, tvOS 15, watchOS 8, *)) {
+        // Tasks retain their delegate until they are complete
+        SRGTaskMetricsDelegate *delegate = [[SRGTaskMetricsDelegate alloc] init];
+        delegate.handler = handler;
+        task.delegate = delegate;
+    }
+}
+
+#pragma mark NSURLSessionTaskDelegate protocol
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics
+{
+    self.handler(metrics);
+    
+    id<NSURLSessionDelegate> sessionDelegate = session.delegate;
+    if ([sessionDelegate respondsToSelector:@selector(URLSession:task:didFinishCollectingMetrics:)]) {
+        [(id<NSURLSessionTaskDelegate>)sessionDelegate URLSession:session task:task didFinishCollectingMetrics:metrics];
+    }
+}
+
+@end
@@ -4,7 +4,14 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "SRGConnectionPrewarmer.h"
+#import "SRGContentCoding.h"
+#import "SRGHedgingPolicy.h"
+#import "SRGMetricsCollector.h"
 #import "SRGNetworkTypes.h"
+#import "SRGParsingExecutor.h"
+#import "SRGResponseCache.h"
+#import "SRGRetryPolicy.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -36,6 +43,118 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (__kindof SRGBaseRequest *)requestWithOptions:(SRGRequestOptions)options;
 
+/**
+ *  Return a clone of the receiver, storing and retrieving responses from the specified cache (`nil` to disable caching,
+ *  which is the default behavior).
+ *
+ *  @discussion Only `GET` requests are cached. The object last parsed from each response is cached as well, and reused
+ *              with the same parser when a fresh response is available or when the server confirms that a stale
+ *              response has not changed.
+ */
+- (__kindof SRGBaseRequest *)requestWithResponseCache:(nullable SRGResponseCache *)responseCache;
+
+/**
+ *  Return a clone of the receiver, immediately calling its completion block with the result obtained from a stale
+ *  cached response while revalidating it with the server, provided the response has not been stale for longer than
+ *  the specified interval (0 to always wait for revalidation, which is the default behavior). Requires a response
+ *  cache.
+ *
+ *  @discussion When a stale result is used, the completion block is called:
+ *                - Once with the stale result, `stale` being set to `YES` during the call.
+ *                - A second time with the revalidated result, `stale` being set to `NO`, but only if content changed,
+ *                  i.e. if the server sent a response with a different `ETag` and a different body. The completion
+ *                  block is never called a second time if revalidation fails (including cancellation and exceeded
+ *                  deadlines), the stale result then remaining the latest known one.
+ *              The request stays running until revalidation ends. Fresh cached responses are used as usual, as well
+ *              as stale responses with a `must-revalidate` directive.
+ */
+- (__kindof SRGBaseRequest *)requestWithMaximumStaleness:(NSTimeInterval)maximumStaleness;
+
+/**
+ *  Return a clone of the receiver, processing its responses (parsing and extraction) with the specified executor
+ *  (`nil` for the shared executor, which is the default behavior).
+ *
+ *  @discussion Responses are never processed on the session delegate queue, so that a slow parser does not delay
+ *              responses received for other requests of the same session.
+ */
+- (__kindof SRGBaseRequest *)requestWithParsingExecutor:(nullable SRGParsingExecutor *)parsingExecutor;
+
+/**
+ *  Return a clone of the receiver, processing its responses with the specified quality of service (by default
+ *  `NSQualityOfServiceUserInitiated`). Among pending responses of an executor, those with higher quality of service
+ *  are processed first.
+ */
+- (__kindof SRGBaseRequest *)requestWithParsingQualityOfService:(NSQualityOfService)parsingQualityOfService;
+
+/**
+ *  Return a clone of the receiver with the specified priority, between `NSURLSessionTaskPriorityLow` and
+ *  `NSURLSessionTaskPriorityHigh` (by default `NSURLSessionTaskPriorityDefault`).
+ *
+ *  @discussion The priority is applied to the underlying session task. Request queues with a limited number of
+ *              concurrent requests also start pending requests with higher priority first.
+ */
+- (__kindof SRGBaseRequest *)requestWithPriority:(float)priority;
+
+/**
+ *  Return a clone of the receiver, starting a duplicate network task if no response has been received after the delay
+ *  defined by the specified policy (`nil` to disable hedging, which is the default behavior). The result of the task
+ *  which finishes first is used, and the other one is cancelled.
+ *
+ *  @discussion Only `GET` and `HEAD` requests without body are hedged. The completion block is called and the response
+ *              parsed only once. Coalesced and streamed requests are never hedged.
+ */
+- (__kindof SRGBaseRequest *)requestWithHedgingPolicy:(nullable SRGHedgingPolicy *)hedgingPolicy;
+
+/**
+ *  Return a clone of the receiver, measuring the duration of each request phase and recording it into the specified
+ *  collector (`nil` to disable measurements, which is the default behavior).
+ *
+ *  @discussion Metrics of the last execution are available from the `metrics` property when the completion block
+ *              is called.
+ */
+- (__kindof SRGBaseRequest *)requestWithMetricsCollector:(nullable SRGMetricsCollector *)metricsCollector;
+
+/**
+ *  Return a clone of the receiver, retrying transient failures according to the specified policy (`nil` to use the
+ *  policy of the request queue the request is added to, if any, which is the default behavior).
+ *
+ *  @discussion The request stays running while waiting to be attempted again, and its completion block is only called
+ *              with the outcome of the last attempt. Streamed requests are never retried.
+ */
+- (__kindof SRGBaseRequest *)requestWithRetryPolicy:(nullable SRGRetryPolicy *)retryPolicy;
+
+/**
+ *  Return a clone of the receiver, advertising the specified content codings in the `Accept-Encoding` header, in order
+ *  of preference, and decoding response bodies encoded with one of them before they are parsed (`nil` for the codings
+ *  natively supported by `NSURLSession`, which is the default behavior).
+ *
+ *  @discussion Codings natively supported by `NSURLSession` (`gzip`, `deflate` and `br`) remain advertised with lower
+ *              preference. The `Accept-Encoding` header is left unchanged if already set by the request. Streamed
+ *              responses are decoded progressively, as data is received. Decoding is part of the parsing phase.
+ */
+- (__kindof SRGBaseRequest *)requestWithContentCodings:(nullable NSArray<SRGContentCoding *> *)contentCodings;
+
+/**
+ *  Return a clone of the receiver, encoding its body with the specified content coding when at least as large as
+ *  the specified minimum length (`nil` to send bodies unchanged, which is the default behavior). The coding must
+ *  have an encoder.
+ *
+ *  @discussion Encoded bodies are only sent if smaller than the original ones, with a matching `Content-Encoding`
+ *              header. Bodies of requests which already have a `Content-Encoding` header, as well as body streams,
+ *              are sent unchanged. Only use with servers known to support the coding.
+ */
+- (__kindof SRGBaseRequest *)requestWithBodyContentCoding:(nullable SRGContentCoding *)bodyContentCoding minimumBodyLength:(NSUInteger)minimumBodyLength;
+
+/**
+ *  Return a clone of the receiver, which must be completed before the specified absolute deadline (`nil` for no
+ *  deadline, which is the default behavior). If the deadline is exceeded, the request is cancelled and its completion
+ *  block called with an `SRGNetworkErrorDeadlineExceeded` error.
+ *
+ *  @discussion The time budget of the request queue the request belongs to (see `-[SRGRequestQueue requestQueueWithTimeBudget:]`)
+ *              is applied as well, if shorter. Attempts which would start after the deadline are never retried.
+ */
+- (__kindof SRGBaseRequest *)requestWithDeadline:(nullable NSDate *)deadline;
+
 /**
  *  Start performing the request.
  *
@@ -49,6 +168,9 @@ NS_ASSUME_NONNULL_BEGIN
  *
  *  @discussion `running` is immediately set to `NO`. Request completion blocks won't be called. You can restart a
  *              cancelled request by `-calling` resume again.
+ *
+ *              If the response has already been received, its parsing is skipped if not started yet. Parsers in
+ *              progress can stop early by checking `SRGCancellationToken.currentToken`.
  */
 - (void)cancel;
 
@@ -77,6 +199,93 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) SRGRequestOptions options;
 
+/**
+ *  The response cache, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGResponseCache *responseCache;
+
+/**
+ *  The maximum staleness of cached responses used while being revalidated (0 if disabled).
+ */
+@property (nonatomic, readonly) NSTimeInterval maximumStaleness;
+
+/**
+ *  The executor used to process responses.
+ */
+@property (nonatomic, readonly) SRGParsingExecutor *parsingExecutor;
+
+/**
+ *  The quality of service with which responses are processed.
+ */
+@property (nonatomic, readonly) NSQualityOfService parsingQualityOfService;
+
+/**
+ *  The request priority.
+ */
+@property (nonatomic, readonly) float priority;
+
+/**
+ *  The hedging policy attached to the request, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGHedgingPolicy *hedgingPolicy;
+
+/**
+ *  The metrics collector attached to the request, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGMetricsCollector *metricsCollector;
+
+/**
+ *  Timing metrics of the last execution of the request, available when its completion block is called. Always `nil`
+ *  if no metrics collector has been attached to the request.
+ */
+@property (atomic, readonly, nullable) SRGRequestMetrics *metrics;
+
+/**
+ *  How the connection used by the last attempt of the request was obtained, available when its completion block is
+ *  called.
+ *
+ *  @discussion Only determined for requests with a metrics collector, or performed with a session having a connection
+ *              prewarmer (see `SRGConnectionPrewarmer`), on iOS 15, tvOS 15, watchOS 8 and above. Coalesced, batched,
+ *              hedged and streamed requests always report `SRGConnectionReuseUnknown`.
+ */
+@property (atomic, readonly) SRGConnectionReuse connectionReuse;
+
+/**
+ *  `YES` iff the completion block is being called with a stale result, which is being revalidated (see
+ *  `-requestWithMaximumStaleness:`). Only meaningful from within the completion block.
+ */
+@property (atomic, readonly, getter=isStale) BOOL stale;
+
+/**
+ *  The retry policy attached to the request, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGRetryPolicy *retryPolicy;
+
+/**
+ *  The content codings advertised and decoded by the request, if any.
+ */
+@property (nonatomic, readonly, nullable) NSArray<SRGContentCoding *> *contentCodings;
+
+/**
+ *  The content coding applied to large request bodies, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGContentCoding *bodyContentCoding;
+
+/**
+ *  The minimum length of request bodies to which the body content coding is applied.
+ */
+@property (nonatomic, readonly) NSUInteger minimumBodyLength;
+
+/**
+ *  The deadline of the request, if any.
+ */
+@property (nonatomic, readonly, nullable) NSDate *deadline;
+
+/**
+ *  The number of times the request has been attempted over the network since it was last started.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfAttempts;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,40 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A cancellation token is cancelled when the request it belongs to is cancelled, or when its deadline is exceeded.
+ *
+ *  While the parser or extractor of a request runs, the token of the request is available as `currentToken`. Long
+ *  parsers can check it from time to time and return early if cancelled (with any error, which is discarded), so that
+ *  no CPU time and memory is wasted on results nobody wants anymore. Parsers provided by the library (e.g. decoding
+ *  parsers, see `SRGJSONSchema`) check it automatically.
+ *
+ *  ## Thread-safety
+ *
+ *  Tokens can be read from any thread.
+ */
+@interface SRGCancellationToken : NSObject
+
+/**
+ *  The token of the request whose parser or extractor is being run on the current thread, `nil` if none.
+ *
+ *  @discussion Parsers shared between several requests (e.g. for coalesced or batched requests) run without token,
+ *              since their result is still useful to the requests which have not been cancelled.
+ */
+@property (class, nonatomic, readonly, nullable) SRGCancellationToken *currentToken;
+
+/**
+ *  Return `YES` iff the token has been cancelled. Cheap enough to be checked often.
+ */
+@property (nonatomic, readonly, getter=isCancelled) BOOL cancelled;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,102 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  How the network connection used by a request was obtained (see `-[SRGBaseRequest connectionReuse]`).
+ */
+typedef NS_ENUM(NSInteger, SRGConnectionReuse) {
+    /**
+     *  The connection could not be determined (e.g. the request did not reach the network, or the information is not
+     *  available, see `-[SRGBaseRequest connectionReuse]`).
+     */
+    SRGConnectionReuseUnknown = 0,
+    /**
+     *  A new connection was established.
+     */
+    SRGConnectionReuseNone,
+    /**
+     *  An existing connection was reused.
+     */
+    SRGConnectionReuseReused,
+    /**
+     *  A connection opened by a connection prewarmer was reused.
+     */
+    SRGConnectionReusePrewarmed
+};
+
+/**
+ *  A connection prewarmer opens connections to known origins (scheme, host and port) ahead of time, so that the
+ *  first requests made to them do not pay for domain lookup, connection and TLS establishment.
+ *
+ *  Connections are opened by sending cheap probe requests (`HEAD` requests to the origin root) with the session of
+ *  the prewarmer. Requests later performed with the same session reuse them as long as they are kept alive by the
+ *  system and by the server. Probes can be repeated periodically so that connections are not closed when idle.
+ *
+ *  At most one prewarmer can be associated with a session, the most recently created one. Requests performed with
+ *  a session having a prewarmer report whether they reused a prewarmed connection (see `-[SRGBaseRequest connectionReuse]`).
+ *
+ *  ## Thread-safety
+ *
+ *  Connection prewarmers can be used from any thread.
+ */
+@interface SRGConnectionPrewarmer : NSObject
+
+/**
+ *  Create a prewarmer for the specified session.
+ *
+ *  @param keepAliveInterval If greater than 0, all origins are probed again at the specified interval, which should
+ *                           be shorter than the time after which the server closes idle connections. Probing stops
+ *                           when the prewarmer is invalidated or deallocated.
+ */
+- (instancetype)initWithSession:(NSURLSession *)session keepAliveInterval:(NSTimeInterval)keepAliveInterval NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Open connections to the origins of the specified URLs (only their scheme, host and port matter). Origins are
+ *  probed immediately, even if already known to the prewarmer.
+ *
+ *  @param completionBlock Block called on the main thread when all probes have ended.
+ */
+- (void)prewarmOriginsWithURLs:(NSArray<NSURL *> *)URLs completionBlock:(nullable void (^)(void))completionBlock;
+
+/**
+ *  Return `YES` iff the last probe made to the origin of the specified URL succeeded.
+ */
+- (BOOL)isOriginWarmForURL:(NSURL *)URL;
+
+/**
+ *  Stop probing origins periodically. Existing connections are not closed.
+ */
+- (void)invalidate;
+
+/**
+ *  The session used to open connections.
+ */
+@property (nonatomic, readonly) NSURLSession *session;
+
+/**
+ *  The interval at which origins are probed again, 0 if they are probed only once.
+ */
+@property (nonatomic, readonly) NSTimeInterval keepAliveInterval;
+
+/**
+ *  The number of probes sent so far.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfProbes;
+
+/**
+ *  The number of requests which reused a connection opened by the prewarmer so far.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfPrewarmedConnectionReuses;
+
+@end
+
+NS_ASSUME_NONNULL_END
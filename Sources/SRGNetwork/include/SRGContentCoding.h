@@ -0,0 +1,103 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGContentDecoderOutputBlock)(NSData *decodedData);
+
+/**
+ *  A content decoder decodes a response body progressively, as encoded bytes are received. Decoded bytes are delivered
+ *  in chunks of bounded size, so that the memory required for decoding does not depend on the body size.
+ *
+ *  A decoder is created for each response. Its methods are called in sequence, never concurrently, and the output
+ *  block is only valid during the call it is provided to.
+ */
+@protocol SRGContentDecoder <NSObject>
+
+/**
+ *  Decode the specified encoded bytes, calling the block with decoded chunks as they become available. Return `NO`
+ *  and an error if the bytes are invalid.
+ */
+- (BOOL)decodeData:(NSData *)data withBlock:(NS_NOESCAPE SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError;
+
+/**
+ *  Called once all encoded bytes have been provided, to deliver remaining decoded chunks. Return `NO` and an error if
+ *  the encoded bytes are incomplete.
+ */
+- (BOOL)finishWithBlock:(NS_NOESCAPE SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError;
+
+@end
+
+// Block signatures.
+typedef id<SRGContentDecoder> _Nonnull (^SRGContentDecoderProvider)(void);
+typedef NSData * _Nullable (^SRGContentEncoder)(NSData *data);
+
+/**
+ *  A content coding (see `-[SRGBaseRequest requestWithContentCodings:]`) is identified by the name used in HTTP
+ *  `Accept-Encoding` and `Content-Encoding` headers (e.g. `zstd`), and provides decoders for response bodies, as well
+ *  as an optional encoder for request bodies.
+ *
+ *  Note that `NSURLSession` natively negotiates and decodes `gzip`, `deflate` and `br` response bodies. Other codings,
+ *  for which Apple platforms provide no implementation (e.g. `zstd`), can be supported by providing a decoder. The
+ *  built-in `gzip` and `deflate` codings decode bodies which were not already decoded by the transport (e.g. when
+ *  served by an `NSURLProtocol`), and can compress request bodies.
+ *
+ *  ## Thread-safety
+ *
+ *  Content codings are immutable and can be shared between requests. Decoder providers and encoders can be called
+ *  from any thread.
+ *
+ *  ## Decoded size
+ *
+ *  Response bodies of streamed requests (see `+[SRGRequest JSONStreamRequestWithURLRequest:session:elementBlock:completionBlock:]`)
+ *  are decoded chunk by chunk, whatever their size. Other response bodies are decoded at once, in memory, and must not
+ *  exceed 64 MB once decoded. Larger bodies, which are most likely compression bombs, fail with an
+ *  `SRGNetworkErrorInvalidData` error.
+ */
+@interface SRGContentCoding : NSObject
+
+/**
+ *  The `gzip` coding.
+ */
+@property (class, nonatomic, readonly) SRGContentCoding *gzipContentCoding;
+
+/**
+ *  The `deflate` coding (zlib format).
+ */
+@property (class, nonatomic, readonly) SRGContentCoding *deflateContentCoding;
+
+/**
+ *  Create a coding with the specified name, calling the provider to create a decoder for each response. If an encoder
+ *  is provided, the coding can be used to compress request bodies. The encoder must return `nil` if the data could
+ *  not be encoded.
+ */
+- (instancetype)initWithName:(NSString *)name
+             decoderProvider:(SRGContentDecoderProvider)decoderProvider
+                     encoder:(nullable SRGContentEncoder)encoder NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The coding name (lowercase).
+ */
+@property (nonatomic, readonly, copy) NSString *name;
+
+/**
+ *  The decoder provider.
+ */
+@property (nonatomic, readonly) SRGContentDecoderProvider decoderProvider;
+
+/**
+ *  The encoder, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGContentEncoder encoder;
+
+@end
+
+NS_ASSUME_NONNULL_END
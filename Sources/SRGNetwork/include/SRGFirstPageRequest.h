@@ -6,6 +6,7 @@
 
 #import "SRGNetworkTypes.h"
 #import "SRGPageRequest.h"
+#import "SRGRequestQueue.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -75,8 +76,8 @@ NS_ASSUME_NONNULL_BEGIN
  *  If helpful, some standard basic parsers are available from <SRGNetwork/SRGNetworkParsers.h>.
  *
  *  @discussion An error is returned to the completion block if parsing fails. The parsing block will be called on a
- *              background thread (except if the session is configured with the main operation queue, which is best
- *              avoided).
+ *              background thread managed by the request parsing executor (see `-requestWithParsingExecutor:`), never
+ *              on the session delegate queue.
  */
 + (SRGFirstPageRequest *)objectRequestWithURLRequest:(NSURLRequest *)URLRequest
                                              session:(NSURLSession *)session
@@ -102,6 +103,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (SRGPageRequest *)requestWithPage:(nullable SRGPage *)page;
 
+/**
+ *  Retrieve all pages of the list concurrently, for services with random access to pages (e.g. pages identified by
+ *  size and number, or by offset). Retrieval starts immediately.
+ *
+ *  @param builder                           A block building the URL request for a page number, from the request
+ *                                           of the first page (with the page size of the receiver applied). The
+ *                                           first page is always retrieved with the receiver request itself.
+ *  @param itemsExtractor                    A block returning the items contained in a page object. Retrieval stops
+ *                                           at the first empty page, or the first page containing fewer items than
+ *                                           the page size (if specified).
+ *  @param maximumNumberOfConcurrentRequests The number of pages retrieved at the same time (at least 1).
+ *  @param completionBlock                   The block called on the main thread when all pages have been retrieved,
+ *                                           with the page objects in page order (`NSNull` for pages without object),
+ *                                           as well as all their items merged in order.
+ *
+ *  @return The queue to which page requests are added, which can be used to cancel retrieval.
+ *
+ *  @discussion Settings and options of the receiver are applied to all page requests. Pages are processed in the
+ *              background. If a page request fails, all others are cancelled and the completion block is called
+ *              with the error. If retrieval is cancelled, the completion block is only called if the receiver
+ *              has the `SRGRequestOptionCancellationErrorsEnabled` option set.
+ */
+- (SRGRequestQueue *)requestQueueForAllPagesWithBuilder:(SRGPageBuilder)builder
+                                         itemsExtractor:(SRGPageItemsExtractor)itemsExtractor
+                      maximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+                                        completionBlock:(SRGAllPagesCompletionBlock)completionBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,56 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A hedging policy reduces tail latency for idempotent requests (see `-[SRGBaseRequest requestWithHedgingPolicy:]`).
+ *  If no response has been received after some delay, a duplicate network task is started, and the result of the
+ *  task which finishes first is used, the other one being cancelled.
+ *
+ *  The delay can be fixed, or derived from the latencies recently observed for requests using the same policy (e.g.
+ *  their 95th percentile, so that only the slowest 5% of the requests are duplicated).
+ *
+ *  ## Thread-safety
+ *
+ *  Hedging policies can be used from any thread, and are meant to be shared between requests with similar latency
+ *  profiles (e.g. requests to the same service).
+ */
+@interface SRGHedgingPolicy : NSObject
+
+/**
+ *  Policy starting a duplicate task after the specified fixed delay.
+ */
+- (instancetype)initWithDelay:(NSTimeInterval)delay;
+
+/**
+ *  Policy starting a duplicate task after the specified percentile (between 0 and 1) of recently observed latencies,
+ *  but never before `minimumDelay`. Until enough latencies have been observed, `minimumDelay` is used.
+ */
+- (instancetype)initWithLatencyPercentile:(double)latencyPercentile minimumDelay:(NSTimeInterval)minimumDelay NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The delay after which a duplicate task is currently started.
+ */
+@property (nonatomic, readonly) NSTimeInterval delay;
+
+/**
+ *  The number of duplicate tasks which have been started.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfHedgesFired;
+
+/**
+ *  The number of duplicate tasks which finished before the original task.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfHedgesWon;
+
+@end
+
+NS_ASSUME_NONNULL_END
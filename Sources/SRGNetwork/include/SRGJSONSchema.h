@@ -0,0 +1,114 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SRGJSONSchema;
+
+/**
+ *  Types of JSON values which can be decoded into model properties.
+ */
+typedef NS_ENUM(NSInteger, SRGJSONFieldType) {
+    /**
+     *  A JSON string, decoded as an `NSString`.
+     */
+    SRGJSONFieldTypeString,
+    /**
+     *  A JSON number, decoded as an `NSNumber`. Scalar properties (e.g. `NSInteger` or `double`) are supported.
+     */
+    SRGJSONFieldTypeNumber,
+    /**
+     *  A JSON boolean, decoded as an `NSNumber`. `BOOL` properties are supported.
+     */
+    SRGJSONFieldTypeBoolean,
+    /**
+     *  A JSON string, decoded as an `NSURL`.
+     */
+    SRGJSONFieldTypeURL,
+    /**
+     *  Any JSON value, decoded as the corresponding Foundation object (with the same types as `NSJSONSerialization`).
+     */
+    SRGJSONFieldTypeJSON
+};
+
+/**
+ *  Describes how a JSON value is decoded into a model property.
+ */
+@interface SRGJSONField : NSObject
+
+/**
+ *  Field decoding the value found at the specified key path into a property of the specified type. Key paths are
+ *  relative to the JSON object from which the model is decoded, and can traverse nested objects (e.g. `show.title`).
+ */
++ (SRGJSONField *)fieldWithKeyPath:(NSString *)keyPath property:(NSString *)property type:(SRGJSONFieldType)type;
+
+/**
+ *  Field decoding the value found at the specified key path with another schema. An object is decoded as a single
+ *  model, an array as an array of models.
+ */
++ (SRGJSONField *)fieldWithKeyPath:(NSString *)keyPath property:(NSString *)property schema:(SRGJSONSchema *)schema;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The JSON key path.
+ */
+@property (nonatomic, readonly, copy) NSString *keyPath;
+
+/**
+ *  The name of the model property.
+ */
+@property (nonatomic, readonly, copy) NSString *property;
+
+/**
+ *  The field type. Ignored if a schema has been provided.
+ */
+@property (nonatomic, readonly) SRGJSONFieldType type;
+
+/**
+ *  The schema used to decode the value, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGJSONSchema *schema;
+
+@end
+
+/**
+ *  A schema declares how model objects of some class are decoded from JSON objects, and can be used with
+ *  `SRGNetworkJSONDecodingParser()` to decode responses in a single pass, without building an intermediate tree of
+ *  Foundation objects (see <SRGNetwork/SRGNetworkParsers.h>).
+ *
+ *  Models are instantiated with `-init`, and their properties are set using key-value coding. Values for keys not
+ *  declared in the schema are skipped without being materialized. Properties for which no value or a `null` value
+ *  is found are left untouched.
+ *
+ *  ## Thread-safety
+ *
+ *  Schemas are immutable and can be shared between threads.
+ */
+@interface SRGJSONSchema : NSObject
+
+/**
+ *  Schema decoding models of the specified class with the provided fields.
+ */
++ (SRGJSONSchema *)schemaWithModelClass:(Class)modelClass fields:(NSArray<SRGJSONField *> *)fields;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The class of decoded models.
+ */
+@property (nonatomic, readonly) Class modelClass;
+
+/**
+ *  The schema fields.
+ */
+@property (nonatomic, readonly) NSArray<SRGJSONField *> *fields;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,42 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Snapshot of the durations recorded for a request phase (see `SRGMetricsCollector`).
+ *
+ *  @discussion Durations are recorded in logarithmic buckets with a relative precision of about 20%, with a
+ *              microsecond resolution. Percentiles are therefore approximate, but always within the recorded
+ *              minimum and maximum.
+ */
+@interface SRGLatencyHistogram : NSObject
+
+/**
+ *  The number of recorded durations.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ *  The mean, minimum and maximum recorded durations (0 if no duration has been recorded).
+ */
+@property (nonatomic, readonly) NSTimeInterval mean;
+@property (nonatomic, readonly) NSTimeInterval minimum;
+@property (nonatomic, readonly) NSTimeInterval maximum;
+
+/**
+ *  Return the duration below which the specified fraction (between 0 and 1) of recorded durations lies (0 if no
+ *  duration has been recorded).
+ */
+- (NSTimeInterval)durationAtPercentile:(double)percentile;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,67 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGLatencyHistogram.h"
+#import "SRGNetworkTypes.h"
+#import "SRGRequestMetrics.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A metrics collector aggregates the timing metrics of requests it has been attached to (see `-[SRGBaseRequest requestWithMetricsCollector:]`)
+ *  into latency histograms, one per endpoint and request phase.
+ *
+ *  Recording a duration is lock-free and allocation-free, so that collectors can be attached to all requests of an
+ *  application. Requests without collector do not measure anything.
+ *
+ *  ## Thread-safety
+ *
+ *  Metrics collectors can be used from any thread.
+ */
+@interface SRGMetricsCollector : NSObject
+
+/**
+ *  Shared collector instance, using request URL hosts as endpoints.
+ */
+@property (class, nonatomic, readonly) SRGMetricsCollector *sharedCollector;
+
+/**
+ *  Create a collector grouping requests by the endpoint returned by the specified block. If no block is provided,
+ *  request URL hosts are used.
+ *
+ *  @discussion The block is called once per request, and should return a small number of distinct values (e.g.
+ *              do not include identifiers or query parameters), as histograms are kept for each of them.
+ */
+- (instancetype)initWithEndpointProvider:(nullable SRGMetricsEndpointProvider)endpointProvider NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The endpoints for which metrics have been recorded.
+ */
+@property (nonatomic, readonly) NSArray<NSString *> *endpoints;
+
+/**
+ *  Return a snapshot of the histogram for the specified endpoint and phase, `nil` if no request has been recorded
+ *  for the endpoint.
+ */
+- (nullable SRGLatencyHistogram *)histogramForEndpoint:(NSString *)endpoint phase:(SRGRequestPhase)phase;
+
+/**
+ *  Return a snapshot of the histograms for the specified phase, for all endpoints.
+ */
+- (NSDictionary<NSString *, SRGLatencyHistogram *> *)histogramsForPhase:(SRGRequestPhase)phase;
+
+/**
+ *  Discard all recorded metrics.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -12,12 +12,26 @@ FOUNDATION_EXPORT NSString *SRGNetworkMarketingVersion(void);
 // Public headers.
 #import "NSHTTPURLResponse+SRGNetwork.h"
 #import "SRGBaseRequest.h"
+#import "SRGCancellationToken.h"
+#import "SRGConnectionPrewarmer.h"
+#import "SRGContentCoding.h"
 #import "SRGFirstPageRequest.h"
+#import "SRGHedgingPolicy.h"
+#import "SRGJSONSchema.h"
+#import "SRGLatencyHistogram.h"
+#import "SRGMetricsCollector.h"
 #import "SRGNetworkError.h"
 #import "SRGNetworkActivityManagement.h"
 #import "SRGNetworkParsers.h"
 #import "SRGNetworkTypes.h"
 #import "SRGPage.h"
+#import "SRGPageCache.h"
 #import "SRGPageRequest.h"
+#import "SRGPageStream.h"
+#import "SRGParsingExecutor.h"
 #import "SRGRequest.h"
+#import "SRGRequestBatcher.h"
+#import "SRGRequestMetrics.h"
 #import "SRGRequestQueue.h"
+#import "SRGResponseCache.h"
+#import "SRGRetryPolicy.h"
@@ -27,7 +27,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  *  Enable automatic network activity management with a custom handler. The handler is called when network activity
  *  changes (the network is considered to be active when at least one request is running), providing the new status as a
- *  boolean `active` parameter.
+ *  boolean `active` parameter. Changes are only notified once they have persisted for `debounceInterval`.
  *
  *  Automatic network activity management is an opt-in. You should call this method early in your application lifecycle
  *  if desired. The method can be called at any time though, the network activity indicator will be updated accordingly.
@@ -46,15 +46,34 @@ NS_ASSUME_NONNULL_BEGIN
 + (void)disable;
 
 /**
- *  Increase the number of running requests.
+ *  The time during which a change in network activity must persist before the handler is notified (default is 0).
+ *  Setting a short interval (e.g. 0.2 seconds) avoids handler calls for requests finishing quickly, as well as the
+ *  activity indicator flickering when requests follow each other closely. Can be set from any thread.
+ */
+@property (class, nonatomic) NSTimeInterval debounceInterval;
+
+/**
+ *  Increase the number of running requests. Can be called from any thread.
  */
 + (void)increaseNumberOfRunningRequests;
 
 /**
- *  Decrease the number of running requests.
+ *  Decrease the number of running requests. Can be called from any thread.
  */
 + (void)decreaseNumberOfRunningRequests;
 
+/**
+ *  The current number of running requests. Can be read cheaply from any thread, at any time.
+ */
+@property (class, nonatomic, readonly) NSUInteger numberOfRunningRequests;
+
+/**
+ *  The current number of running requests to the specified host. Can be read cheaply from any thread, at any time.
+ *
+ *  @discussion Only requests are counted per host, not activity reported with `+increaseNumberOfRunningRequests`.
+ */
++ (NSUInteger)numberOfRunningRequestsForHost:(NSString *)host;
+
 @end
 
 NS_ASSUME_NONNULL_END
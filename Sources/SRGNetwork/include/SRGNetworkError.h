@@ -24,7 +24,12 @@ typedef NS_ENUM(NSInteger, SRGNetworkErrorCode) {
     /**
      *  Several errors have been encountered. Use the `SRGNetworkErrorsKey` user info key to retrieve the error list.
      */
-    SRGNetworkErrorMultiple
+    SRGNetworkErrorMultiple,
+    /**
+     *  The request could not be completed before its deadline, or before the time budget of its request queue was
+     *  exhausted.
+     */
+    SRGNetworkErrorDeadlineExceeded
 };
 
 /**
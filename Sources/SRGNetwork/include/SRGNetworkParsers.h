@@ -4,6 +4,9 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "SRGJSONSchema.h"
+#import "SRGNetworkTypes.h"
+
 @import Foundation;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -20,4 +23,43 @@ OBJC_EXPORT NSArray * _Nullable SRGNetworkJSONArrayParser(NSData *data, NSError
  */
 OBJC_EXPORT NSDictionary * _Nullable SRGNetworkJSONDictionaryParser(NSData *data, NSError * __autoreleasing *pError);
 
+/**
+ *  Same as `SRGNetworkJSONArrayParser()`, but returning a lazy read-only view over the data (see
+ *  `SRGNetworkJSONDictionaryViewParser()`).
+ */
+OBJC_EXPORT NSArray * _Nullable SRGNetworkJSONArrayViewParser(NSData *data, NSError * __autoreleasing *pError);
+
+/**
+ *  Same as `SRGNetworkJSONDictionaryParser()`, but returning a lazy read-only view over the data. The structure of
+ *  the data is indexed once, and values are only materialized when accessed, which is much faster and uses much
+ *  less memory when only a few values of a large response are read (e.g. the next page link and a few identifiers).
+ *
+ *  @discussion Nested objects and arrays are returned as views as well, and values are materialized again on each
+ *              access, so that views are best suited for sparse reads. Views keep the entire data alive as long as
+ *              they are themselves alive, and should not be stored. Being valid `NSDictionary` and `NSArray`
+ *              objects, they can be used wherever parsed JSON is expected (e.g. by JSON dictionary paginators).
+ *              Strings are only decoded when accessed. Invalid strings, which the indexing cannot detect, are then
+ *              returned as `NSNull`.
+ */
+OBJC_EXPORT NSDictionary * _Nullable SRGNetworkJSONDictionaryViewParser(NSData *data, NSError * __autoreleasing *pError);
+
+/**
+ *  Parser decoding JSON data directly into model objects, as described by the specified schema. If the top-level
+ *  value is an object, a single model is returned. If it is an array, an array of models is returned.
+ *
+ *  @discussion Unlike parsing JSON with `SRGNetworkJSONDictionaryParser()` and then building models from the resulting
+ *              dictionary, decoding is made in a single pass over the data, and only values declared by the schema
+ *              are materialized. The data must be UTF-8 encoded. The parser fails with an error if the data is not
+ *              valid JSON or if some declared value does not have the expected type. The same parser is returned for
+ *              the same schema as long as it is in use, so that objects it parsed can be reused by response caches.
+ */
+OBJC_EXPORT SRGResponseParser SRGNetworkJSONDecodingParser(SRGJSONSchema *schema);
+
+/**
+ *  Same as `SRGNetworkJSONDecodingParser()`, but decoding the object or array found at the specified key path (e.g.
+ *  `mediaList` to decode items wrapped into a dictionary). The parser fails with an error if no object or array is
+ *  found at the key path.
+ */
+OBJC_EXPORT SRGResponseParser SRGNetworkJSONDecodingParserAtKeyPath(SRGJSONSchema *schema, NSString *keyPath);
+
 NS_ASSUME_NONNULL_END
@@ -38,6 +38,26 @@ typedef NS_OPTIONS(NSUInteger, SRGRequestOptions) {
      *  simply enable the following option.
      */
     SRGRequestOptionBackgroundCompletionEnabled = (1UL << 3),
+    /**
+     *  By default, each request performs its own network task. When this flag is set, a request started while an
+     *  equivalent request (same session, HTTP method, URL and headers) is already running attaches to it instead,
+     *  sharing a single download and a single parsing result with all other attached requests. Cancelling a coalesced
+     *  request only cancels the shared network task when all attached requests have been cancelled.
+     *
+     *  Only requests without body, performed with the `GET` or `HEAD` methods, can be coalesced. For other requests
+     *  the flag is ignored.
+     */
+    SRGRequestOptionCoalescingEnabled = (1UL << 4),
+    /**
+     *  By default, response bodies are received in memory. When this flag is set, they are downloaded to a temporary
+     *  file instead, which is then provided to the parser as memory-mapped data, so that the system can page its
+     *  contents in and out as needed. This reduces the memory footprint of large responses, especially with parsers
+     *  reading the data lazily (e.g. `SRGNetworkJSONDictionaryViewParser()`).
+     *
+     *  The temporary file is removed when the data is released, i.e. when the parsed object does not reference it
+     *  anymore. File-backed requests are never coalesced or hedged, and the flag is ignored for streamed requests.
+     */
+    SRGRequestOptionDownloadToFileEnabled = (1UL << 5),
 };
 
 /**
@@ -55,6 +75,9 @@ typedef NS_OPTIONS(NSUInteger, SRGRequestQueueOptions) {
 // Parser signature.
 typedef id _Nullable (^SRGResponseParser)(NSData *data, NSError * __autoreleasing *pError);
 
+// Streamed JSON element signature.
+typedef void (^SRGJSONElementBlock)(id element);
+
 // Sizer signature.
 typedef NSURLRequest * _Nonnull (^SRGPageSizer)(NSURLRequest *URLRequest, NSUInteger size);
 
@@ -64,6 +87,15 @@ typedef NSURLRequest * _Nullable (^SRGJSONArrayPaginator)(NSURLRequest *URLReque
 typedef NSURLRequest * _Nullable (^SRGJSONDictionaryPaginator)(NSURLRequest *URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number);
 typedef NSURLRequest * _Nullable (^SRGObjectPaginator)(NSURLRequest *URLRequest, id _Nullable object, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number);
 
+// Page builder signature (for services with random access to pages).
+typedef NSURLRequest * _Nonnull (^SRGPageBuilder)(NSURLRequest *URLRequest, NSUInteger size, NSUInteger number);
+
+// Page items extractor signature.
+typedef NSArray * _Nullable (^SRGPageItemsExtractor)(id _Nullable object);
+
+// Metrics endpoint provider signature.
+typedef NSString * _Nonnull (^SRGMetricsEndpointProvider)(NSURLRequest *URLRequest);
+
 // Completion block signatures.
 typedef void (^SRGDataCompletionBlock)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error);
 typedef void (^SRGJSONArrayCompletionBlock)(NSArray * _Nullable JSONArray, NSURLResponse * _Nullable response, NSError * _Nullable error);
@@ -76,4 +108,7 @@ typedef void (^SRGJSONArrayPageCompletionBlock)(NSArray * _Nullable JSONArray, S
 typedef void (^SRGJSONDictionaryPageCompletionBlock)(NSDictionary * _Nullable JSONDictionary, SRGPage *page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error);
 typedef void (^SRGObjectPageCompletionBlock)(id _Nullable object, SRGPage *page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error);
 
+// All pages completion block signature.
+typedef void (^SRGAllPagesCompletionBlock)(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error);
+
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,128 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPage.h"
+
+@import Foundation;
+
+@class SRGPageRequest;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A page stored in a page cache.
+ */
+@interface SRGCachedPage : NSObject
+
+/**
+ *  The object parsed for the page.
+ */
+@property (nonatomic, readonly) id object;
+
+/**
+ *  The page.
+ */
+@property (nonatomic, readonly) SRGPage *page;
+
+/**
+ *  The next page, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGPage *nextPage;
+
+/**
+ *  The response received for the page.
+ */
+@property (nonatomic, readonly, nullable) NSURLResponse *response;
+
+/**
+ *  The approximate memory cost of the page (in bytes).
+ */
+@property (nonatomic, readonly) NSUInteger cost;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ *  A page cache keeps the pages retrieved by page requests it has been attached to (see `-[SRGPageRequest requestWithPageCache:]`)
+ *  in memory, so that they can be displayed again instantly, e.g. when navigating back to a list.
+ *
+ *  Unlike a response cache, a page cache ignores HTTP caching headers and stores parsed objects only. Pages are kept
+ *  until they are evicted (least recently used pages first) to keep the total cost below the cost limit, until the
+ *  system is under memory pressure, or until they are explicitly removed. Pages of a list, whatever their size, can
+ *  be removed at once (e.g. when the list is refreshed by the user) with `-removeCachedPagesForRequest:`.
+ *
+ *  ## Thread-safety
+ *
+ *  Page caches can be used from any thread.
+ */
+@interface SRGPageCache : NSObject
+
+/**
+ *  Create a cache with the specified cost limit (in bytes). The cost of a page is the length of the response data
+ *  it was parsed from.
+ */
+- (instancetype)initWithCostLimit:(NSUInteger)costLimit NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The cost limit (in bytes). Reducing the limit immediately evicts pages if needed.
+ */
+@property (nonatomic) NSUInteger costLimit;
+
+/**
+ *  The total cost of the cached pages (in bytes).
+ */
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+/**
+ *  The number of cached pages.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfCachedPages;
+
+/**
+ *  Return the cached page for the page the specified request retrieves, if any. Can be used to synchronously display
+ *  a page before the request for it is started.
+ *
+ *  @discussion Pages are cached per request family: only requests derived from each other, or created with the same
+ *              parser (e.g. JSON dictionary page requests), share cached pages.
+ */
+- (nullable SRGCachedPage *)cachedPageForRequest:(SRGPageRequest *)request;
+
+/**
+ *  Remove all cached pages of the list the specified request belongs to.
+ */
+- (void)removeCachedPagesForRequest:(SRGPageRequest *)request;
+
+/**
+ *  Remove all cached pages.
+ */
+- (void)removeAllCachedPages;
+
+/**
+ *  Number of lookups for which a cached page was found.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfHits;
+
+/**
+ *  Number of lookups for which no cached page was found.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfMisses;
+
+/**
+ *  Number of pages evicted because of the cost limit.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfEvictions;
+
+/**
+ *  Reset all counters to zero.
+ */
+- (void)resetStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -6,6 +6,7 @@
 
 #import "SRGBaseRequest.h"
 #import "SRGPage.h"
+#import "SRGPageCache.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -14,11 +15,43 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @interface SRGPageRequest : SRGBaseRequest
 
+/**
+ *  Return a clone of the receiver, prefetching up to the specified number of pages ahead (0 = disabled, the default).
+ *
+ *  @discussion When a request with prefetching enabled succeeds, the following pages are retrieved and parsed in the
+ *              background, one after the other. Requests for prefetched pages (obtained with `-requestWithPage:` from
+ *              the same original request) then complete without any network access. Prefetched pages are kept for
+ *              at most one minute, and discarded when the system is under memory pressure or when too many pages have
+ *              been prefetched but not requested.
+ */
+- (__kindof SRGPageRequest *)requestWithPrefetchDepth:(NSUInteger)prefetchDepth;
+
+/**
+ *  Return a clone of the receiver, storing the pages it retrieves into the specified cache (`nil` = disabled, the default).
+ *
+ *  @discussion Requests for cached pages (obtained with `-requestWithPage:` from the same original request) complete
+ *              with the cached result, without any network access or parsing, whatever the HTTP caching headers say.
+ *              Use `-[SRGPageCache cachedPageForRequest:]` to synchronously retrieve a cached page without starting a
+ *              request, and `-[SRGPageCache removeCachedPagesForRequest:]` to discard the pages of a list, e.g. when
+ *              the user explicitly refreshes it. A cache can be shared between several lists.
+ */
+- (__kindof SRGPageRequest *)requestWithPageCache:(nullable SRGPageCache *)pageCache;
+
 /**
  *  The page which is requested.
  */
 @property (nonatomic, readonly) SRGPage *page;
 
+/**
+ *  The number of pages prefetched ahead.
+ */
+@property (nonatomic, readonly) NSUInteger prefetchDepth;
+
+/**
+ *  The cache in which retrieved pages are stored, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGPageCache *pageCache;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,121 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGFirstPageRequest.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A page delivered by a page stream.
+ */
+@interface SRGStreamedPage : NSObject
+
+/**
+ *  The object obtained for the page, if any.
+ */
+@property (nonatomic, readonly, nullable) id object;
+
+/**
+ *  The page.
+ */
+@property (nonatomic, readonly) SRGPage *page;
+
+/**
+ *  The response received for the page.
+ */
+@property (nonatomic, readonly, nullable) NSURLResponse *response;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+// Block signatures.
+typedef void (^SRGPageStreamCompletionBlock)(SRGStreamedPage * _Nullable_result streamedPage, NSError * _Nullable error);
+
+/**
+ *  A page stream delivers the pages of a list one after the other, on demand. Each page is requested only when the
+ *  consumer asks for it with `-nextPageWithCompletionBlock:`, optionally with a few pages read ahead, so that very
+ *  long lists can be consumed in constant memory, without chaining page requests by hand.
+ *
+ *  From Swift, `-nextPageWithCompletionBlock:` is available as an `async` method, from which an `AsyncSequence` is
+ *  easily obtained:
+ *
+ *  ```swift
+ *  let pages = AsyncThrowingStream { try await pageStream.nextPage() }
+ *  for try await page in pages { ... }
+ *  ```
+ *
+ *  Wrap the call with `withTaskCancellationHandler(operation:onCancel:)`, calling `-cancel` when cancelled, so that
+ *  cancelling the consuming task cancels the page request in flight.
+ *
+ *  ## Thread-safety
+ *
+ *  Page streams can be used from any thread.
+ */
+@interface SRGPageStream : NSObject
+
+/**
+ *  Create a stream delivering the pages of the specified request, starting with its page.
+ *
+ *  @param request   The request of the first page to deliver. Its completion block is never called, but its settings
+ *                   and options apply to all page requests (except cancellation errors, always reported, see below).
+ *                   Page requests never prefetch pages, see `readAhead` instead.
+ *  @param readAhead The number of pages retrieved ahead of the pages requested by the consumer (0 = none). Pages are
+ *                   always retrieved one after the other, since each page request is obtained from the response to
+ *                   the previous one.
+ */
+- (instancetype)initWithRequest:(SRGFirstPageRequest *)request readAhead:(NSUInteger)readAhead NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Ask for the next page. The completion block is called with the page, or with `nil` once all pages have been
+ *  delivered. Calls made while a page is awaited are served in order.
+ *
+ *  @discussion The completion block is called on the main thread, except if the request of the stream has the
+ *              `SRGRequestOptionBackgroundCompletionEnabled` option set. Once a page request has failed, or once the
+ *              stream has been cancelled, the completion block is always called with the corresponding error (a
+ *              cancellation error in the latter case).
+ */
+- (void)nextPageWithCompletionBlock:(SRGPageStreamCompletionBlock)completionBlock;
+
+/**
+ *  Cancel the stream. The page request in flight, if any, is cancelled, and awaited pages are delivered with an
+ *  `NSURLErrorCancelled` error.
+ */
+- (void)cancel;
+
+/**
+ *  The request of the first page.
+ */
+@property (nonatomic, readonly) SRGFirstPageRequest *request;
+
+/**
+ *  The number of pages retrieved ahead of the pages requested by the consumer.
+ */
+@property (nonatomic, readonly) NSUInteger readAhead;
+
+/**
+ *  The number of pages delivered so far.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfDeliveredPages;
+
+/**
+ *  The number of pages retrieved and not delivered yet.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfBufferedPages;
+
+/**
+ *  `YES` iff the stream does not deliver pages anymore (all pages have been delivered, a page request failed, or the
+ *  stream was cancelled).
+ */
+@property (nonatomic, readonly, getter=isFinished) BOOL finished;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,51 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A parsing executor runs response processing work (parsing and extraction) for the requests it has been attached
+ *  to (see `-[SRGBaseRequest requestWithParsingExecutor:]`), off the session delegate queue.
+ *
+ *  Executors run at most a given number of operations concurrently. When this limit is reached, pending operations
+ *  are started as running ones finish, those with the highest quality of service first (and in submission order for
+ *  the same quality of service). Operations are executed with the quality of service of the request they belong to.
+ *
+ *  ## Thread-safety
+ *
+ *  Parsing executors can be used from any thread.
+ */
+@interface SRGParsingExecutor : NSObject
+
+/**
+ *  Shared executor, running as many operations concurrently as there are active processors. Used by all requests
+ *  by default.
+ */
+@property (class, nonatomic, readonly) SRGParsingExecutor *sharedExecutor;
+
+/**
+ *  Create an executor running at most the specified number of operations concurrently (at least one).
+ */
+- (instancetype)initWithMaximumConcurrentOperationCount:(NSUInteger)maximumConcurrentOperationCount NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The maximum number of operations executed concurrently.
+ */
+@property (nonatomic, readonly) NSUInteger maximumConcurrentOperationCount;
+
+/**
+ *  The number of operations currently running, respectively waiting to be run.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfRunningOperations;
+@property (nonatomic, readonly) NSUInteger numberOfPendingOperations;
+
+@end
+
+NS_ASSUME_NONNULL_END
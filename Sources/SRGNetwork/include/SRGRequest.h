@@ -57,14 +57,33 @@ NS_ASSUME_NONNULL_BEGIN
  *  If helpful, some standard basic parsers are available from <SRGNetwork/SRGNetworkParsers.h>.
  *
  *  @discussion An error is returned to the completion block if parsing fails. The parsing block will be called on a
- *              background thread (except if the session is configured with the main operation queue, which is best
- *              avoided).
+ *              background thread managed by the request parsing executor (see `-requestWithParsingExecutor:`), never
+ *              on the session delegate queue.
  */
 + (SRGRequest *)objectRequestWithURLRequest:(NSURLRequest *)URLRequest
                                     session:(NSURLSession *)session
                                      parser:(SRGResponseParser)parser
                             completionBlock:(SRGObjectCompletionBlock)completionBlock;
 
+/**
+ *  Request started with the provided session, parsing the response as JSON while it is received (rather than once
+ *  it has been entirely downloaded), and calling the specified block on completion with the top-level JSON object
+ *  (usually an array or a dictionary).
+ *
+ *  If an element block is provided and the top-level JSON object is an array, each array element is provided to the
+ *  block as soon as it has been parsed. Elements are then not accumulated, and the completion block receives an
+ *  empty array, which makes it possible to process arbitrarily large arrays with constant memory.
+ *
+ *  @discussion An error is returned to the completion block if the response is not valid JSON. The element block
+ *              is called in order on a background thread. Streamed requests cannot be coalesced or cached, and
+ *              the corresponding settings are ignored. Authentication challenges are handled by the session
+ *              delegate, and parsing is performed by the parsing executor of the request.
+ */
++ (SRGRequest *)JSONStreamRequestWithURLRequest:(NSURLRequest *)URLRequest
+                                        session:(NSURLSession *)session
+                                   elementBlock:(nullable SRGJSONElementBlock)elementBlock
+                                completionBlock:(SRGObjectCompletionBlock)completionBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRequest.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef NSURLRequest * _Nonnull (^SRGBatchBuilder)(NSArray<NSString *> *keys);
+typedef NSDictionary<NSString *, id> * _Nullable (^SRGBatchSplitter)(NSData *data, NSArray<NSString *> *keys, NSError * __autoreleasing *pError);
+
+/**
+ *  A request batcher merges logical requests for individual items, identified by keys (e.g. item identifiers), into
+ *  a single request to a bulk service. Logical requests started within a short window are batched together, until
+ *  the window ends or a maximum number of distinct keys is reached. The batch request is built from the keys, and its
+ *  response is split back into one object per key, delivered to the logical requests.
+ *
+ *  Logical requests are usual requests, which can be configured with options or added to request queues. Cancelling
+ *  a logical request only cancels the batch request when all logical requests it serves have been cancelled. Logical
+ *  requests cancelled before their batch has been started are not included in it.
+ *
+ *  ## Thread-safety
+ *
+ *  Request batchers can be used from any thread. Builder and splitter blocks are called on background threads.
+ */
+@interface SRGRequestBatcher : NSObject
+
+/**
+ *  Create a batcher performing batch requests with the specified session.
+ *
+ *  @param window           The time during which logical requests are collected after the first one of a batch has
+ *                          been started.
+ *  @param maximumBatchSize The maximum number of distinct keys per batch (at least 1). A batch is started immediately
+ *                          when this number is reached.
+ *  @param builder          Block returning the batch request for a list of keys, in the order they were requested.
+ *                          A request built for a single key is used to describe the corresponding logical requests.
+ *  @param splitter         Block splitting the data of a successful batch response into objects, keyed by their
+ *                          respective keys. If an error is returned, all logical requests of the batch fail with it.
+ *                          Logical requests whose key is missing succeed with a `nil` object.
+ */
+- (instancetype)initWithSession:(NSURLSession *)session
+                         window:(NSTimeInterval)window
+               maximumBatchSize:(NSUInteger)maximumBatchSize
+                        builder:(SRGBatchBuilder)builder
+                       splitter:(SRGBatchSplitter)splitter NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Return a (non-started) logical request for the item with the specified key. Its completion block is called with
+ *  the object obtained for the key when the corresponding batch finishes.
+ *
+ *  @discussion Logical requests are never cached, coalesced, hedged or streamed. Their priority is applied to the
+ *              batch request if higher than the ones of other logical requests of the same batch.
+ */
+- (SRGRequest *)requestForKey:(NSString *)key completionBlock:(SRGObjectCompletionBlock)completionBlock;
+
+/**
+ *  The session used for batch requests.
+ */
+@property (nonatomic, readonly) NSURLSession *session;
+
+/**
+ *  The window during which logical requests are collected.
+ */
+@property (nonatomic, readonly) NSTimeInterval window;
+
+/**
+ *  The maximum number of distinct keys per batch.
+ */
+@property (nonatomic, readonly) NSUInteger maximumBatchSize;
+
+/**
+ *  The number of batch requests which have been started.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfBatches;
+
+@end
+
+NS_ASSUME_NONNULL_END
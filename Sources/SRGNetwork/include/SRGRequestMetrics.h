@@ -0,0 +1,85 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Request phases for which durations are measured.
+ */
+typedef NS_ENUM(NSInteger, SRGRequestPhase) {
+    /**
+     *  Transport phases, from the metrics collected by the URL loading system for the last network transaction.
+     */
+    SRGRequestPhaseDomainLookup = 0,
+    SRGRequestPhaseConnect,
+    SRGRequestPhaseSecureConnection,
+    SRGRequestPhaseTimeToFirstByte,
+    SRGRequestPhaseDownload,
+    /**
+     *  Response parsing, excluding the time spent waiting for the parsing executor.
+     */
+    SRGRequestPhaseParsing,
+    /**
+     *  Object extraction (e.g. next page extraction for page requests).
+     */
+    SRGRequestPhaseExtraction,
+    /**
+     *  Time between the moment the result is ready and the moment the completion block is called (e.g. waiting for
+     *  the main thread).
+     */
+    SRGRequestPhaseDelivery,
+    /**
+     *  Time between the moment the request is started and the moment its completion block is called.
+     */
+    SRGRequestPhaseTotal
+};
+
+/**
+ *  The number of request phases.
+ */
+static const NSInteger SRGRequestPhaseCount = SRGRequestPhaseTotal + 1;
+
+/**
+ *  Timing metrics for a request execution (see `-[SRGBaseRequest requestWithMetricsCollector:]`).
+ *
+ *  @discussion Transport phases are only available for requests which are neither coalesced, hedged nor streamed, on
+ *              iOS 15, tvOS 15, watchOS 8 and above. They are not available either for responses served from a response
+ *              cache without network access.
+ */
+@interface SRGRequestMetrics : NSObject
+
+/**
+ *  The request.
+ */
+@property (nonatomic, readonly) NSURLRequest *URLRequest;
+
+/**
+ *  The endpoint the metrics have been recorded for (see `SRGMetricsCollector`).
+ */
+@property (nonatomic, readonly, copy) NSString *endpoint;
+
+/**
+ *  The date at which the request was started.
+ */
+@property (nonatomic, readonly) NSDate *startDate;
+
+/**
+ *  Return the duration of the specified phase, or a negative value if it could not be measured.
+ */
+- (NSTimeInterval)durationForPhase:(SRGRequestPhase)phase;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ *  Return a readable name for the specified phase.
+ */
+OBJC_EXPORT NSString *SRGRequestPhaseName(SRGRequestPhase phase);
+
+NS_ASSUME_NONNULL_END
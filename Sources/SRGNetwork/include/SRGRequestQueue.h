@@ -96,24 +96,62 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (SRGRequestQueue *)requestQueueWithOptions:(SRGRequestQueueOptions)options;
 
+/**
+ *  Return a clone of the receiver, starting at most the specified number of requests at the same time. Use 0 for
+ *  no limit (the default).
+ *
+ *  @discussion When the limit is reached, requests resumed through the queue (with `-addRequest:resume:` or `-resume`)
+ *              wait until a running request ends. Waiting requests are started by decreasing priority (see
+ *              `SRGBaseRequest` `-requestWithPriority:`), and in the order they were resumed for the same priority.
+ *              A queue is running while some of its requests are waiting to be started. Requests resumed directly
+ *              (calling `-resume` on the request itself) are not subject to the limit.
+ */
+- (SRGRequestQueue *)requestQueueWithMaximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests;
+
+/**
+ *  Return a clone of the receiver, applying the specified retry policy to requests added to it which do not have
+ *  a retry policy of their own (see `-[SRGBaseRequest requestWithRetryPolicy:]`). Use `nil` for no retries (the
+ *  default).
+ *
+ *  @discussion Requests stay running while they wait to be attempted again, retries are therefore invisible to the
+ *              queue state.
+ */
+- (SRGRequestQueue *)requestQueueWithRetryPolicy:(nullable SRGRetryPolicy *)retryPolicy;
+
+/**
+ *  Return a clone of the receiver, whose requests share the specified time budget (in seconds) each time the queue
+ *  runs. Use 0 for no budget (the default).
+ *
+ *  @discussion The budget starts when the queue starts running. Requests resumed while the queue is running must then
+ *              be completed before the budget is exhausted, otherwise they are cancelled and their completion block is
+ *              called with an `SRGNetworkErrorDeadlineExceeded` error (see `-[SRGBaseRequest requestWithDeadline:]`).
+ *              Requests waiting to be started when the budget is exhausted fail with the same error, without any
+ *              network access.
+ */
+- (SRGRequestQueue *)requestQueueWithTimeBudget:(NSTimeInterval)timeBudget;
+
 /**
  *  Add a request to the queue. The queue status will immediately be updated according to the status of the request
  *  added to it.
  *
  *  @param request The request to add to the queue.
- *  @param resume  If set to `YES`, `-resume` is automatically called on the request when added to the queue.
+ *  @param resume  If set to `YES`, `-resume` is automatically called on the request when added to the queue (or
+ *                 later if the maximum number of concurrent requests has been reached).
  *
- *  @discussion Adding the same request to two different queues is not supported and leads to undefined behavior.
+ *  @discussion A request can be added to several queues, each one tracking its status independently. Its deadline is
+ *              then the earliest of the deadlines of these queues, and the retry policy of the first queue it was added
+ *              to which has one applies (unless the request has its own retry policy). Cancelling a queue cancels
+ *              the request for all other queues as well.
  */
 - (void)addRequest:(SRGBaseRequest *)request resume:(BOOL)resume;
 
 /**
- *  Call `-resume` on all requests within the queue.
+ *  Call `-resume` on all requests within the queue, honoring the maximum number of concurrent requests.
  */
 - (void)resume;
 
 /**
- *  Call `-cancel` on all requests within the queue.
+ *  Call `-cancel` on all requests within the queue. Requests waiting to be started are discarded.
  */
 - (void)cancel;
 
@@ -134,6 +172,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly, getter=isRunning) BOOL running;
 
+/**
+ *  The retry policy applied to requests without retry policy of their own.
+ */
+@property (nonatomic, readonly, nullable) SRGRetryPolicy *retryPolicy;
+
+/**
+ *  The time budget shared by requests each time the queue runs, 0 if none.
+ */
+@property (nonatomic, readonly) NSTimeInterval timeBudget;
+
 @end
 
 NS_ASSUME_NONNULL_END
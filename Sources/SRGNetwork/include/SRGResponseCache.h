@@ -0,0 +1,99 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A response cache stores responses received by requests it has been attached to (see `-[SRGBaseRequest requestWithResponseCache:]`),
+ *  in two tiers:
+ *    - An in-memory tier, with least recently used eviction, storing raw response bodies as well as the object last
+ *      parsed from each of them.
+ *    - An on-disk tier, storing raw response bodies only.
+ *
+ *  Responses are stored according to their `Cache-Control` and `Expires` headers. A fresh cached response is directly
+ *  used without any network access. A stale one is revalidated using its `ETag` and `Last-Modified` headers, in which
+ *  case a `304 Not Modified` server response is transparently turned into a cache hit. Objects parsed from cached
+ *  responses are reused, so that a parser is not called again when data has not changed. Parsers are identified by
+ *  pointer, and must therefore be created once rather than for each request.
+ *
+ *  Only successful `GET` requests without body are cached.
+ *
+ *  ## Thread-safety
+ *
+ *  Response caches can be used from any thread.
+ */
+@interface SRGResponseCache : NSObject
+
+/**
+ *  Shared cache instance, with a 4 MB memory capacity and a 20 MB disk capacity.
+ */
+@property (class, nonatomic, readonly) SRGResponseCache *sharedCache;
+
+/**
+ *  Create a cache with the specified capacities (in bytes).
+ *
+ *  @param directoryURL The directory where responses must be stored on disk. If `nil`, a directory within the user
+ *                      caches directory is used. Using the same directory for several caches leads to undefined behavior.
+ */
+- (instancetype)initWithMemoryCapacity:(NSUInteger)memoryCapacity
+                          diskCapacity:(NSUInteger)diskCapacity
+                          directoryURL:(nullable NSURL *)directoryURL NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Memory and disk capacities (in bytes). Reducing a capacity immediately evicts responses if needed.
+ */
+@property (nonatomic) NSUInteger memoryCapacity;
+@property (nonatomic) NSUInteger diskCapacity;
+
+/**
+ *  Current memory and disk usage (in bytes).
+ */
+@property (nonatomic, readonly) NSUInteger currentMemoryUsage;
+@property (nonatomic, readonly) NSUInteger currentDiskUsage;
+
+/**
+ *  Remove all cached responses.
+ */
+- (void)removeAllCachedResponses;
+
+/**
+ *  Number of requests served from the cache, either directly or after a successful revalidation.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfHits;
+
+/**
+ *  Number of hits for which a revalidation with the server was required.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfRevalidations;
+
+/**
+ *  Number of stale responses used while being revalidated (see `-[SRGBaseRequest requestWithMaximumStaleness:]`).
+ *  Each revalidation is then counted as a hit or as a miss as well.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfStaleHits;
+
+/**
+ *  Number of requests for which no usable cached response was found.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfMisses;
+
+/**
+ *  Number of responses evicted from the memory or disk tiers because of capacity constraints.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfEvictions;
+
+/**
+ *  Reset all counters to zero.
+ */
+- (void)resetStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,91 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A retry policy defines whether and when a request failing with a transient error is attempted again (see
+ *  `-[SRGBaseRequest requestWithRetryPolicy:]` and `-[SRGRequestQueue requestQueueWithRetryPolicy:]`).
+ *
+ *  By default, a request is retried if it failed because of a network error which is likely transient (e.g. a timeout
+ *  or a lost connection), or with one of the `retryableHTTPStatusCodes`. Delays between attempts grow exponentially,
+ *  with full jitter so that clients failing at the same time do not retry in sync. If the server provides a
+ *  `Retry-After` header, it is honored instead. Requests are only retried as long as the maximum number of attempts
+ *  and the time budget have not been exhausted. Only requests with idempotent methods are retried.
+ *
+ *  Subclass and override `-shouldRetryURLRequest:afterAttempt:withResponse:error:` or
+ *  `-delayBeforeAttempt:withResponse:` to customize this behavior.
+ *
+ *  ## Thread-safety
+ *
+ *  Retry policies can be used from any thread, but must not be altered once attached to a request.
+ */
+@interface SRGRetryPolicy : NSObject
+
+/**
+ *  Policy attempting a request at most 3 times within 30 seconds.
+ */
+@property (class, nonatomic, readonly) SRGRetryPolicy *defaultPolicy;
+
+/**
+ *  Create a policy attempting a request at most `maximumNumberOfAttempts` times (the first attempt included), and
+ *  never retrying once `timeBudget` seconds have elapsed since the first attempt.
+ */
+- (instancetype)initWithMaximumNumberOfAttempts:(NSUInteger)maximumNumberOfAttempts timeBudget:(NSTimeInterval)timeBudget NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The maximum number of attempts, the first one included.
+ */
+@property (nonatomic, readonly) NSUInteger maximumNumberOfAttempts;
+
+/**
+ *  The time budget within which retries can be made.
+ */
+@property (nonatomic, readonly) NSTimeInterval timeBudget;
+
+/**
+ *  The base delay before the first retry (default is 0.5 seconds). The delay is randomly picked up to a bound
+ *  doubling with each retry, itself bounded by `maximumDelay`.
+ */
+@property (nonatomic) NSTimeInterval baseDelay;
+
+/**
+ *  The maximum delay between two attempts (default is 10 seconds).
+ */
+@property (nonatomic) NSTimeInterval maximumDelay;
+
+/**
+ *  HTTP status codes for which a request is retried (default is 408, 429, 502, 503 and 504).
+ */
+@property (nonatomic, copy) NSIndexSet *retryableHTTPStatusCodes;
+
+/**
+ *  If set to `YES`, requests with non-idempotent methods (e.g. `POST`) are retried as well. Default is `NO`.
+ */
+@property (nonatomic, getter=isNonIdempotentRequestRetryEnabled) BOOL nonIdempotentRequestRetryEnabled;
+
+/**
+ *  Return `YES` iff a request which failed after the specified attempt (1 for the first one) must be attempted again.
+ *  The time budget is checked separately.
+ */
+- (BOOL)shouldRetryURLRequest:(NSURLRequest *)URLRequest
+                 afterAttempt:(NSUInteger)attempt
+                 withResponse:(nullable NSURLResponse *)response
+                        error:(nullable NSError *)error;
+
+/**
+ *  Return the delay to wait before the specified attempt (2 for the first retry), given the response of the previous
+ *  attempt.
+ */
+- (NSTimeInterval)delayBeforeAttempt:(NSUInteger)attempt withResponse:(nullable NSURLResponse *)response;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,70 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+#import "LoopbackServer.h"
+
+@import SRGNetwork;
+@import XCTest;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^BenchmarkLatencyHandler)(NSTimeInterval latency);
+
+/**
+ *  Base class for benchmarks. A loopback server using `+[LoopbackServer configurableHandler]` is started for each
+ *  test, so that benchmarks run without Internet access. A fixture store using the same handler is also available,
+ *  serving responses in-process to isolate the library overhead from the cost of the loopback network stack.
+ *
+ *  Results are emitted as JSON files (one per scenario) to the directory specified by the `SRG_BENCHMARK_OUTPUT_DIRECTORY`
+ *  environment variable, or to a temporary directory if not set. If set, the `SRG_BENCHMARK_REVISION` environment
+ *  variable is included in results, so that they can be compared between commits.
+ */
+@interface BenchmarkTestCase : XCTestCase
+
+/**
+ *  The running loopback server.
+ */
+@property (nonatomic, readonly) LoopbackServer *server;
+
+/**
+ *  Ephemeral session dedicated to the benchmark.
+ */
+@property (nonatomic, readonly) NSURLSession *session;
+
+/**
+ *  The in-process fixture store.
+ */
+@property (nonatomic, readonly) FixtureStore *fixtureStore;
+
+/**
+ *  Request to the loopback server, configured with the specified query parameters (see `+[LoopbackServer configurableHandler]`).
+ */
+- (NSURLRequest *)URLRequestWithParameters:(nullable NSDictionary<NSString *, id> *)parameters;
+
+/**
+ *  Same as `-URLRequestWithParameters:`, but for a request served by the fixture store. Such requests must be performed
+ *  with the fixture store session.
+ */
+- (NSURLRequest *)inProcessURLRequestWithParameters:(nullable NSDictionary<NSString *, id> *)parameters;
+
+/**
+ *  Run a scenario. The block must perform its work synchronously, call the provided handler with the latency of each
+ *  operation (on the main thread), and return the number of operations performed. Throughput, latency percentiles,
+ *  allocations and peak memory are then measured and emitted.
+ */
+- (void)runScenario:(NSString *)scenario withBlock:(NSUInteger (^)(BenchmarkLatencyHandler latencyHandler))block;
+
+/**
+ *  Record an additional result (a JSON-serializable value) for the scenario being run, e.g. the number of bytes
+ *  transferred. Must be called from the scenario block, on the main thread.
+ */
+- (void)recordResult:(id)result forKey:(NSString *)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,169 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+#import <mach/mach.h>
+#import <malloc/malloc.h>
+
+static uint64_t BenchmarkPhysicalFootprint(void);
+static NSTimeInterval BenchmarkPercentile(NSArray<NSNumber *> *sortedLatencies, double percentile);
+
+@interface BenchmarkTestCase ()
+
+@property (nonatomic) LoopbackServer *server;
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic) FixtureStore *fixtureStore;
+@property (nonatomic) NSMutableDictionary<NSString *, id> *additionalResults;
+
+@end
+
+@implementation BenchmarkTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([self.server start]);
+    
+    NSURLSessionConfiguration *sessionConfiguration = NSURLSessionConfiguration.ephemeralSessionConfiguration;
+    sessionConfiguration.HTTPMaximumConnectionsPerHost = 8;
+    self.session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+    
+    self.fixtureStore = [[FixtureStore alloc] initWithHandler:LoopbackServer.configurableHandler];
+}
+
+- (void)tearDown
+{
+    [self.session invalidateAndCancel];
+    self.session = nil;
+    
+    [self.server stop];
+    self.server = nil;
+    
+    self.fixtureStore = nil;
+}
+
+#pragma mark Requests
+
+- (NSURLRequest *)URLRequestWithParameters:(NSDictionary<NSString *, id> *)parameters
+{
+    return [self URLRequestWithURL:[self.server URLForPath:@"/benchmark"] parameters:parameters];
+}
+
+- (NSURLRequest *)inProcessURLRequestWithParameters:(NSDictionary<NSString *, id> *)parameters
+{
+    return [self URLRequestWithURL:[self.fixtureStore URLForPath:@"/benchmark"] parameters:parameters];
+}
+
+- (NSURLRequest *)URLRequestWithURL:(NSURL *)URL parameters:(NSDictionary<NSString *, id> *)parameters
+{
+    NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+    NSMutableArray<NSURLQueryItem *> *queryItems = [NSMutableArray array];
+    [parameters enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull name, id _Nonnull value, BOOL * _Nonnull stop) {
+        [queryItems addObject:[NSURLQueryItem queryItemWithName:name value:[value description]]];
+    }];
+    URLComponents.queryItems = queryItems.copy;
+    return [NSURLRequest requestWithURL:URLComponents.URL];
+}
+
+#pragma mark Scenarios
+
+- (void)runScenario:(NSString *)scenario withBlock:(NSUInteger (^)(BenchmarkLatencyHandler _Nonnull))block
+{
+    // Sample the memory footprint regularly to find its peak value during the scenario
+    uint64_t initialFootprint = BenchmarkPhysicalFootprint();
+    __block uint64_t peakFootprint = initialFootprint;
+    
+    dispatch_queue_t samplingQueue = dispatch_queue_create("ch.srgssr.network.benchmarks.sampling", DISPATCH_QUEUE_SERIAL);
+    dispatch_source_t samplingSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, samplingQueue);
+    dispatch_source_set_timer(samplingSource, DISPATCH_TIME_NOW, 5 * NSEC_PER_MSEC, NSEC_PER_MSEC);
+    dispatch_source_set_event_handler(samplingSource, ^{
+        peakFootprint = MAX(peakFootprint, BenchmarkPhysicalFootprint());
+    });
+    dispatch_resume(samplingSource);
+    
+    self.additionalResults = [NSMutableDictionary dictionary];
+    
+    malloc_statistics_t initialStatistics;
+    malloc_zone_statistics(NULL, &initialStatistics);
+    
+    NSMutableArray<NSNumber *> *latencies = [NSMutableArray array];
+    NSDate *startDate = NSDate.date;
+    NSUInteger numberOfOperations = block(^(NSTimeInterval latency) {
+        [latencies addObject:@(latency)];
+    });
+    NSTimeInterval duration = [NSDate.date timeIntervalSinceDate:startDate];
+    
+    malloc_statistics_t finalStatistics;
+    malloc_zone_statistics(NULL, &finalStatistics);
+    
+    dispatch_source_cancel(samplingSource);
+    dispatch_sync(samplingQueue, ^{
+        peakFootprint = MAX(peakFootprint, BenchmarkPhysicalFootprint());
+    });
+    
+    NSArray<NSNumber *> *sortedLatencies = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    NSMutableDictionary<NSString *, id> *result = self.additionalResults;
+    self.additionalResults = nil;
+    
+    result[@"scenario"] = scenario;
+    result[@"date"] = [[[NSISO8601DateFormatter alloc] init] stringFromDate:startDate];
+    result[@"revision"] = NSProcessInfo.processInfo.environment[@"SRG_BENCHMARK_REVISION"];
+    result[@"operations"] = @(numberOfOperations);
+    result[@"duration"] = @(duration);
+    result[@"operationsPerSecond"] = @((duration > 0.) ? numberOfOperations / duration : 0.);
+    result[@"latency"] = @{ @"mean" : [sortedLatencies valueForKeyPath:@"@avg.self"] ?: @0,
+                            @"p50" : @(BenchmarkPercentile(sortedLatencies, 0.5)),
+                            @"p90" : @(BenchmarkPercentile(sortedLatencies, 0.9)),
+                            @"p99" : @(BenchmarkPercentile(sortedLatencies, 0.99)),
+                            @"max" : sortedLatencies.lastObject ?: @0 };
+    result[@"netAllocatedBytes"] = @((int64_t)finalStatistics.size_in_use - (int64_t)initialStatistics.size_in_use);
+    result[@"netAllocatedBlocks"] = @((int64_t)finalStatistics.blocks_in_use - (int64_t)initialStatistics.blocks_in_use);
+    result[@"peakFootprintIncreaseBytes"] = @(peakFootprint - initialFootprint);
+    
+    NSData *data = [NSJSONSerialization dataWithJSONObject:result options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys error:NULL];
+    
+    NSString *outputDirectoryPath = NSProcessInfo.processInfo.environment[@"SRG_BENCHMARK_OUTPUT_DIRECTORY"] ?: [NSTemporaryDirectory() stringByAppendingPathComponent:@"SRGNetworkBenchmarks"];
+    NSURL *outputDirectoryURL = [NSURL fileURLWithPath:outputDirectoryPath isDirectory:YES];
+    [NSFileManager.defaultManager createDirectoryAtURL:outputDirectoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+    
+    NSURL *outputFileURL = [outputDirectoryURL URLByAppendingPathComponent:[scenario stringByAppendingPathExtension:@"json"]];
+    XCTAssertTrue([data writeToURL:outputFileURL atomically:YES]);
+    
+    NSLog(@"[BENCHMARK] %@ (written to %@)", [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding], outputFileURL.path);
+}
+
+- (void)recordResult:(id)result forKey:(NSString *)key
+{
+    NSAssert(self.additionalResults, @"Results can only be recorded while a scenario is running");
+    self.additionalResults[key] = result;
+}
+
+@end
+
+#pragma mark Static functions
+
+static uint64_t BenchmarkPhysicalFootprint(void)
+{
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.phys_footprint;
+}
+
+static NSTimeInterval BenchmarkPercentile(NSArray<NSNumber *> *sortedLatencies, double percentile)
+{
+    if (sortedLatencies.count == 0) {
+        return 0.;
+    }
+    
+    NSUInteger rank = MAX((NSUInteger)ceil(percentile * sortedLatencies.count), 1);
+    return sortedLatencies[MIN(rank, sortedLatencies.count) - 1].doubleValue;
+}
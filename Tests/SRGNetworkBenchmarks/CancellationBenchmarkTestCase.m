@@ -0,0 +1,127 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+#import <stdatomic.h>
+
+static const NSUInteger kNumberOfRequests = 60;
+static const NSUInteger kNumberOfVisibleRequests = 4;
+static const NSTimeInterval kScrollingInterval = 0.02;
+
+static atomic_ulong s_numberOfDecodedResponses = 0;
+
+@interface CancellationBenchmarkItem : NSObject
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, copy) NSString *title;
+
+@end
+
+// Simulates fast scrolling through a list whose cells each load a large page of items. Requests for cells scrolled
+// out of view are either left running (their results being ignored) or cancelled. Only the requests of the cells
+// finally visible are measured, the number of responses fully decoded being recorded as well.
+@interface CancellationBenchmarkTestCase : BenchmarkTestCase
+
+@property (nonatomic) SRGJSONSchema *itemSchema;
+
+@end
+
+@implementation CancellationBenchmarkTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.itemSchema = [SRGJSONSchema schemaWithModelClass:CancellationBenchmarkItem.class fields:@[
+        [SRGJSONField fieldWithKeyPath:@"identifier" property:@"identifier" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"title" property:@"title" type:SRGJSONFieldTypeString]
+    ]];
+}
+
+- (void)tearDown
+{
+    self.itemSchema = nil;
+    
+    [super tearDown];
+}
+
+#pragma mark Helpers
+
+- (void)runScenario:(NSString *)scenario cancellingRequests:(BOOL)cancellingRequests
+{
+    // A dedicated executor, so that parsing backlogs do not leak between scenarios
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:2];
+    SRGResponseParser decodingParser = SRGNetworkJSONDecodingParserAtKeyPath(self.itemSchema, @"items");
+    
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        atomic_store_explicit(&s_numberOfDecodedResponses, 0, memory_order_relaxed);
+        SRGResponseParser parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+            id object = decodingParser(data, pError);
+            if (object) {
+                atomic_fetch_add_explicit(&s_numberOfDecodedResponses, 1, memory_order_relaxed);
+            }
+            return object;
+        };
+        
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Visible requests finished"];
+        expectation.expectedFulfillmentCount = kNumberOfVisibleRequests;
+        
+        NSMutableArray<SRGRequest *> *requests = [NSMutableArray arrayWithCapacity:kNumberOfRequests];
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            BOOL visible = (i >= kNumberOfRequests - kNumberOfVisibleRequests);
+            NSDate *startDate = NSDate.date;
+            NSURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @20000, @"page" : @(i) }];
+            SRGRequest *request = [[SRGRequest objectRequestWithURLRequest:URLRequest session:self.session parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                if (! visible) {
+                    return;
+                }
+                
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] requestWithParsingExecutor:parsingExecutor];
+            [request resume];
+            [requests addObject:request];
+            
+            // The cell displayed at the top of the screen is scrolled out of view
+            if (cancellingRequests && i >= kNumberOfVisibleRequests) {
+                [requests[i - kNumberOfVisibleRequests] cancel];
+            }
+            
+            [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:kScrollingInterval]];
+        }
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        
+        [self recordResult:@(atomic_load_explicit(&s_numberOfDecodedResponses, memory_order_relaxed)) forKey:@"decodedResponses"];
+        
+        // Do not let abandoned requests consume resources in subsequent scenarios
+        for (SRGRequest *request in requests) {
+            [request cancel];
+        }
+        return kNumberOfVisibleRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testAbandonedRequestsIgnored
+{
+    [self runScenario:@"cancellation-ignored" cancellingRequests:NO];
+}
+
+- (void)testAbandonedRequestsCancelled
+{
+    [self runScenario:@"cancellation-cancelled" cancellingRequests:YES];
+}
+
+@end
+
+@implementation CancellationBenchmarkItem
+
+@end
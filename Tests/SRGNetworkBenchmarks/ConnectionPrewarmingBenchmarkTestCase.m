@@ -0,0 +1,72 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfSessions = 50;
+
+// Measures the latency of the first request made with a new session (thus without any open connection), with and
+// without prewarming a connection beforehand. On the loopback interface only TCP connection establishment is saved,
+// real hosts additionally saving domain lookup and TLS handshakes.
+@interface ConnectionPrewarmingBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation ConnectionPrewarmingBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runScenario:(NSString *)scenario prewarming:(BOOL)prewarming
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        NSUInteger numberOfPrewarmedConnectionReuses = 0;
+        
+        for (NSUInteger i = 0; i < kNumberOfSessions; i++) {
+            NSURLSession *session = [NSURLSession sessionWithConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration];
+            NSURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @10, @"page" : @(i) }];
+            
+            SRGConnectionPrewarmer *connectionPrewarmer = nil;
+            if (prewarming) {
+                XCTestExpectation *prewarmingExpectation = [self expectationWithDescription:@"Prewarming finished"];
+                connectionPrewarmer = [[SRGConnectionPrewarmer alloc] initWithSession:session keepAliveInterval:0.];
+                [connectionPrewarmer prewarmOriginsWithURLs:@[ URLRequest.URL ] completionBlock:^{
+                    [prewarmingExpectation fulfill];
+                }];
+                [self waitForExpectationsWithTimeout:30. handler:nil];
+                XCTAssertTrue([connectionPrewarmer isOriginWarmForURL:URLRequest.URL]);
+            }
+            
+            XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+            NSDate *startDate = NSDate.date;
+            [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] resume];
+            [self waitForExpectationsWithTimeout:30. handler:nil];
+            
+            numberOfPrewarmedConnectionReuses += connectionPrewarmer.numberOfPrewarmedConnectionReuses;
+            [session invalidateAndCancel];
+        }
+        
+        [self recordResult:@(numberOfPrewarmedConnectionReuses) forKey:@"prewarmedConnectionReuses"];
+        return kNumberOfSessions;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testFirstRequestWithoutPrewarming
+{
+    [self runScenario:@"first-request-cold" prewarming:NO];
+}
+
+- (void)testFirstRequestWithPrewarming
+{
+    [self runScenario:@"first-request-prewarmed" prewarming:YES];
+}
+
+@end
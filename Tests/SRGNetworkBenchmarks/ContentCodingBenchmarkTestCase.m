@@ -0,0 +1,131 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 500;
+static const NSUInteger kNumberOfItems = 5000;
+
+// Measures the bandwidth saved by content codings for representative JSON responses and request bodies, and the time
+// spent to decode or encode them. In-process responses are decoded by the library, loopback responses by the system.
+@interface ContentCodingBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation ContentCodingBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)recordBandwidthForEncoding:(NSString *)encoding
+{
+    NSMutableDictionary<NSString *, id> *parameters = [@{ @"items" : @(kNumberOfItems) } mutableCopy];
+    NSUInteger decodedLength = LoopbackServer.configurableHandler([self inProcessURLRequestWithParameters:parameters]).body.length;
+    
+    parameters[@"encoding"] = encoding;
+    NSUInteger encodedLength = LoopbackServer.configurableHandler([self inProcessURLRequestWithParameters:parameters]).body.length;
+    
+    [self recordResult:@(encodedLength) forKey:@"transferredBytesPerResponse"];
+    [self recordResult:@(decodedLength) forKey:@"decodedBytesPerResponse"];
+    [self recordResult:@(1. - (double)encodedLength / decodedLength) forKey:@"bandwidthSaving"];
+}
+
+- (void)runResponseScenario:(NSString *)scenario withEncoding:(NSString *)encoding inProcess:(BOOL)inProcess
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        [self recordBandwidthForEncoding:encoding];
+        
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+        expectation.expectedFulfillmentCount = kNumberOfRequests;
+        
+        NSMutableDictionary<NSString *, id> *parameters = [@{ @"items" : @(kNumberOfItems) } mutableCopy];
+        parameters[@"encoding"] = encoding;
+        
+        NSURLRequest *URLRequest = inProcess ? [self inProcessURLRequestWithParameters:parameters] : [self URLRequestWithParameters:parameters];
+        NSURLSession *session = inProcess ? self.fixtureStore.session : self.session;
+        NSArray<SRGContentCoding *> *contentCodings = encoding ? @[ SRGContentCoding.gzipContentCoding, SRGContentCoding.deflateContentCoding ] : nil;
+        
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                XCTAssertEqual([JSONDictionary[@"items"] count], kNumberOfItems);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] requestWithContentCodings:contentCodings] resume];
+        }
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        return kNumberOfRequests;
+    }];
+}
+
+- (void)runUploadScenario:(NSString *)scenario withBodyContentCoding:(SRGContentCoding *)bodyContentCoding
+{
+    NSData *body = LoopbackServer.configurableHandler([self URLRequestWithParameters:@{ @"items" : @(kNumberOfItems) }]).body;
+    
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        NSData *sentBody = bodyContentCoding ? bodyContentCoding.encoder(body) : body;
+        [self recordResult:@(sentBody.length) forKey:@"transferredBytesPerRequest"];
+        [self recordResult:@(body.length) forKey:@"decodedBytesPerRequest"];
+        [self recordResult:@(1. - (double)sentBody.length / body.length) forKey:@"bandwidthSaving"];
+        
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+        expectation.expectedFulfillmentCount = kNumberOfRequests;
+        
+        NSMutableURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @0 }].mutableCopy;
+        URLRequest.HTTPMethod = @"POST";
+        URLRequest.HTTPBody = body;
+        
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            [[[SRGRequest dataRequestWithURLRequest:URLRequest session:self.session completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] requestWithBodyContentCoding:bodyContentCoding minimumBodyLength:1024] resume];
+        }
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        return kNumberOfRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testInProcessIdentityResponses
+{
+    [self runResponseScenario:@"content-coding-in-process-identity" withEncoding:nil inProcess:YES];
+}
+
+- (void)testInProcessGzipResponses
+{
+    [self runResponseScenario:@"content-coding-in-process-gzip" withEncoding:@"gzip" inProcess:YES];
+}
+
+- (void)testInProcessDeflateResponses
+{
+    [self runResponseScenario:@"content-coding-in-process-deflate" withEncoding:@"deflate" inProcess:YES];
+}
+
+- (void)testLoopbackIdentityResponses
+{
+    [self runResponseScenario:@"content-coding-loopback-identity" withEncoding:nil inProcess:NO];
+}
+
+- (void)testLoopbackGzipResponses
+{
+    [self runResponseScenario:@"content-coding-loopback-gzip" withEncoding:@"gzip" inProcess:NO];
+}
+
+- (void)testIdentityUploads
+{
+    [self runUploadScenario:@"content-coding-upload-identity" withBodyContentCoding:nil];
+}
+
+- (void)testGzipUploads
+{
+    [self runUploadScenario:@"content-coding-upload-gzip" withBodyContentCoding:SRGContentCoding.gzipContentCoding];
+}
+
+@end
@@ -0,0 +1,146 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfParsings = 200;
+static const NSUInteger kNumberOfRequests = 500;
+
+@interface BenchmarkItem : NSObject
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic) NSInteger duration;
+@property (nonatomic, getter=isAvailable) BOOL available;
+
+@end
+
+// Compares decoding models in a single pass with a schema to the usual two-pass approach (JSON dictionary parsing,
+// then model creation from the dictionary).
+@interface DecodingBenchmarkTestCase : BenchmarkTestCase
+
+@property (nonatomic) SRGJSONSchema *itemSchema;
+
+@end
+
+@implementation DecodingBenchmarkTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.itemSchema = [SRGJSONSchema schemaWithModelClass:BenchmarkItem.class fields:@[
+        [SRGJSONField fieldWithKeyPath:@"identifier" property:@"identifier" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"title" property:@"title" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"duration" property:@"duration" type:SRGJSONFieldTypeNumber],
+        [SRGJSONField fieldWithKeyPath:@"available" property:@"available" type:SRGJSONFieldTypeBoolean]
+    ]];
+}
+
+- (void)tearDown
+{
+    self.itemSchema = nil;
+    
+    [super tearDown];
+}
+
+#pragma mark Parsers
+
+- (SRGResponseParser)twoPassParser
+{
+    return ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        NSDictionary *JSONDictionary = SRGNetworkJSONDictionaryParser(data, pError);
+        if (! JSONDictionary) {
+            return nil;
+        }
+        
+        NSArray<NSDictionary *> *JSONItems = JSONDictionary[@"items"];
+        NSMutableArray<BenchmarkItem *> *items = [NSMutableArray arrayWithCapacity:JSONItems.count];
+        for (NSDictionary *JSONItem in JSONItems) {
+            BenchmarkItem *item = [[BenchmarkItem alloc] init];
+            item.identifier = JSONItem[@"identifier"];
+            item.title = JSONItem[@"title"];
+            item.duration = [JSONItem[@"duration"] integerValue];
+            item.available = [JSONItem[@"available"] boolValue];
+            [items addObject:item];
+        }
+        return items.copy;
+    };
+}
+
+- (SRGResponseParser)schemaParser
+{
+    return SRGNetworkJSONDecodingParserAtKeyPath(self.itemSchema, @"items");
+}
+
+#pragma mark Helpers
+
+- (void)runParsingScenario:(NSString *)scenario withParser:(SRGResponseParser)parser
+{
+    NSData *data = LoopbackServer.configurableHandler([self inProcessURLRequestWithParameters:@{ @"items" : @5000 }]).body;
+    
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        for (NSUInteger i = 0; i < kNumberOfParsings; i++) {
+            @autoreleasepool {
+                NSDate *startDate = NSDate.date;
+                NSArray<BenchmarkItem *> *items = parser(data, NULL);
+                XCTAssertEqual(items.count, 5000);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+            }
+        }
+        return kNumberOfParsings;
+    }];
+}
+
+- (void)runRequestScenario:(NSString *)scenario withParser:(SRGResponseParser)parser
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+        expectation.expectedFulfillmentCount = kNumberOfRequests;
+        
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            NSURLRequest *URLRequest = [self inProcessURLRequestWithParameters:@{ @"items" : @500 }];
+            [[SRGRequest objectRequestWithURLRequest:URLRequest session:self.fixtureStore.session parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] resume];
+        }
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        return kNumberOfRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testTwoPassParsing
+{
+    [self runParsingScenario:@"decoding-parse-two-pass" withParser:[self twoPassParser]];
+}
+
+- (void)testSchemaParsing
+{
+    [self runParsingScenario:@"decoding-parse-schema" withParser:[self schemaParser]];
+}
+
+- (void)testTwoPassRequests
+{
+    [self runRequestScenario:@"decoding-request-two-pass" withParser:[self twoPassParser]];
+}
+
+- (void)testSchemaRequests
+{
+    [self runRequestScenario:@"decoding-request-schema" withParser:[self schemaParser]];
+}
+
+@end
+
+@implementation BenchmarkItem
+
+@end
@@ -0,0 +1,82 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 10;
+
+// Compares the peak memory footprint of large responses (about 10 MB each) received in memory with data tasks to the
+// one of responses downloaded to files and memory-mapped. All parsed results are kept alive until the end of each
+// scenario, as an application displaying them would.
+@interface DownloadToFileBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation DownloadToFileBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runScenario:(NSString *)scenario withParser:(SRGResponseParser)parser options:(SRGRequestOptions)options
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+        expectation.expectedFulfillmentCount = kNumberOfRequests;
+        
+        NSMutableArray *objects = [NSMutableArray arrayWithCapacity:kNumberOfRequests];
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            NSURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @100000, @"page" : @(i) }];
+            [[[SRGRequest objectRequestWithURLRequest:URLRequest session:self.session parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                XCTAssertNotNil(object[@"items"][99999][@"identifier"]);
+                [objects addObject:object];
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] requestWithOptions:options] resume];
+        }
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        XCTAssertEqual(objects.count, kNumberOfRequests);
+        return kNumberOfRequests;
+    }];
+}
+
+- (SRGResponseParser)foundationParser
+{
+    return ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    };
+}
+
+- (SRGResponseParser)viewParser
+{
+    return ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        return SRGNetworkJSONDictionaryViewParser(data, pError);
+    };
+}
+
+#pragma mark Tests
+
+- (void)testDataTaskWithFoundation
+{
+    [self runScenario:@"download-data-task-foundation" withParser:[self foundationParser] options:0];
+}
+
+- (void)testDownloadToFileWithFoundation
+{
+    [self runScenario:@"download-to-file-foundation" withParser:[self foundationParser] options:SRGRequestOptionDownloadToFileEnabled];
+}
+
+- (void)testDataTaskWithView
+{
+    [self runScenario:@"download-data-task-view" withParser:[self viewParser] options:0];
+}
+
+- (void)testDownloadToFileWithView
+{
+    [self runScenario:@"download-to-file-view" withParser:[self viewParser] options:SRGRequestOptionDownloadToFileEnabled];
+}
+
+@end
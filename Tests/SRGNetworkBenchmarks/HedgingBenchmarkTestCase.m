@@ -0,0 +1,97 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 200;
+static const uint64_t kDelayScheduleSeed = 0x5247;
+
+static NSTimeInterval HedgingBenchmarkDelay(NSUInteger index, NSUInteger attempt);
+
+// Measures tail latencies with and without hedging for the same requests, served by a server which answers each
+// attempt after a delay drawn from the same seeded random schedule (20 ms, or 1 second with a 5% probability).
+@interface HedgingBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation HedgingBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runScenario:(NSString *)scenario withHedgingPolicy:(SRGHedgingPolicy *)hedgingPolicy
+{
+    // Dedicated server, so that attempts are counted from scratch for each scenario
+    __block __weak LoopbackServer *weakServer = nil;
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSUInteger index = request.URL.lastPathComponent.integerValue;
+        NSUInteger attempt = [weakServer numberOfRequestsForPath:request.URL.path];
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"index" : @(index) }];
+        response.delay = HedgingBenchmarkDelay(index, attempt);
+        return response;
+    }];
+    weakServer = server;
+    XCTAssertTrue([server start]);
+    
+    // Dedicated session, so that enough connections are available for duplicate tasks
+    NSURLSessionConfiguration *sessionConfiguration = NSURLSessionConfiguration.ephemeralSessionConfiguration;
+    sessionConfiguration.HTTPMaximumConnectionsPerHost = 16;
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+    
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+            
+            NSString *path = [NSString stringWithFormat:@"/hedging/%@", @(i)];
+            NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[server URLForPath:path]];
+            NSDate *startDate = NSDate.date;
+            SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] requestWithHedgingPolicy:hedgingPolicy];
+            [request resume];
+        }
+        
+        [self waitForExpectationsWithTimeout:60. handler:nil];
+        
+        [self recordResult:@(server.numberOfRequests) forKey:@"serverRequests"];
+        [self recordResult:@(hedgingPolicy.numberOfHedgesFired) forKey:@"hedgesFired"];
+        [self recordResult:@(hedgingPolicy.numberOfHedgesWon) forKey:@"hedgesWon"];
+        return kNumberOfRequests;
+    }];
+    
+    [session invalidateAndCancel];
+    [server stop];
+}
+
+#pragma mark Tests
+
+- (void)testWithoutHedging
+{
+    [self runScenario:@"hedging-disabled" withHedgingPolicy:nil];
+}
+
+- (void)testWithHedging
+{
+    [self runScenario:@"hedging-enabled" withHedgingPolicy:[[SRGHedgingPolicy alloc] initWithDelay:0.1]];
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSTimeInterval HedgingBenchmarkDelay(NSUInteger index, NSUInteger attempt)
+{
+    // SplitMix64 finalizer applied to the seed, request index and attempt number, so that the schedule is the same
+    // for all scenarios and independent of the order in which requests reach the server
+    uint64_t z = kDelayScheduleSeed + ((uint64_t)index << 8 | (uint64_t)MIN(attempt, 0xff)) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    
+    double value = (double)(z >> 11) / (double)(1ULL << 53);
+    return (value < 0.05) ? 1. : 0.02;
+}
@@ -0,0 +1,87 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+// Scenarios run against the in-process fixture store, so that only the library overhead (request setup, parsing,
+// extraction, completion delivery and queue bookkeeping) is measured.
+@interface InProcessBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation InProcessBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runJSONScenario:(NSString *)scenario withParameters:(NSDictionary<NSString *, id> *)parameters numberOfRequests:(NSUInteger)numberOfRequests
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+        expectation.expectedFulfillmentCount = numberOfRequests;
+        
+        for (NSUInteger i = 0; i < numberOfRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            [[SRGRequest JSONDictionaryRequestWithURLRequest:[self inProcessURLRequestWithParameters:parameters] session:self.fixtureStore.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] resume];
+        }
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        return numberOfRequests;
+    }];
+}
+
+- (void)runFanInScenario:(NSString *)scenario withNumberOfRequests:(NSUInteger)numberOfRequests maximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Queue finished"];
+        
+        SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+            if (finished) {
+                XCTAssertNil(error);
+                [expectation fulfill];
+            }
+        }] requestQueueWithMaximumNumberOfConcurrentRequests:maximumNumberOfConcurrentRequests];
+        
+        for (NSUInteger i = 0; i < numberOfRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            NSURLRequest *URLRequest = [self inProcessURLRequestWithParameters:@{ @"items" : @10, @"index" : @(i) }];
+            SRGRequest *request = [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:self.fixtureStore.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                [requestQueue reportError:error];
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+            }];
+            [requestQueue addRequest:request resume:YES];
+        }
+        
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        return numberOfRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testSmallJSONResponses
+{
+    [self runJSONScenario:@"in-process-json-small" withParameters:@{ @"items" : @10 } numberOfRequests:20000];
+}
+
+- (void)testLargeJSONResponses
+{
+    [self runJSONScenario:@"in-process-json-large" withParameters:@{ @"items" : @5000 } numberOfRequests:500];
+}
+
+- (void)testFanIn
+{
+    [self runFanInScenario:@"in-process-queue-fan-in" withNumberOfRequests:20000 maximumNumberOfConcurrentRequests:0];
+}
+
+- (void)testLimitedFanIn
+{
+    [self runFanInScenario:@"in-process-queue-fan-in-limited" withNumberOfRequests:20000 maximumNumberOfConcurrentRequests:8];
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfParsings = 50;
+
+// Compares lazy JSON views to fully parsed JSON for multi-megabyte responses from which only a few values are read
+// (the next page link and a few identifiers), as well as when all values are read.
+@interface JSONViewBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation JSONViewBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runReadScenario:(NSString *)scenario withParser:(SRGResponseParser)parser sparse:(BOOL)sparse
+{
+    // About 2 MB
+    NSData *data = LoopbackServer.configurableHandler([self inProcessURLRequestWithParameters:@{ @"items" : @20000, @"pages" : @2 }]).body;
+    
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        for (NSUInteger i = 0; i < kNumberOfParsings; i++) {
+            @autoreleasepool {
+                NSDate *startDate = NSDate.date;
+                NSDictionary *JSONDictionary = parser(data, NULL);
+                XCTAssertNotNil(JSONDictionary[@"next"]);
+                
+                NSArray<NSDictionary *> *items = JSONDictionary[@"items"];
+                NSUInteger numberOfReadItems = sparse ? 10 : items.count;
+                for (NSUInteger j = 0; j < numberOfReadItems; j++) {
+                    XCTAssertNotNil(items[j][@"identifier"]);
+                }
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+            }
+        }
+        return kNumberOfParsings;
+    }];
+}
+
+- (SRGResponseParser)foundationParser
+{
+    return ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    };
+}
+
+- (SRGResponseParser)viewParser
+{
+    return ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        return SRGNetworkJSONDictionaryViewParser(data, pError);
+    };
+}
+
+#pragma mark Tests
+
+- (void)testSparseReadWithFoundation
+{
+    [self runReadScenario:@"json-sparse-foundation" withParser:[self foundationParser] sparse:YES];
+}
+
+- (void)testSparseReadWithView
+{
+    [self runReadScenario:@"json-sparse-view" withParser:[self viewParser] sparse:YES];
+}
+
+- (void)testFullReadWithFoundation
+{
+    [self runReadScenario:@"json-full-foundation" withParser:[self foundationParser] sparse:NO];
+}
+
+- (void)testFullReadWithView
+{
+    [self runReadScenario:@"json-full-view" withParser:[self viewParser] sparse:NO];
+}
+
+@end
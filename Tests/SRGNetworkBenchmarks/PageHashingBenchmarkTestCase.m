@@ -0,0 +1,88 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfPages = 100;
+static const NSUInteger kNumberOfIterations = 1000;
+
+// Measures the cost (in particular allocations) of using pages as dictionary keys, as page caches and prefetch buffers do.
+@interface PageHashingBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation PageHashingBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (NSArray<SRGPage *> *)pages
+{
+    NSURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @10 }];
+    SRGFirstPageRequest *request = [SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:URLRequest session:self.session sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URLRequest.URL resolvingAgainstBaseURL:NO];
+        URLComponents.queryItems = [URLComponents.queryItems arrayByAddingObject:[NSURLQueryItem queryItemWithName:@"size" value:@(size).stringValue]];
+        return [NSURLRequest requestWithURL:URLComponents.URL];
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        return nil;
+    } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    
+    NSMutableArray<SRGPage *> *pages = [NSMutableArray arrayWithCapacity:kNumberOfPages];
+    for (NSUInteger i = 0; i < kNumberOfPages; i++) {
+        [pages addObject:[request requestWithPageSize:i + 1].page];
+    }
+    return pages.copy;
+}
+
+#pragma mark Tests
+
+- (void)testPageHashing
+{
+    // Pages are created beforehand, so that only hashing is measured
+    NSArray<SRGPage *> *pages = [self pages];
+    
+    [self runScenario:@"page-hash" withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        NSUInteger combinedHash = 0;
+        for (NSUInteger i = 0; i < kNumberOfIterations; i++) {
+            @autoreleasepool {
+                for (SRGPage *page in pages) {
+                    combinedHash ^= page.hash;
+                }
+            }
+        }
+        [self recordResult:@(combinedHash != 0) forKey:@"nonZeroHash"];
+        return kNumberOfIterations * kNumberOfPages;
+    }];
+}
+
+- (void)testPageDictionaryLookup
+{
+    NSArray<SRGPage *> *pages = [self pages];
+    
+    NSMutableDictionary<SRGPage *, NSNumber *> *dictionary = [NSMutableDictionary dictionary];
+    [pages enumerateObjectsUsingBlock:^(SRGPage * _Nonnull page, NSUInteger idx, BOOL * _Nonnull stop) {
+        dictionary[page] = @(idx);
+    }];
+    
+    // Lookups are made with equal but distinct page instances, as is the case when pages are received from requests
+    NSArray<SRGPage *> *lookupPages = [self pages];
+    
+    [self runScenario:@"page-dictionary-lookup" withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        NSUInteger numberOfHits = 0;
+        for (NSUInteger i = 0; i < kNumberOfIterations; i++) {
+            @autoreleasepool {
+                for (SRGPage *page in lookupPages) {
+                    if (dictionary[page]) {
+                        numberOfHits++;
+                    }
+                }
+            }
+        }
+        [self recordResult:@(numberOfHits) forKey:@"hits"];
+        return kNumberOfIterations * kNumberOfPages;
+    }];
+}
+
+@end
@@ -0,0 +1,146 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfPages = 100;
+
+@interface PageRequestBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation PageRequestBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (SRGFirstPageRequest *)firstPageRequestWithParameters:(NSDictionary<NSString *, id> *)parameters completionBlock:(SRGJSONDictionaryPageCompletionBlock)completionBlock
+{
+    return [SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithParameters:parameters] session:self.session sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        return URLRequest;
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        NSString *nextURLString = JSONDictionary[@"next"];
+        return nextURLString ? [NSURLRequest requestWithURL:[NSURL URLWithString:nextURLString]] : nil;
+    } completionBlock:completionBlock];
+}
+
+- (void)runPageWalkScenario:(NSString *)scenario withPrefetchDepth:(NSUInteger)prefetchDepth
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+        
+        __block NSUInteger numberOfPages = 0;
+        __block NSDate *startDate = NSDate.date;
+        __block SRGFirstPageRequest *firstPageRequest = nil;
+        
+        // The next page is requested once the current one has been processed, as a user scrolling through a list would
+        SRGJSONDictionaryPageCompletionBlock completionBlock = ^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+            numberOfPages++;
+            
+            if (nextPage) {
+                startDate = NSDate.date;
+                [[firstPageRequest requestWithPage:nextPage] resume];
+            }
+            else {
+                [expectation fulfill];
+            }
+        };
+        
+        firstPageRequest = [[self firstPageRequestWithParameters:@{ @"items" : @20, @"latency" : @10, @"pages" : @(kNumberOfPages) } completionBlock:completionBlock] requestWithPrefetchDepth:prefetchDepth];
+        [firstPageRequest resume];
+        
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+        firstPageRequest = nil;
+        return numberOfPages;
+    }];
+}
+
+- (void)runPageStreamScenario:(NSString *)scenario withReadAhead:(NSUInteger)readAhead
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+        
+        SRGFirstPageRequest *firstPageRequest = [self firstPageRequestWithParameters:@{ @"items" : @20, @"latency" : @10, @"pages" : @(kNumberOfPages) } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+        SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:firstPageRequest readAhead:readAhead];
+        
+        // Pages are pulled one after the other, as a user scrolling through a list would
+        __block NSDate *startDate = NSDate.date;
+        __block void (^pullNextPage)(void) = nil;
+        void (^pullPage)(void) = ^{
+            startDate = NSDate.date;
+            [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                if (streamedPage) {
+                    latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                    pullNextPage();
+                }
+                else {
+                    [expectation fulfill];
+                }
+            }];
+        };
+        pullNextPage = pullPage;
+        pullPage();
+        
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+        pullNextPage = nil;
+        return pageStream.numberOfDeliveredPages;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testPageWalk
+{
+    [self runPageWalkScenario:@"page-walk" withPrefetchDepth:0];
+}
+
+- (void)testPageWalkWithPrefetching
+{
+    [self runPageWalkScenario:@"page-walk-prefetch" withPrefetchDepth:2];
+}
+
+- (void)testPageStream
+{
+    [self runPageStreamScenario:@"page-stream" withReadAhead:0];
+}
+
+- (void)testPageStreamWithReadAhead
+{
+    [self runPageStreamScenario:@"page-stream-read-ahead" withReadAhead:2];
+}
+
+- (void)testAllPages
+{
+    [self runScenario:@"page-all" withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+        
+        NSDate *startDate = NSDate.date;
+        __block NSUInteger numberOfPages = 0;
+        SRGFirstPageRequest *firstPageRequest = [self firstPageRequestWithParameters:@{ @"items" : @20, @"latency" : @10, @"pages" : @(kNumberOfPages) } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+        [[firstPageRequest requestWithPageSize:20] requestQueueForAllPagesWithBuilder:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size, NSUInteger number) {
+            NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URLRequest.URL resolvingAgainstBaseURL:NO];
+            NSMutableArray<NSURLQueryItem *> *queryItems = [URLComponents.queryItems mutableCopy] ?: [NSMutableArray array];
+            [queryItems addObject:[NSURLQueryItem queryItemWithName:@"page" value:@(number).stringValue]];
+            URLComponents.queryItems = queryItems.copy;
+            return [NSURLRequest requestWithURL:URLComponents.URL];
+        } itemsExtractor:^NSArray * _Nullable(id _Nullable object) {
+            return object[@"items"];
+        } maximumNumberOfConcurrentRequests:8 completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            XCTAssertEqual(items.count, kNumberOfPages * 20);
+            numberOfPages = pageObjects.count;
+            latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+            [expectation fulfill];
+        }];
+        
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+        return numberOfPages;
+    }];
+}
+
+@end
@@ -0,0 +1,77 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+@interface RequestBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation RequestBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runJSONScenario:(NSString *)scenario withParameters:(NSDictionary<NSString *, id> *)parameters numberOfRequests:(NSUInteger)numberOfRequests
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        for (NSUInteger i = 0; i < numberOfRequests; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+            
+            NSDate *startDate = NSDate.date;
+            [[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithParameters:parameters] session:self.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] resume];
+        }
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+        return numberOfRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testSmallJSONResponses
+{
+    [self runJSONScenario:@"request-json-small" withParameters:@{ @"items" : @10 } numberOfRequests:1000];
+}
+
+- (void)testLargeJSONResponses
+{
+    [self runJSONScenario:@"request-json-large" withParameters:@{ @"items" : @5000 } numberOfRequests:100];
+}
+
+- (void)testChunkedJSONResponses
+{
+    [self runJSONScenario:@"request-json-chunked" withParameters:@{ @"items" : @5000, @"chunk" : @4096 } numberOfRequests:100];
+}
+
+- (void)testJSONResponsesWithLatency
+{
+    [self runJSONScenario:@"request-json-latency" withParameters:@{ @"items" : @100, @"latency" : @50 } numberOfRequests:200];
+}
+
+- (void)testStreamedJSONResponses
+{
+    [self runScenario:@"request-json-streamed" withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        static const NSUInteger kNumberOfRequests = 100;
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+            
+            NSDate *startDate = NSDate.date;
+            NSURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @5000, @"chunk" : @4096 }];
+            [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:self.session elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                [expectation fulfill];
+            }] resume];
+        }
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+        return kNumberOfRequests;
+    }];
+}
+
+@end
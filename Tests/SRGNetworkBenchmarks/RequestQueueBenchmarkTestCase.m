@@ -0,0 +1,57 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfFanInRequests = 2000;
+
+@interface RequestQueueBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation RequestQueueBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runFanInScenario:(NSString *)scenario withMaximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Queue finished"];
+        
+        SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+            if (finished) {
+                XCTAssertNil(error);
+                [expectation fulfill];
+            }
+        }] requestQueueWithMaximumNumberOfConcurrentRequests:maximumNumberOfConcurrentRequests];
+        
+        for (NSUInteger i = 0; i < kNumberOfFanInRequests; i++) {
+            NSDate *startDate = NSDate.date;
+            SRGRequest *request = [SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithParameters:@{ @"items" : @10, @"index" : @(i) }] session:self.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                [requestQueue reportError:error];
+                latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+            }];
+            [requestQueue addRequest:request resume:YES];
+        }
+        
+        [self waitForExpectationsWithTimeout:300. handler:nil];
+        return kNumberOfFanInRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testFanIn
+{
+    [self runFanInScenario:@"queue-fan-in" withMaximumNumberOfConcurrentRequests:0];
+}
+
+- (void)testLimitedFanIn
+{
+    [self runFanInScenario:@"queue-fan-in-limited" withMaximumNumberOfConcurrentRequests:8];
+}
+
+@end
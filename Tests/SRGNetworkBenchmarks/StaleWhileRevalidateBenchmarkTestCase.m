@@ -0,0 +1,69 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "BenchmarkTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 50;
+
+// Measures the latency until a result can be displayed for a list whose cached response must be revalidated, when
+// waiting for revalidation and when using the stale result in the meantime.
+@interface StaleWhileRevalidateBenchmarkTestCase : BenchmarkTestCase
+
+@end
+
+@implementation StaleWhileRevalidateBenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runScenario:(NSString *)scenario withMaximumStaleness:(NSTimeInterval)maximumStaleness
+{
+    [self runScenario:scenario withBlock:^NSUInteger(BenchmarkLatencyHandler latencyHandler) {
+        NSURL *directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString]];
+        SRGResponseCache *responseCache = [[SRGResponseCache alloc] initWithMemoryCapacity:1024 * 1024 diskCapacity:1024 * 1024 directoryURL:directoryURL];
+        NSURLRequest *URLRequest = [self URLRequestWithParameters:@{ @"items" : @100, @"latency" : @50, @"etag" : @"v1" }];
+        
+        // The first request populates the cache, subsequent ones revalidate the cached response
+        for (NSUInteger i = 0; i < kNumberOfRequests + 1; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:@"Result received"];
+            
+            __block BOOL resultReceived = NO;
+            NSDate *startDate = NSDate.date;
+            SRGRequest *request = [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:self.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertNil(error);
+                if (i != 0 && ! resultReceived) {
+                    latencyHandler([NSDate.date timeIntervalSinceDate:startDate]);
+                }
+                resultReceived = YES;
+                [expectation fulfill];
+            }] requestWithResponseCache:responseCache] requestWithMaximumStaleness:maximumStaleness];
+            [request resume];
+            [self waitForExpectationsWithTimeout:30. handler:nil];
+            
+            // Revalidation must end before the next request is made
+            [self expectationForPredicate:[NSPredicate predicateWithFormat:@"running == NO"] evaluatedWithObject:request handler:nil];
+            [self waitForExpectationsWithTimeout:30. handler:nil];
+        }
+        
+        [self recordResult:@(responseCache.numberOfStaleHits) forKey:@"staleHits"];
+        [self recordResult:@(responseCache.numberOfRevalidations) forKey:@"revalidations"];
+        [responseCache removeAllCachedResponses];
+        return kNumberOfRequests;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testRevalidation
+{
+    [self runScenario:@"revalidate" withMaximumStaleness:0.];
+}
+
+- (void)testStaleWhileRevalidate
+{
+    [self runScenario:@"stale-while-revalidate" withMaximumStaleness:60.];
+}
+
+@end
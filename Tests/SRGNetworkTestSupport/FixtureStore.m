@@ -0,0 +1,139 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+
+#import "FixtureURLProtocol.h"
+
+static NSString *FixtureStoreContentTypeForPathExtension(NSString *pathExtension);
+
+@interface FixtureStore ()
+
+@property (nonatomic, copy) LoopbackServerHandler handler;
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic) NSURL *baseURL;
+
+@property (nonatomic) NSMutableDictionary<NSString *, LoopbackServerResponse *> *responses;
+@property (nonatomic) NSUInteger numberOfRequests;
+
+@end
+
+@implementation FixtureStore
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithHandler:(LoopbackServerHandler)handler
+{
+    if (self = [super init]) {
+        self.handler = handler ?: ^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+            return [LoopbackServerResponse responseWithStatusCode:404 headers:nil body:nil];
+        };
+        self.responses = [NSMutableDictionary dictionary];
+        
+        // Invalid top-level domain, so that requests can never reach the network
+        NSString *host = [NSString stringWithFormat:@"%@.fixtures.invalid", NSUUID.UUID.UUIDString.lowercaseString];
+        self.baseURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://%@", host]];
+        [FixtureURLProtocol registerStore:self forHost:host];
+        
+        NSURLSessionConfiguration *sessionConfiguration = NSURLSessionConfiguration.ephemeralSessionConfiguration;
+        sessionConfiguration.protocolClasses = @[ FixtureURLProtocol.class ];
+        self.session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [FixtureURLProtocol unregisterStoreForHost:self.baseURL.host];
+    [self.session invalidateAndCancel];
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfRequests
+{
+    @synchronized(self) {
+        return _numberOfRequests;
+    }
+}
+
+- (NSURL *)URLForPath:(NSString *)path
+{
+    return [NSURL URLWithString:path relativeToURL:self.baseURL].absoluteURL;
+}
+
+#pragma mark Responses
+
+- (void)setResponse:(LoopbackServerResponse *)response forPath:(NSString *)path
+{
+    @synchronized(self) {
+        self.responses[path] = response;
+    }
+}
+
+- (BOOL)addResponsesFromDirectoryAtURL:(NSURL *)directoryURL
+{
+    BOOL isDirectory = NO;
+    if (! [NSFileManager.defaultManager fileExistsAtPath:directoryURL.path isDirectory:&isDirectory] || ! isDirectory) {
+        return NO;
+    }
+    
+    NSURL *standardizedDirectoryURL = directoryURL.URLByStandardizingPath.URLByResolvingSymlinksInPath;
+    NSDirectoryEnumerator<NSURL *> *enumerator = [NSFileManager.defaultManager enumeratorAtURL:standardizedDirectoryURL
+                                                                    includingPropertiesForKeys:@[ NSURLIsRegularFileKey ]
+                                                                                       options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                                  errorHandler:nil];
+    if (! enumerator) {
+        return NO;
+    }
+    
+    NSString *directoryPath = standardizedDirectoryURL.path;
+    for (NSURL *fileURL in enumerator) {
+        NSNumber *regularFile = nil;
+        [fileURL getResourceValue:&regularFile forKey:NSURLIsRegularFileKey error:NULL];
+        if (! regularFile.boolValue) {
+            continue;
+        }
+        
+        NSData *body = [NSData dataWithContentsOfURL:fileURL];
+        if (! body) {
+            continue;
+        }
+        
+        NSString *filePath = fileURL.URLByStandardizingPath.URLByResolvingSymlinksInPath.path;
+        NSString *path = [filePath substringFromIndex:directoryPath.length];
+        NSDictionary<NSString *, NSString *> *headers = @{ @"Content-Type" : FixtureStoreContentTypeForPathExtension(fileURL.pathExtension) };
+        [self setResponse:[LoopbackServerResponse responseWithStatusCode:200 headers:headers body:body] forPath:path];
+    }
+    return YES;
+}
+
+- (LoopbackServerResponse *)responseForRequest:(NSURLRequest *)request
+{
+    LoopbackServerResponse *response = nil;
+    @synchronized(self) {
+        _numberOfRequests++;
+        response = self.responses[request.URL.path];
+    }
+    return response ?: self.handler(request);
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSString *FixtureStoreContentTypeForPathExtension(NSString *pathExtension)
+{
+    static NSDictionary<NSString *, NSString *> *s_contentTypes;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_contentTypes = @{ @"json" : @"application/json",
+                            @"xml" : @"application/xml",
+                            @"html" : @"text/html",
+                            @"txt" : @"text/plain" };
+    });
+    return s_contentTypes[pathExtension.lowercaseString] ?: @"application/octet-stream";
+}
@@ -0,0 +1,42 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  URL protocol serving requests from the fixture store registered for their host.
+ */
+@interface FixtureURLProtocol : NSURLProtocol
+
+/**
+ *  Register a store for the specified host. Stores are weakly referenced.
+ */
++ (void)registerStore:(FixtureStore *)store forHost:(NSString *)host;
+
+/**
+ *  Unregister the store for the specified host.
+ */
++ (void)unregisterStoreForHost:(NSString *)host;
+
+@end
+
+/**
+ *  Private interface for the URL protocol.
+ */
+@interface FixtureStore (FixtureURLProtocol)
+
+/**
+ *  Return the response for the specified request, counting it as served.
+ */
+- (LoopbackServerResponse *)responseForRequest:(NSURLRequest *)request;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,159 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureURLProtocol.h"
+
+static NSMapTable<NSString *, FixtureStore *> *s_stores = nil;
+
+@interface FixtureURLProtocol ()
+
+@property (nonatomic) NSThread *clientThread;
+@property (nonatomic) NSArray<NSRunLoopMode> *modes;
+@property (nonatomic, getter=isStopped) BOOL stopped;
+
+@end
+
+@implementation FixtureURLProtocol
+
+#pragma mark Class methods
+
++ (void)initialize
+{
+    if (self != FixtureURLProtocol.class) {
+        return;
+    }
+    
+    s_stores = [NSMapTable strongToWeakObjectsMapTable];
+}
+
++ (void)registerStore:(FixtureStore *)store forHost:(NSString *)host
+{
+    @synchronized(s_stores) {
+        [s_stores setObject:store forKey:host.lowercaseString];
+    }
+}
+
++ (void)unregisterStoreForHost:(NSString *)host
+{
+    @synchronized(s_stores) {
+        [s_stores removeObjectForKey:host.lowercaseString];
+    }
+}
+
++ (FixtureStore *)storeForHost:(NSString *)host
+{
+    if (! host) {
+        return nil;
+    }
+    
+    @synchronized(s_stores) {
+        return [s_stores objectForKey:host.lowercaseString];
+    }
+}
+
+#pragma mark NSURLProtocol overrides
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+    return [self storeForHost:request.URL.host] != nil;
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void)startLoading
+{
+    // Client methods must be called on the thread loading started on
+    self.clientThread = NSThread.currentThread;
+    self.modes = @[ NSRunLoop.currentRunLoop.currentMode ?: NSDefaultRunLoopMode ];
+    
+    FixtureStore *store = [FixtureURLProtocol storeForHost:self.request.URL.host];
+    if (! store) {
+        NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:@{ NSURLErrorFailingURLErrorKey : self.request.URL }];
+        [self.client URLProtocol:self didFailWithError:error];
+        return;
+    }
+    
+    LoopbackServerResponse *response = [store responseForRequest:self.request];
+    [self performBlock:^{
+        [self sendResponse:response];
+    } afterDelay:response.delay];
+}
+
+- (void)stopLoading
+{
+    self.stopped = YES;
+}
+
+#pragma mark Delivery
+
+- (void)sendResponse:(LoopbackServerResponse *)response
+{
+    NSData *body = [self.request.HTTPMethod isEqualToString:@"HEAD"] ? nil : response.body;
+    
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionaryWithDictionary:response.headers ?: @{}];
+    if (response.chunked) {
+        headers[@"Transfer-Encoding"] = @"chunked";
+    }
+    else {
+        headers[@"Content-Length"] = @(response.body.length).stringValue;
+    }
+    
+    NSHTTPURLResponse *HTTPURLResponse = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:response.statusCode HTTPVersion:@"HTTP/1.1" headerFields:headers.copy];
+    [self.client URLProtocol:self didReceiveResponse:HTTPURLResponse cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    
+    if (body.length == 0) {
+        [self.client URLProtocolDidFinishLoading:self];
+    }
+    else if (response.bodyChunkSize == 0) {
+        [self.client URLProtocol:self didLoadData:body];
+        [self.client URLProtocolDidFinishLoading:self];
+    }
+    else {
+        [self sendBody:body fromOffset:0 forResponse:response];
+    }
+}
+
+- (void)sendBody:(NSData *)body fromOffset:(NSUInteger)offset forResponse:(LoopbackServerResponse *)response
+{
+    NSUInteger length = MIN(response.bodyChunkSize, body.length - offset);
+    [self.client URLProtocol:self didLoadData:[body subdataWithRange:NSMakeRange(offset, length)]];
+    
+    NSUInteger nextOffset = offset + length;
+    if (nextOffset == body.length) {
+        [self.client URLProtocolDidFinishLoading:self];
+        return;
+    }
+    
+    [self performBlock:^{
+        [self sendBody:body fromOffset:nextOffset forResponse:response];
+    } afterDelay:response.bodyChunkInterval];
+}
+
+- (void)performBlock:(dispatch_block_t)block afterDelay:(NSTimeInterval)delay
+{
+    if (delay <= 0.) {
+        block();
+        return;
+    }
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [self performSelector:@selector(runBlock:) onThread:self.clientThread withObject:[block copy] waitUntilDone:NO modes:self.modes];
+    });
+}
+
+- (void)runBlock:(dispatch_block_t)block
+{
+    if (self.stopped) {
+        return;
+    }
+    
+    block();
+}
+
+@end
@@ -0,0 +1,434 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <unistd.h>
+#import <zlib.h>
+
+static NSData *LoopbackServerEncodedData(NSData *data, NSString *encoding);
+
+static NSData *LoopbackServerHeaderTerminator(void)
+{
+    static NSData *s_terminator;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_terminator = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    });
+    return s_terminator;
+}
+
+@implementation LoopbackServerResponse
+
+#pragma mark Class methods
+
++ (LoopbackServerResponse *)responseWithStatusCode:(NSInteger)statusCode headers:(NSDictionary<NSString *,NSString *> *)headers body:(NSData *)body
+{
+    LoopbackServerResponse *response = [[self alloc] init];
+    response.statusCode = statusCode;
+    response.headers = headers;
+    response.body = body;
+    return response;
+}
+
++ (LoopbackServerResponse *)JSONResponseWithObject:(id)JSONObject
+{
+    NSData *body = [NSJSONSerialization dataWithJSONObject:JSONObject options:0 error:NULL];
+    return [self responseWithStatusCode:200 headers:@{ @"Content-Type" : @"application/json" } body:body];
+}
+
+@end
+
+@interface LoopbackServer ()
+
+@property (nonatomic, copy) LoopbackServerHandler handler;
+@property (nonatomic) dispatch_source_t acceptSource;
+@property (nonatomic) NSURL *baseURL;
+
+@property (nonatomic) NSCountedSet<NSString *> *receivedPaths;
+
+@end
+
+@implementation LoopbackServer
+
+#pragma mark Class methods
+
++ (LoopbackServerHandler)configurableHandler
+{
+    return ^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+        NSMutableDictionary<NSString *, NSString *> *parameters = [NSMutableDictionary dictionary];
+        for (NSURLQueryItem *queryItem in URLComponents.queryItems) {
+            parameters[queryItem.name] = queryItem.value;
+        }
+        
+        NSInteger page = parameters[@"page"].integerValue;
+        BOOL pageAvailable = ! parameters[@"pages"] || page < parameters[@"pages"].integerValue;
+        NSUInteger numberOfItems = pageAvailable ? (parameters[@"items"] ? (NSUInteger)MAX(parameters[@"items"].integerValue, 0) : 10) : 0;
+        
+        NSMutableArray<NSDictionary *> *items = [NSMutableArray arrayWithCapacity:numberOfItems];
+        for (NSUInteger i = 0; i < numberOfItems; i++) {
+            [items addObject:@{ @"identifier" : [NSString stringWithFormat:@"%@-%@", @(page), @(i)],
+                                @"title" : @"Lorem ipsum dolor sit amet",
+                                @"duration" : @(i * 1000),
+                                @"available" : @YES }];
+        }
+        
+        NSMutableDictionary *JSONDictionary = [NSMutableDictionary dictionary];
+        JSONDictionary[@"items"] = items.copy;
+        
+        if (parameters[@"pages"]) {
+            JSONDictionary[@"page"] = @(page);
+        }
+        if (parameters[@"pages"] && page + 1 < parameters[@"pages"].integerValue) {
+            NSMutableArray<NSURLQueryItem *> *queryItems = [NSMutableArray array];
+            for (NSURLQueryItem *queryItem in URLComponents.queryItems) {
+                if (! [queryItem.name isEqualToString:@"page"]) {
+                    [queryItems addObject:queryItem];
+                }
+            }
+            [queryItems addObject:[NSURLQueryItem queryItemWithName:@"page" value:@(page + 1).stringValue]];
+            URLComponents.queryItems = queryItems.copy;
+            JSONDictionary[@"next"] = URLComponents.URL.absoluteString;
+        }
+        
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:JSONDictionary.copy];
+        if (parameters[@"status"]) {
+            response.statusCode = parameters[@"status"].integerValue;
+        }
+        if (parameters[@"encoding"]) {
+            NSMutableDictionary<NSString *, NSString *> *headers = response.headers.mutableCopy ?: [NSMutableDictionary dictionary];
+            headers[@"Content-Encoding"] = parameters[@"encoding"];
+            response.headers = headers.copy;
+            response.body = LoopbackServerEncodedData(response.body, parameters[@"encoding"]);
+        }
+        if (parameters[@"etag"]) {
+            NSString *ETag = [NSString stringWithFormat:@"\"%@\"", parameters[@"etag"]];
+            if ([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:ETag]) {
+                response = [LoopbackServerResponse responseWithStatusCode:304 headers:nil body:nil];
+            }
+            NSMutableDictionary<NSString *, NSString *> *headers = response.headers.mutableCopy ?: [NSMutableDictionary dictionary];
+            headers[@"ETag"] = ETag;
+            headers[@"Cache-Control"] = @"no-cache";
+            response.headers = headers.copy;
+        }
+        if (parameters[@"chunk"]) {
+            response.chunked = YES;
+            response.bodyChunkSize = (NSUInteger)MAX(parameters[@"chunk"].integerValue, 0);
+        }
+        response.delay = parameters[@"latency"].doubleValue / 1000.;
+        return response;
+    };
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithHandler:(LoopbackServerHandler)handler
+{
+    if (self = [super init]) {
+        self.handler = handler;
+        self.receivedPaths = [NSCountedSet set];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+}
+
+#pragma mark Getters and setters
+
+- (NSUInteger)numberOfRequests
+{
+    @synchronized(self.receivedPaths) {
+        NSUInteger numberOfRequests = 0;
+        for (NSString *path in self.receivedPaths) {
+            numberOfRequests += [self.receivedPaths countForObject:path];
+        }
+        return numberOfRequests;
+    }
+}
+
+- (NSUInteger)numberOfRequestsForPath:(NSString *)path
+{
+    @synchronized(self.receivedPaths) {
+        return [self.receivedPaths countForObject:path];
+    }
+}
+
+- (NSURL *)URLForPath:(NSString *)path
+{
+    NSAssert(self.baseURL, @"The server must be started");
+    return [NSURL URLWithString:path relativeToURL:self.baseURL].absoluteURL;
+}
+
+#pragma mark Server
+
+- (BOOL)start
+{
+    if (self.acceptSource) {
+        return YES;
+    }
+    
+    int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+    if (socketDescriptor < 0) {
+        return NO;
+    }
+    
+    int enabled = 1;
+    setsockopt(socketDescriptor, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+    
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    
+    socklen_t addressLength = sizeof(address);
+    if (bind(socketDescriptor, (struct sockaddr *)&address, sizeof(address)) != 0
+            || listen(socketDescriptor, SOMAXCONN) != 0
+            || getsockname(socketDescriptor, (struct sockaddr *)&address, &addressLength) != 0) {
+        close(socketDescriptor);
+        return NO;
+    }
+    
+    self.baseURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%@", @(ntohs(address.sin_port))]];
+    
+    dispatch_queue_t queue = dispatch_queue_create("ch.srgssr.network.tests.loopback", DISPATCH_QUEUE_SERIAL);
+    dispatch_source_t acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)socketDescriptor, 0, queue);
+    
+    __weak __typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(acceptSource, ^{
+        int connectionDescriptor = accept(socketDescriptor, NULL, NULL);
+        if (connectionDescriptor < 0) {
+            return;
+        }
+        
+        int enabled = 1;
+        setsockopt(connectionDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+        
+        // One thread per connection, so that delayed responses do not starve other connections
+        [NSThread detachNewThreadWithBlock:^{
+            [weakSelf serveConnection:connectionDescriptor];
+            close(connectionDescriptor);
+        }];
+    });
+    dispatch_source_set_cancel_handler(acceptSource, ^{
+        close(socketDescriptor);
+    });
+    dispatch_resume(acceptSource);
+    self.acceptSource = acceptSource;
+    return YES;
+}
+
+- (void)stop
+{
+    if (self.acceptSource) {
+        dispatch_source_cancel(self.acceptSource);
+        self.acceptSource = nil;
+    }
+}
+
+#pragma mark Connections
+
+- (void)serveConnection:(int)connectionDescriptor
+{
+    NSMutableData *buffer = [NSMutableData data];
+    
+    while (YES) {
+        @autoreleasepool {
+            // Read the request head
+            NSRange terminatorRange = NSMakeRange(NSNotFound, 0);
+            while ((terminatorRange = [buffer rangeOfData:LoopbackServerHeaderTerminator() options:0 range:NSMakeRange(0, buffer.length)]).location == NSNotFound) {
+                if (! [self readFromConnection:connectionDescriptor intoBuffer:buffer]) {
+                    return;
+                }
+            }
+            
+            NSData *headData = [buffer subdataWithRange:NSMakeRange(0, terminatorRange.location)];
+            [buffer replaceBytesInRange:NSMakeRange(0, NSMaxRange(terminatorRange)) withBytes:NULL length:0];
+            
+            NSString *head = [[NSString alloc] initWithData:headData encoding:NSASCIIStringEncoding];
+            NSArray<NSString *> *lines = [head componentsSeparatedByString:@"\r\n"];
+            NSArray<NSString *> *requestLineComponents = [lines.firstObject componentsSeparatedByString:@" "];
+            if (requestLineComponents.count < 2) {
+                return;
+            }
+            
+            NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionary];
+            for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, lines.count - 1)]) {
+                NSRange separatorRange = [line rangeOfString:@":"];
+                if (separatorRange.location == NSNotFound) {
+                    continue;
+                }
+                NSString *name = [line substringToIndex:separatorRange.location].lowercaseString;
+                NSString *value = [[line substringFromIndex:NSMaxRange(separatorRange)] stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+                headers[name] = value;
+            }
+            
+            // Read the request body, if any
+            NSUInteger contentLength = (NSUInteger)MAX(headers[@"content-length"].integerValue, 0);
+            while (buffer.length < contentLength) {
+                if (! [self readFromConnection:connectionDescriptor intoBuffer:buffer]) {
+                    return;
+                }
+            }
+            NSData *body = [buffer subdataWithRange:NSMakeRange(0, contentLength)];
+            [buffer replaceBytesInRange:NSMakeRange(0, contentLength) withBytes:NULL length:0];
+            
+            NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[self URLForPath:requestLineComponents[1]]];
+            request.HTTPMethod = requestLineComponents[0];
+            request.allHTTPHeaderFields = headers;
+            request.HTTPBody = (body.length != 0) ? body : nil;
+            
+            @synchronized(self.receivedPaths) {
+                [self.receivedPaths addObject:request.URL.path];
+            }
+            
+            LoopbackServerResponse *response = self.handler(request);
+            if (response.delay > 0.) {
+                [NSThread sleepForTimeInterval:response.delay];
+            }
+            
+            if (! [self writeResponse:response forRequest:request toConnection:connectionDescriptor]) {
+                return;
+            }
+            
+            if ([headers[@"connection"].lowercaseString isEqualToString:@"close"]) {
+                return;
+            }
+        }
+    }
+}
+
+- (BOOL)readFromConnection:(int)connectionDescriptor intoBuffer:(NSMutableData *)buffer
+{
+    uint8_t bytes[16384];
+    ssize_t length = recv(connectionDescriptor, bytes, sizeof(bytes), 0);
+    if (length <= 0) {
+        return NO;
+    }
+    [buffer appendBytes:bytes length:(NSUInteger)length];
+    return YES;
+}
+
+- (BOOL)writeResponse:(LoopbackServerResponse *)response forRequest:(NSURLRequest *)request toConnection:(int)connectionDescriptor
+{
+    NSData *body = [request.HTTPMethod isEqualToString:@"HEAD"] ? nil : response.body;
+    
+    NSMutableString *head = [NSMutableString stringWithFormat:@"HTTP/1.1 %@ %@\r\n", @(response.statusCode), [NSHTTPURLResponse localizedStringForStatusCode:response.statusCode]];
+    [response.headers enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull name, NSString * _Nonnull value, BOOL * _Nonnull stop) {
+        [head appendFormat:@"%@: %@\r\n", name, value];
+    }];
+    if (response.chunked) {
+        [head appendString:@"Transfer-Encoding: chunked\r\n\r\n"];
+    }
+    else {
+        [head appendFormat:@"Content-Length: %@\r\n\r\n", @(response.body.length)];
+    }
+    
+    NSData *headData = [head dataUsingEncoding:NSASCIIStringEncoding];
+    if (response.chunked && ! [request.HTTPMethod isEqualToString:@"HEAD"]) {
+        return [self writeChunkedBody:body ?: NSData.data forResponse:response afterHead:headData toConnection:connectionDescriptor];
+    }
+    else if (response.bodyChunkSize == 0 || ! body) {
+        NSMutableData *data = headData.mutableCopy;
+        if (body) {
+            [data appendData:body];
+        }
+        return [self writeData:data toConnection:connectionDescriptor];
+    }
+    
+    // Throttled delivery
+    if (! [self writeData:headData toConnection:connectionDescriptor]) {
+        return NO;
+    }
+    
+    for (NSUInteger offset = 0; offset < body.length; offset += response.bodyChunkSize) {
+        if (offset != 0 && response.bodyChunkInterval > 0.) {
+            [NSThread sleepForTimeInterval:response.bodyChunkInterval];
+        }
+        
+        NSData *chunk = [body subdataWithRange:NSMakeRange(offset, MIN(response.bodyChunkSize, body.length - offset))];
+        if (! [self writeData:chunk toConnection:connectionDescriptor]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (BOOL)writeChunkedBody:(NSData *)body forResponse:(LoopbackServerResponse *)response afterHead:(NSData *)headData toConnection:(int)connectionDescriptor
+{
+    if (! [self writeData:headData toConnection:connectionDescriptor]) {
+        return NO;
+    }
+    
+    NSUInteger chunkSize = (response.bodyChunkSize != 0) ? response.bodyChunkSize : MAX(body.length, 1);
+    for (NSUInteger offset = 0; offset < body.length; offset += chunkSize) {
+        if (offset != 0 && response.bodyChunkInterval > 0.) {
+            [NSThread sleepForTimeInterval:response.bodyChunkInterval];
+        }
+        
+        NSData *chunk = [body subdataWithRange:NSMakeRange(offset, MIN(chunkSize, body.length - offset))];
+        NSMutableData *data = [[NSString stringWithFormat:@"%lx\r\n", (unsigned long)chunk.length] dataUsingEncoding:NSASCIIStringEncoding].mutableCopy;
+        [data appendData:chunk];
+        [data appendData:[@"\r\n" dataUsingEncoding:NSASCIIStringEncoding]];
+        if (! [self writeData:data toConnection:connectionDescriptor]) {
+            return NO;
+        }
+    }
+    
+    // Last chunk
+    return [self writeData:[@"0\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding] toConnection:connectionDescriptor];
+}
+
+- (BOOL)writeData:(NSData *)data toConnection:(int)connectionDescriptor
+{
+    const uint8_t *bytes = data.bytes;
+    NSUInteger offset = 0;
+    while (offset < data.length) {
+        ssize_t length = send(connectionDescriptor, bytes + offset, data.length - offset, 0);
+        if (length <= 0) {
+            return NO;
+        }
+        offset += (NSUInteger)length;
+    }
+    return YES;
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSData *LoopbackServerEncodedData(NSData *data, NSString *encoding)
+{
+    int windowBits = [encoding isEqualToString:@"gzip"] ? 16 + MAX_WBITS : MAX_WBITS;
+    
+    z_stream stream = { 0 };
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return data;
+    }
+    
+    NSMutableData *encodedData = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)data.length)];
+    stream.next_in = (Bytef *)data.bytes;
+    stream.avail_in = (uInt)data.length;
+    stream.next_out = encodedData.mutableBytes;
+    stream.avail_out = (uInt)encodedData.length;
+    
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return data;
+    }
+    
+    encodedData.length = stream.total_out;
+    return encodedData.copy;
+}
@@ -0,0 +1,65 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Store of responses served in-process, without any socket involved, to requests performed with its session. This
+ *  makes it possible to measure the cost of the library itself, independently of the network.
+ *
+ *  Responses are either fixed (e.g. recorded) responses registered for a path, or generated by a handler. Response
+ *  delays and body chunking settings are honored, but are not applied by default.
+ */
+@interface FixtureStore : NSObject
+
+/**
+ *  Create a store, calling the specified handler (on a background thread) for requests whose path has no registered
+ *  response. If no handler is provided, a 404 response is returned for such requests.
+ */
+- (instancetype)initWithHandler:(nullable LoopbackServerHandler)handler NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Ephemeral session whose requests to the store base URL are served by the store.
+ */
+@property (nonatomic, readonly) NSURLSession *session;
+
+/**
+ *  The store base URL, unique to the store.
+ */
+@property (nonatomic, readonly) NSURL *baseURL;
+
+/**
+ *  URL for the specified path and optional query.
+ */
+- (NSURL *)URLForPath:(NSString *)path;
+
+/**
+ *  Register the response to return for the specified path (query excluded). Use `nil` to remove a registered
+ *  response.
+ */
+- (void)setResponse:(nullable LoopbackServerResponse *)response forPath:(NSString *)path;
+
+/**
+ *  Register recorded responses from the files of a directory. Each file is served for the path matching its location
+ *  relative to the directory, with a content type matching its extension (e.g. the `shows/list.json` file is served
+ *  as JSON for the `/shows/list.json` path). Returns `NO` if the directory could not be read.
+ */
+- (BOOL)addResponsesFromDirectoryAtURL:(NSURL *)directoryURL;
+
+/**
+ *  The total number of requests served so far.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfRequests;
+
+@end
+
+NS_ASSUME_NONNULL_END
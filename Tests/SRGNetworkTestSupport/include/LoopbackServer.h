@@ -0,0 +1,114 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Response returned by a loopback server.
+ */
+@interface LoopbackServerResponse : NSObject
+
+/**
+ *  Response with the specified status code, headers and body.
+ */
++ (LoopbackServerResponse *)responseWithStatusCode:(NSInteger)statusCode headers:(nullable NSDictionary<NSString *, NSString *> *)headers body:(nullable NSData *)body;
+
+/**
+ *  Successful response whose body is the specified JSON object.
+ */
++ (LoopbackServerResponse *)JSONResponseWithObject:(id)JSONObject;
+
+@property (nonatomic) NSInteger statusCode;
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *headers;
+@property (nonatomic, copy, nullable) NSData *body;
+
+/**
+ *  Delay applied before the response is sent.
+ */
+@property (nonatomic) NSTimeInterval delay;
+
+/**
+ *  If non-zero, the body is sent in pieces of the specified size, separated by `bodyChunkInterval`.
+ */
+@property (nonatomic) NSUInteger bodyChunkSize;
+@property (nonatomic) NSTimeInterval bodyChunkInterval;
+
+/**
+ *  If set to `YES`, the body is sent with chunked transfer encoding (in pieces of `bodyChunkSize` if non-zero, as a
+ *  single chunk otherwise) instead of with a content length.
+ */
+@property (nonatomic, getter=isChunked) BOOL chunked;
+
+@end
+
+// Block signatures.
+typedef LoopbackServerResponse * _Nonnull (^LoopbackServerHandler)(NSURLRequest *request);
+
+/**
+ *  Minimal HTTP/1.1 server listening on the loopback interface, so that tests can run without Internet access and
+ *  with full control over responses.
+ */
+@interface LoopbackServer : NSObject
+
+/**
+ *  Handler whose responses are configured by request query parameters, all optional:
+ *    - `latency`: Delay before the response is sent, in milliseconds.
+ *    - `status`: The response status code (200 by default).
+ *    - `items`: The number of items in the response, a JSON dictionary with an `items` array (10 by default). Each
+ *               item is a dictionary of about 100 bytes.
+ *    - `encoding`: If present (`gzip` or `deflate`), the body is compressed and sent with a matching `Content-Encoding`
+ *               header.
+ *    - `chunk`: If present, the body is sent with chunked transfer encoding, in pieces of the specified size in bytes.
+ *    - `etag`: If present, the response is sent with the specified `ETag` and a `no-cache` directive, or as a `304 Not
+ *               Modified` response without body if the request has a matching `If-None-Match` header.
+ *    - `page` and `pages`: The page number (starting at 0) and the total number of pages. The response then contains
+ *               the `page` number and a `next` entry with the URL of the next page, except for the last page. Pages
+ *               past the last one contain no items.
+ */
++ (LoopbackServerHandler)configurableHandler;
+
+/**
+ *  Create a server calling the specified handler (on a background thread) for each received request.
+ */
+- (instancetype)initWithHandler:(LoopbackServerHandler)handler NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Start listening on a random available port. Returns `NO` if the server could not be started.
+ */
+- (BOOL)start;
+
+/**
+ *  Stop listening.
+ */
+- (void)stop;
+
+/**
+ *  The server base URL (`nil` if not started).
+ */
+@property (nonatomic, readonly, nullable) NSURL *baseURL;
+
+/**
+ *  URL for the specified path and optional query.
+ */
+- (NSURL *)URLForPath:(NSString *)path;
+
+/**
+ *  The total number of requests received so far.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfRequests;
+
+/**
+ *  The number of requests received so far for the specified path (query excluded).
+ */
+- (NSUInteger)numberOfRequestsForPath:(NSString *)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
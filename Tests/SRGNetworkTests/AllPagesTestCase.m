@@ -0,0 +1,202 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kPageSize = 10;
+static const NSUInteger kMaximumNumberOfConcurrentRequests = 4;
+static const NSTimeInterval kResponseDelay = 0.2;
+
+@interface AllPagesTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation AllPagesTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+        NSMutableDictionary<NSString *, NSString *> *parameters = [NSMutableDictionary dictionary];
+        for (NSURLQueryItem *queryItem in URLComponents.queryItems) {
+            parameters[queryItem.name] = queryItem.value;
+        }
+        
+        NSInteger total = parameters[@"total"].integerValue;
+        NSInteger size = parameters[@"size"].integerValue;
+        NSInteger number = parameters[@"page"].integerValue;
+        
+        if (parameters[@"failingPage"] && parameters[@"failingPage"].integerValue == number) {
+            return [LoopbackServerResponse responseWithStatusCode:500 headers:nil body:nil];
+        }
+        
+        NSMutableArray<NSNumber *> *items = [NSMutableArray array];
+        for (NSInteger item = number * size; item < MIN((number + 1) * size, total); item++) {
+            [items addObject:@(item)];
+        }
+        
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"items" : items.copy }];
+        response.delay = kResponseDelay;
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGFirstPageRequest *)itemsRequestWithQuery:(NSString *)query
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:[NSString stringWithFormat:@"/items?%@", query]]];
+    return [[SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URLRequest.URL resolvingAgainstBaseURL:NO];
+        NSMutableArray<NSURLQueryItem *> *queryItems = URLComponents.queryItems.mutableCopy ?: [NSMutableArray array];
+        [queryItems addObject:[NSURLQueryItem queryItemWithName:@"size" value:@(size).stringValue]];
+        URLComponents.queryItems = queryItems.copy;
+        return [NSURLRequest requestWithURL:URLComponents.URL];
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        return nil;
+    } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"The completion block of the original request must not be called");
+    }] requestWithPageSize:kPageSize];
+}
+
+- (SRGRequestQueue *)allItemsWithRequest:(SRGFirstPageRequest *)request completionBlock:(SRGAllPagesCompletionBlock)completionBlock
+{
+    return [request requestQueueForAllPagesWithBuilder:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size, NSUInteger number) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URLRequest.URL resolvingAgainstBaseURL:NO];
+        NSMutableArray<NSURLQueryItem *> *queryItems = URLComponents.queryItems.mutableCopy;
+        [queryItems addObject:[NSURLQueryItem queryItemWithName:@"page" value:@(number).stringValue]];
+        URLComponents.queryItems = queryItems.copy;
+        return [NSURLRequest requestWithURL:URLComponents.URL];
+    } itemsExtractor:^NSArray * _Nullable(NSDictionary * _Nullable JSONDictionary) {
+        return JSONDictionary[@"items"];
+    } maximumNumberOfConcurrentRequests:kMaximumNumberOfConcurrentRequests completionBlock:completionBlock];
+}
+
+- (NSArray<NSNumber *> *)itemsUpTo:(NSUInteger)total
+{
+    NSMutableArray<NSNumber *> *items = [NSMutableArray array];
+    for (NSUInteger item = 0; item < total; item++) {
+        [items addObject:@(item)];
+    }
+    return items.copy;
+}
+
+#pragma mark Tests
+
+- (void)testAllPages
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+    
+    NSDate *startDate = NSDate.date;
+    SRGRequestQueue *requestQueue = [self allItemsWithRequest:[self itemsRequestWithQuery:@"total=95"] completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqual(pageObjects.count, 10);
+        XCTAssertEqualObjects(items, [self itemsUpTo:95]);
+        [expectation fulfill];
+    }];
+    XCTAssertTrue(requestQueue.running);
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Much faster than retrieving the 10 pages one after the other
+    XCTAssertLessThan([NSDate.date timeIntervalSinceDate:startDate], 10 * kResponseDelay * 0.75);
+    
+    // Pages beyond the last one might have been requested in parallel, but not more than the fan-out allows
+    XCTAssertGreaterThanOrEqual(self.server.numberOfRequests, 10);
+    XCTAssertLessThanOrEqual(self.server.numberOfRequests, 10 + kMaximumNumberOfConcurrentRequests);
+}
+
+- (void)testAllPagesWithEmptyLastPage
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+    
+    [self allItemsWithRequest:[self itemsRequestWithQuery:@"total=40"] completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(pageObjects.count, 5);
+        XCTAssertEqualObjects(pageObjects.lastObject[@"items"], @[]);
+        XCTAssertEqualObjects(items, [self itemsUpTo:40]);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testAllPagesWithSinglePage
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+    
+    [self allItemsWithRequest:[self itemsRequestWithQuery:@"total=3"] completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(pageObjects.count, 1);
+        XCTAssertEqualObjects(items, [self itemsUpTo:3]);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testAllPagesWithFailure
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+    
+    [self allItemsWithRequest:[self itemsRequestWithQuery:@"total=1000&failingPage=2"] completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+        XCTAssertNil(pageObjects);
+        XCTAssertNil(items);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @500);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Remaining pages are cancelled
+    XCTAssertLessThan(self.server.numberOfRequests, 100);
+}
+
+- (void)testAllPagesCancellation
+{
+    SRGRequestQueue *requestQueue = [self allItemsWithRequest:[self itemsRequestWithQuery:@"total=1000"] completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+        XCTFail(@"No completion is expected when cancelled");
+    }];
+    [requestQueue cancel];
+    
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(requestQueue.running);
+}
+
+- (void)testAllPagesCancellationWithCancellationErrors
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All pages retrieved"];
+    
+    SRGFirstPageRequest *request = [[self itemsRequestWithQuery:@"total=1000"] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled];
+    SRGRequestQueue *requestQueue = [self allItemsWithRequest:request completionBlock:^(NSArray * _Nullable pageObjects, NSArray * _Nullable items, NSError * _Nullable error) {
+        XCTAssertNil(pageObjects);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }];
+    [requestQueue cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+@end
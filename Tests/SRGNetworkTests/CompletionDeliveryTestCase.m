@@ -0,0 +1,149 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfBurstRequests = 300;
+
+@interface CompletionDeliveryTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation CompletionDeliveryTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        return [LoopbackServerResponse JSONResponseWithObject:@{ @"path" : request.URL.path }];
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Tests
+
+- (void)testBurstWithBusyMainThread
+{
+    // Serial parsing, so that completion blocks are submitted in parsing order
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:1];
+    
+    dispatch_group_t parsingGroup = dispatch_group_create();
+    NSMutableArray<NSNumber *> *parsedIndexes = [NSMutableArray array];
+    
+    // Main queue hop during which each completion block is called
+    __block NSUInteger numberOfMainQueueHops = 0;
+    __block BOOL hopMarked = NO;
+    NSMutableArray<NSNumber *> *completionHops = [NSMutableArray array];
+    
+    NSMutableArray<NSNumber *> *completionIndexes = [NSMutableArray array];
+    __block BOOL finishedBeforeCompletions = NO;
+    
+    XCTestExpectation *queueExpectation = [self expectationWithDescription:@"Queue finished"];
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            finishedBeforeCompletions = (completionIndexes.count != kNumberOfBurstRequests);
+            [queueExpectation fulfill];
+        }
+    }];
+    
+    for (NSUInteger i = 0; i < kNumberOfBurstRequests; i++) {
+        dispatch_group_enter(parsingGroup);
+        
+        NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:[NSString stringWithFormat:@"/burst/%@", @(i)]]];
+        SRGRequest *request = [[SRGRequest objectRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+            @synchronized (parsedIndexes) {
+                [parsedIndexes addObject:@(i)];
+            }
+            dispatch_group_leave(parsingGroup);
+            return SRGNetworkJSONDictionaryParser(data, pError);
+        } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertTrue(NSThread.isMainThread);
+            XCTAssertNotNil(object);
+            
+            if (! hopMarked) {
+                hopMarked = YES;
+                numberOfMainQueueHops++;
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    hopMarked = NO;
+                });
+            }
+            [completionHops addObject:@(numberOfMainQueueHops)];
+            [completionIndexes addObject:@(i)];
+        }] requestWithParsingExecutor:parsingExecutor];
+        [requestQueue addRequest:request resume:YES];
+    }
+    
+    // Keep the main thread busy until all responses have been processed. Processing must not be stalled meanwhile.
+    XCTAssertEqual(dispatch_group_wait(parsingGroup, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(30. * NSEC_PER_SEC))), 0);
+    
+    // Completion blocks are submitted by the executor right after parsing, before it becomes idle
+    while (parsingExecutor.numberOfRunningOperations != 0 || parsingExecutor.numberOfPendingOperations != 0) {
+        sched_yield();
+    }
+    XCTAssertEqual(completionIndexes.count, 0);
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertFalse(finishedBeforeCompletions);
+    
+    // All completion blocks were pending when the main thread became available. They are delivered in submission
+    // order, in as few hops as the delivery batch size (64 blocks) permits
+    XCTAssertEqualObjects(completionIndexes, parsedIndexes);
+    
+    NSUInteger expectedNumberOfMainQueueHops = (kNumberOfBurstRequests + 63) / 64;
+    XCTAssertEqual(numberOfMainQueueHops, expectedNumberOfMainQueueHops);
+    
+    NSCountedSet<NSNumber *> *hops = [[NSCountedSet alloc] initWithArray:completionHops];
+    for (NSUInteger hop = 1; hop < expectedNumberOfMainQueueHops; hop++) {
+        XCTAssertEqual([hops countForObject:@(hop)], 64);
+    }
+}
+
+- (void)testRunningUntilCompletionBlockCalled
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    __block SRGRequest *request = nil;
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/json"]];
+    request = [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(request.running);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            XCTAssertFalse(request.running);
+            [expectation fulfill];
+        });
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+#pragma mark Performance tests
+
+- (void)testBurstDeliveryPerformance
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kNumberOfBurstRequests; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+            NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:[NSString stringWithFormat:@"/burst/%@", @(i)]]];
+            [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                [expectation fulfill];
+            }] resume];
+        }
+        [self waitForExpectationsWithTimeout:30. handler:nil];
+    }];
+}
+
+@end
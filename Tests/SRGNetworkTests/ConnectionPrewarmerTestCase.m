@@ -0,0 +1,183 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+@interface ConnectionPrewarmerTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+@property (nonatomic) NSURLSession *session;
+
+@end
+
+@implementation ConnectionPrewarmerTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([self.server start]);
+    
+    // Dedicated session, so that no connection has been opened beforehand
+    self.session = [NSURLSession sessionWithConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration];
+}
+
+- (void)tearDown
+{
+    [self.session invalidateAndCancel];
+    self.session = nil;
+    
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (void)prewarmWithConnectionPrewarmer:(SRGConnectionPrewarmer *)connectionPrewarmer URLs:(NSArray<NSURL *> *)URLs
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prewarming finished"];
+    [connectionPrewarmer prewarmOriginsWithURLs:URLs completionBlock:^{
+        XCTAssertTrue(NSThread.isMainThread);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (SRGRequest *)performRequestWithPath:(NSString *)path metricsCollector:(SRGMetricsCollector *)metricsCollector
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:self.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] requestWithMetricsCollector:metricsCollector];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    return request;
+}
+
+#pragma mark Tests
+
+- (void)testPrewarming
+{
+    SRGConnectionPrewarmer *connectionPrewarmer = [[SRGConnectionPrewarmer alloc] initWithSession:self.session keepAliveInterval:0.];
+    XCTAssertEqual(connectionPrewarmer.session, self.session);
+    XCTAssertEqual(connectionPrewarmer.keepAliveInterval, 0.);
+    
+    NSURL *URL = [self.server URLForPath:@"/items"];
+    XCTAssertFalse([connectionPrewarmer isOriginWarmForURL:URL]);
+    
+    // Several URLs with the same origin are probed once
+    [self prewarmWithConnectionPrewarmer:connectionPrewarmer URLs:@[ URL, [self.server URLForPath:@"/other"] ]];
+    
+    XCTAssertTrue([connectionPrewarmer isOriginWarmForURL:URL]);
+    XCTAssertTrue([connectionPrewarmer isOriginWarmForURL:[self.server URLForPath:@"/any/path?query=1"]]);
+    XCTAssertEqual(connectionPrewarmer.numberOfProbes, 1);
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/"], 1);
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testPrewarmingUnreachableOrigin
+{
+    NSURL *URL = [self.server URLForPath:@"/items"];
+    [self.server stop];
+    
+    SRGConnectionPrewarmer *connectionPrewarmer = [[SRGConnectionPrewarmer alloc] initWithSession:self.session keepAliveInterval:0.];
+    [self prewarmWithConnectionPrewarmer:connectionPrewarmer URLs:@[ URL ]];
+    
+    XCTAssertFalse([connectionPrewarmer isOriginWarmForURL:URL]);
+    XCTAssertEqual(connectionPrewarmer.numberOfProbes, 1);
+}
+
+- (void)testPrewarmingInvalidURLs
+{
+    SRGConnectionPrewarmer *connectionPrewarmer = [[SRGConnectionPrewarmer alloc] initWithSession:self.session keepAliveInterval:0.];
+    [self prewarmWithConnectionPrewarmer:connectionPrewarmer URLs:@[ [NSURL URLWithString:@"file:///tmp/file.json"], [NSURL URLWithString:@"relative/path"] ]];
+    
+    XCTAssertEqual(connectionPrewarmer.numberOfProbes, 0);
+}
+
+- (void)testPrewarmedConnectionReuse
+{
+    SRGConnectionPrewarmer *connectionPrewarmer = [[SRGConnectionPrewarmer alloc] initWithSession:self.session keepAliveInterval:0.];
+    [self prewarmWithConnectionPrewarmer:connectionPrewarmer URLs:@[ [self.server URLForPath:@"/items"] ]];
+    
+    SRGRequest *request = [self performRequestWithPath:@"/items" metricsCollector:nil];
+    
+    if (@available(iOS 15, tvOS 15, watchOS 8, *)) {
+        XCTAssertEqual(request.connectionReuse, SRGConnectionReusePrewarmed);
+        XCTAssertEqual(connectionPrewarmer.numberOfPrewarmedConnectionReuses, 1);
+    }
+    else {
+        XCTAssertEqual(request.connectionReuse, SRGConnectionReuseUnknown);
+        XCTAssertEqual(connectionPrewarmer.numberOfPrewarmedConnectionReuses, 0);
+    }
+}
+
+- (void)testConnectionReuseWithoutPrewarming
+{
+    // Without metrics collector or prewarmer, connection reuse is not determined
+    SRGRequest *request1 = [self performRequestWithPath:@"/items" metricsCollector:nil];
+    XCTAssertEqual(request1.connectionReuse, SRGConnectionReuseUnknown);
+    
+    SRGMetricsCollector *metricsCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:^NSString * _Nonnull(NSURLRequest * _Nonnull URLRequest) {
+        return @"loopback";
+    }];
+    SRGRequest *request2 = [self performRequestWithPath:@"/items" metricsCollector:metricsCollector];
+    
+    if (@available(iOS 15, tvOS 15, watchOS 8, *)) {
+        XCTAssertEqual(request2.connectionReuse, SRGConnectionReuseReused);
+    }
+    else {
+        XCTAssertEqual(request2.connectionReuse, SRGConnectionReuseUnknown);
+    }
+}
+
+- (void)testNewConnection
+{
+    SRGMetricsCollector *metricsCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:^NSString * _Nonnull(NSURLRequest * _Nonnull URLRequest) {
+        return @"loopback";
+    }];
+    SRGRequest *request = [self performRequestWithPath:@"/items" metricsCollector:metricsCollector];
+    
+    if (@available(iOS 15, tvOS 15, watchOS 8, *)) {
+        XCTAssertEqual(request.connectionReuse, SRGConnectionReuseNone);
+    }
+    else {
+        XCTAssertEqual(request.connectionReuse, SRGConnectionReuseUnknown);
+    }
+}
+
+- (void)testKeepAlive
+{
+    SRGConnectionPrewarmer *connectionPrewarmer = [[SRGConnectionPrewarmer alloc] initWithSession:self.session keepAliveInterval:0.2];
+    [self prewarmWithConnectionPrewarmer:connectionPrewarmer URLs:@[ [self.server URLForPath:@"/items"] ]];
+    
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertGreaterThan(connectionPrewarmer.numberOfProbes, 2);
+    
+    [connectionPrewarmer invalidate];
+    
+    // Let probes in flight end
+    [self expectationForElapsedTimeInterval:0.3 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSUInteger numberOfProbes = connectionPrewarmer.numberOfProbes;
+    
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(connectionPrewarmer.numberOfProbes, numberOfProbes);
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/"], numberOfProbes);
+}
+
+@end
@@ -0,0 +1,296 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+#import "NetworkBaseTestCase.h"
+
+/**
+ *  Decoder for a test coding inverting all bits, delivering decoded data in small chunks.
+ */
+@interface InvertingContentDecoder : NSObject <SRGContentDecoder>
+
+@end
+
+static NSData *ContentCodingTestInvertedData(NSData *data)
+{
+    NSMutableData *invertedData = data.mutableCopy;
+    uint8_t *bytes = invertedData.mutableBytes;
+    for (NSUInteger i = 0; i < invertedData.length; i++) {
+        bytes[i] = ~bytes[i];
+    }
+    return invertedData.copy;
+}
+
+@interface ContentCodingTestCase : NetworkBaseTestCase
+
+@property (nonatomic) SRGContentCoding *invertingContentCoding;
+
+@end
+
+@implementation ContentCodingTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.invertingContentCoding = [[SRGContentCoding alloc] initWithName:@"X-Inverted" decoderProvider:^id<SRGContentDecoder> _Nonnull{
+        return [[InvertingContentDecoder alloc] init];
+    } encoder:^NSData * _Nullable(NSData * _Nonnull data) {
+        return ContentCodingTestInvertedData(data);
+    }];
+}
+
+- (void)tearDown
+{
+    self.invertingContentCoding = nil;
+}
+
+#pragma mark Helpers
+
+- (NSData *)JSONData
+{
+    return LoopbackServer.configurableHandler([NSURLRequest requestWithURL:[NSURL URLWithString:@"http://localhost/items?items=2000"]]).body;
+}
+
+#pragma mark Tests
+
+- (void)testDecoderChunks
+{
+    NSData *data = [self JSONData];
+    NSData *encodedData = SRGContentCoding.gzipContentCoding.encoder(data);
+    XCTAssertNotNil(encodedData);
+    XCTAssertLessThan(encodedData.length, data.length / 4);
+    
+    // Feed encoded bytes in small pieces, decoded chunks must be bounded
+    id<SRGContentDecoder> decoder = SRGContentCoding.gzipContentCoding.decoderProvider();
+    NSMutableData *decodedData = [NSMutableData data];
+    SRGContentDecoderOutputBlock block = ^(NSData *decodedChunk) {
+        XCTAssertLessThanOrEqual(decodedChunk.length, 64 * 1024);
+        [decodedData appendData:decodedChunk];
+    };
+    for (NSUInteger offset = 0; offset < encodedData.length; offset += 1000) {
+        NSData *chunk = [encodedData subdataWithRange:NSMakeRange(offset, MIN(1000, encodedData.length - offset))];
+        XCTAssertTrue([decoder decodeData:chunk withBlock:block error:NULL]);
+    }
+    XCTAssertTrue([decoder finishWithBlock:block error:NULL]);
+    XCTAssertEqualObjects(decodedData, data);
+}
+
+- (void)testDecoderPassThrough
+{
+    NSData *data = [self JSONData];
+    
+    for (SRGContentCoding *contentCoding in @[ SRGContentCoding.gzipContentCoding, SRGContentCoding.deflateContentCoding ]) {
+        id<SRGContentDecoder> decoder = contentCoding.decoderProvider();
+        NSMutableData *decodedData = [NSMutableData data];
+        SRGContentDecoderOutputBlock block = ^(NSData *decodedChunk) {
+            [decodedData appendData:decodedChunk];
+        };
+        XCTAssertTrue([decoder decodeData:[data subdataWithRange:NSMakeRange(0, 1)] withBlock:block error:NULL]);
+        XCTAssertTrue([decoder decodeData:[data subdataWithRange:NSMakeRange(1, data.length - 1)] withBlock:block error:NULL]);
+        XCTAssertTrue([decoder finishWithBlock:block error:NULL]);
+        XCTAssertEqualObjects(decodedData, data, @"%@", contentCoding);
+    }
+}
+
+- (void)testInvalidData
+{
+    NSData *data = [self JSONData];
+    NSData *encodedData = SRGContentCoding.gzipContentCoding.encoder(data);
+    
+    id<SRGContentDecoder> decoder = SRGContentCoding.gzipContentCoding.decoderProvider();
+    NSError *error = nil;
+    XCTAssertTrue([decoder decodeData:[encodedData subdataWithRange:NSMakeRange(0, encodedData.length / 2)] withBlock:^(NSData * _Nonnull decodedData) {} error:&error]);
+    XCTAssertFalse([decoder finishWithBlock:^(NSData * _Nonnull decodedData) {} error:&error]);
+    XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+    XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+    
+    NSMutableData *corruptedData = encodedData.mutableCopy;
+    memset((uint8_t *)corruptedData.mutableBytes + 10, 0xff, 32);
+    
+    decoder = SRGContentCoding.gzipContentCoding.decoderProvider();
+    XCTAssertFalse([decoder decodeData:corruptedData withBlock:^(NSData * _Nonnull decodedData) {} error:&error]);
+    XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+    XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+}
+
+- (void)testDecodedResponses
+{
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:LoopbackServer.configurableHandler];
+    NSArray<SRGContentCoding *> *contentCodings = @[ SRGContentCoding.gzipContentCoding, SRGContentCoding.deflateContentCoding ];
+    
+    for (NSString *encoding in @[ @"gzip", @"deflate" ]) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+        
+        NSURL *URL = [fixtureStore URLForPath:[NSString stringWithFormat:@"/items?items=200&encoding=%@", encoding]];
+        [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:fixtureStore.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            XCTAssertEqual([JSONDictionary[@"items"] count], 200);
+            [expectation fulfill];
+        }] requestWithContentCodings:contentCodings] resume];
+        
+        [self waitForExpectationsWithTimeout:5. handler:nil];
+    }
+}
+
+- (void)testUndecodedResponse
+{
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:LoopbackServer.configurableHandler];
+    
+    // In-process responses are not decoded by the system
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/items?encoding=gzip"]];
+    [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:fixtureStore.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testResponseDecodedBySystem
+{
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([server start]);
+    
+    // Bodies already decoded by the system must not be decoded again
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[server URLForPath:@"/items?items=200&encoding=gzip"]];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([JSONDictionary[@"items"] count], 200);
+        [expectation fulfill];
+    }] requestWithContentCodings:@[ SRGContentCoding.gzipContentCoding ]] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    [server stop];
+}
+
+- (void)testCustomCoding
+{
+    __block NSString *acceptEncoding = nil;
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        acceptEncoding = [request valueForHTTPHeaderField:@"Accept-Encoding"];
+        
+        NSData *body = ContentCodingTestInvertedData([@"{ \"name\": \"inverted\" }" dataUsingEncoding:NSUTF8StringEncoding]);
+        return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Content-Encoding" : @"x-inverted" } body:body];
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/inverted"]];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:fixtureStore.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(JSONDictionary, @{ @"name" : @"inverted" });
+        [expectation fulfill];
+    }] requestWithContentCodings:@[ self.invertingContentCoding, SRGContentCoding.gzipContentCoding ]] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertEqualObjects(acceptEncoding, @"x-inverted, gzip, deflate, br");
+}
+
+- (void)testMaximumDecodedSize
+{
+    // Zeros compress extremely well, as compression bombs do
+    NSData *encodedData = SRGContentCoding.gzipContentCoding.encoder([NSMutableData dataWithLength:64 * 1024 * 1024 + 1]);
+    XCTAssertNotNil(encodedData);
+    
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Content-Encoding" : @"gzip" } body:encodedData];
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/bomb"]];
+    [[[SRGRequest dataRequestWithURLRequest:URLRequest session:fixtureStore.session completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(data);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+        [expectation fulfill];
+    }] requestWithContentCodings:@[ SRGContentCoding.gzipContentCoding ]] resume];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (void)testStreamedResponse
+{
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:LoopbackServer.configurableHandler];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/items?items=2000&encoding=gzip&chunk=512"]];
+    [[[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:fixtureStore.session elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([object[@"items"] count], 2000);
+        [expectation fulfill];
+    }] requestWithContentCodings:@[ SRGContentCoding.gzipContentCoding ]] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testBodyEncoding
+{
+    NSMutableArray<NSDictionary *> *receivedRequests = [NSMutableArray array];
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        @synchronized (receivedRequests) {
+            [receivedRequests addObject:@{ @"encoding" : [request valueForHTTPHeaderField:@"Content-Encoding"] ?: @"identity",
+                                           @"length" : @(request.HTTPBody.length) }];
+        }
+        return [LoopbackServerResponse responseWithStatusCode:204 headers:nil body:nil];
+    }];
+    XCTAssertTrue([server start]);
+    
+    NSData *largeBody = [self JSONData];
+    NSData *smallBody = [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    for (NSData *body in @[ largeBody, smallBody ]) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+        
+        NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:[server URLForPath:@"/upload"]];
+        URLRequest.HTTPMethod = @"POST";
+        URLRequest.HTTPBody = body;
+        [[[SRGRequest dataRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }] requestWithBodyContentCoding:SRGContentCoding.gzipContentCoding minimumBodyLength:1024] resume];
+        
+        [self waitForExpectationsWithTimeout:5. handler:nil];
+    }
+    
+    [server stop];
+    
+    XCTAssertEqual(receivedRequests.count, 2);
+    XCTAssertEqualObjects(receivedRequests.firstObject[@"encoding"], @"gzip");
+    XCTAssertLessThan([receivedRequests.firstObject[@"length"] unsignedIntegerValue], largeBody.length);
+    XCTAssertEqualObjects(receivedRequests.lastObject[@"encoding"], @"identity");
+    XCTAssertEqual([receivedRequests.lastObject[@"length"] unsignedIntegerValue], smallBody.length);
+}
+
+@end
+
+@implementation InvertingContentDecoder
+
+#pragma mark SRGContentDecoder protocol
+
+- (BOOL)decodeData:(NSData *)data withBlock:(SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError
+{
+    for (NSUInteger offset = 0; offset < data.length; offset += 4) {
+        block(ContentCodingTestInvertedData([data subdataWithRange:NSMakeRange(offset, MIN(4, data.length - offset))]));
+    }
+    return YES;
+}
+
+- (BOOL)finishWithBlock:(SRGContentDecoderOutputBlock)block error:(NSError * __autoreleasing *)pError
+{
+    return YES;
+}
+
+@end
@@ -0,0 +1,333 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+#import <stdatomic.h>
+
+static atomic_bool s_parsed = false;
+
+@interface DeadlineTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation DeadlineTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (NSURLRequest *)URLRequestWithPath:(NSString *)path
+{
+    return [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+}
+
+#pragma mark Tests
+
+- (void)testDeadlineExceeded
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSDate *startDate = NSDate.date;
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items?latency=3000"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(JSONDictionary);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+        [expectation fulfill];
+    }] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertLessThan([NSDate.date timeIntervalSinceDate:startDate], 2.);
+    XCTAssertFalse(request.running);
+}
+
+- (void)testDeadlineMet
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(JSONDictionary);
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:10.]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testPastDeadline
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+        [expectation fulfill];
+    }] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:-1.]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 0);
+}
+
+- (void)testCancellationBeforeDeadline
+{
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items?latency=1000"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called");
+    }] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+    [request resume];
+    [request cancel];
+    
+    // Cancelled requests are not reported when their deadline is reached
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testNoRetryAfterDeadline
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRetryPolicy *retryPolicy = [[SRGRetryPolicy alloc] initWithMaximumNumberOfAttempts:5 timeBudget:60.];
+    retryPolicy.baseDelay = 1.;
+    retryPolicy.maximumDelay = 1.;
+    SRGRequest *request = [[[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items?status=503"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:retryPolicy] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // The delay before the next attempt would exceed the deadline
+    XCTAssertEqual(request.numberOfAttempts, 1);
+}
+
+- (void)testQueueTimeBudget
+{
+    XCTestExpectation *queueExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            XCTAssertEqual(error.code, SRGNetworkErrorMultiple);
+            [queueExpectation fulfill];
+        }
+    }] requestQueueWithTimeBudget:0.5];
+    XCTAssertEqual(requestQueue.timeBudget, 0.5);
+    
+    NSDate *startDate = NSDate.date;
+    for (NSUInteger i = 0; i < 3; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        SRGRequest *request = [SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items?latency=3000"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+            [requestQueue reportError:error];
+            [expectation fulfill];
+        }];
+        [requestQueue addRequest:request resume:YES];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertLessThan([NSDate.date timeIntervalSinceDate:startDate], 2.);
+}
+
+- (void)testQueueTimeBudgetWithPendingRequests
+{
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] init] requestQueueWithTimeBudget:0.5];
+    requestQueue = [requestQueue requestQueueWithMaximumNumberOfConcurrentRequests:1];
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Request 1 finished"];
+    [requestQueue addRequest:[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items?latency=1000"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+        [expectation1 fulfill];
+    }] resume:YES];
+    
+    // Started once the budget has been exhausted, without reaching the server
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Request 2 finished"];
+    [requestQueue addRequest:[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/pending"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+        [expectation2 fulfill];
+    }] resume:YES];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/pending"], 0);
+    XCTAssertFalse(requestQueue.running);
+}
+
+- (void)testRequestDeadlineShorterThanQueueBudget
+{
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] init] requestQueueWithTimeBudget:60.];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:[self URLRequestWithPath:@"/items?latency=3000"] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+        [expectation fulfill];
+    }] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+    [requestQueue addRequest:request resume:YES];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(requestQueue.running);
+}
+
+- (void)testParsingSkippedAfterCancellation
+{
+    // A single parsing slot, kept busy so that the response of the cancelled request waits to be processed
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:1];
+    
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking request finished"];
+    [[[SRGRequest objectRequestWithURLRequest:[self URLRequestWithPath:@"/blocking"] session:NSURLSession.sharedSession parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        [NSThread sleepForTimeInterval:1.];
+        return data;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [blockingExpectation fulfill];
+    }] requestWithParsingExecutor:parsingExecutor] resume];
+    
+    atomic_store(&s_parsed, false);
+    SRGRequest *request = [[SRGRequest objectRequestWithURLRequest:[self URLRequestWithPath:@"/items"] session:NSURLSession.sharedSession parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        atomic_store(&s_parsed, true);
+        return data;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called");
+    }] requestWithParsingExecutor:parsingExecutor];
+    [request resume];
+    
+    // Wait until the response has been received and is waiting for the parsing slot
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [request cancel];
+    });
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(atomic_load(&s_parsed));
+}
+
+- (void)testCooperativeParserCancellation
+{
+    XCTestExpectation *parserExpectation = [self expectationWithDescription:@"Parser stopped"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [[SRGRequest objectRequestWithURLRequest:[self URLRequestWithPath:@"/items"] session:NSURLSession.sharedSession parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        SRGCancellationToken *cancellationToken = SRGCancellationToken.currentToken;
+        XCTAssertNotNil(cancellationToken);
+        
+        // Simulate a long parse, stopping as soon as possible
+        NSDate *startDate = NSDate.date;
+        while (! cancellationToken.cancelled && [NSDate.date timeIntervalSinceDate:startDate] < 10.) {
+            [NSThread sleepForTimeInterval:0.01];
+        }
+        XCTAssertTrue(cancellationToken.cancelled);
+        [parserExpectation fulfill];
+        
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+        }
+        return nil;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(object);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled];
+    [request resume];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [request cancel];
+    });
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertNil(SRGCancellationToken.currentToken);
+}
+
+- (void)testDeadlineDuringParsing
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSDate *startDate = NSDate.date;
+    [[[SRGRequest objectRequestWithURLRequest:[self URLRequestWithPath:@"/items"] session:NSURLSession.sharedSession parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        SRGCancellationToken *cancellationToken = SRGCancellationToken.currentToken;
+        while (! cancellationToken.cancelled) {
+            [NSThread sleepForTimeInterval:0.01];
+        }
+        return nil;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorDeadlineExceeded);
+        [expectation fulfill];
+    }] requestWithDeadline:[NSDate dateWithTimeIntervalSinceNow:0.5]] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertLessThan([NSDate.date timeIntervalSinceDate:startDate], 2.);
+}
+
+- (void)testDecodingParserCancellation
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Parser finished"];
+    
+    SRGJSONSchema *itemSchema = [SRGJSONSchema schemaWithModelClass:NSObject.class fields:@[]];
+    
+    __block NSError *parsingError = nil;
+    __block id parsedObject = nil;
+    SRGRequest *request = [SRGRequest objectRequestWithURLRequest:[self URLRequestWithPath:@"/items?items=5000"] session:NSURLSession.sharedSession parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        // Wait for the request to be cancelled, so that decoding starts with a cancelled token
+        SRGCancellationToken *cancellationToken = SRGCancellationToken.currentToken;
+        NSDate *startDate = NSDate.date;
+        while (! cancellationToken.cancelled && [NSDate.date timeIntervalSinceDate:startDate] < 10.) {
+            [NSThread sleepForTimeInterval:0.01];
+        }
+        
+        NSError *error = nil;
+        parsedObject = SRGNetworkJSONDecodingParserAtKeyPath(itemSchema, @"items")(data, &error);
+        parsingError = error;
+        [expectation fulfill];
+        return parsedObject;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called");
+    }];
+    [request resume];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [request cancel];
+    });
+    
+    [self waitForExpectationsWithTimeout:15. handler:nil];
+    
+    XCTAssertNil(parsedObject);
+    XCTAssertEqualObjects(parsingError.domain, NSURLErrorDomain);
+    XCTAssertEqual(parsingError.code, NSURLErrorCancelled);
+}
+
+- (void)testNoCurrentTokenOutsideParsers
+{
+    XCTAssertNil(SRGCancellationToken.currentToken);
+}
+
+@end
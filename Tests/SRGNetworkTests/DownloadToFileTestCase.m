@@ -0,0 +1,160 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+@interface DownloadToFileTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation DownloadToFileTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (NSArray<NSString *> *)temporaryFileNames
+{
+    NSArray<NSString *> *fileNames = [NSFileManager.defaultManager contentsOfDirectoryAtPath:NSFileManager.defaultManager.temporaryDirectory.path error:NULL];
+    return [fileNames filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF BEGINSWITH 'SRGNetwork-'"]];
+}
+
+#pragma mark Tests
+
+- (void)testJSONDictionary
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items?items=5000&pages=2"]];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([JSONDictionary[@"items"] count], 5000);
+        XCTAssertNotNil(JSONDictionary[@"next"]);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self temporaryFileNames].count, 0);
+}
+
+- (void)testMappedData
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items?items=5000"]];
+    NSData *expectedData = LoopbackServer.configurableHandler(URLRequest).body;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    __block NSData *downloadedData = nil;
+    [[[SRGRequest dataRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        downloadedData = data;
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // The data stays valid after the file has been removed
+    XCTAssertEqual([self temporaryFileNames].count, 0);
+    XCTAssertEqualObjects(downloadedData, expectedData);
+}
+
+- (void)testLazyView
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items?items=5000"]];
+    [[[SRGRequest objectRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        return SRGNetworkJSONDictionaryViewParser(data, pError);
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(object[@"items"][4999][@"identifier"], @"0-4999");
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testHTTPError
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items?status=404"]];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(JSONDictionary);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @404);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testInvalidData
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items"]];
+    [[[SRGRequest JSONArrayRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSArray * _Nullable JSONArray, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(JSONArray);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testCancellation
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items?latency=1000"]];
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled | SRGRequestOptionCancellationErrorsEnabled];
+    [request resume];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.2 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [request cancel];
+    });
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    XCTAssertFalse(request.running);
+}
+
+- (void)testCancellationWithoutErrors
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/items?latency=1000"]];
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called for cancelled requests");
+    }] requestWithOptions:SRGRequestOptionDownloadToFileEnabled];
+    [request resume];
+    [request cancel];
+    
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+@end
@@ -0,0 +1,213 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+@interface HedgedRequestTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation HedgedRequestTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    // Paths have the form /slow/<delay>/<identifier> (the first request for the path is answered after the specified
+    // delay, subsequent ones immediately) or /fast/<identifier>. The response contains the request number for the path.
+    // Paths of the form /latency/<index> are answered after 20 ms.
+    __weak __typeof(self) weakSelf = self;
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSArray<NSString *> *components = [request.URL.path componentsSeparatedByString:@"/"];
+        NSUInteger number = [weakSelf.server numberOfRequestsForPath:request.URL.path];
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"number" : @(number) }];
+        if ([components[1] isEqualToString:@"slow"] && number == 1) {
+            response.delay = components[2].doubleValue;
+        }
+        else if ([components[1] isEqualToString:@"latency"]) {
+            response.delay = 0.02;
+        }
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequest *)requestForPath:(NSString *)path session:(NSURLSession *)session completionBlock:(SRGJSONDictionaryCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:session completionBlock:completionBlock];
+}
+
+// Resume requests for the specified paths in parallel, waiting until all of them have finished
+- (void)resumeRequestsForPaths:(NSArray<NSString *> *)paths session:(NSURLSession *)session hedgingPolicy:(SRGHedgingPolicy *)hedgingPolicy
+{
+    for (NSString *path in paths) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", path]];
+        
+        SRGRequest *request = [[self requestForPath:path session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }] requestWithHedgingPolicy:hedgingPolicy];
+        [request resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+#pragma mark Tests
+
+- (void)testHedgingPolicySettings
+{
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithDelay:0.2];
+    XCTAssertEqual(hedgingPolicy.delay, 0.2);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesFired, 0);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesWon, 0);
+    
+    SRGRequest *request = [self requestForPath:@"/fast/1" session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    XCTAssertNil(request.hedgingPolicy);
+    XCTAssertEqual([request requestWithHedgingPolicy:hedgingPolicy].hedgingPolicy, hedgingPolicy);
+    XCTAssertEqual([[[request requestWithHedgingPolicy:hedgingPolicy] requestWithPriority:SRGRequestPriorityHigh] hedgingPolicy], hedgingPolicy);
+    XCTAssertNil([[request requestWithHedgingPolicy:hedgingPolicy] requestWithHedgingPolicy:nil].hedgingPolicy);
+}
+
+- (void)testHedgeWinning
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithDelay:0.2];
+    
+    __block NSUInteger numberOfCompletions = 0;
+    NSDate *startDate = NSDate.date;
+    SRGRequest *request = [[self requestForPath:@"/slow/5/1" session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(JSONDictionary[@"number"], @2);
+        numberOfCompletions++;
+        [expectation fulfill];
+    }] requestWithHedgingPolicy:hedgingPolicy];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertLessThan([NSDate.date timeIntervalSinceDate:startDate], 5.);
+    XCTAssertEqual(numberOfCompletions, 1);
+    XCTAssertEqual(request.numberOfAttempts, 1);
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/slow/5/1"], 2);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesFired, 1);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesWon, 1);
+}
+
+- (void)testFastResponse
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithDelay:2.];
+    SRGRequest *request = [[self requestForPath:@"/fast/1" session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(JSONDictionary[@"number"], @1);
+        [expectation fulfill];
+    }] requestWithHedgingPolicy:hedgingPolicy];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Wait past the hedging delay to ensure no duplicate task is started
+    [self expectationForElapsedTimeInterval:3. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/fast/1"], 1);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesFired, 0);
+}
+
+- (void)testNonIdempotentRequest
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithDelay:0.2];
+    
+    NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:[self.server URLForPath:@"/slow/1/1"]];
+    URLRequest.HTTPMethod = @"POST";
+    SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(JSONDictionary[@"number"], @1);
+        [expectation fulfill];
+    }] requestWithHedgingPolicy:hedgingPolicy];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/slow/1/1"], 1);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesFired, 0);
+}
+
+- (void)testCancellation
+{
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithDelay:0.2];
+    SRGRequest *request = [[[self requestForPath:@"/slow/5/1" session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called when cancellation errors are disabled");
+    }] requestWithHedgingPolicy:hedgingPolicy] requestWithOptions:0];
+    [request resume];
+    
+    // Cancel after the duplicate task has been started
+    [self expectationForElapsedTimeInterval:0.5 withHandler:^{
+        [request cancel];
+        XCTAssertFalse(request.running);
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Ensure the completion block is not called afterwards
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(request.running);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesFired, 1);
+    XCTAssertEqual(hedgingPolicy.numberOfHedgesWon, 0);
+}
+
+- (void)testCancellationError
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithDelay:0.2];
+    SRGRequest *request = [[[self requestForPath:@"/slow/5/1" session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }] requestWithHedgingPolicy:hedgingPolicy] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled];
+    [request resume];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [request cancel];
+    });
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testAdaptiveDelay
+{
+    SRGHedgingPolicy *hedgingPolicy = [[SRGHedgingPolicy alloc] initWithLatencyPercentile:0.95 minimumDelay:0.01];
+    XCTAssertEqual(hedgingPolicy.delay, 0.01);
+    
+    NSMutableArray<NSString *> *paths = [NSMutableArray array];
+    for (NSUInteger i = 1; i <= 40; i++) {
+        [paths addObject:[NSString stringWithFormat:@"/latency/%@", @(i)]];
+    }
+    [self resumeRequestsForPaths:paths.copy session:NSURLSession.sharedSession hedgingPolicy:hedgingPolicy];
+    
+    // Observed latencies are around 20 ms
+    XCTAssertGreaterThan(hedgingPolicy.delay, 0.01);
+    XCTAssertLessThan(hedgingPolicy.delay, 0.5);
+}
+
+@end
@@ -0,0 +1,182 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+#import "NetworkBaseTestCase.h"
+
+@interface InProcessTransportTestCase : NetworkBaseTestCase
+
+@property (nonatomic) FixtureStore *fixtureStore;
+
+@end
+
+@implementation InProcessTransportTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.fixtureStore = [[FixtureStore alloc] initWithHandler:LoopbackServer.configurableHandler];
+}
+
+- (void)tearDown
+{
+    self.fixtureStore = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequest *)requestForPath:(NSString *)path completionBlock:(SRGJSONDictionaryCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.fixtureStore URLForPath:path]];
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:self.fixtureStore.session completionBlock:completionBlock];
+}
+
+#pragma mark Tests
+
+- (void)testRegisteredResponse
+{
+    [self.fixtureStore setResponse:[LoopbackServerResponse JSONResponseWithObject:@{ @"name" : @"fixture" }] forPath:@"/shows/1"];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    [[self requestForPath:@"/shows/1?vector=appplay" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(JSONDictionary, @{ @"name" : @"fixture" });
+        XCTAssertEqual([(NSHTTPURLResponse *)response statusCode], 200);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertEqual(self.fixtureStore.numberOfRequests, 1);
+}
+
+- (void)testGeneratedResponse
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    [[self requestForPath:@"/benchmark?items=25" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([JSONDictionary[@"items"] count], 25);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testMissingResponse
+{
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:nil];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/missing"]];
+    [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:fixtureStore.session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(JSONDictionary);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @404);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testChunkedResponse
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    [[self requestForPath:@"/benchmark?items=500&chunk=1024" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([JSONDictionary[@"items"] count], 500);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testDelayedResponse
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSDate *startDate = NSDate.date;
+    [[self requestForPath:@"/benchmark?latency=300" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertGreaterThanOrEqual([NSDate.date timeIntervalSinceDate:startDate], 0.3);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testCancellation
+{
+    SRGRequest *request = [self requestForPath:@"/benchmark?latency=500" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called for cancelled requests");
+    }];
+    [request resume];
+    [request cancel];
+    
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testRequestQueue
+{
+    static const NSUInteger kNumberOfRequests = 1000;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }
+    }];
+    
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        NSString *path = [NSString stringWithFormat:@"/benchmark?index=%@", @(i)];
+        SRGRequest *request = [self requestForPath:path completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [requestQueue reportError:error];
+        }];
+        [requestQueue addRequest:request resume:YES];
+    }
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertEqual(self.fixtureStore.numberOfRequests, kNumberOfRequests);
+}
+
+- (void)testResponsesFromDirectory
+{
+    NSURL *directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString] isDirectory:YES];
+    NSURL *showsDirectoryURL = [directoryURL URLByAppendingPathComponent:@"shows" isDirectory:YES];
+    XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtURL:showsDirectoryURL withIntermediateDirectories:YES attributes:nil error:NULL]);
+    
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@{ @"title" : @"recorded" } options:0 error:NULL];
+    XCTAssertTrue([data writeToURL:[showsDirectoryURL URLByAppendingPathComponent:@"list.json"] atomically:YES]);
+    
+    XCTAssertTrue([self.fixtureStore addResponsesFromDirectoryAtURL:directoryURL]);
+    XCTAssertFalse([self.fixtureStore addResponsesFromDirectoryAtURL:[directoryURL URLByAppendingPathComponent:@"missing"]]);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    [[self requestForPath:@"/shows/list.json" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(JSONDictionary, @{ @"title" : @"recorded" });
+        XCTAssertEqualObjects([(NSHTTPURLResponse *)response allHeaderFields][@"Content-Type"], @"application/json");
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    [NSFileManager.defaultManager removeItemAtURL:directoryURL error:NULL];
+}
+
+@end
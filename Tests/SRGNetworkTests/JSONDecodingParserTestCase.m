@@ -0,0 +1,215 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+#import "NetworkBaseTestCase.h"
+
+@interface DecodedShow : NSObject
+
+@property (nonatomic, copy) NSString *uid;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic) NSURL *imageURL;
+
+@end
+
+@interface DecodedMedia : NSObject
+
+@property (nonatomic, copy) NSString *uid;
+@property (nonatomic) NSInteger duration;
+@property (nonatomic) double aspectRatio;
+@property (nonatomic, getter=isAvailable) BOOL available;
+@property (nonatomic) NSNumber *views;
+@property (nonatomic) DecodedShow *show;
+@property (nonatomic) NSArray<DecodedShow *> *relatedShows;
+@property (nonatomic) id metadata;
+
+@end
+
+@interface DecodedItem : NSObject
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic) NSInteger duration;
+@property (nonatomic, getter=isAvailable) BOOL available;
+
+@end
+
+@interface JSONDecodingParserTestCase : NetworkBaseTestCase
+
+@property (nonatomic) SRGJSONSchema *mediaSchema;
+
+@end
+
+@implementation JSONDecodingParserTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    SRGJSONSchema *showSchema = [SRGJSONSchema schemaWithModelClass:DecodedShow.class fields:@[
+        [SRGJSONField fieldWithKeyPath:@"id" property:@"uid" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"title" property:@"title" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"image.url" property:@"imageURL" type:SRGJSONFieldTypeURL]
+    ]];
+    self.mediaSchema = [SRGJSONSchema schemaWithModelClass:DecodedMedia.class fields:@[
+        [SRGJSONField fieldWithKeyPath:@"id" property:@"uid" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"duration" property:@"duration" type:SRGJSONFieldTypeNumber],
+        [SRGJSONField fieldWithKeyPath:@"format.aspectRatio" property:@"aspectRatio" type:SRGJSONFieldTypeNumber],
+        [SRGJSONField fieldWithKeyPath:@"available" property:@"available" type:SRGJSONFieldTypeBoolean],
+        [SRGJSONField fieldWithKeyPath:@"statistics.views" property:@"views" type:SRGJSONFieldTypeNumber],
+        [SRGJSONField fieldWithKeyPath:@"show" property:@"show" schema:showSchema],
+        [SRGJSONField fieldWithKeyPath:@"relatedShows" property:@"relatedShows" schema:showSchema],
+        [SRGJSONField fieldWithKeyPath:@"metadata" property:@"metadata" type:SRGJSONFieldTypeJSON]
+    ]];
+}
+
+- (void)tearDown
+{
+    self.mediaSchema = nil;
+}
+
+#pragma mark Helpers
+
+- (id)decodeJSONString:(NSString *)JSONString withParser:(SRGResponseParser)parser error:(NSError * __autoreleasing *)pError
+{
+    return parser([JSONString dataUsingEncoding:NSUTF8StringEncoding], pError);
+}
+
+#pragma mark Tests
+
+- (void)testObjectDecoding
+{
+    NSString *JSONString = @"{ \"id\": \"m1\", \"unknown\": { \"nested\": [1, 2, { \"a\": \"b\" }] }, \"duration\": 3600, "
+        "\"format\": { \"aspectRatio\": 1.78, \"codec\": \"h264\" }, \"available\": true, \"statistics\": { \"views\": 123456789012 }, "
+        "\"show\": { \"id\": \"s1\", \"title\": \"Caf\\u00e9 \\\"show\\\"\", \"image\": { \"url\": \"https://www.rts.ch/image.jpg\" } }, "
+        "\"relatedShows\": [ { \"id\": \"s2\" }, null, { \"id\": \"s3\" } ], \"metadata\": { \"tags\": [\"a\", \"b\"] } }";
+    
+    NSError *error = nil;
+    DecodedMedia *media = [self decodeJSONString:JSONString withParser:SRGNetworkJSONDecodingParser(self.mediaSchema) error:&error];
+    XCTAssertNil(error);
+    XCTAssertTrue([media isKindOfClass:DecodedMedia.class]);
+    XCTAssertEqualObjects(media.uid, @"m1");
+    XCTAssertEqual(media.duration, 3600);
+    XCTAssertEqualWithAccuracy(media.aspectRatio, 1.78, 0.0001);
+    XCTAssertTrue(media.available);
+    XCTAssertEqualObjects(media.views, @123456789012);
+    XCTAssertEqualObjects(media.show.uid, @"s1");
+    XCTAssertEqualObjects(media.show.title, @"Café \"show\"");
+    XCTAssertEqualObjects(media.show.imageURL, [NSURL URLWithString:@"https://www.rts.ch/image.jpg"]);
+    XCTAssertEqualObjects([media.relatedShows valueForKey:@"uid"], (@[ @"s2", @"s3" ]));
+    XCTAssertEqualObjects(media.metadata, @{ @"tags" : @[ @"a", @"b" ] });
+}
+
+- (void)testArrayDecoding
+{
+    NSError *error = nil;
+    NSArray<DecodedMedia *> *medias = [self decodeJSONString:@"[ { \"id\": \"m1\" }, { \"id\": \"m2\", \"duration\": null } ]" withParser:SRGNetworkJSONDecodingParser(self.mediaSchema) error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([medias valueForKey:@"uid"], (@[ @"m1", @"m2" ]));
+    XCTAssertEqual(medias.lastObject.duration, 0);
+}
+
+- (void)testKeyPathDecoding
+{
+    NSError *error = nil;
+    NSArray<DecodedMedia *> *medias = [self decodeJSONString:@"{ \"next\": \"abc\", \"result\": { \"mediaList\": [ { \"id\": \"m1\" } ] }, \"total\": 1 }" withParser:SRGNetworkJSONDecodingParserAtKeyPath(self.mediaSchema, @"result.mediaList") error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([medias valueForKey:@"uid"], @[ @"m1" ]);
+    
+    NSError *missingError = nil;
+    XCTAssertNil([self decodeJSONString:@"{ \"result\": {} }" withParser:SRGNetworkJSONDecodingParserAtKeyPath(self.mediaSchema, @"result.mediaList") error:&missingError]);
+    XCTAssertEqualObjects(missingError.domain, SRGNetworkErrorDomain);
+    XCTAssertEqual(missingError.code, SRGNetworkErrorInvalidData);
+}
+
+- (void)testParserIdentity
+{
+    // Parsers in use are reused, so that objects they parsed can be found in response caches
+    SRGResponseParser parser = SRGNetworkJSONDecodingParser(self.mediaSchema);
+    XCTAssertEqual(SRGNetworkJSONDecodingParser(self.mediaSchema), parser);
+    
+    SRGResponseParser keyPathParser = SRGNetworkJSONDecodingParserAtKeyPath(self.mediaSchema, @"mediaList");
+    XCTAssertEqual(SRGNetworkJSONDecodingParserAtKeyPath(self.mediaSchema, @"mediaList"), keyPathParser);
+    XCTAssertNotEqual(keyPathParser, parser);
+    XCTAssertNotEqual(SRGNetworkJSONDecodingParserAtKeyPath(self.mediaSchema, @"result.mediaList"), keyPathParser);
+}
+
+- (void)testTypeMismatch
+{
+    NSError *error = nil;
+    XCTAssertNil([self decodeJSONString:@"{ \"id\": 12 }" withParser:SRGNetworkJSONDecodingParser(self.mediaSchema) error:&error]);
+    XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+    XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+}
+
+- (void)testInvalidData
+{
+    NSArray<NSString *> *JSONStrings = @[ @"", @"{", @"{ \"id\": \"m1\" ", @"{ \"unknown\": [1, 2 }", @"{ \"id\": \"m1\" } trailing", @"{ \"unknown\": tru }", @"\"string\"",
+                                          @"{ \"duration\": 01 }", @"{ \"duration\": 1. }", @"{ \"duration\": -1e }", @"{ \"unknown\": +1 }", @"{ \"unknown\": [1.] }",
+                                          @"{ \"id\": \"m\t1\" }" ];
+    for (NSString *JSONString in JSONStrings) {
+        NSError *error = nil;
+        XCTAssertNil([self decodeJSONString:JSONString withParser:SRGNetworkJSONDecodingParser(self.mediaSchema) error:&error], @"%@", JSONString);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain, @"%@", JSONString);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData, @"%@", JSONString);
+    }
+}
+
+- (void)testConsistencyWithFoundation
+{
+    NSData *data = [LoopbackServer.configurableHandler([NSURLRequest requestWithURL:[NSURL URLWithString:@"http://localhost/items?items=100"]]) body];
+    
+    SRGJSONSchema *itemSchema = [SRGJSONSchema schemaWithModelClass:DecodedItem.class fields:@[
+        [SRGJSONField fieldWithKeyPath:@"identifier" property:@"identifier" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"title" property:@"title" type:SRGJSONFieldTypeString],
+        [SRGJSONField fieldWithKeyPath:@"duration" property:@"duration" type:SRGJSONFieldTypeNumber],
+        [SRGJSONField fieldWithKeyPath:@"available" property:@"available" type:SRGJSONFieldTypeBoolean]
+    ]];
+    
+    NSError *error = nil;
+    NSArray<DecodedItem *> *items = SRGNetworkJSONDecodingParserAtKeyPath(itemSchema, @"items")(data, &error);
+    XCTAssertNil(error);
+    
+    NSArray<NSDictionary *> *JSONItems = SRGNetworkJSONDictionaryParser(data, NULL)[@"items"];
+    XCTAssertEqual(items.count, JSONItems.count);
+    [items enumerateObjectsUsingBlock:^(DecodedItem * _Nonnull item, NSUInteger idx, BOOL * _Nonnull stop) {
+        XCTAssertEqualObjects([item dictionaryWithValuesForKeys:JSONItems[idx].allKeys], JSONItems[idx]);
+    }];
+}
+
+- (void)testObjectRequest
+{
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:nil];
+    [fixtureStore setResponse:[LoopbackServerResponse JSONResponseWithObject:@{ @"mediaList" : @[ @{ @"id" : @"m1", @"duration" : @12 } ] }] forPath:@"/medias"];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/medias"]];
+    [[SRGRequest objectRequestWithURLRequest:URLRequest session:fixtureStore.session parser:SRGNetworkJSONDecodingParserAtKeyPath(self.mediaSchema, @"mediaList") completionBlock:^(id  _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        NSArray<DecodedMedia *> *medias = object;
+        XCTAssertEqual(medias.count, 1);
+        XCTAssertEqualObjects(medias.firstObject.uid, @"m1");
+        XCTAssertEqual(medias.firstObject.duration, 12);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+@end
+
+@implementation DecodedShow
+
+@end
+
+@implementation DecodedMedia
+
+@end
+
+@implementation DecodedItem
+
+@end
@@ -0,0 +1,153 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "FixtureStore.h"
+#import "NetworkBaseTestCase.h"
+
+@interface JSONViewParserTestCase : NetworkBaseTestCase
+
+@end
+
+@implementation JSONViewParserTestCase
+
+#pragma mark Helpers
+
+- (NSData *)dataForJSONString:(NSString *)JSONString
+{
+    return [JSONString dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+#pragma mark Tests
+
+- (void)testDictionaryView
+{
+    NSString *JSONString = @"{ \"string\": \"Caf\\u00e9 \\\"au lait\\\"\", \"unicode\": \"Zürich\", \"integer\": -42, \"large\": 123456789012345, "
+        "\"double\": 1.5e3, \"true\": true, \"false\": false, \"null\": null, \"esc\\u0061ped\": 1, "
+        "\"object\": { \"nested\": { \"value\": [1, [2, 3], {}] } }, \"array\": [ \"a\", { \"b\": [] }, null ] }";
+    NSData *data = [self dataForJSONString:JSONString];
+    
+    NSError *error = nil;
+    NSDictionary *JSONDictionary = SRGNetworkJSONDictionaryViewParser(data, &error);
+    XCTAssertNil(error);
+    XCTAssertNotNil(JSONDictionary);
+    
+    XCTAssertEqual(JSONDictionary.count, 11);
+    XCTAssertEqualObjects(JSONDictionary[@"string"], @"Café \"au lait\"");
+    XCTAssertEqualObjects(JSONDictionary[@"unicode"], @"Zürich");
+    XCTAssertEqualObjects(JSONDictionary[@"integer"], @(-42));
+    XCTAssertEqualObjects(JSONDictionary[@"large"], @123456789012345);
+    XCTAssertEqualObjects(JSONDictionary[@"double"], @1500.);
+    XCTAssertEqualObjects(JSONDictionary[@"true"], @YES);
+    XCTAssertEqualObjects(JSONDictionary[@"false"], @NO);
+    XCTAssertEqualObjects(JSONDictionary[@"null"], NSNull.null);
+    XCTAssertEqualObjects(JSONDictionary[@"escaped"], @1);
+    XCTAssertNil(JSONDictionary[@"missing"]);
+    XCTAssertEqualObjects([JSONDictionary valueForKeyPath:@"object.nested.value"], (@[ @1, @[ @2, @3 ], @{} ]));
+    
+    NSArray *array = JSONDictionary[@"array"];
+    XCTAssertTrue([array isKindOfClass:NSArray.class]);
+    XCTAssertEqual(array.count, 3);
+    XCTAssertEqualObjects(array[0], @"a");
+    XCTAssertEqualObjects(array[1], @{ @"b" : @[] });
+    XCTAssertEqualObjects(array.lastObject, NSNull.null);
+    XCTAssertThrows(array[3]);
+    
+    // Views must be equal to objects parsed by Foundation
+    XCTAssertEqualObjects(JSONDictionary, SRGNetworkJSONDictionaryParser(data, NULL));
+    XCTAssertEqualObjects([NSSet setWithArray:JSONDictionary.allKeys], [NSSet setWithArray:SRGNetworkJSONDictionaryParser(data, NULL).allKeys]);
+}
+
+- (void)testArrayView
+{
+    NSData *data = [self dataForJSONString:@"[ 1, \"two\", [ 3 ], { \"four\": 4 } ]"];
+    
+    NSError *error = nil;
+    NSArray *JSONArray = SRGNetworkJSONArrayViewParser(data, &error);
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(JSONArray, SRGNetworkJSONArrayParser(data, NULL));
+    
+    NSMutableArray *elements = [NSMutableArray array];
+    for (id element in JSONArray) {
+        [elements addObject:element];
+    }
+    XCTAssertEqualObjects(elements, JSONArray);
+}
+
+- (void)testLargeResponse
+{
+    NSData *data = LoopbackServer.configurableHandler([NSURLRequest requestWithURL:[NSURL URLWithString:@"http://localhost/items?items=2000&page=0&pages=2"]]).body;
+    
+    NSDictionary *JSONDictionary = SRGNetworkJSONDictionaryViewParser(data, NULL);
+    XCTAssertEqualObjects(JSONDictionary, SRGNetworkJSONDictionaryParser(data, NULL));
+    XCTAssertNotNil(JSONDictionary[@"next"]);
+    XCTAssertEqualObjects(JSONDictionary[@"items"][1999][@"identifier"], @"0-1999");
+}
+
+- (void)testIncorrectType
+{
+    NSError *error = nil;
+    XCTAssertNil(SRGNetworkJSONDictionaryViewParser([self dataForJSONString:@"[]"], &error));
+    XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+    XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+    
+    XCTAssertNil(SRGNetworkJSONArrayViewParser([self dataForJSONString:@"{}"], NULL));
+}
+
+- (void)testInvalidData
+{
+    NSArray<NSString *> *JSONStrings = @[ @"", @"{", @"{ \"a\" }", @"{ \"a\": 1, }", @"[1 2]", @"[01]", @"[1.]", @"[-]", @"[tru]",
+                                          @"[nul]", @"{ 1: 2 }", @"{} {}", @"[\"unterminated]", @"\"a\" :", @"]", @"[+1]", @"[1e]", @"[\"a\tb\"]" ];
+    for (NSString *JSONString in JSONStrings) {
+        NSData *data = [self dataForJSONString:JSONString];
+        
+        NSError *error = nil;
+        XCTAssertNil(SRGNetworkJSONDictionaryViewParser(data, &error), @"%@", JSONString);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain, @"%@", JSONString);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData, @"%@", JSONString);
+    }
+}
+
+- (void)testCopy
+{
+    NSDictionary *JSONDictionary = SRGNetworkJSONDictionaryViewParser([self dataForJSONString:@"{ \"a\": [ 1 ] }"], NULL);
+    XCTAssertEqualObjects(JSONDictionary.copy, JSONDictionary);
+    
+    NSMutableDictionary *mutableJSONDictionary = JSONDictionary.mutableCopy;
+    mutableJSONDictionary[@"b"] = @2;
+    XCTAssertEqualObjects(mutableJSONDictionary, (@{ @"a" : @[ @1 ], @"b" : @2 }));
+    
+    NSData *archivedData = [NSKeyedArchiver archivedDataWithRootObject:JSONDictionary requiringSecureCoding:YES error:NULL];
+    NSSet<Class> *classes = [NSSet setWithObjects:NSDictionary.class, NSArray.class, NSNumber.class, NSString.class, nil];
+    XCTAssertEqualObjects([NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:archivedData error:NULL], JSONDictionary);
+}
+
+- (void)testFirstPageRequest
+{
+    FixtureStore *fixtureStore = [[FixtureStore alloc] initWithHandler:LoopbackServer.configurableHandler];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[fixtureStore URLForPath:@"/items?items=20&pages=2"]];
+    [[SRGFirstPageRequest objectRequestWithURLRequest:URLRequest session:fixtureStore.session parser:^id _Nullable(NSData * _Nonnull data, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        return SRGNetworkJSONDictionaryViewParser(data, pError);
+    } sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        return URLRequest;
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        NSString *nextURLString = JSONDictionary[@"next"];
+        NSURL *nextURL = nextURLString ? [NSURL URLWithString:nextURLString] : nil;
+        return nextURL ? [NSURLRequest requestWithURL:nextURL] : nil;
+    } completionBlock:^(id _Nullable object, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([object[@"items"] count], 20);
+        XCTAssertEqualObjects([object valueForKeyPath:@"items.identifier"][3], @"0-3");
+        XCTAssertNotNil(nextPage);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+@end
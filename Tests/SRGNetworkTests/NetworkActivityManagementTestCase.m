@@ -4,6 +4,7 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "LoopbackServer.h"
 #import "NetworkBaseTestCase.h"
 
 // For tests, you can use:
@@ -31,6 +32,14 @@ static BOOL NetworkActivtiyStatesAreConsistent(NSArray<NSNumber *> *states1, NSA
 
 @implementation NetworkActivityManagementTestCase
 
+#pragma mark Setup and teardown
+
+- (void)tearDown
+{
+    [SRGNetworkActivityManagement disable];
+    SRGNetworkActivityManagement.debounceInterval = 0.;
+}
+
 #pragma mark Tests
 
 - (void)testNormalNetworkActivity
@@ -159,4 +168,128 @@ static BOOL NetworkActivtiyStatesAreConsistent(NSArray<NSNumber *> *states1, NSA
     XCTAssertTrue(NetworkActivtiyStatesAreConsistent(states, expectedStates));
 }
 
+- (void)testDebouncedNetworkActivity
+{
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([server start]);
+    
+    SRGNetworkActivityManagement.debounceInterval = 0.5;
+    
+    NSMutableArray<NSNumber *> *states = [NSMutableArray array];
+    [SRGNetworkActivityManagement enableWithHandler:^(BOOL active) {
+        XCTAssertTrue(NSThread.isMainThread);
+        [states addObject:@(active)];
+    }];
+    [states removeAllObjects];
+    
+    // Requests following each other closely, each shorter than the debounce interval
+    XCTestExpectation *shortExpectation = [self expectationWithDescription:@"Short requests finished"];
+    __block void (^performRequest)(NSUInteger) = nil;
+    __block __weak void (^weakPerformRequest)(NSUInteger) = nil;
+    weakPerformRequest = performRequest = ^(NSUInteger remaining) {
+        if (remaining == 0) {
+            [shortExpectation fulfill];
+            return;
+        }
+        
+        NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[server URLForPath:@"/items?latency=50"]];
+        [[SRGRequest dataRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            weakPerformRequest(remaining - 1);
+        }] resume];
+    };
+    performRequest(20);
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Each request lasts less than the debounce interval, but activity persisted long enough overall (at least one
+    // second), with no idle state reported in between
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<NSNumber *> *expectedStates = @[@YES, @NO];
+    XCTAssertEqualObjects(states, expectedStates);
+    
+    [server stop];
+}
+
+- (void)testShortNetworkActivityIsNotReported
+{
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([server start]);
+    
+    SRGNetworkActivityManagement.debounceInterval = 1.;
+    
+    NSMutableArray<NSNumber *> *states = [NSMutableArray array];
+    [SRGNetworkActivityManagement enableWithHandler:^(BOOL active) {
+        [states addObject:@(active)];
+    }];
+    [states removeAllObjects];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[server URLForPath:@"/items"]];
+    [[SRGRequest dataRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(states.count, 0);
+    
+    [server stop];
+}
+
+- (void)testNumberOfRunningRequestsForHost
+{
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([server start]);
+    
+    NSString *host = server.baseURL.host;
+    XCTAssertEqual([SRGNetworkActivityManagement numberOfRunningRequestsForHost:host], 0);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+    expectation.expectedFulfillmentCount = 3;
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 3; i++) {
+        NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[server URLForPath:@"/items?latency=500"]];
+        SRGRequest *request = [SRGRequest dataRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [expectation fulfill];
+        }];
+        [request resume];
+        [requests addObject:request];
+    }
+    
+    // Counts are updated synchronously, without any main queue hop
+    XCTAssertEqual([SRGNetworkActivityManagement numberOfRunningRequestsForHost:host], 3);
+    XCTAssertEqual([SRGNetworkActivityManagement numberOfRunningRequestsForHost:host.uppercaseString], 3);
+    XCTAssertEqual([SRGNetworkActivityManagement numberOfRunningRequestsForHost:@"unknown.host"], 0);
+    XCTAssertGreaterThanOrEqual(SRGNetworkActivityManagement.numberOfRunningRequests, 3);
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // The running state is updated after the completion block has been called
+    [self expectationForElapsedTimeInterval:0.1 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([SRGNetworkActivityManagement numberOfRunningRequestsForHost:host], 0);
+    
+    [server stop];
+}
+
+- (void)testConcurrentUpdates
+{
+    NSUInteger numberOfRunningRequests = SRGNetworkActivityManagement.numberOfRunningRequests;
+    
+    dispatch_apply(10000, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        [SRGNetworkActivityManagement increaseNumberOfRunningRequests];
+        [SRGNetworkActivityManagement decreaseNumberOfRunningRequests];
+    });
+    
+    XCTAssertEqual(SRGNetworkActivityManagement.numberOfRunningRequests, numberOfRunningRequests);
+}
+
 @end
@@ -9,6 +9,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class LoopbackServer;
+
 @interface NetworkBaseTestCase : XCTestCase
 
 /**
@@ -17,6 +19,18 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (XCTestExpectation *)expectationForElapsedTimeInterval:(NSTimeInterval)timeInterval withHandler:(nullable void (^)(void))handler;
 
+/**
+ *  Request for the list of pages starting at the specified URL, served by `LoopbackServer.configurableHandler` (with
+ *  the number of pages set with the `pages` query parameter). Following pages are retrieved from `next` entries, and
+ *  the page size sets the number of `items` per page.
+ */
+- (SRGFirstPageRequest *)pagesRequestWithURL:(NSURL *)URL completionBlock:(SRGJSONDictionaryPageCompletionBlock)completionBlock;
+
+/**
+ *  Wait until the server has received at least the specified number of requests.
+ */
+- (void)waitForNumberOfRequests:(NSUInteger)numberOfRequests receivedByServer:(LoopbackServer *)server;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -6,6 +6,8 @@
 
 #import "NetworkBaseTestCase.h"
 
+#import "LoopbackServer.h"
+
 @implementation NetworkBaseTestCase
 
 #pragma mark Helpers
@@ -20,4 +22,31 @@
     return expectation;
 }
 
+- (SRGFirstPageRequest *)pagesRequestWithURL:(NSURL *)URL completionBlock:(SRGJSONDictionaryPageCompletionBlock)completionBlock
+{
+    return [SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URLRequest.URL resolvingAgainstBaseURL:NO];
+        NSMutableArray<NSURLQueryItem *> *queryItems = [NSMutableArray array];
+        for (NSURLQueryItem *queryItem in URLComponents.queryItems) {
+            if (! [queryItem.name isEqualToString:@"items"]) {
+                [queryItems addObject:queryItem];
+            }
+        }
+        [queryItems addObject:[NSURLQueryItem queryItemWithName:@"items" value:@(size).stringValue]];
+        URLComponents.queryItems = queryItems.copy;
+        return [NSURLRequest requestWithURL:URLComponents.URL];
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        NSString *nextURLString = JSONDictionary[@"next"];
+        return nextURLString ? [NSURLRequest requestWithURL:[NSURL URLWithString:nextURLString]] : nil;
+    } completionBlock:completionBlock];
+}
+
+- (void)waitForNumberOfRequests:(NSUInteger)numberOfRequests receivedByServer:(LoopbackServer *)server
+{
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(LoopbackServer * _Nullable evaluatedServer, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return evaluatedServer.numberOfRequests >= numberOfRequests;
+    }] evaluatedWithObject:server handler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
 @end
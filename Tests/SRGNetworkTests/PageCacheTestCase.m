@@ -0,0 +1,323 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSInteger kNumberOfPages = 4;
+
+@interface PageCacheTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation PageCacheTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGFirstPageRequest *)pagesRequestWithPath:(NSString *)path completionBlock:(SRGJSONDictionaryPageCompletionBlock)completionBlock
+{
+    NSString *pagesPath = [NSString stringWithFormat:@"%@?pages=%@", path, @(kNumberOfPages)];
+    return [self pagesRequestWithURL:[self.server URLForPath:pagesPath] completionBlock:completionBlock];
+}
+
+- (void)resumeRequest:(SRGPageRequest *)request expectation:(XCTestExpectation *)expectation
+{
+    [request resume];
+    [self waitForExpectations:@[ expectation ] timeout:10.];
+}
+
+#pragma mark Tests
+
+- (void)testPageCacheDisabledByDefault
+{
+    SRGFirstPageRequest *request = [self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    XCTAssertNil(request.pageCache);
+}
+
+- (void)testPageCachePreservedByDerivedRequests
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    SRGFirstPageRequest *request = [[self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}] requestWithPageCache:pageCache];
+    XCTAssertEqual(request.pageCache, pageCache);
+    XCTAssertEqual([request requestWithOptions:SRGRequestOptionCancellationErrorsEnabled].pageCache, pageCache);
+    XCTAssertEqual([request requestWithPageSize:10].pageCache, pageCache);
+    XCTAssertEqual([request requestWithPage:nil].pageCache, pageCache);
+    XCTAssertEqual([request requestWithPrefetchDepth:2].pageCache, pageCache);
+    XCTAssertNil([request requestWithPageCache:nil].pageCache);
+}
+
+- (void)testCachedPagesServedWithoutNetworkAccess
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    
+    __block XCTestExpectation *expectation = nil;
+    __block SRGPage *lastNextPage = nil;
+    __block NSDictionary *lastJSONDictionary = nil;
+    
+    SRGFirstPageRequest *request = [[self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertNotNil(response);
+        lastNextPage = nextPage;
+        lastJSONDictionary = JSONDictionary;
+        [expectation fulfill];
+    }] requestWithPageCache:pageCache];
+    
+    expectation = [self expectationWithDescription:@"First page finished"];
+    [self resumeRequest:request expectation:expectation];
+    
+    SRGPage *secondPage = lastNextPage;
+    XCTAssertEqual(secondPage.number, 1);
+    
+    expectation = [self expectationWithDescription:@"Second page finished"];
+    [self resumeRequest:[request requestWithPage:secondPage] expectation:expectation];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+    XCTAssertEqual(pageCache.numberOfCachedPages, 2);
+    
+    // Both pages are now served from the cache, with the same next pages
+    expectation = [self expectationWithDescription:@"First page finished again"];
+    [self resumeRequest:[request requestWithPage:nil] expectation:expectation];
+    
+    XCTAssertEqualObjects(lastJSONDictionary[@"page"], @0);
+    XCTAssertEqualObjects(lastNextPage, secondPage);
+    
+    expectation = [self expectationWithDescription:@"Second page finished again"];
+    [self resumeRequest:[request requestWithPage:secondPage] expectation:expectation];
+    
+    XCTAssertEqualObjects(lastJSONDictionary[@"page"], @1);
+    XCTAssertEqual(lastNextPage.number, 2);
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+    XCTAssertEqual(pageCache.numberOfHits, 2);
+}
+
+- (void)testCachedNextPagesUsedOnHits
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    
+    __block XCTestExpectation *expectation = nil;
+    __block SRGPage *lastNextPage = nil;
+    __block NSUInteger numberOfPaginations = 0;
+    
+    NSURL *URL = [self.server URLForPath:[NSString stringWithFormat:@"/pages?pages=%@", @(kNumberOfPages)]];
+    SRGFirstPageRequest *request = [[SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        return URLRequest;
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        @synchronized (self) {
+            numberOfPaginations++;
+        }
+        NSString *nextURLString = JSONDictionary[@"next"];
+        return nextURLString ? [NSURLRequest requestWithURL:[NSURL URLWithString:nextURLString]] : nil;
+    } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        lastNextPage = nextPage;
+        [expectation fulfill];
+    }] requestWithPageCache:pageCache];
+    
+    expectation = [self expectationWithDescription:@"First page finished"];
+    [self resumeRequest:request expectation:expectation];
+    
+    SRGPage *secondPage = lastNextPage;
+    XCTAssertEqual(numberOfPaginations, 1);
+    
+    // The next page stored with the cached page is delivered as is
+    expectation = [self expectationWithDescription:@"First page finished again"];
+    [self resumeRequest:[request requestWithPage:nil] expectation:expectation];
+    
+    XCTAssertEqual(lastNextPage, secondPage);
+    XCTAssertEqual(numberOfPaginations, 1);
+    XCTAssertEqual(pageCache.numberOfHits, 1);
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testPagesScopedByParser
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    
+    XCTestExpectation *JSONExpectation = [self expectationWithDescription:@"JSON request finished"];
+    SRGFirstPageRequest *JSONRequest = [[self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue([JSONDictionary isKindOfClass:NSDictionary.class]);
+        [JSONExpectation fulfill];
+    }] requestWithPageCache:pageCache];
+    [self resumeRequest:JSONRequest expectation:JSONExpectation];
+    
+    // A request for the same page with another parser does not receive the cached dictionary
+    XCTestExpectation *dataExpectation = [self expectationWithDescription:@"Data request finished"];
+    NSURL *URL = [self.server URLForPath:[NSString stringWithFormat:@"/pages?pages=%@", @(kNumberOfPages)]];
+    SRGFirstPageRequest *dataRequest = [[SRGFirstPageRequest dataRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        return URLRequest;
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSData * _Nullable data, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        return nil;
+    } completionBlock:^(NSData * _Nullable data, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue([data isKindOfClass:NSData.class]);
+        [dataExpectation fulfill];
+    }] requestWithPageCache:pageCache];
+    XCTAssertNil([pageCache cachedPageForRequest:dataRequest]);
+    [self resumeRequest:dataRequest expectation:dataExpectation];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+    XCTAssertEqual(pageCache.numberOfCachedPages, 2);
+    
+    // Only the pages of the same request family are removed
+    [pageCache removeCachedPagesForRequest:dataRequest];
+    XCTAssertEqual(pageCache.numberOfCachedPages, 1);
+    XCTAssertNotNil([pageCache cachedPageForRequest:JSONRequest]);
+}
+
+- (void)testSynchronousLookup
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    __block NSDictionary *receivedJSONDictionary = nil;
+    SRGFirstPageRequest *request = [[self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        receivedJSONDictionary = JSONDictionary;
+        [expectation fulfill];
+    }] requestWithPageCache:pageCache];
+    
+    XCTAssertNil([pageCache cachedPageForRequest:request]);
+    XCTAssertEqual(pageCache.numberOfMisses, 1);
+    
+    [self resumeRequest:request expectation:expectation];
+    
+    SRGCachedPage *cachedPage = [pageCache cachedPageForRequest:request];
+    XCTAssertNotNil(cachedPage);
+    XCTAssertEqualObjects(cachedPage.page, request.page);
+    XCTAssertEqualObjects(cachedPage.object, receivedJSONDictionary);
+    XCTAssertEqual(cachedPage.nextPage.number, 1);
+    XCTAssertNotEqual(cachedPage.cost, 0);
+    XCTAssertEqual(pageCache.totalCost, cachedPage.cost);
+    XCTAssertEqual(pageCache.numberOfHits, 1);
+    
+    // A page with another size is another page
+    XCTAssertNil([pageCache cachedPageForRequest:[request requestWithPageSize:10]]);
+}
+
+- (void)testEviction
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    
+    __block XCTestExpectation *expectation = nil;
+    __block SRGPage *lastNextPage = nil;
+    
+    SRGFirstPageRequest *request = [[self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        lastNextPage = nextPage;
+        [expectation fulfill];
+    }] requestWithPageCache:pageCache];
+    
+    expectation = [self expectationWithDescription:@"First page finished"];
+    [self resumeRequest:request expectation:expectation];
+    
+    // Only leave room for a single page
+    NSUInteger pageCost = pageCache.totalCost;
+    XCTAssertNotEqual(pageCost, 0);
+    pageCache.costLimit = pageCost;
+    XCTAssertEqual(pageCache.numberOfCachedPages, 1);
+    XCTAssertEqual(pageCache.numberOfEvictions, 0);
+    
+    SRGPage *secondPage = lastNextPage;
+    expectation = [self expectationWithDescription:@"Second page finished"];
+    [self resumeRequest:[request requestWithPage:secondPage] expectation:expectation];
+    
+    XCTAssertEqual(pageCache.numberOfCachedPages, 1);
+    XCTAssertEqual(pageCache.numberOfEvictions, 1);
+    XCTAssertLessThanOrEqual(pageCache.totalCost, pageCost);
+    XCTAssertNil([pageCache cachedPageForRequest:request]);
+    XCTAssertNotNil([pageCache cachedPageForRequest:[request requestWithPage:secondPage]]);
+    
+    // Pages larger than the limit are never stored
+    pageCache.costLimit = 0;
+    XCTAssertEqual(pageCache.numberOfCachedPages, 0);
+    XCTAssertEqual(pageCache.totalCost, 0);
+    
+    expectation = [self expectationWithDescription:@"First page finished again"];
+    [self resumeRequest:[request requestWithPage:nil] expectation:expectation];
+    
+    XCTAssertEqual(pageCache.numberOfCachedPages, 0);
+    XCTAssertEqual(self.server.numberOfRequests, 3);
+}
+
+- (void)testRemoveCachedPagesForRequest
+{
+    SRGPageCache *pageCache = [[SRGPageCache alloc] initWithCostLimit:1024 * 1024];
+    
+    __block XCTestExpectation *expectation = nil;
+    SRGJSONDictionaryPageCompletionBlock completionBlock = ^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    };
+    
+    SRGFirstPageRequest *request = [[self pagesRequestWithPath:@"/pages" completionBlock:completionBlock] requestWithPageCache:pageCache];
+    SRGFirstPageRequest *otherRequest = [[self pagesRequestWithPath:@"/others" completionBlock:completionBlock] requestWithPageCache:pageCache];
+    
+    // Pages of different sizes belong to the same list
+    SRGFirstPageRequest *sizedRequest = [request requestWithPageSize:10];
+    
+    expectation = [self expectationWithDescription:@"Request finished"];
+    [self resumeRequest:request expectation:expectation];
+    
+    expectation = [self expectationWithDescription:@"Sized request finished"];
+    [self resumeRequest:sizedRequest expectation:expectation];
+    
+    expectation = [self expectationWithDescription:@"Other request finished"];
+    [self resumeRequest:otherRequest expectation:expectation];
+    
+    XCTAssertEqual(pageCache.numberOfCachedPages, 3);
+    
+    [pageCache removeCachedPagesForRequest:[sizedRequest requestWithPage:nil]];
+    
+    XCTAssertEqual(pageCache.numberOfCachedPages, 1);
+    XCTAssertNil([pageCache cachedPageForRequest:request]);
+    XCTAssertNil([pageCache cachedPageForRequest:sizedRequest]);
+    XCTAssertNotNil([pageCache cachedPageForRequest:otherRequest]);
+    
+    // The list is retrieved again
+    expectation = [self expectationWithDescription:@"Request finished again"];
+    [self resumeRequest:[request requestWithPage:nil] expectation:expectation];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 4);
+    
+    [pageCache removeAllCachedPages];
+    XCTAssertEqual(pageCache.numberOfCachedPages, 0);
+    XCTAssertEqual(pageCache.totalCost, 0);
+}
+
+- (void)testPageEquality
+{
+    SRGFirstPageRequest *request = [self pagesRequestWithPath:@"/pages" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    SRGFirstPageRequest *otherRequest = [self pagesRequestWithPath:@"/others" completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    
+    SRGPage *page = [request requestWithPageSize:10].page;
+    SRGPage *samePage = [request requestWithPageSize:10].page;
+    XCTAssertNotEqual(page, samePage);
+    XCTAssertEqualObjects(page, samePage);
+    XCTAssertEqual(page.hash, samePage.hash);
+    XCTAssertEqualObjects(page, page.copy);
+    XCTAssertEqual(page.hash, [page.copy hash]);
+    
+    XCTAssertNotEqualObjects(page, [request requestWithPageSize:20].page);
+    XCTAssertNotEqualObjects(page, request.page);
+    XCTAssertNotEqualObjects(page, [otherRequest requestWithPageSize:10].page);
+}
+
+@end
@@ -0,0 +1,228 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSInteger kNumberOfPages = 6;
+
+@interface PagePrefetchTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation PagePrefetchTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGFirstPageRequest *)pagesRequestWithCompletionBlock:(SRGJSONDictionaryPageCompletionBlock)completionBlock
+{
+    NSString *path = [NSString stringWithFormat:@"/pages?pages=%@&latency=100", @(kNumberOfPages)];
+    return [self pagesRequestWithURL:[self.server URLForPath:path] completionBlock:completionBlock];
+}
+
+#pragma mark Tests
+
+- (void)testDefaultPrefetchDepth
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGFirstPageRequest *request = [self pagesRequestWithCompletionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(nextPage);
+        [expectation fulfill];
+    }];
+    XCTAssertEqual(request.prefetchDepth, 0);
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Give prefetching a chance to happen, if it were incorrectly enabled
+    [NSThread sleepForTimeInterval:0.5];
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testPrefetchDepthPreservedByDerivedRequests
+{
+    SRGFirstPageRequest *request = [[self pagesRequestWithCompletionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {}] requestWithPrefetchDepth:3];
+    XCTAssertEqual(request.prefetchDepth, 3);
+    XCTAssertEqual([request requestWithOptions:SRGRequestOptionCancellationErrorsEnabled].prefetchDepth, 3);
+    XCTAssertEqual([request requestWithPageSize:10].prefetchDepth, 3);
+    XCTAssertEqual([request requestWithPage:nil].prefetchDepth, 3);
+    XCTAssertEqual([request requestWithPrefetchDepth:0].prefetchDepth, 0);
+}
+
+- (void)testPrefetchedPagesServedWithoutNetworkAccess
+{
+    static const NSUInteger kPrefetchDepth = 2;
+    
+    XCTestExpectation *firstPageExpectation = [self expectationWithDescription:@"First page finished"];
+    XCTestExpectation *secondPageExpectation = [self expectationWithDescription:@"Second page finished"];
+    
+    __block SRGPage *secondPage = nil;
+    SRGFirstPageRequest *request = [[self pagesRequestWithCompletionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(JSONDictionary[@"page"], @(page.number));
+        XCTAssertEqual(nextPage.number, page.number + 1);
+        
+        if (page.number == 0) {
+            secondPage = nextPage;
+            [firstPageExpectation fulfill];
+        }
+        else {
+            [secondPageExpectation fulfill];
+        }
+    }] requestWithPrefetchDepth:kPrefetchDepth];
+    [request resume];
+    
+    [self waitForExpectations:@[ firstPageExpectation ] timeout:10.];
+    
+    // The following pages are retrieved in the background
+    [self waitForNumberOfRequests:1 + kPrefetchDepth receivedByServer:self.server];
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/pages"], 1 + kPrefetchDepth);
+    
+    [[request requestWithPage:secondPage] resume];
+    
+    [self waitForExpectations:@[ secondPageExpectation ] timeout:10.];
+    
+    // The page following the last prefetched one is now prefetched as well
+    [self waitForNumberOfRequests:2 + kPrefetchDepth receivedByServer:self.server];
+    [NSThread sleepForTimeInterval:0.5];
+    XCTAssertEqual(self.server.numberOfRequests, 2 + kPrefetchDepth);
+}
+
+- (void)testPageRequestedWhilePrefetched
+{
+    XCTestExpectation *firstPageExpectation = [self expectationWithDescription:@"First page finished"];
+    XCTestExpectation *secondPageExpectation = [self expectationWithDescription:@"Second page finished"];
+    
+    __block SRGFirstPageRequest *request = nil;
+    request = [[self pagesRequestWithCompletionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(JSONDictionary[@"page"], @(page.number));
+        
+        if (page.number == 0) {
+            // The second page is still being prefetched, and must not be retrieved again
+            [[request requestWithPage:nextPage] resume];
+            [firstPageExpectation fulfill];
+        }
+        else {
+            XCTAssertEqual(page.number, 1);
+            [secondPageExpectation fulfill];
+        }
+    }] requestWithPrefetchDepth:1];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // The third page is then prefetched
+    [self waitForNumberOfRequests:3 receivedByServer:self.server];
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    XCTAssertEqual(self.server.numberOfRequests, 3);
+    
+    // Break the cycle between the request and its completion block
+    request = nil;
+}
+
+- (void)testPrefetchPipeline
+{
+    static const NSUInteger kPrefetchDepth = 2;
+    
+    NSUInteger numberOfRequestsAfterFirstPage = 0;
+    NSMutableArray<NSNumber *> *pageNumbers = [NSMutableArray array];
+    
+    __block SRGFirstPageRequest *request = nil;
+    __block SRGPage *currentNextPage = nil;
+    
+    XCTestExpectation *firstPageExpectation = [self expectationWithDescription:@"First page finished"];
+    
+    request = [[self pagesRequestWithCompletionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [pageNumbers addObject:JSONDictionary[@"page"]];
+        currentNextPage = nextPage;
+        if (page.number == 0) {
+            [firstPageExpectation fulfill];
+        }
+    }] requestWithPrefetchDepth:kPrefetchDepth];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitForNumberOfRequests:1 + kPrefetchDepth receivedByServer:self.server];
+    numberOfRequestsAfterFirstPage = self.server.numberOfRequests;
+    XCTAssertEqual(numberOfRequestsAfterFirstPage, 1 + kPrefetchDepth);
+    
+    // Walk through all pages. Each page is served from the prefetch buffer, and prefetching continues ahead.
+    while (currentNextPage) {
+        NSUInteger pageNumber = currentNextPage.number;
+        NSUInteger numberOfRequests = self.server.numberOfRequests;
+        
+        [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id _Nullable evaluatedObject, NSDictionary<NSString *,id> * _Nullable bindings) {
+            return pageNumbers.lastObject.unsignedIntegerValue == pageNumber;
+        }] evaluatedWithObject:self handler:nil];
+        
+        [[request requestWithPage:currentNextPage] resume];
+        
+        [self waitForExpectationsWithTimeout:10. handler:nil];
+        
+        // No additional request was needed to retrieve the page itself
+        XCTAssertLessThanOrEqual(self.server.numberOfRequests, MIN(numberOfRequests + 1, kNumberOfPages));
+        [self waitForNumberOfRequests:MIN(pageNumber + 1 + kPrefetchDepth, kNumberOfPages) receivedByServer:self.server];
+    }
+    
+    NSArray<NSNumber *> *expectedPageNumbers = @[ @0, @1, @2, @3, @4, @5 ];
+    XCTAssertEqualObjects(pageNumbers, expectedPageNumbers);
+    
+    // Each page was retrieved exactly once
+    [NSThread sleepForTimeInterval:0.5];
+    XCTAssertEqual(self.server.numberOfRequests, kNumberOfPages);
+}
+
+- (void)testPrefetchedPageCancellation
+{
+    XCTestExpectation *firstPageExpectation = [self expectationWithDescription:@"First page finished"];
+    
+    __block SRGPage *secondPage = nil;
+    SRGFirstPageRequest *request = [[self pagesRequestWithCompletionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        if (page.number == 0) {
+            secondPage = nextPage;
+            [firstPageExpectation fulfill];
+        }
+        else {
+            XCTFail(@"Cancelled requests must not call their completion block");
+        }
+    }] requestWithPrefetchDepth:1];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitForNumberOfRequests:2 receivedByServer:self.server];
+    
+    SRGPageRequest *secondPageRequest = [request requestWithPage:secondPage];
+    [secondPageRequest resume];
+    XCTAssertTrue(secondPageRequest.running);
+    [secondPageRequest cancel];
+    XCTAssertFalse(secondPageRequest.running);
+    
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+@end
@@ -0,0 +1,276 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSInteger kNumberOfPages = 6;
+static const NSInteger kFailingPage = 2;
+
+@interface PageStreamTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation PageStreamTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    LoopbackServerHandler handler = LoopbackServer.configurableHandler;
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+        NSInteger number = [[URLComponents.queryItems filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == 'page'"]].firstObject.value integerValue];
+        if ([request.URL.path isEqualToString:@"/failing"] && number == kFailingPage) {
+            return [LoopbackServerResponse responseWithStatusCode:500 headers:nil body:nil];
+        }
+        return handler(request);
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGFirstPageRequest *)pagesRequestWithPath:(NSString *)path
+{
+    NSString *pagesPath = [NSString stringWithFormat:@"%@?pages=%@&latency=100", path, @(kNumberOfPages)];
+    return [self pagesRequestWithURL:[self.server URLForPath:pagesPath] completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"The completion block of the stream request must not be called");
+    }];
+}
+
+// Consume all pages, calling the completion block with the page numbers and the final error, if any
+- (void)consumePageStream:(SRGPageStream *)pageStream numbers:(NSMutableArray<NSNumber *> *)numbers completionBlock:(void (^)(NSArray<NSNumber *> *numbers, NSError * _Nullable error))completionBlock
+{
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        
+        if (! streamedPage) {
+            completionBlock(numbers.copy, error);
+            return;
+        }
+        
+        XCTAssertEqual(streamedPage.page.number, numbers.count);
+        XCTAssertEqualObjects(streamedPage.object[@"page"], @(numbers.count));
+        XCTAssertNotNil(streamedPage.response);
+        [numbers addObject:@(streamedPage.page.number)];
+        [self consumePageStream:pageStream numbers:numbers completionBlock:completionBlock];
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testAllPages
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream consumed"];
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/pages"] readAhead:0];
+    XCTAssertEqual(pageStream.readAhead, 0);
+    XCTAssertFalse(pageStream.finished);
+    
+    [self consumePageStream:pageStream numbers:[NSMutableArray array] completionBlock:^(NSArray<NSNumber *> *numbers, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(numbers, (@[ @0, @1, @2, @3, @4, @5 ]));
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertTrue(pageStream.finished);
+    XCTAssertEqual(pageStream.numberOfDeliveredPages, kNumberOfPages);
+    XCTAssertEqual(self.server.numberOfRequests, kNumberOfPages);
+    
+    // The end of the stream is reported again
+    XCTestExpectation *endExpectation = [self expectationWithDescription:@"End reported"];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertNil(streamedPage);
+        XCTAssertNil(error);
+        [endExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testPagesRetrievedOnDemand
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Page received"];
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/pages"] readAhead:0];
+    
+    // Nothing is retrieved until a page is requested
+    [self expectationForElapsedTimeInterval:0.3 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    XCTAssertEqual(self.server.numberOfRequests, 0);
+    
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertEqual(streamedPage.page.number, 0);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+    XCTAssertEqual(pageStream.numberOfBufferedPages, 0);
+}
+
+- (void)testReadAhead
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Page received"];
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/pages"] readAhead:2];
+    XCTAssertEqual(pageStream.readAhead, 2);
+    
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertEqual(streamedPage.page.number, 0);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitForNumberOfRequests:3 receivedByServer:self.server];
+    
+    // Read ahead stops once enough pages are available
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    XCTAssertEqual(self.server.numberOfRequests, 3);
+    XCTAssertEqual(pageStream.numberOfBufferedPages, 2);
+    
+    // Buffered pages are delivered immediately, and the next page is read ahead
+    XCTestExpectation *bufferedExpectation = [self expectationWithDescription:@"Buffered page received"];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertEqual(streamedPage.page.number, 1);
+        [bufferedExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitForNumberOfRequests:4 receivedByServer:self.server];
+}
+
+- (void)testConcurrentCalls
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Pages received"];
+    expectation.expectedFulfillmentCount = 3;
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/pages"] readAhead:0];
+    
+    __block NSInteger expectedNumber = 0;
+    for (NSInteger i = 0; i < 3; i++) {
+        [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+            XCTAssertEqual(streamedPage.page.number, expectedNumber);
+            expectedNumber++;
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 3);
+}
+
+- (void)testFailure
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream consumed"];
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/failing"] readAhead:1];
+    [self consumePageStream:pageStream numbers:[NSMutableArray array] completionBlock:^(NSArray<NSNumber *> *numbers, NSError * _Nullable error) {
+        XCTAssertEqualObjects(numbers, (@[ @0, @1 ]));
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertTrue(pageStream.finished);
+    
+    // The error is reported again, without any further request
+    XCTestExpectation *errorExpectation = [self expectationWithDescription:@"Error reported"];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertNil(streamedPage);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        [errorExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, kFailingPage + 1);
+}
+
+- (void)testCancellation
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Cancellation reported"];
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/pages"] readAhead:3];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertNil(streamedPage);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }];
+    [pageStream cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertTrue(pageStream.finished);
+    
+    // No further page is retrieved
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    XCTAssertLessThanOrEqual(self.server.numberOfRequests, 1);
+    
+    XCTestExpectation *cancelledExpectation = [self expectationWithDescription:@"Cancellation reported again"];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [cancelledExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testCancellationDiscardsBufferedPages
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Page received"];
+    
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:[self pagesRequestWithPath:@"/pages"] readAhead:2];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitForNumberOfRequests:3 receivedByServer:self.server];
+    
+    [pageStream cancel];
+    XCTAssertEqual(pageStream.numberOfBufferedPages, 0);
+    
+    XCTestExpectation *cancelledExpectation = [self expectationWithDescription:@"Cancellation reported"];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertNil(streamedPage);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [cancelledExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testBackgroundCompletion
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Page received"];
+    
+    SRGFirstPageRequest *request = [[self pagesRequestWithPath:@"/pages"] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled];
+    SRGPageStream *pageStream = [[SRGPageStream alloc] initWithRequest:request readAhead:0];
+    [pageStream nextPageWithCompletionBlock:^(SRGStreamedPage * _Nullable streamedPage, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertEqual(streamedPage.page.number, 0);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+@end
@@ -0,0 +1,254 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfLargeResponses = 16;
+
+@interface ParsingExecutorTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+@property (nonatomic) NSData *largeBody;
+
+@end
+
+@implementation ParsingExecutorTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSMutableArray<NSDictionary *> *items = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 20000; i++) {
+        [items addObject:@{ @"id" : @(i), @"title" : [NSString stringWithFormat:@"Media %@", @(i)], @"duration" : @(i * 1.5) }];
+    }
+    self.largeBody = [NSJSONSerialization dataWithJSONObject:items options:0 error:NULL];
+    
+    NSData *largeBody = self.largeBody;
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        if ([request.URL.path hasPrefix:@"/large"]) {
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:nil body:largeBody];
+        }
+        else {
+            return [LoopbackServerResponse JSONResponseWithObject:@{ @"path" : request.URL.path }];
+        }
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequest *)requestWithPath:(NSString *)path parser:(SRGResponseParser)parser completionBlock:(SRGObjectCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    return [SRGRequest objectRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession parser:parser completionBlock:completionBlock];
+}
+
+- (void)measureLargeResponsesParsingWithExecutor:(SRGParsingExecutor *)parsingExecutor
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kNumberOfLargeResponses; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+            
+            NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:[NSString stringWithFormat:@"/large/%@", @(i)]]];
+            [[[SRGRequest JSONArrayRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSArray * _Nullable JSONArray, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                XCTAssertEqual(JSONArray.count, 20000);
+                [expectation fulfill];
+            }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] requestWithParsingExecutor:parsingExecutor] resume];
+        }
+        [self waitForExpectationsWithTimeout:60. handler:nil];
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testDefaultSettings
+{
+    SRGRequest *request = [self requestWithPath:@"/json" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    XCTAssertEqual(request.parsingExecutor, SRGParsingExecutor.sharedExecutor);
+    XCTAssertEqual(request.parsingQualityOfService, NSQualityOfServiceUserInitiated);
+    XCTAssertEqual(SRGParsingExecutor.sharedExecutor.maximumConcurrentOperationCount, NSProcessInfo.processInfo.activeProcessorCount);
+}
+
+- (void)testSettingsPreservedByCopies
+{
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:2];
+    SRGRequest *request = [[[self requestWithPath:@"/json" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {}] requestWithParsingExecutor:parsingExecutor] requestWithParsingQualityOfService:NSQualityOfServiceUtility];
+    
+    SRGRequest *optionsRequest = [request requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled];
+    XCTAssertEqual(optionsRequest.parsingExecutor, parsingExecutor);
+    XCTAssertEqual(optionsRequest.parsingQualityOfService, NSQualityOfServiceUtility);
+}
+
+- (void)testBoundedConcurrency
+{
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:2];
+    
+    NSLock *lock = [[NSLock alloc] init];
+    __block NSUInteger numberOfRunningParsers = 0;
+    __block NSUInteger maximumNumberOfRunningParsers = 0;
+    
+    SRGResponseParser parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        [lock lock];
+        numberOfRunningParsers++;
+        maximumNumberOfRunningParsers = MAX(maximumNumberOfRunningParsers, numberOfRunningParsers);
+        [lock unlock];
+        
+        [NSThread sleepForTimeInterval:0.2];
+        
+        [lock lock];
+        numberOfRunningParsers--;
+        [lock unlock];
+        
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    };
+    
+    for (NSUInteger i = 0; i < 8; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[[self requestWithPath:[NSString stringWithFormat:@"/json/%@", @(i)] parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNotNil(object);
+            [expectation fulfill];
+        }] requestWithParsingExecutor:parsingExecutor] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(maximumNumberOfRunningParsers, 2);
+    XCTAssertEqual(parsingExecutor.numberOfRunningOperations, 0);
+    XCTAssertEqual(parsingExecutor.numberOfPendingOperations, 0);
+}
+
+- (void)testQualityOfService
+{
+    __block qos_class_t parsingQOSClass = QOS_CLASS_UNSPECIFIED;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    [[[self requestWithPath:@"/json" parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        parsingQOSClass = qos_class_self();
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [expectation fulfill];
+    }] requestWithParsingQualityOfService:NSQualityOfServiceUtility] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(parsingQOSClass, QOS_CLASS_UTILITY);
+}
+
+- (void)testBackgroundCompletionDoesNotOccupyExecutor
+{
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:1];
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    
+    // The first completion block waits until the second response has been parsed, which requires the only executor
+    // slot to be available
+    XCTestExpectation *firstExpectation = [self expectationWithDescription:@"First request finished"];
+    XCTestExpectation *secondExpectation = [self expectationWithDescription:@"Second request finished"];
+    [[[[self requestWithPath:@"/first" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [[[[self requestWithPath:@"/second" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            dispatch_semaphore_signal(semaphore);
+            [secondExpectation fulfill];
+        }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] requestWithParsingExecutor:parsingExecutor] resume];
+        
+        XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(5. * NSEC_PER_SEC))), 0);
+        [firstExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] requestWithParsingExecutor:parsingExecutor] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testSlowParserDoesNotBlockOtherResponses
+{
+    // Session delegate queues are serial by default
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration];
+    NSMutableArray<NSString *> *completedPaths = [NSMutableArray array];
+    
+    XCTestExpectation *slowExpectation = [self expectationWithDescription:@"Slow request finished"];
+    NSURLRequest *slowURLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/slow"]];
+    [[SRGRequest objectRequestWithURLRequest:slowURLRequest session:session parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        [NSThread sleepForTimeInterval:1.];
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [completedPaths addObject:@"/slow"];
+        [slowExpectation fulfill];
+    }] resume];
+    
+    XCTestExpectation *fastExpectation = [self expectationWithDescription:@"Fast request finished"];
+    NSURLRequest *fastURLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/fast"]];
+    [[SRGRequest JSONDictionaryRequestWithURLRequest:fastURLRequest session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [completedPaths addObject:@"/fast"];
+        [fastExpectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<NSString *> *expectedPaths = @[ @"/fast", @"/slow" ];
+    XCTAssertEqualObjects(completedPaths, expectedPaths);
+    
+    [session finishTasksAndInvalidate];
+}
+
+- (void)testHigherQualityOfServiceFirst
+{
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:1];
+    NSMutableArray<NSString *> *parsedPaths = [NSMutableArray array];
+    
+    SRGResponseParser parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        NSDictionary *JSONDictionary = SRGNetworkJSONDictionaryParser(data, pError);
+        @synchronized (parsedPaths) {
+            [parsedPaths addObject:JSONDictionary[@"path"]];
+        }
+        return JSONDictionary;
+    };
+    
+    // Occupy the executor so that the next responses are pending
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking request finished"];
+    [[[self requestWithPath:@"/blocking" parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        [NSThread sleepForTimeInterval:1.];
+        return parser(data, pError);
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [blockingExpectation fulfill];
+    }] requestWithParsingExecutor:parsingExecutor] resume];
+    
+    // Let the blocking response be received first
+    [NSThread sleepForTimeInterval:0.3];
+    
+    XCTestExpectation *backgroundExpectation = [self expectationWithDescription:@"Background request finished"];
+    [[[[self requestWithPath:@"/background" parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [backgroundExpectation fulfill];
+    }] requestWithParsingExecutor:parsingExecutor] requestWithParsingQualityOfService:NSQualityOfServiceBackground] resume];
+    
+    XCTestExpectation *userInteractiveExpectation = [self expectationWithDescription:@"User-interactive request finished"];
+    [[[[self requestWithPath:@"/user-interactive" parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [userInteractiveExpectation fulfill];
+    }] requestWithParsingExecutor:parsingExecutor] requestWithParsingQualityOfService:NSQualityOfServiceUserInteractive] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<NSString *> *expectedPaths = @[ @"/blocking", @"/user-interactive", @"/background" ];
+    XCTAssertEqualObjects(parsedPaths, expectedPaths);
+}
+
+#pragma mark Performance tests
+
+- (void)testSerialParsingThroughput
+{
+    [self measureLargeResponsesParsingWithExecutor:[[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:1]];
+}
+
+- (void)testParallelParsingThroughput
+{
+    [self measureLargeResponsesParsingWithExecutor:SRGParsingExecutor.sharedExecutor];
+}
+
+@end
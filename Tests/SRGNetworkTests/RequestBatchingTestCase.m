@@ -0,0 +1,344 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 10;
+
+@interface RequestBatchingTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation RequestBatchingTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    // Bulk service returning one item per requested identifier, except for identifiers starting with `missing`
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"name == 'ids'"];
+        NSString *identifiersString = [[URLComponents.queryItems filteredArrayUsingPredicate:predicate].firstObject value];
+        NSArray<NSString *> *identifiers = identifiersString.length != 0 ? [identifiersString componentsSeparatedByString:@","] : @[];
+        
+        if ([request.URL.path isEqualToString:@"/error"]) {
+            return [LoopbackServerResponse responseWithStatusCode:500 headers:nil body:nil];
+        }
+        
+        NSMutableDictionary<NSString *, id> *items = [NSMutableDictionary dictionary];
+        for (NSString *identifier in identifiers) {
+            if (! [identifier hasPrefix:@"missing"]) {
+                items[identifier] = @{ @"identifier" : identifier };
+            }
+        }
+        
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"items" : items.copy, @"count" : @(identifiers.count) }];
+        response.delay = 0.2;
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequestBatcher *)batcherWithPath:(NSString *)path window:(NSTimeInterval)window maximumBatchSize:(NSUInteger)maximumBatchSize
+{
+    NSURL *URL = [self.server URLForPath:path];
+    return [[SRGRequestBatcher alloc] initWithSession:NSURLSession.sharedSession window:window maximumBatchSize:maximumBatchSize builder:^NSURLRequest * _Nonnull(NSArray<NSString *> * _Nonnull keys) {
+        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+        URLComponents.queryItems = @[ [NSURLQueryItem queryItemWithName:@"ids" value:[keys componentsJoinedByString:@","]] ];
+        return [NSURLRequest requestWithURL:URLComponents.URL];
+    } splitter:^NSDictionary<NSString *, id> * _Nullable(NSData * _Nonnull data, NSArray<NSString *> * _Nonnull keys, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        NSDictionary *JSONDictionary = SRGNetworkJSONDictionaryParser(data, pError);
+        if (! JSONDictionary) {
+            return nil;
+        }
+        
+        // Batch sizes are recorded to check which keys were actually requested
+        NSMutableDictionary<NSString *, id> *objects = [JSONDictionary[@"items"] mutableCopy];
+        objects[@"count"] = JSONDictionary[@"count"];
+        return objects.copy;
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testSingleServerHit
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.1 maximumBatchSize:100];
+    
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        
+        NSString *key = @(i).stringValue;
+        [[batcher requestForKey:key completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertTrue(NSThread.isMainThread);
+            XCTAssertNil(error);
+            XCTAssertEqualObjects(object[@"identifier"], key);
+            XCTAssertEqual([(NSHTTPURLResponse *)response statusCode], 200);
+            [expectation fulfill];
+        }] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/items"], 1);
+    XCTAssertEqual(batcher.numberOfBatches, 1);
+}
+
+- (void)testDuplicateKeys
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.1 maximumBatchSize:100];
+    
+    for (NSUInteger i = 0; i < 3; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[batcher requestForKey:@"a" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqualObjects(object[@"identifier"], @"a");
+            [expectation fulfill];
+        }] resume];
+    }
+    
+    XCTestExpectation *countExpectation = [self expectationWithDescription:@"Count retrieved"];
+    [[batcher requestForKey:@"count" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(object, @2);
+        [countExpectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testMaximumBatchSize
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:1. maximumBatchSize:3];
+    
+    NSDate *startDate = NSDate.date;
+    for (NSUInteger i = 0; i < 6; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        
+        NSString *key = @(i).stringValue;
+        [[batcher requestForKey:key completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqualObjects(object[@"identifier"], key);
+            [expectation fulfill];
+        }] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Full batches are started without waiting for the window to end
+    XCTAssertLessThan([NSDate.date timeIntervalSinceDate:startDate], 1.);
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+    XCTAssertEqual(batcher.numberOfBatches, 2);
+}
+
+- (void)testSeparateWindows
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.1 maximumBatchSize:100];
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Request 1 finished"];
+    [[batcher requestForKey:@"a" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [expectation1 fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Request 2 finished"];
+    [[batcher requestForKey:@"b" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [expectation2 fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+}
+
+- (void)testMissingKey
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.1 maximumBatchSize:100];
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Request 1 finished"];
+    [[batcher requestForKey:@"a" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(object[@"identifier"], @"a");
+        XCTAssertNil(error);
+        [expectation1 fulfill];
+    }] resume];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Request 2 finished"];
+    [[batcher requestForKey:@"missing" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(object);
+        XCTAssertNil(error);
+        [expectation2 fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testHTTPError
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/error" window:0.1 maximumBatchSize:100];
+    
+    for (NSUInteger i = 0; i < 3; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[batcher requestForKey:@(i).stringValue completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(object);
+            XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+            XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+            [expectation fulfill];
+        }] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testSplittingError
+{
+    NSURL *URL = [self.server URLForPath:@"/items"];
+    SRGRequestBatcher *batcher = [[SRGRequestBatcher alloc] initWithSession:NSURLSession.sharedSession window:0.1 maximumBatchSize:100 builder:^NSURLRequest * _Nonnull(NSArray<NSString *> * _Nonnull keys) {
+        return [NSURLRequest requestWithURL:URL];
+    } splitter:^NSDictionary<NSString *, id> * _Nullable(NSData * _Nonnull data, NSArray<NSString *> * _Nonnull keys, NSError * _Nullable __autoreleasing * _Nullable pError) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:@"ch.srgssr.test" code:1012 userInfo:nil];
+        }
+        return nil;
+    }];
+    
+    for (NSUInteger i = 0; i < 3; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[batcher requestForKey:@(i).stringValue completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(object);
+            XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+            XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+            [expectation fulfill];
+        }] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testCancellationBeforeBatchStart
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.2 maximumBatchSize:100];
+    
+    SRGRequest *request1 = [batcher requestForKey:@"a" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called");
+    }];
+    [request1 resume];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    SRGRequest *request2 = [batcher requestForKey:@"b" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(object[@"identifier"], @"b");
+        [expectation fulfill];
+    }];
+    [request2 resume];
+    
+    XCTestExpectation *countExpectation = [self expectationWithDescription:@"Count retrieved"];
+    [[batcher requestForKey:@"count" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(object, @2);
+        [countExpectation fulfill];
+    }] resume];
+    
+    // The key of a request cancelled before its batch starts is not requested anymore
+    [request1 cancel];
+    XCTAssertFalse(request1.running);
+    XCTAssertTrue(request2.running);
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testPartialCancellationAfterBatchStart
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:1. maximumBatchSize:2];
+    
+    XCTestExpectation *cancellationExpectation = [self expectationWithDescription:@"Request cancelled"];
+    SRGRequest *request1 = [[batcher requestForKey:@"a" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(object);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [cancellationExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled];
+    [request1 resume];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    [[batcher requestForKey:@"b" completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(object[@"identifier"], @"b");
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] resume];
+    
+    // The batch has been started since it is full, and must survive as long as one request is still interested
+    [request1 cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testFullCancellation
+{
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.1 maximumBatchSize:100];
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [batcher requestForKey:@(i).stringValue completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTFail(@"Completion block must not be called");
+        }];
+        [request resume];
+        [requests addObject:request];
+    }
+    
+    for (SRGRequest *request in requests) {
+        [request cancel];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // No batch request is made if all logical requests were cancelled before their batch started
+    XCTAssertEqual(self.server.numberOfRequests, 0);
+    XCTAssertEqual(batcher.numberOfBatches, 0);
+}
+
+- (void)testRequestQueue
+{
+    SRGRequestBatcher *batcher = [self batcherWithPath:@"/items" window:0.1 maximumBatchSize:100];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Queue finished"];
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }
+    }];
+    
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        [requestQueue addRequest:[batcher requestForKey:@(i).stringValue completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNotNil(object);
+        }] resume:YES];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+@end
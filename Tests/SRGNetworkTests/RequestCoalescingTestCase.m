@@ -0,0 +1,264 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 10;
+
+@interface RequestCoalescingTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation RequestCoalescingTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"path" : request.URL.path }];
+        response.delay = 0.5;
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Tests
+
+- (void)testSingleServerHit
+{
+    NSMutableArray<NSDictionary *> *JSONDictionaries = [NSMutableArray array];
+    
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertTrue(NSThread.isMainThread);
+            XCTAssertNotNil(JSONDictionary);
+            XCTAssertNil(error);
+            [JSONDictionaries addObject:JSONDictionary];
+            [expectation fulfill];
+        }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/json"], 1);
+    
+    // A single parsing result is shared between all requests
+    XCTAssertEqual(JSONDictionaries.count, kNumberOfRequests);
+    for (NSDictionary *JSONDictionary in JSONDictionaries) {
+        XCTAssertEqual(JSONDictionary, JSONDictionaries.firstObject);
+    }
+}
+
+- (void)testWithoutCoalescing
+{
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNotNil(JSONDictionary);
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/json"], kNumberOfRequests);
+}
+
+- (void)testDifferentURLs
+{
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Request 1 finished"];
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Request 2 finished"];
+    
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:[self.server URLForPath:@"/json1"]] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(JSONDictionary[@"path"], @"/json1");
+        [expectation1 fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:[self.server URLForPath:@"/json2"]] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(JSONDictionary[@"path"], @"/json2");
+        [expectation2 fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+}
+
+- (void)testDifferentParsers
+{
+    XCTestExpectation *dataExpectation = [self expectationWithDescription:@"Data request finished"];
+    XCTestExpectation *JSONExpectation = [self expectationWithDescription:@"JSON request finished"];
+    
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    [[[SRGRequest dataRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue([data isKindOfClass:NSData.class]);
+        [dataExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue([JSONDictionary isKindOfClass:NSDictionary.class]);
+        [JSONExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testSlowParserDoesNotBlockOtherParsers
+{
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    
+    // The slow parser only returns once the fast one has parsed the same shared response
+    XCTestExpectation *slowExpectation = [self expectationWithDescription:@"Slow request finished"];
+    XCTestExpectation *fastExpectation = [self expectationWithDescription:@"Fast request finished"];
+    
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    [[[SRGRequest objectRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(5. * NSEC_PER_SEC))), 0);
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(object);
+        [slowExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    [[[SRGRequest objectRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        dispatch_semaphore_signal(semaphore);
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(object);
+        [fastExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testPartialCancellation
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    SRGRequest *request1 = [[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Completion block must not be called");
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled];
+    [request1 resume];
+    
+    SRGRequest *request2 = [[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(JSONDictionary);
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled];
+    [request2 resume];
+    
+    // The shared task must survive as long as one request is still interested
+    [request1 cancel];
+    XCTAssertFalse(request1.running);
+    XCTAssertTrue(request2.running);
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testPartialCancellationWithCancellationErrors
+{
+    XCTestExpectation *cancellationExpectation = [self expectationWithDescription:@"Request cancelled"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    SRGRequest *request1 = [[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(JSONDictionary);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [cancellationExpectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled | SRGRequestOptionCancellationErrorsEnabled];
+    [request1 resume];
+    
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(JSONDictionary);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    
+    [request1 cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testFullCancellation
+{
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTFail(@"Completion block must not be called");
+        }] requestWithOptions:SRGRequestOptionCoalescingEnabled];
+        [request resume];
+        [requests addObject:request];
+    }
+    
+    for (SRGRequest *request in requests) {
+        [request cancel];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testNewTaskAfterCompletion
+{
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Request 1 finished"];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [expectation1 fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Request 2 finished"];
+    [[[SRGRequest JSONDictionaryRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [expectation2 fulfill];
+    }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+}
+
+- (void)testPOSTRequestsAreNotCoalesced
+{
+    NSURL *URL = [self.server URLForPath:@"/json"];
+    NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:URL];
+    URLRequest.HTTPMethod = @"POST";
+    
+    for (NSUInteger i = 0; i < 2; i++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+        [[[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [expectation fulfill];
+        }] requestWithOptions:SRGRequestOptionCoalescingEnabled] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 2);
+}
+
+@end
@@ -0,0 +1,198 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfBurstRequests = 200;
+
+@interface RequestMetricsTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation RequestMetricsTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    // Paths have the form /<delay in milliseconds>/<identifier>
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSArray<NSString *> *components = [request.URL.path componentsSeparatedByString:@"/"];
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"path" : request.URL.path }];
+        response.delay = components[1].doubleValue / 1000.;
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequest *)requestForPath:(NSString *)path completionBlock:(SRGJSONDictionaryCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:completionBlock];
+}
+
+- (void)measureBurstWithMetricsCollector:(SRGMetricsCollector *)metricsCollector
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kNumberOfBurstRequests; i++) {
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", @(i)]];
+            [[[self requestForPath:[NSString stringWithFormat:@"/0/%@", @(i)] completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                [expectation fulfill];
+            }] requestWithMetricsCollector:metricsCollector] resume];
+        }
+        [self waitForExpectationsWithTimeout:30. handler:nil];
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testDefaultSettings
+{
+    SRGRequest *request = [self requestForPath:@"/0/1" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    XCTAssertNil(request.metricsCollector);
+    XCTAssertNil(request.metrics);
+    
+    SRGMetricsCollector *metricsCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:nil];
+    XCTAssertEqual([request requestWithMetricsCollector:metricsCollector].metricsCollector, metricsCollector);
+    XCTAssertEqual([[[request requestWithMetricsCollector:metricsCollector] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled] metricsCollector], metricsCollector);
+    XCTAssertEqualObjects(metricsCollector.endpoints, @[]);
+}
+
+- (void)testRequestWithoutCollector
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    __block SRGRequest *request = nil;
+    request = [self requestForPath:@"/0/1" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(request.metrics);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertNil(request.metrics);
+}
+
+- (void)testRequestMetrics
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGMetricsCollector *metricsCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:nil];
+    
+    __block SRGRequest *request = nil;
+    request = [[self requestForPath:@"/200/1" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        SRGRequestMetrics *metrics = request.metrics;
+        XCTAssertNotNil(metrics);
+        XCTAssertEqualObjects(metrics.URLRequest, request.URLRequest);
+        XCTAssertEqualObjects(metrics.endpoint, request.URLRequest.URL.host);
+        XCTAssertGreaterThanOrEqual([metrics durationForPhase:SRGRequestPhaseTotal], 0.2);
+        XCTAssertGreaterThanOrEqual([metrics durationForPhase:SRGRequestPhaseParsing], 0.);
+        XCTAssertGreaterThanOrEqual([metrics durationForPhase:SRGRequestPhaseDelivery], 0.);
+        XCTAssertLessThan([metrics durationForPhase:SRGRequestPhaseParsing], [metrics durationForPhase:SRGRequestPhaseTotal]);
+        
+        // No extractor for simple requests
+        XCTAssertLessThan([metrics durationForPhase:SRGRequestPhaseExtraction], 0.);
+        
+        if (@available(iOS 15, tvOS 15, watchOS 8, *)) {
+            XCTAssertGreaterThanOrEqual([metrics durationForPhase:SRGRequestPhaseTimeToFirstByte], 0.2);
+        }
+        [expectation fulfill];
+    }] requestWithMetricsCollector:metricsCollector];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSString *host = request.URLRequest.URL.host;
+    XCTAssertEqualObjects(metricsCollector.endpoints, @[ host ]);
+    
+    SRGLatencyHistogram *totalHistogram = [metricsCollector histogramForEndpoint:host phase:SRGRequestPhaseTotal];
+    XCTAssertEqual(totalHistogram.count, 1);
+    XCTAssertEqualWithAccuracy(totalHistogram.mean, [request.metrics durationForPhase:SRGRequestPhaseTotal], 0.001);
+    XCTAssertEqual(totalHistogram.minimum, totalHistogram.maximum);
+    XCTAssertEqual([totalHistogram durationAtPercentile:0.5], totalHistogram.minimum);
+    
+    // Phases which could not be measured are not recorded
+    XCTAssertNil([metricsCollector histogramForEndpoint:host phase:SRGRequestPhaseExtraction]);
+    XCTAssertNil([metricsCollector histogramForEndpoint:@"unknown" phase:SRGRequestPhaseTotal]);
+    
+    XCTAssertEqualObjects([metricsCollector histogramsForPhase:SRGRequestPhaseTotal].allKeys, @[ host ]);
+    
+    [metricsCollector reset];
+    XCTAssertEqualObjects(metricsCollector.endpoints, @[]);
+}
+
+- (void)testPageRequestMetrics
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGMetricsCollector *metricsCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:nil];
+    
+    __block SRGFirstPageRequest *request = nil;
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/0/1"]];
+    request = [[SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        return URLRequest;
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        return nil;
+    } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertGreaterThanOrEqual([request.metrics durationForPhase:SRGRequestPhaseExtraction], 0.);
+        [expectation fulfill];
+    }] requestWithMetricsCollector:metricsCollector];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testEndpointProvider
+{
+    SRGMetricsCollector *metricsCollector = [[SRGMetricsCollector alloc] initWithEndpointProvider:^NSString * _Nonnull(NSURLRequest * _Nonnull URLRequest) {
+        return [URLRequest.URL.path componentsSeparatedByString:@"/"][1];
+    }];
+    
+    NSArray<NSString *> *paths = @[ @"/10/1", @"/10/2", @"/10/3", @"/100/1" ];
+    for (NSString *path in paths) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Request %@ finished", path]];
+        [[[self requestForPath:path completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [expectation fulfill];
+        }] requestWithMetricsCollector:metricsCollector] resume];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqualObjects([NSSet setWithArray:metricsCollector.endpoints], ([NSSet setWithObjects:@"10", @"100", nil]));
+    
+    NSDictionary<NSString *, SRGLatencyHistogram *> *histograms = [metricsCollector histogramsForPhase:SRGRequestPhaseTotal];
+    XCTAssertEqual(histograms[@"10"].count, 3);
+    XCTAssertEqual(histograms[@"100"].count, 1);
+    XCTAssertGreaterThanOrEqual([histograms[@"10"] durationAtPercentile:0.5], 0.01);
+    XCTAssertGreaterThanOrEqual([histograms[@"100"] durationAtPercentile:0.5], 0.1);
+    XCTAssertLessThanOrEqual([histograms[@"10"] durationAtPercentile:1.], histograms[@"10"].maximum);
+}
+
+#pragma mark Performance tests
+
+- (void)testBurstPerformanceWithoutCollector
+{
+    [self measureBurstWithMetricsCollector:nil];
+}
+
+- (void)testBurstPerformanceWithCollector
+{
+    [self measureBurstWithMetricsCollector:[[SRGMetricsCollector alloc] initWithEndpointProvider:nil]];
+}
+
+@end
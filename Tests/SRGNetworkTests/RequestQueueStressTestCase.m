@@ -0,0 +1,140 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 10000;
+
+@interface RequestQueueStressTestCase : NetworkBaseTestCase
+
+@end
+
+@implementation RequestQueueStressTestCase
+
+#pragma mark Helpers
+
+// Requests failing immediately without network access (unsupported URL scheme)
+- (SRGRequest *)failingRequestWithIndex:(NSUInteger)index completionBlock:(SRGDataCompletionBlock)completionBlock
+{
+    NSURL *URL = [NSURL URLWithString:[NSString stringWithFormat:@"unsupported://stress/%@", @(index)]];
+    return [SRGRequest dataRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:completionBlock];
+}
+
+#pragma mark Tests
+
+- (void)testConcurrentAdditions
+{
+    NSLock *lock = [[NSLock alloc] init];
+    __block NSUInteger numberOfCompletions = 0;
+    __block NSUInteger numberOfStarts = 0;
+    __block NSUInteger numberOfFinishes = 0;
+    __block NSUInteger numberOfErrors = 0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Queue finished"];
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        if (finished) {
+            numberOfFinishes++;
+            numberOfErrors = [error.userInfo[SRGNetworkErrorsKey] count];
+            [expectation fulfill];
+        }
+        else {
+            numberOfStarts++;
+        }
+    }];
+    
+    // Retain requests until they are all added, since queues do not retain their requests
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray arrayWithCapacity:kNumberOfRequests];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        [requests addObject:[self failingRequestWithIndex:i completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [lock lock];
+            numberOfCompletions++;
+            [lock unlock];
+            
+            [requestQueue reportError:error];
+        }]];
+    }
+    
+    dispatch_apply(kNumberOfRequests, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        [requestQueue addRequest:requests[i] resume:NO];
+    });
+    
+    XCTAssertFalse(requestQueue.running);
+    
+    [requestQueue resume];
+    
+    [self waitForExpectationsWithTimeout:60. handler:nil];
+    
+    XCTAssertFalse(requestQueue.running);
+    XCTAssertEqual(numberOfCompletions, kNumberOfRequests);
+    XCTAssertEqual(numberOfStarts, 1);
+    XCTAssertEqual(numberOfFinishes, 1);
+    XCTAssertEqual(numberOfErrors, kNumberOfRequests);
+}
+
+- (void)testConcurrentAdditionsAndResumes
+{
+    NSLock *lock = [[NSLock alloc] init];
+    __block NSUInteger numberOfCompletions = 0;
+    __block NSInteger balance = 0;
+    __block BOOL consistent = YES;
+    
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        // Starts and finishes must strictly alternate
+        balance += finished ? -1 : 1;
+        if (balance != 0 && balance != 1) {
+            consistent = NO;
+        }
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All requests completed"];
+    dispatch_apply(kNumberOfRequests, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        SRGRequest *request = [[self failingRequestWithIndex:i completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            [lock lock];
+            BOOL last = (++numberOfCompletions == kNumberOfRequests);
+            [lock unlock];
+            
+            if (last) {
+                [expectation fulfill];
+            }
+        }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled];
+        [requestQueue addRequest:request resume:YES];
+    });
+    
+    [self waitForExpectationsWithTimeout:60. handler:nil];
+    
+    // Let pending state changes be delivered
+    XCTestExpectation *stateExpectation = [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(SRGRequestQueue * _Nullable requestQueue, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return ! requestQueue.running;
+    }] evaluatedWithObject:requestQueue handler:nil];
+    [self waitForExpectations:@[ stateExpectation ] timeout:10.];
+    
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertTrue(consistent);
+    XCTAssertEqual(balance, 0);
+}
+
+#pragma mark Performance tests
+
+- (void)testAdditionPerformance
+{
+    [self measureBlock:^{
+        SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] init];
+        
+        NSMutableArray<SRGRequest *> *requests = [NSMutableArray arrayWithCapacity:kNumberOfRequests];
+        for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+            [requests addObject:[self failingRequestWithIndex:i completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {}]];
+        }
+        
+        dispatch_apply(kNumberOfRequests, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+            [requestQueue addRequest:requests[i] resume:NO];
+        });
+    }];
+}
+
+@end
@@ -4,6 +4,7 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "LoopbackServer.h"
 #import "NetworkBaseTestCase.h"
 
 @interface RequestQueueTestCase : NetworkBaseTestCase
@@ -565,6 +566,43 @@
     [self waitForExpectationsWithTimeout:5. handler:nil];
 }
 
+- (void)testRequestInSeveralQueues
+{
+    XCTestExpectation *queue1FinishedExpectation = [self expectationWithDescription:@"Queue 1 finished"];
+    XCTestExpectation *queue2FinishedExpectation = [self expectationWithDescription:@"Queue 2 finished"];
+    
+    SRGRequestQueue *requestQueue1 = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queue1FinishedExpectation fulfill];
+        }
+    }];
+    SRGRequestQueue *requestQueue2 = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queue2FinishedExpectation fulfill];
+        }
+    }];
+    
+    LoopbackServer *server = [[LoopbackServer alloc] initWithHandler:LoopbackServer.configurableHandler];
+    XCTAssertTrue([server start]);
+    
+    SRGRequest *request = [SRGRequest dataRequestWithURLRequest:[NSURLRequest requestWithURL:[server URLForPath:@"/items?latency=100"]] session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        // Not interested in individual request status
+    }];
+    [requestQueue1 addRequest:request resume:NO];
+    [requestQueue2 addRequest:request resume:YES];
+    
+    // Both queues track the request status
+    XCTAssertTrue(requestQueue1.running);
+    XCTAssertTrue(requestQueue2.running);
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertFalse(requestQueue1.running);
+    XCTAssertFalse(requestQueue2.running);
+    
+    [server stop];
+}
+
 - (void)testReportedErrorsReset
 {
     // Errors are only collected when the queue is running, and reset when returning to non-running state. If we perform
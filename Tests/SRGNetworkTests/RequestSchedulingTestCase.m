@@ -0,0 +1,259 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static const NSUInteger kNumberOfRequests = 10;
+static const NSUInteger kMaximumNumberOfConcurrentRequests = 2;
+
+@interface RequestSchedulingTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation RequestSchedulingTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"path" : request.URL.path }];
+        response.delay = 0.2;
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequest *)requestForPath:(NSString *)path completionBlock:(SRGJSONDictionaryCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:completionBlock];
+}
+
+- (NSUInteger)numberOfRunningRequestsInArray:(NSArray<SRGRequest *> *)requests
+{
+    return [requests filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"running == YES"]].count;
+}
+
+#pragma mark Tests
+
+- (void)testDefaultMaximumNumberOfConcurrentRequests
+{
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] init];
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [self requestForPath:[NSString stringWithFormat:@"/%@", @(i)] completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+        [requestQueue addRequest:request resume:YES];
+        [requests addObject:request];
+    }
+    
+    XCTAssertEqual([self numberOfRunningRequestsInArray:requests], kNumberOfRequests);
+    [requestQueue cancel];
+}
+
+- (void)testMaximumNumberOfConcurrentRequests
+{
+    XCTestExpectation *queueFinishedExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            XCTAssertNil(error);
+            [queueFinishedExpectation fulfill];
+        }
+    }] requestQueueWithMaximumNumberOfConcurrentRequests:kMaximumNumberOfConcurrentRequests];
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    __block NSUInteger numberOfFinishedRequests = 0;
+    
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [self requestForPath:[NSString stringWithFormat:@"/%@", @(i)] completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNotNil(JSONDictionary);
+            XCTAssertNil(error);
+            XCTAssertLessThanOrEqual([self numberOfRunningRequestsInArray:requests], kMaximumNumberOfConcurrentRequests);
+            numberOfFinishedRequests++;
+        }];
+        [requests addObject:request];
+    }
+    
+    for (SRGRequest *request in requests) {
+        [requestQueue addRequest:request resume:YES];
+    }
+    
+    XCTAssertTrue(requestQueue.running);
+    XCTAssertEqual([self numberOfRunningRequestsInArray:requests], kMaximumNumberOfConcurrentRequests);
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertFalse(requestQueue.running);
+    XCTAssertEqual(numberOfFinishedRequests, kNumberOfRequests);
+    XCTAssertEqual(self.server.numberOfRequests, kNumberOfRequests);
+}
+
+- (void)testMaximumNumberOfConcurrentRequestsPreservedByOptions
+{
+    XCTestExpectation *queueFinishedExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queueFinishedExpectation fulfill];
+        }
+    }] requestQueueWithMaximumNumberOfConcurrentRequests:1] requestQueueWithOptions:SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled];
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [self requestForPath:[NSString stringWithFormat:@"/%@", @(i)] completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertLessThanOrEqual([self numberOfRunningRequestsInArray:requests], 1);
+        }];
+        [requestQueue addRequest:request resume:YES];
+        [requests addObject:request];
+    }
+    
+    XCTAssertEqual([self numberOfRunningRequestsInArray:requests], 1);
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (void)testPriorityOrdering
+{
+    XCTestExpectation *queueFinishedExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queueFinishedExpectation fulfill];
+        }
+    }] requestQueueWithMaximumNumberOfConcurrentRequests:1];
+    
+    NSMutableArray<NSString *> *paths = [NSMutableArray array];
+    SRGJSONDictionaryCompletionBlock completionBlock = ^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [paths addObject:JSONDictionary[@"path"]];
+    };
+    
+    // The first request is started immediately, the others wait
+    [requestQueue addRequest:[self requestForPath:@"/first" completionBlock:completionBlock] resume:YES];
+    for (NSUInteger i = 0; i < 3; i++) {
+        [requestQueue addRequest:[self requestForPath:[NSString stringWithFormat:@"/low%@", @(i)] completionBlock:completionBlock] resume:YES];
+    }
+    [requestQueue addRequest:[[self requestForPath:@"/high" completionBlock:completionBlock] requestWithPriority:NSURLSessionTaskPriorityHigh] resume:YES];
+    [requestQueue addRequest:[[self requestForPath:@"/lowest" completionBlock:completionBlock] requestWithPriority:NSURLSessionTaskPriorityLow] resume:YES];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    NSArray<NSString *> *expectedPaths = @[ @"/first", @"/high", @"/low0", @"/low1", @"/low2", @"/lowest" ];
+    XCTAssertEqualObjects(paths, expectedPaths);
+}
+
+- (void)testPriorityClamping
+{
+    SRGRequest *request = [self requestForPath:@"/json" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    XCTAssertEqual(request.priority, NSURLSessionTaskPriorityDefault);
+    XCTAssertEqual([request requestWithPriority:2.f].priority, NSURLSessionTaskPriorityHigh);
+    XCTAssertEqual([request requestWithPriority:-1.f].priority, NSURLSessionTaskPriorityLow);
+    XCTAssertEqual([[[request requestWithPriority:0.8f] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled] priority], 0.8f);
+}
+
+- (void)testCancelWithPendingRequests
+{
+    XCTestExpectation *queueFinishedExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queueFinishedExpectation fulfill];
+        }
+    }] requestQueueWithMaximumNumberOfConcurrentRequests:1];
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [self requestForPath:[NSString stringWithFormat:@"/%@", @(i)] completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTFail(@"Cancelled and discarded requests must not call their completion block");
+        }];
+        [requestQueue addRequest:request resume:YES];
+        [requests addObject:request];
+    }
+    
+    [requestQueue cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(requestQueue.running);
+    XCTAssertEqual([self numberOfRunningRequestsInArray:requests], 0);
+    XCTAssertLessThanOrEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testCancelPendingRequest
+{
+    XCTestExpectation *queueFinishedExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queueFinishedExpectation fulfill];
+        }
+    }] requestQueueWithMaximumNumberOfConcurrentRequests:1];
+    
+    NSMutableArray<NSString *> *paths = [NSMutableArray array];
+    SRGJSONDictionaryCompletionBlock completionBlock = ^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        if (JSONDictionary) {
+            [paths addObject:JSONDictionary[@"path"]];
+        }
+    };
+    
+    SRGRequest *pendingRequest = [self requestForPath:@"/cancelled" completionBlock:completionBlock];
+    [requestQueue addRequest:[self requestForPath:@"/first" completionBlock:completionBlock] resume:YES];
+    [requestQueue addRequest:pendingRequest resume:YES];
+    [requestQueue addRequest:[self requestForPath:@"/last" completionBlock:completionBlock] resume:YES];
+    
+    [pendingRequest cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<NSString *> *expectedPaths = @[ @"/first", @"/last" ];
+    XCTAssertEqualObjects(paths, expectedPaths);
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/cancelled"], 0);
+}
+
+- (void)testQueueResume
+{
+    XCTestExpectation *queueFinishedExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            [queueFinishedExpectation fulfill];
+        }
+    }] requestQueueWithMaximumNumberOfConcurrentRequests:kMaximumNumberOfConcurrentRequests];
+    
+    NSMutableArray<SRGRequest *> *requests = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumberOfRequests; i++) {
+        SRGRequest *request = [self requestForPath:[NSString stringWithFormat:@"/%@", @(i)] completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertLessThanOrEqual([self numberOfRunningRequestsInArray:requests], kMaximumNumberOfConcurrentRequests);
+        }];
+        [requestQueue addRequest:request resume:NO];
+        [requests addObject:request];
+    }
+    
+    XCTAssertFalse(requestQueue.running);
+    
+    [requestQueue resume];
+    
+    XCTAssertTrue(requestQueue.running);
+    XCTAssertEqual([self numberOfRunningRequestsInArray:requests], kMaximumNumberOfConcurrentRequests);
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, kNumberOfRequests);
+}
+
+@end
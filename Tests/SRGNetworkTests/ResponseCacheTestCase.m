@@ -0,0 +1,250 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+@interface ResponseCacheTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+@property (nonatomic) SRGResponseCache *responseCache;
+
+@end
+
+@implementation ResponseCacheTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSString *path = request.URL.path;
+        NSData *body = [NSJSONSerialization dataWithJSONObject:@{ @"path" : path } options:0 error:NULL];
+        
+        if ([path isEqualToString:@"/fresh"]) {
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"max-age=60" } body:body];
+        }
+        else if ([path isEqualToString:@"/etag"]) {
+            if ([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:@"\"v1\""]) {
+                return [LoopbackServerResponse responseWithStatusCode:304 headers:@{ @"ETag" : @"\"v1\"" } body:nil];
+            }
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"no-cache", @"ETag" : @"\"v1\"" } body:body];
+        }
+        else if ([path isEqualToString:@"/etag-evicted"]) {
+            if ([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:@"\"v1\""]) {
+                // Evict the cached response while the revalidation is in flight (the cycle is broken in `-tearDown`)
+                [self.responseCache removeAllCachedResponses];
+                return [LoopbackServerResponse responseWithStatusCode:304 headers:@{ @"ETag" : @"\"v1\"" } body:nil];
+            }
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"no-cache", @"ETag" : @"\"v1\"" } body:body];
+        }
+        else if ([path isEqualToString:@"/last-modified"]) {
+            NSString *lastModified = @"Wed, 21 Oct 2015 07:28:00 GMT";
+            if ([[request valueForHTTPHeaderField:@"If-Modified-Since"] isEqualToString:lastModified]) {
+                return [LoopbackServerResponse responseWithStatusCode:304 headers:nil body:nil];
+            }
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"max-age=0", @"Last-Modified" : lastModified } body:body];
+        }
+        else if ([path isEqualToString:@"/no-store"]) {
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"no-store, max-age=60" } body:body];
+        }
+        else {
+            return [LoopbackServerResponse responseWithStatusCode:404 headers:nil body:nil];
+        }
+    }];
+    XCTAssertTrue([self.server start]);
+    
+    NSURL *directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString]];
+    self.responseCache = [[SRGResponseCache alloc] initWithMemoryCapacity:1024 * 1024 diskCapacity:1024 * 1024 directoryURL:directoryURL];
+}
+
+- (void)tearDown
+{
+    [self.responseCache removeAllCachedResponses];
+    self.responseCache = nil;
+    
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (void)performRequestWithPath:(NSString *)path parser:(SRGResponseParser)parser completionBlock:(SRGObjectCompletionBlock)completionBlock
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    [[[SRGRequest objectRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        completionBlock(object, response, error);
+        [expectation fulfill];
+    }] requestWithResponseCache:self.responseCache] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+#pragma mark Tests
+
+- (void)testFreshResponse
+{
+    __block NSUInteger numberOfParsings = 0;
+    SRGResponseParser parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        numberOfParsings++;
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    };
+    
+    __block id firstObject = nil;
+    [self performRequestWithPath:@"/fresh" parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(object[@"path"], @"/fresh");
+        XCTAssertNil(error);
+        firstObject = object;
+    }];
+    
+    [self performRequestWithPath:@"/fresh" parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqual(object, firstObject);
+        XCTAssertEqual([(NSHTTPURLResponse *)response statusCode], 200);
+        XCTAssertNil(error);
+    }];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/fresh"], 1);
+    XCTAssertEqual(numberOfParsings, 1);
+    XCTAssertEqual(self.responseCache.numberOfHits, 1);
+    XCTAssertEqual(self.responseCache.numberOfMisses, 1);
+    XCTAssertEqual(self.responseCache.numberOfRevalidations, 0);
+}
+
+- (void)testETagRevalidation
+{
+    __block NSUInteger numberOfParsings = 0;
+    SRGResponseParser parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        numberOfParsings++;
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    };
+    
+    for (NSUInteger i = 0; i < 3; i++) {
+        [self performRequestWithPath:@"/etag" parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqualObjects(object[@"path"], @"/etag");
+            XCTAssertEqual([(NSHTTPURLResponse *)response statusCode], 200);
+            XCTAssertNil(error);
+        }];
+    }
+    
+    // Always revalidated, but never parsed again
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/etag"], 3);
+    XCTAssertEqual(numberOfParsings, 1);
+    XCTAssertEqual(self.responseCache.numberOfHits, 2);
+    XCTAssertEqual(self.responseCache.numberOfRevalidations, 2);
+    XCTAssertEqual(self.responseCache.numberOfMisses, 1);
+}
+
+- (void)testRevalidationOfEvictedResponse
+{
+    for (NSUInteger i = 0; i < 2; i++) {
+        [self performRequestWithPath:@"/etag-evicted" parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+            return SRGNetworkJSONDictionaryParser(data, pError);
+        } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqualObjects(object[@"path"], @"/etag-evicted");
+            XCTAssertEqual([(NSHTTPURLResponse *)response statusCode], 200);
+            XCTAssertNil(error);
+        }];
+    }
+    
+    // The empty `304` body is never parsed, the response being retrieved again instead
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/etag-evicted"], 3);
+    XCTAssertEqual(self.responseCache.numberOfHits, 0);
+    XCTAssertEqual(self.responseCache.numberOfRevalidations, 0);
+}
+
+- (void)testLastModifiedRevalidation
+{
+    for (NSUInteger i = 0; i < 2; i++) {
+        [self performRequestWithPath:@"/last-modified" parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+            return SRGNetworkJSONDictionaryParser(data, pError);
+        } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqualObjects(object[@"path"], @"/last-modified");
+            XCTAssertNil(error);
+        }];
+    }
+    
+    XCTAssertEqual(self.responseCache.numberOfHits, 1);
+    XCTAssertEqual(self.responseCache.numberOfRevalidations, 1);
+}
+
+- (void)testNoStore
+{
+    for (NSUInteger i = 0; i < 2; i++) {
+        [self performRequestWithPath:@"/no-store" parser:^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+            return SRGNetworkJSONDictionaryParser(data, pError);
+        } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNotNil(object);
+        }];
+    }
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/no-store"], 2);
+    XCTAssertEqual(self.responseCache.numberOfHits, 0);
+    XCTAssertEqual(self.responseCache.numberOfMisses, 2);
+}
+
+- (void)testHTTPErrorsAreNotCached
+{
+    for (NSUInteger i = 0; i < 2; i++) {
+        [self performRequestWithPath:@"/missing" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        }];
+    }
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/missing"], 2);
+    XCTAssertEqual(self.responseCache.numberOfHits, 0);
+}
+
+- (void)testMemoryEviction
+{
+    self.responseCache.memoryCapacity = 0;
+    
+    [self performRequestWithPath:@"/fresh" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(object);
+    }];
+    
+    XCTAssertEqual(self.responseCache.currentMemoryUsage, 0);
+    
+    // Still available from the disk tier
+    [self performRequestWithPath:@"/fresh" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(object);
+    }];
+    
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/fresh"], 1);
+    XCTAssertEqual(self.responseCache.numberOfHits, 1);
+}
+
+- (void)testCapacityReduction
+{
+    [self performRequestWithPath:@"/fresh" parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(object);
+    }];
+    
+    XCTAssertNotEqual(self.responseCache.currentMemoryUsage, 0);
+    
+    self.responseCache.memoryCapacity = 0;
+    XCTAssertEqual(self.responseCache.currentMemoryUsage, 0);
+    XCTAssertEqual(self.responseCache.numberOfEvictions, 1);
+}
+
+- (void)testPageRequestsPreserveCache
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/fresh"]];
+    SRGFirstPageRequest *request = [[SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+        return URLRequest;
+    } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+        return nil;
+    } completionBlock:^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        // Nothing
+    }] requestWithResponseCache:self.responseCache];
+    
+    XCTAssertEqual(request.responseCache, self.responseCache);
+    XCTAssertEqual([request requestWithPageSize:10].responseCache, self.responseCache);
+    XCTAssertEqual([[request requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] responseCache], self.responseCache);
+}
+
+@end
@@ -0,0 +1,327 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+@interface RetryPolicyTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation RetryPolicyTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    // Paths have the form /<status>/<number of failures>[/<Retry-After value>]. The specified status is returned for
+    // the first requests, then the request succeeds.
+    __weak __typeof(self) weakSelf = self;
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSArray<NSString *> *components = [request.URL.path componentsSeparatedByString:@"/"];
+        NSInteger statusCode = components[1].integerValue;
+        NSUInteger numberOfFailures = components[2].integerValue;
+        NSString *retryAfter = (components.count > 3) ? components[3] : nil;
+        
+        if ([weakSelf.server numberOfRequestsForPath:request.URL.path] <= numberOfFailures) {
+            NSDictionary<NSString *, NSString *> *headers = retryAfter ? @{ @"Retry-After" : retryAfter } : nil;
+            return [LoopbackServerResponse responseWithStatusCode:statusCode headers:headers body:nil];
+        }
+        else {
+            return [LoopbackServerResponse JSONResponseWithObject:@{ @"method" : request.HTTPMethod ?: @"GET" }];
+        }
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRetryPolicy *)fastRetryPolicyWithMaximumNumberOfAttempts:(NSUInteger)maximumNumberOfAttempts
+{
+    SRGRetryPolicy *retryPolicy = [[SRGRetryPolicy alloc] initWithMaximumNumberOfAttempts:maximumNumberOfAttempts timeBudget:10.];
+    retryPolicy.baseDelay = 0.05;
+    return retryPolicy;
+}
+
+- (SRGRequest *)requestForPath:(NSString *)path completionBlock:(SRGJSONDictionaryCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:completionBlock];
+}
+
+#pragma mark Tests
+
+- (void)testDefaultPolicy
+{
+    SRGRetryPolicy *retryPolicy = SRGRetryPolicy.defaultPolicy;
+    XCTAssertEqual(retryPolicy.maximumNumberOfAttempts, 3);
+    XCTAssertEqual(retryPolicy.timeBudget, 30.);
+    XCTAssertTrue([retryPolicy.retryableHTTPStatusCodes containsIndex:503]);
+    XCTAssertFalse([retryPolicy.retryableHTTPStatusCodes containsIndex:500]);
+    XCTAssertFalse(retryPolicy.nonIdempotentRequestRetryEnabled);
+    
+    SRGRequest *request = [self requestForPath:@"/503/0" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {}];
+    XCTAssertNil(request.retryPolicy);
+    XCTAssertEqual([request requestWithRetryPolicy:retryPolicy].retryPolicy, retryPolicy);
+    XCTAssertEqual([[[request requestWithRetryPolicy:retryPolicy] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled] retryPolicy], retryPolicy);
+}
+
+- (void)testWithoutPolicy
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [self requestForPath:@"/503/1" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(JSONDictionary);
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @503);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 1);
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testSuccessfulRetry
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [[self requestForPath:@"/503/2" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(JSONDictionary);
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 3);
+    XCTAssertEqual(self.server.numberOfRequests, 3);
+}
+
+- (void)testMaximumNumberOfAttempts
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [[self requestForPath:@"/502/5" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(JSONDictionary);
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @502);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 3);
+    XCTAssertEqual(self.server.numberOfRequests, 3);
+}
+
+- (void)testNonRetryableStatusCode
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequest *request = [[self requestForPath:@"/404/1" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @404);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 1);
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testRetryAfter
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    NSDate *startDate = NSDate.date;
+    SRGRequest *request = [[self requestForPath:@"/503/1/1" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(JSONDictionary);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertGreaterThanOrEqual([NSDate.date timeIntervalSinceDate:startDate], 1.);
+    XCTAssertEqual(request.numberOfAttempts, 2);
+}
+
+- (void)testTimeBudget
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    // The delay requested by the server exceeds the budget
+    SRGRetryPolicy *retryPolicy = [[SRGRetryPolicy alloc] initWithMaximumNumberOfAttempts:3 timeBudget:2.];
+    SRGRequest *request = [[self requestForPath:@"/503/1/5" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @503);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:retryPolicy];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 1);
+}
+
+- (void)testNonIdempotentRequest
+{
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Request 1 finished"];
+    
+    NSMutableURLRequest *URLRequest1 = [NSMutableURLRequest requestWithURL:[self.server URLForPath:@"/503/1"]];
+    URLRequest1.HTTPMethod = @"POST";
+    SRGRequest *request1 = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest1 session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @503);
+        [expectation1 fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    [request1 resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request1.numberOfAttempts, 1);
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Request 2 finished"];
+    
+    SRGRetryPolicy *retryPolicy = [self fastRetryPolicyWithMaximumNumberOfAttempts:3];
+    retryPolicy.nonIdempotentRequestRetryEnabled = YES;
+    
+    NSMutableURLRequest *URLRequest2 = [NSMutableURLRequest requestWithURL:[self.server URLForPath:@"/503/2"]];
+    URLRequest2.HTTPMethod = @"POST";
+    SRGRequest *request2 = [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest2 session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(JSONDictionary[@"method"], @"POST");
+        [expectation2 fulfill];
+    }] requestWithRetryPolicy:retryPolicy];
+    [request2 resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request2.numberOfAttempts, 3);
+}
+
+- (void)testNetworkErrorRetry
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    // Nothing listens on the port of a stopped server
+    NSURL *URL = [self.server URLForPath:@"/503/0"];
+    [self.server stop];
+    
+    SRGRequest *request = [[SRGRequest dataRequestWithURLRequest:[NSURLRequest requestWithURL:URL] session:NSURLSession.sharedSession completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCannotConnectToHost);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:2]];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 2);
+}
+
+- (void)testQueuePolicy
+{
+    XCTestExpectation *requestExpectation = [self expectationWithDescription:@"Request finished"];
+    XCTestExpectation *queueExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    __block NSUInteger numberOfStateChanges = 0;
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        numberOfStateChanges++;
+        if (finished) {
+            XCTAssertNil(error);
+            [queueExpectation fulfill];
+        }
+    }] requestQueueWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    XCTAssertNotNil(requestQueue.retryPolicy);
+    XCTAssertNotNil([requestQueue requestQueueWithOptions:SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled].retryPolicy);
+    
+    SRGRequest *request = [self requestForPath:@"/504/2" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(JSONDictionary);
+        [requestQueue reportError:error];
+        [requestExpectation fulfill];
+    }];
+    [requestQueue addRequest:request resume:YES];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Retries are invisible to the queue
+    XCTAssertEqual(numberOfStateChanges, 2);
+    XCTAssertEqual(request.numberOfAttempts, 3);
+}
+
+- (void)testRequestPolicyOverridesQueuePolicy
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    SRGRequestQueue *requestQueue = [[[SRGRequestQueue alloc] init] requestQueueWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:5]];
+    SRGRequest *request = [[self requestForPath:@"/503/5" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(error);
+        [expectation fulfill];
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:2]];
+    [requestQueue addRequest:request resume:YES];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(request.numberOfAttempts, 2);
+}
+
+- (void)testCancellationWhileWaiting
+{
+    SRGRequest *request = [[self requestForPath:@"/503/1/2" completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTFail(@"Cancelled requests must not call their completion block");
+    }] requestWithRetryPolicy:[self fastRetryPolicyWithMaximumNumberOfAttempts:3]];
+    [request resume];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(LoopbackServer * _Nullable server, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return server.numberOfRequests == 1;
+    }] evaluatedWithObject:self.server handler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertTrue(request.running);
+    [request cancel];
+    XCTAssertFalse(request.running);
+    
+    [self expectationForElapsedTimeInterval:3. withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.server.numberOfRequests, 1);
+}
+
+- (void)testJitteredDelays
+{
+    SRGRetryPolicy *retryPolicy = [[SRGRetryPolicy alloc] initWithMaximumNumberOfAttempts:10 timeBudget:60.];
+    retryPolicy.baseDelay = 1.;
+    retryPolicy.maximumDelay = 5.;
+    
+    NSMutableSet<NSNumber *> *delays = [NSMutableSet set];
+    for (NSUInteger i = 0; i < 100; i++) {
+        NSTimeInterval delay2 = [retryPolicy delayBeforeAttempt:2 withResponse:nil];
+        XCTAssertGreaterThanOrEqual(delay2, 0.);
+        XCTAssertLessThanOrEqual(delay2, 1.);
+        [delays addObject:@(delay2)];
+        
+        NSTimeInterval delay3 = [retryPolicy delayBeforeAttempt:3 withResponse:nil];
+        XCTAssertLessThanOrEqual(delay3, 2.);
+        
+        NSTimeInterval delay10 = [retryPolicy delayBeforeAttempt:10 withResponse:nil];
+        XCTAssertLessThanOrEqual(delay10, 5.);
+    }
+    
+    // Delays are randomized
+    XCTAssertGreaterThan(delays.count, 1);
+}
+
+@end
@@ -0,0 +1,423 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+// Parsed objects are cached per parser, the same block must therefore be used for all requests
+static SRGResponseParser const kJSONDictionaryParser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+    return SRGNetworkJSONDictionaryParser(data, pError);
+};
+
+@interface StaleWhileRevalidateTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+@property (nonatomic) SRGResponseCache *responseCache;
+
+// Version of the content served
+@property (atomic) NSInteger version;
+
+@end
+
+@implementation StaleWhileRevalidateTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.version = 1;
+    
+    __weak __typeof(self) weakSelf = self;
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSString *path = request.URL.path;
+        NSInteger version = weakSelf.version;
+        NSString *ETag = [NSString stringWithFormat:@"\"v%@\"", @(version)];
+        NSData *body = [NSJSONSerialization dataWithJSONObject:@{ @"version" : @(version) } options:0 error:NULL];
+        
+        LoopbackServerResponse *response = nil;
+        if ([path isEqualToString:@"/etag"]) {
+            if ([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:ETag]) {
+                response = [LoopbackServerResponse responseWithStatusCode:304 headers:@{ @"ETag" : ETag } body:nil];
+            }
+            else {
+                response = [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"no-cache", @"ETag" : ETag } body:body];
+            }
+        }
+        else if ([path isEqualToString:@"/body"]) {
+            // Conditional headers are ignored, content changes can only be detected from the body
+            response = [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"max-age=0", @"Last-Modified" : @"Wed, 21 Oct 2015 07:28:00 GMT" } body:body];
+        }
+        else if ([path isEqualToString:@"/must-revalidate"]) {
+            response = [LoopbackServerResponse responseWithStatusCode:200 headers:@{ @"Cache-Control" : @"no-cache, must-revalidate", @"ETag" : ETag } body:body];
+        }
+        else {
+            response = [LoopbackServerResponse responseWithStatusCode:404 headers:nil body:nil];
+        }
+        response.delay = 0.2;
+        return response;
+    }];
+    XCTAssertTrue([self.server start]);
+    
+    NSURL *directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString]];
+    self.responseCache = [[SRGResponseCache alloc] initWithMemoryCapacity:1024 * 1024 diskCapacity:1024 * 1024 directoryURL:directoryURL];
+}
+
+- (void)tearDown
+{
+    [self.responseCache removeAllCachedResponses];
+    self.responseCache = nil;
+    
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (SRGRequest *)requestWithPath:(NSString *)path maximumStaleness:(NSTimeInterval)maximumStaleness parser:(SRGResponseParser)parser completionBlock:(SRGObjectCompletionBlock)completionBlock
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:path]];
+    SRGRequest *request = [SRGRequest objectRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession parser:parser ?: kJSONDictionaryParser completionBlock:completionBlock];
+    return [[request requestWithResponseCache:self.responseCache] requestWithMaximumStaleness:maximumStaleness];
+}
+
+- (void)populateCacheWithPath:(NSString *)path parser:(SRGResponseParser)parser
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:path maximumStaleness:60. parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertFalse(request.stale);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    request = nil;
+}
+
+- (void)waitUntilRequestFinished:(SRGBaseRequest *)request
+{
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"running == NO"] evaluatedWithObject:request handler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+#pragma mark Tests
+
+- (void)testStaleResultWithUnchangedContent
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stale result received"];
+    
+    __block NSUInteger numberOfCalls = 0;
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/etag" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        numberOfCalls++;
+        XCTAssertTrue(request.stale);
+        XCTAssertEqualObjects(object[@"version"], @1);
+        XCTAssertNil(error);
+        
+        // Still running, since revalidation is in progress
+        XCTAssertTrue(request.running);
+        [expectation fulfill];
+    }];
+    XCTAssertEqual(request.maximumStaleness, 60.);
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // The stale result was delivered before the server was able to respond
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/etag"], 1);
+    
+    [self waitUntilRequestFinished:request];
+    
+    XCTAssertEqual(numberOfCalls, 1);
+    XCTAssertFalse(request.stale);
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/etag"], 2);
+    XCTAssertEqual(self.responseCache.numberOfStaleHits, 1);
+    XCTAssertEqual(self.responseCache.numberOfRevalidations, 1);
+    request = nil;
+}
+
+- (void)testStaleResultWithChangedContent
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    self.version = 2;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Results received"];
+    expectation.expectedFulfillmentCount = 2;
+    
+    __block NSUInteger numberOfCalls = 0;
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/etag" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        numberOfCalls++;
+        XCTAssertNil(error);
+        
+        if (numberOfCalls == 1) {
+            XCTAssertTrue(request.stale);
+            XCTAssertEqualObjects(object[@"version"], @1);
+        }
+        else {
+            XCTAssertFalse(request.stale);
+            XCTAssertEqualObjects(object[@"version"], @2);
+        }
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitUntilRequestFinished:request];
+    
+    XCTAssertEqual(numberOfCalls, 2);
+    request = nil;
+}
+
+- (void)testUnchangedBody
+{
+    __block NSUInteger numberOfParsings = 0;
+    SRGResponseParser parser = ^id _Nullable(NSData *data, NSError * __autoreleasing *pError) {
+        numberOfParsings++;
+        return SRGNetworkJSONDictionaryParser(data, pError);
+    };
+    
+    [self populateCacheWithPath:@"/body" parser:parser];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stale result received"];
+    
+    __block NSUInteger numberOfCalls = 0;
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/body" maximumStaleness:60. parser:parser completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        numberOfCalls++;
+        XCTAssertTrue(request.stale);
+        XCTAssertEqualObjects(object[@"version"], @1);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitUntilRequestFinished:request];
+    
+    // Identical bodies are never parsed again
+    XCTAssertEqual(numberOfCalls, 1);
+    XCTAssertEqual(numberOfParsings, 1);
+    XCTAssertEqual([self.server numberOfRequestsForPath:@"/body"], 2);
+    request = nil;
+}
+
+- (void)testChangedBody
+{
+    [self populateCacheWithPath:@"/body" parser:nil];
+    self.version = 2;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Results received"];
+    expectation.expectedFulfillmentCount = 2;
+    
+    NSMutableArray<NSNumber *> *versions = [NSMutableArray array];
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/body" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        [versions addObject:object[@"version"]];
+        XCTAssertEqual(request.stale, versions.count == 1);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitUntilRequestFinished:request];
+    
+    XCTAssertEqualObjects(versions, (@[ @1, @2 ]));
+    request = nil;
+}
+
+- (void)testMaximumStalenessExceeded
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    self.version = 2;
+    
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Result received"];
+    
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/etag" maximumStaleness:0.1 parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertFalse(request.stale);
+        XCTAssertEqualObjects(object[@"version"], @2);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.responseCache.numberOfStaleHits, 0);
+    request = nil;
+}
+
+- (void)testMustRevalidate
+{
+    [self populateCacheWithPath:@"/must-revalidate" parser:nil];
+    self.version = 2;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Result received"];
+    
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/must-revalidate" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertFalse(request.stale);
+        XCTAssertEqualObjects(object[@"version"], @2);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(self.responseCache.numberOfStaleHits, 0);
+    request = nil;
+}
+
+- (void)testDisabled
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Result received"];
+    
+    __block SRGRequest *request = nil;
+    request = [[self requestWithPath:@"/etag" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertFalse(request.stale);
+        XCTAssertEqualObjects(object[@"version"], @1);
+        
+        // Revalidation has been waited for
+        XCTAssertEqual([self.server numberOfRequestsForPath:@"/etag"], 2);
+        [expectation fulfill];
+    }] requestWithMaximumStaleness:0.];
+    XCTAssertEqual(request.maximumStaleness, 0.);
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    request = nil;
+}
+
+- (void)testFailedRevalidation
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    [self.server stop];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stale result received"];
+    
+    __block NSUInteger numberOfCalls = 0;
+    __block SRGRequest *request = nil;
+    request = [self requestWithPath:@"/etag" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        numberOfCalls++;
+        XCTAssertTrue(request.stale);
+        XCTAssertEqualObjects(object[@"version"], @1);
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    [self waitUntilRequestFinished:request];
+    
+    // Revalidation errors are not reported
+    XCTAssertEqual(numberOfCalls, 1);
+    request = nil;
+}
+
+- (void)testCancellationDuringRevalidation
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    self.version = 2;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stale result received"];
+    
+    __block NSUInteger numberOfCalls = 0;
+    __block SRGRequest *request = nil;
+    request = [[self requestWithPath:@"/etag" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        numberOfCalls++;
+        XCTAssertTrue(request.stale);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled];
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [request cancel];
+    XCTAssertFalse(request.running);
+    
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Cancellation errors are not reported once a stale result has been delivered
+    XCTAssertEqual(numberOfCalls, 1);
+    request = nil;
+}
+
+- (void)testRequestQueueRunningUntilRevalidationEnds
+{
+    [self populateCacheWithPath:@"/etag" parser:nil];
+    
+    XCTestExpectation *staleExpectation = [self expectationWithDescription:@"Stale result received"];
+    XCTestExpectation *queueExpectation = [self expectationWithDescription:@"Queue finished"];
+    
+    __block BOOL staleResultReceived = NO;
+    SRGRequestQueue *requestQueue = [[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
+        if (finished) {
+            XCTAssertTrue(staleResultReceived);
+            XCTAssertNil(error);
+            XCTAssertEqual([self.server numberOfRequestsForPath:@"/etag"], 2);
+            [queueExpectation fulfill];
+        }
+    }];
+    
+    SRGRequest *request = [self requestWithPath:@"/etag" maximumStaleness:60. parser:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        staleResultReceived = YES;
+        XCTAssertTrue(requestQueue.running);
+        [staleExpectation fulfill];
+    }];
+    [requestQueue addRequest:request resume:YES];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(requestQueue.running);
+}
+
+- (void)testPageRequests
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/etag"]];
+    SRGFirstPageRequest *(^firstPageRequest)(SRGJSONDictionaryPageCompletionBlock) = ^SRGFirstPageRequest *(SRGJSONDictionaryPageCompletionBlock completionBlock) {
+        return [[[SRGFirstPageRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession sizer:^NSURLRequest * _Nonnull(NSURLRequest * _Nonnull URLRequest, NSUInteger size) {
+            return URLRequest;
+        } paginator:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull URLRequest, NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSUInteger size, NSUInteger number) {
+            return nil;
+        } completionBlock:completionBlock] requestWithResponseCache:self.responseCache] requestWithMaximumStaleness:60.];
+    };
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"First result received"];
+    [firstPageRequest(^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqualObjects(JSONDictionary[@"version"], @1);
+        [expectation1 fulfill];
+    }) resume];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    self.version = 2;
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Results received"];
+    expectation2.expectedFulfillmentCount = 2;
+    
+    NSMutableArray<NSNumber *> *versions = [NSMutableArray array];
+    SRGFirstPageRequest *request = firstPageRequest(^(NSDictionary * _Nullable JSONDictionary, SRGPage * _Nonnull page, SRGPage * _Nullable nextPage, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertEqual(page.number, 0);
+        [versions addObject:JSONDictionary[@"version"]];
+        [expectation2 fulfill];
+    });
+    XCTAssertEqual(request.maximumStaleness, 60.);
+    [request resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqualObjects(versions, (@[ @1, @2 ]));
+}
+
+@end
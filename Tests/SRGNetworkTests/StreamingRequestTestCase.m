@@ -0,0 +1,377 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "LoopbackServer.h"
+#import "NetworkBaseTestCase.h"
+
+static NSArray<NSDictionary *> *StreamingRequestTestItems(NSUInteger count)
+{
+    NSMutableArray<NSDictionary *> *items = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [items addObject:@{ @"id" : @(i),
+                            @"title" : [NSString stringWithFormat:@"Media \"%@\" – épisode ✓", @(i)],
+                            @"duration" : @(i * 1.5),
+                            @"tags" : @[ @"news", @"sport" ],
+                            @"available" : @(i % 2 == 0),
+                            @"image" : NSNull.null }];
+    }
+    return items.copy;
+}
+
+// Session delegate recording the tasks for which metrics have been collected.
+@interface StreamingRequestSessionDelegate : NSObject <NSURLSessionTaskDelegate>
+
+@property (nonatomic) XCTestExpectation *metricsExpectation;
+
+@end
+
+@implementation StreamingRequestSessionDelegate
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics
+{
+    [self.metricsExpectation fulfill];
+}
+
+@end
+
+@interface StreamingRequestTestCase : NetworkBaseTestCase
+
+@property (nonatomic) LoopbackServer *server;
+
+@end
+
+@implementation StreamingRequestTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.server = [[LoopbackServer alloc] initWithHandler:^LoopbackServerResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+        NSString *path = request.URL.path;
+        if ([path isEqualToString:@"/dictionary"]) {
+            LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:@{ @"name" : @"a \\ \"quoted\" é\U0001F600 string\n",
+                                                                                                 @"count" : @-12,
+                                                                                                 @"ratio" : @0.5,
+                                                                                                 @"big" : @(LLONG_MAX),
+                                                                                                 @"flags" : @[ @YES, @NO, NSNull.null ],
+                                                                                                 @"nested" : @{ @"empty" : @{}, @"list" : @[] },
+                                                                                                 @"items" : StreamingRequestTestItems(10) }];
+            response.bodyChunkSize = 7;
+            return response;
+        }
+        else if ([path isEqualToString:@"/array"]) {
+            LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:StreamingRequestTestItems(2000)];
+            response.bodyChunkSize = 1024;
+            return response;
+        }
+        else if ([path isEqualToString:@"/slow-array"]) {
+            LoopbackServerResponse *response = [LoopbackServerResponse JSONResponseWithObject:StreamingRequestTestItems(200)];
+            response.bodyChunkSize = 2048;
+            response.bodyChunkInterval = 0.05;
+            return response;
+        }
+        else if ([path isEqualToString:@"/large-array"]) {
+            return [LoopbackServerResponse JSONResponseWithObject:StreamingRequestTestItems(50000)];
+        }
+        else if ([path isEqualToString:@"/invalid"]) {
+            NSData *body = [@"[{\"id\": 1}, {\"id\": 2]" dataUsingEncoding:NSUTF8StringEncoding];
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:nil body:body];
+        }
+        else if ([path hasPrefix:@"/invalid-number/"]) {
+            NSString *JSONString = [NSString stringWithFormat:@"[{\"id\": %@}]", path.lastPathComponent];
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:nil body:[JSONString dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+        else if ([path isEqualToString:@"/truncated"]) {
+            NSData *body = [@"[{\"id\": 1}, {\"id\": 2}" dataUsingEncoding:NSUTF8StringEncoding];
+            return [LoopbackServerResponse responseWithStatusCode:200 headers:nil body:body];
+        }
+        else {
+            NSData *body = [@"<html>Not found</html>" dataUsingEncoding:NSUTF8StringEncoding];
+            return [LoopbackServerResponse responseWithStatusCode:404 headers:nil body:body];
+        }
+    }];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown
+{
+    [self.server stop];
+    self.server = nil;
+}
+
+#pragma mark Helpers
+
+- (void)measureTimeAndMemoryWithBlock:(void (^)(void))block
+{
+    if (@available(iOS 13, tvOS 13, *)) {
+        [self measureWithMetrics:@[ [[XCTClockMetric alloc] init], [[XCTMemoryMetric alloc] init] ] block:block];
+    }
+    else {
+        [self measureBlock:block];
+    }
+}
+
+#pragma mark Tests
+
+- (void)testStreamedObjectMatchesBufferedObject
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/dictionary"]];
+    
+    __block NSDictionary *bufferedJSONDictionary = nil;
+    XCTestExpectation *bufferedExpectation = [self expectationWithDescription:@"Buffered request finished"];
+    [[SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        bufferedJSONDictionary = JSONDictionary;
+        [bufferedExpectation fulfill];
+    }] resume];
+    
+    __block id streamedObject = nil;
+    XCTestExpectation *streamedExpectation = [self expectationWithDescription:@"Streamed request finished"];
+    [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertNil(error);
+        streamedObject = object;
+        [streamedExpectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertNotNil(bufferedJSONDictionary);
+    XCTAssertEqualObjects(streamedObject, bufferedJSONDictionary);
+}
+
+- (void)testElementBlock
+{
+    __block NSUInteger numberOfElements = 0;
+    __block BOOL ordered = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/array"]];
+    [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:^(id  _Nonnull element) {
+        XCTAssertFalse(NSThread.isMainThread);
+        if ([element[@"id"] unsignedIntegerValue] != numberOfElements) {
+            ordered = NO;
+        }
+        numberOfElements++;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        
+        // Elements are not accumulated
+        XCTAssertEqualObjects(object, @[]);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(numberOfElements, 2000);
+    XCTAssertTrue(ordered);
+}
+
+- (void)testFirstElementBeforeDownloadEnd
+{
+    __block NSDate *firstElementDate = nil;
+    __block NSDate *completionDate = nil;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/slow-array"]];
+    [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:^(id  _Nonnull element) {
+        if (! firstElementDate) {
+            firstElementDate = NSDate.date;
+        }
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        completionDate = NSDate.date;
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // The body is delivered over several hundred milliseconds. The first element must be available well before the end.
+    XCTAssertNotNil(firstElementDate);
+    XCTAssertGreaterThan([completionDate timeIntervalSinceDate:firstElementDate], 0.2);
+}
+
+- (void)testInvalidJSON
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/invalid"]];
+    [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(object);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testInvalidNumbers
+{
+    // Same number grammar as for other JSON parsers
+    for (NSString *number in @[ @"01", @"1.", @"+1", @"-", @"1e", @"1.5e+" ]) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+        NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:[@"/invalid-number/" stringByAppendingString:number]]];
+        [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(object, @"%@", number);
+            XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain, @"%@", number);
+            XCTAssertEqual(error.code, SRGNetworkErrorInvalidData, @"%@", number);
+            [expectation fulfill];
+        }] resume];
+        
+        [self waitForExpectationsWithTimeout:10. handler:nil];
+    }
+}
+
+- (void)testTruncatedJSON
+{
+    __block NSUInteger numberOfElements = 0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/truncated"]];
+    [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:^(id  _Nonnull element) {
+        numberOfElements++;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(object);
+        XCTAssertEqual(error.code, SRGNetworkErrorInvalidData);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Elements received before the error was detected have been delivered
+    XCTAssertEqual(numberOfElements, 2);
+}
+
+- (void)testHTTPError
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/missing"]];
+    [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(object);
+        XCTAssertEqualObjects(error.domain, SRGNetworkErrorDomain);
+        XCTAssertEqual(error.code, SRGNetworkErrorHTTP);
+        XCTAssertEqualObjects(error.userInfo[SRGNetworkHTTPStatusCodeKey], @404);
+        [expectation fulfill];
+    }] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testCancellation
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/slow-array"]];
+    SRGRequest *request = [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(object);
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionCancellationErrorsEnabled];
+    [request resume];
+    [request cancel];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(request.running);
+}
+
+- (void)testCopyPreservesStreaming
+{
+    __block NSUInteger numberOfElements = 0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/array"]];
+    [[[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:^(id  _Nonnull element) {
+        numberOfElements++;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(numberOfElements, 2000);
+}
+
+- (void)testParsingExecutor
+{
+    SRGParsingExecutor *parsingExecutor = [[SRGParsingExecutor alloc] initWithMaximumConcurrentOperationCount:1];
+    
+    __block NSUInteger numberOfElements = 0;
+    __block BOOL executedByParsingExecutor = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/array"]];
+    [[[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:^(id  _Nonnull element) {
+        if (parsingExecutor.numberOfRunningOperations != 1) {
+            executedByParsingExecutor = NO;
+        }
+        numberOfElements++;
+    } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] requestWithParsingExecutor:parsingExecutor] resume];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(numberOfElements, 2000);
+    XCTAssertTrue(executedByParsingExecutor);
+}
+
+- (void)testSessionDelegate
+{
+    if (@available(iOS 15, tvOS 15, *)) {
+        StreamingRequestSessionDelegate *sessionDelegate = [[StreamingRequestSessionDelegate alloc] init];
+        sessionDelegate.metricsExpectation = [self expectationWithDescription:@"Metrics collected"];
+        NSURLSession *session = [NSURLSession sessionWithConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration delegate:sessionDelegate delegateQueue:nil];
+        
+        // Streamed requests are performed with the provided session, whose delegate is still involved
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+        NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/array"]];
+        [[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:session elementBlock:nil completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }] resume];
+        
+        [self waitForExpectationsWithTimeout:10. handler:nil];
+        [session finishTasksAndInvalidate];
+    }
+}
+
+#pragma mark Performance tests
+
+- (void)testBufferedParsingPerformance
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/large-array"]];
+    [self measureTimeAndMemoryWithBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+        [[[SRGRequest JSONArrayRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession completionBlock:^(NSArray * _Nullable JSONArray, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqual(JSONArray.count, 50000);
+            [expectation fulfill];
+        }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] resume];
+        [self waitForExpectationsWithTimeout:30. handler:nil];
+    }];
+}
+
+- (void)testStreamedParsingPerformance
+{
+    NSURLRequest *URLRequest = [NSURLRequest requestWithURL:[self.server URLForPath:@"/large-array"]];
+    [self measureTimeAndMemoryWithBlock:^{
+        __block NSUInteger numberOfElements = 0;
+        
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request finished"];
+        [[[SRGRequest JSONStreamRequestWithURLRequest:URLRequest session:NSURLSession.sharedSession elementBlock:^(id  _Nonnull element) {
+            numberOfElements++;
+        } completionBlock:^(id _Nullable object, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+            XCTAssertEqual(numberOfElements, 50000);
+            [expectation fulfill];
+        }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled] resume];
+        [self waitForExpectationsWithTimeout:30. handler:nil];
+    }];
+}
+
+@end